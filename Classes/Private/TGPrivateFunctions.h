@@ -8,20 +8,17 @@
 
 #import <Foundation/Foundation.h>
 
-@class TGRESTResource;
-
 extern NSString * TGApplicationDataDirectory(void);
 extern NSString * TGExecutableName(void);
 extern NSString * TGExtractHeaderValueParameter(NSString *value, NSString *name);
 extern NSStringEncoding TGStringEncodingFromCharset(NSString *charset);
 extern NSDictionary *TGParseURLEncodedForm(NSString *form);
 
-extern NSString *TGIndexRegex(TGRESTResource *resource);
-extern NSString *TGShowRegex(TGRESTResource *resource);
-extern NSString *TGCreateRegex(TGRESTResource *resource);
-extern NSString *TGUpdateRegex(TGRESTResource *resource);
-extern NSString *TGDestroyRegex(TGRESTResource *resource);
-
 extern uint8_t TGCountOfCores(void);
-extern CGFloat TGTimedBlock (void (^block)(void));
-extern CGFloat TGRandomInRange(CGFloat lowerRange, CGFloat upperRange);
\ No newline at end of file
+
+/**
+ Nanoseconds on a clock that only ever moves forward and isn't affected by changes to the wall clock, mach_absolute_time on Apple platforms and CLOCK_MONOTONIC everywhere else.  Only differences between two readings are meaningful.
+ */
+
+extern uint64_t TGMonotonicTime(void);
+extern CGFloat TGTimedBlock (void (^block)(void));
\ No newline at end of file
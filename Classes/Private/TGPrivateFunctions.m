@@ -7,9 +7,13 @@
 //
 
 #import "TGPrivateFunctions.h"
-#import "TGRESTResource.h"
+#if defined(__APPLE__)
 #include <sys/sysctl.h>
 #import <mach/mach_time.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
 
 NSString *TGApplicationDataDirectory(void)
 {
@@ -101,100 +105,40 @@ NSDictionary *TGParseURLEncodedForm(NSString *form) {
     return parameters;
 }
 
-NSString *TGIndexRegex(TGRESTResource *resource)
-{
-    NSMutableString *regex = [NSMutableString new];
-    
-    // First append the default match
-    
-    [regex appendString:[NSString stringWithFormat:@"^(/%@/?$)", resource.name]];
-    
-    // Now add any paths from the parents
-    
-    for (TGRESTResource *parent in resource.parentResources) {
-        [regex appendString:[NSString stringWithFormat:@"|(/%@/\\w+/%@/?$)", parent.name, resource.name]];
-    }
-    
-    return [NSString stringWithString:regex];
-}
-
-NSString *TGShowRegex(TGRESTResource *resource)
-{
-    NSMutableString *regex = [NSMutableString new];
-    
-    // Shallow nested, use the base path only
-    
-    [regex appendString:[NSString stringWithFormat:@"^(/%@/\\w+/?$)", resource.name]];
-    
-    return [NSString stringWithString:regex];
-}
-
-NSString *TGCreateRegex(TGRESTResource *resource)
-{
-    NSMutableString *regex = [NSMutableString new];
-    
-    // First append the default match
-    
-    [regex appendString:[NSString stringWithFormat:@"^(/%@/?$)", resource.name]];
-    
-    // Now add any paths from the parents
-    
-    for (TGRESTResource *parent in resource.parentResources) {
-        [regex appendString:[NSString stringWithFormat:@"|(/%@/\\w+/%@/?$)", parent.name, resource.name]];
-    }
-    
-    return [NSString stringWithString:regex];
-}
-
-NSString *TGUpdateRegex(TGRESTResource *resource)
-{
-    NSMutableString *regex = [NSMutableString new];
-    
-    // Shallow nested, use the base path only
-    
-    [regex appendString:[NSString stringWithFormat:@"^(/%@/\\w+/?$)", resource.name]];
-    
-    return [NSString stringWithString:regex];
-}
-
-NSString *TGDestroyRegex(TGRESTResource *resource)
-{
-    NSMutableString *regex = [NSMutableString new];
-    
-    // Shallow nested, use the base path only
-    
-    [regex appendString:[NSString stringWithFormat:@"^(/%@/\\w+/?$)", resource.name]];
-    
-    return [NSString stringWithString:regex];
-}
-
 uint8_t TGCountOfCores(void)
 {
+#if defined(__APPLE__)
     NSUInteger ncpu;
     size_t len = sizeof(ncpu);
     sysctlbyname("hw.ncpu", &ncpu, &len, NULL, 0);
     
     return ncpu;
+#else
+    return (uint8_t)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 }
 
-CGFloat TGTimedBlock (void (^block)(void))
+uint64_t TGMonotonicTime(void)
 {
-    mach_timebase_info_data_t info;
-    if (mach_timebase_info(&info) != KERN_SUCCESS) return -1.0;
-    
-    uint64_t start = mach_absolute_time ();
-    block ();
-    uint64_t end = mach_absolute_time ();
-    uint64_t elapsed = end - start;
-    
-    uint64_t nanos = elapsed * info.numer / info.denom;
-    return (CGFloat)nanos / NSEC_PER_SEC;
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t info;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&info);
+    });
+    return mach_absolute_time() * info.numer / info.denom;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+#endif
 }
 
-CGFloat TGRandomInRange(CGFloat lowerRange, CGFloat upperRange)
+CGFloat TGTimedBlock (void (^block)(void))
 {
-    CGFloat random = drand48();
-    CGFloat range = upperRange - lowerRange;
-    CGFloat scaled = random * range;
-    return scaled + lowerRange;
+    uint64_t start = TGMonotonicTime();
+    block ();
+    uint64_t elapsed = TGMonotonicTime() - start;
+    
+    return (CGFloat)elapsed / NSEC_PER_SEC;
 }
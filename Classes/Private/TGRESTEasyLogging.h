@@ -10,6 +10,7 @@
 #define _TGRESTEasyLogging_h
 
 #import "TGRESTServer.h"
+#import "TGRESTLogger.h"
 
 #define TG_LOG_FLAG_FATAL   (1 << 0)  // 0...0001
 #define TG_LOG_FLAG_ERROR   (1 << 1)  // 0...0010
@@ -24,6 +25,15 @@
 #define TG_LOG_LEVEL_INFO    (TG_LOG_FLAG_FATAL | TG_LOG_FLAG_ERROR | TG_LOG_FLAG_WARN | TG_LOG_FLAG_INFO)                    // 0...0111
 #define TG_LOG_LEVEL_VERBOSE (TG_LOG_FLAG_FATAL | TG_LOG_FLAG_ERROR | TG_LOG_FLAG_WARN | TG_LOG_FLAG_INFO | TG_LOG_FLAG_VERBOSE) // 0...1111
 
+// Levels missing from the minimum level are compiled out, arguments and all, so Info and Verbose calls cost nothing on hot paths in release builds.  Define it before this header is imported to change it.
+#ifndef TG_LOG_MINIMUM_LEVEL
+#ifdef DEBUG
+#define TG_LOG_MINIMUM_LEVEL TG_LOG_LEVEL_VERBOSE
+#else
+#define TG_LOG_MINIMUM_LEVEL TG_LOG_LEVEL_WARN
+#endif
+#endif
+
 #define LOG_ASYNC_ENABLED YES
 
 #define LOG_ASYNC_ERROR   ( NO && LOG_ASYNC_ENABLED)
@@ -34,10 +44,10 @@
 #ifndef LOG_MACRO
 
 #define LOG_MACRO(isAsynchronous, lvl, flg, ctx, atag, fnct, frmt, ...) \
-NSLog (frmt, ##__VA_ARGS__)
+TGRESTLogMessage(isAsynchronous, ^NSString *{ return [NSString stringWithFormat:frmt, ##__VA_ARGS__]; })
 
 #define LOG_MAYBE(async, lvl, flg, ctx, fnct, frmt, ...) \
-do { if(lvl & flg) LOG_MACRO(async, lvl, flg, ctx, nil, fnct, frmt, ##__VA_ARGS__); } while(0)
+do { if((TG_LOG_MINIMUM_LEVEL & flg) && (lvl & flg)) LOG_MACRO(async, lvl, flg, ctx, nil, fnct, frmt, ##__VA_ARGS__); } while(0)
 
 #define LOG_OBJC_MAYBE(async, lvl, flg, ctx, frmt, ...) \
 LOG_MAYBE(async, lvl, flg, ctx, sel_getName(_cmd), frmt, ##__VA_ARGS__)
@@ -0,0 +1,38 @@
+//
+//  TGRESTFixtureLoader.h
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource, TGRESTStore;
+
+/**
+ Loads a JSON array or newline delimited JSON buffer into a store.  The buffer is cut into chunks on element boundaries, a window of chunks is parsed and normalized against the resource model in parallel and each window is bulk inserted in file order while the next one is being parsed, so only two windows of parsed objects are ever alive at once.
+ */
+
+@interface TGRESTFixtureLoader : NSObject
+
+@property (nonatomic, assign) NSUInteger chunkSize;
+@property (nonatomic, assign) NSUInteger concurrency;
+
++ (instancetype)loaderWithResource:(TGRESTResource *)resource store:(TGRESTStore *)store;
+
++ (NSArray *)normalizedObjectsFromArray:(NSArray *)array forResource:(TGRESTResource *)resource;
+
+/**
+ *  Loads the buffer into the store.  Windows are inserted as soon as they are parsed, so a load that fails partway through is not rolled back and leaves the objects ahead of the malformed chunk (or the failed insert) in the store.
+ *
+ *  @param data        Buffer holding a JSON array of objects or newline delimited JSON.
+ *  @param loadedCount On return holds the number of objects inserted into the store, which is also how many a failed load left behind.
+ *  @param error       On return contains the error that stopped the load.
+ *
+ *  @return YES if every object in the buffer was loaded.
+ */
+
+- (BOOL)loadData:(NSData *)data loadedCount:(NSUInteger *)loadedCount error:(NSError * __autoreleasing *)error;
+
+@end
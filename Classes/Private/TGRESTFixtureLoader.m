@@ -0,0 +1,303 @@
+//
+//  TGRESTFixtureLoader.m
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import "TGRESTFixtureLoader.h"
+#import "TGRESTResource.h"
+#import "TGRESTStore.h"
+#import "TGRESTServer.h"
+#import "TGPrivateFunctions.h"
+#import "TGRESTEasyLogging.h"
+
+static NSUInteger const TGFixtureDefaultChunkSize = 1 << 20;
+
+typedef NS_ENUM(NSUInteger, TGFixtureFormat) {
+    TGFixtureFormatArray,
+    TGFixtureFormatLines
+};
+
+static inline BOOL TGFixtureIsWhitespace(uint8_t byte)
+{
+    return byte == ' ' || byte == '\n' || byte == '\r' || byte == '\t';
+}
+
+static NSUInteger TGFixtureSkipWhitespace(const uint8_t *bytes, NSUInteger length, NSUInteger position)
+{
+    while (position < length && TGFixtureIsWhitespace(bytes[position])) {
+        position++;
+    }
+    
+    return position;
+}
+
+/**
+ Scans the elements of a JSON array from `start`, which must be the start of an element, and returns the position of the first top level comma at least `target` bytes in, or of the closing bracket.  Only brackets, braces and strings are tracked, the elements themselves are validated when they are parsed.  Returns NSNotFound if the buffer ends first.
+ */
+
+static NSUInteger TGFixtureNextArrayBoundary(const uint8_t *bytes, NSUInteger length, NSUInteger start, NSUInteger target, BOOL *closed)
+{
+    NSUInteger depth = 0;
+    NSUInteger position = start;
+    
+    while (position < length) {
+        uint8_t byte = bytes[position];
+        if (byte == '"') {
+            for (position++; position < length && bytes[position] != '"'; position++) {
+                if (bytes[position] == '\\') {
+                    position++;
+                }
+            }
+        } else if (byte == '{' || byte == '[') {
+            depth++;
+        } else if (byte == '}' || byte == ']') {
+            if (depth == 0) {
+                *closed = YES;
+                return position;
+            }
+            depth--;
+        } else if (byte == ',' && depth == 0 && position - start >= target) {
+            return position;
+        }
+        position++;
+    }
+    
+    return NSNotFound;
+}
+
+static NSError *TGFixtureError(NSString *reason)
+{
+    return [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:@{NSLocalizedDescriptionKey: reason}];
+}
+
+@interface TGRESTFixtureLoader ()
+
+@property (nonatomic, strong) TGRESTResource *resource;
+@property (nonatomic, strong) TGRESTStore *store;
+
+@end
+
+@implementation TGRESTFixtureLoader
+
++ (instancetype)loaderWithResource:(TGRESTResource *)resource store:(TGRESTStore *)store
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(store);
+    
+    TGRESTFixtureLoader *loader = [self new];
+    loader.resource = resource;
+    loader.store = store;
+    loader.chunkSize = TGFixtureDefaultChunkSize;
+    loader.concurrency = TGCountOfCores();
+    
+    return loader;
+}
+
++ (NSArray *)normalizedObjectsFromArray:(NSArray *)array forResource:(TGRESTResource *)resource
+{
+    NSArray *modelKeys = resource.model.allKeys;
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:array.count];
+    NSUInteger skippedCount = 0;
+    
+    for (NSDictionary *objectDictionary in array) {
+        if (![objectDictionary isKindOfClass:[NSDictionary class]]) {
+            skippedCount++;
+            continue;
+        }
+        NSMutableDictionary *newObjectStub = [NSMutableDictionary dictionaryWithCapacity:modelKeys.count];
+        for (NSString *key in modelKeys) {
+            id value = objectDictionary[key];
+            if (value) {
+                [newObjectStub setObject:value forKey:key];
+            }
+        }
+        if (newObjectStub.count > 0) {
+            [objects addObject:[NSDictionary dictionaryWithDictionary:newObjectStub]];
+        } else {
+            skippedCount++;
+        }
+    }
+    
+    if (skippedCount > 0) {
+        TGLogWarn(@"Skipped %lu objects with no keys matching the model of %@", (unsigned long)skippedCount, resource.name);
+    }
+    
+    return objects;
+}
+
+- (BOOL)loadData:(NSData *)data loadedCount:(NSUInteger *)loadedCount error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(data);
+    
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger position = 0;
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        position = 3;
+    }
+    position = TGFixtureSkipWhitespace(bytes, length, position);
+    
+    TGFixtureFormat format = TGFixtureFormatLines;
+    if (position < length && bytes[position] == '[') {
+        format = TGFixtureFormatArray;
+        position = TGFixtureSkipWhitespace(bytes, length, position + 1);
+    }
+    
+    NSUInteger chunkSize = MAX(self.chunkSize, 1);
+    NSUInteger windowSize = MAX(self.concurrency, 1) * 2;
+    dispatch_queue_t insertQueue = dispatch_queue_create("com.tinylittlegears.resteasy.loader", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t insertGroup = dispatch_group_create();
+    __block NSUInteger insertedCount = 0;
+    __block NSError *insertError;
+    NSError *loadError;
+    BOOL finished = (position >= length);
+    
+    while (!finished && !loadError) {
+        // Cutting chunks is a cheap sequential scan, the expensive parsing and normalizing happens in parallel below.
+        NSMutableArray *ranges = [NSMutableArray arrayWithCapacity:windowSize];
+        while (ranges.count < windowSize && !finished) {
+            NSUInteger end;
+            if (format == TGFixtureFormatArray) {
+                BOOL closed = NO;
+                end = TGFixtureNextArrayBoundary(bytes, length, position, chunkSize, &closed);
+                if (end == NSNotFound) {
+                    loadError = TGFixtureError(@"The JSON array is not terminated");
+                    break;
+                }
+                if (closed) {
+                    finished = YES;
+                    // The last chunk can be cut right after a comma and come out empty, so look behind the bracket for a trailing comma.
+                    NSUInteger last = end;
+                    while (last > 0 && TGFixtureIsWhitespace(bytes[last - 1])) {
+                        last--;
+                    }
+                    if (last > 0 && bytes[last - 1] == ',') {
+                        loadError = TGFixtureError(@"The JSON array has a trailing comma");
+                        break;
+                    }
+                    if (TGFixtureSkipWhitespace(bytes, length, end + 1) != length) {
+                        loadError = TGFixtureError(@"Unexpected data after the end of the JSON array");
+                        break;
+                    }
+                }
+            } else {
+                NSUInteger searchStart = MIN(position + chunkSize, length);
+                const uint8_t *newline = memchr(bytes + searchStart, '\n', length - searchStart);
+                end = newline ? (NSUInteger)(newline - bytes) : length;
+                finished = (end >= length - 1);
+            }
+            if (end > position) {
+                [ranges addObject:[NSValue valueWithRange:NSMakeRange(position, end - position)]];
+            }
+            position = end + 1;
+        }
+        if (loadError || ranges.count == 0) {
+            break;
+        }
+        
+        NSMutableArray *results = [NSMutableArray arrayWithCapacity:ranges.count];
+        for (NSUInteger x = 0; x < ranges.count; x++) {
+            [results addObject:[NSNull null]];
+        }
+        __block NSError *parseError;
+        dispatch_apply(ranges.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+            @autoreleasepool {
+                NSError *chunkError;
+                NSArray *objects = [self objectsInRange:[ranges[index] rangeValue] ofBytes:bytes format:format error:&chunkError];
+                @synchronized(results) {
+                    if (objects) {
+                        [results replaceObjectAtIndex:index withObject:objects];
+                    } else if (!parseError) {
+                        parseError = chunkError;
+                    }
+                }
+            }
+        });
+        if (parseError) {
+            loadError = parseError;
+            break;
+        }
+        
+        // The previous window is still being inserted while this one was parsed, wait for it so objects keep their order in the file.
+        dispatch_group_wait(insertGroup, DISPATCH_TIME_FOREVER);
+        if (insertError) {
+            break;
+        }
+        dispatch_group_async(insertGroup, insertQueue, ^{
+            for (NSArray *objects in results) {
+                if (objects.count == 0) {
+                    continue;
+                }
+                @autoreleasepool {
+                    NSError *storeError;
+                    [self.store createNewObjectsForResource:self.resource withPropertiesArray:objects error:&storeError];
+                    if (storeError) {
+                        insertError = storeError;
+                        return;
+                    }
+                    insertedCount = insertedCount + objects.count;
+                }
+            }
+        });
+    }
+    dispatch_group_wait(insertGroup, DISPATCH_TIME_FOREVER);
+    
+    if (loadedCount) {
+        *loadedCount = insertedCount;
+    }
+    
+    loadError = loadError ?: insertError;
+    if (loadError) {
+        if (error) {
+            *error = loadError;
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (NSArray *)objectsInRange:(NSRange)range ofBytes:(const uint8_t *)bytes format:(TGFixtureFormat)format error:(NSError * __autoreleasing *)error
+{
+    // Every chunk is wrapped up as a JSON array of its own so each one is a single parse.
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:range.length + 2];
+    [buffer appendBytes:"[" length:1];
+    if (format == TGFixtureFormatArray) {
+        [buffer appendBytes:bytes + range.location length:range.length];
+    } else {
+        NSUInteger lineStart = range.location;
+        NSUInteger end = NSMaxRange(range);
+        while (lineStart < end) {
+            const uint8_t *newline = memchr(bytes + lineStart, '\n', end - lineStart);
+            NSUInteger lineEnd = newline ? (NSUInteger)(newline - bytes) : end;
+            NSUInteger contentStart = TGFixtureSkipWhitespace(bytes, lineEnd, lineStart);
+            if (contentStart < lineEnd) {
+                if (buffer.length > 1) {
+                    [buffer appendBytes:"," length:1];
+                }
+                [buffer appendBytes:bytes + contentStart length:lineEnd - contentStart];
+            }
+            lineStart = lineEnd + 1;
+        }
+    }
+    if (buffer.length == 1) {
+        return @[];
+    }
+    [buffer appendBytes:"]" length:1];
+    
+    NSError *parseError;
+    NSArray *array = [NSJSONSerialization JSONObjectWithData:buffer options:0 error:&parseError];
+    if (![array isKindOfClass:[NSArray class]]) {
+        if (error) {
+            *error = TGFixtureError([NSString stringWithFormat:@"Malformed JSON between bytes %lu and %lu: %@", (unsigned long)range.location, (unsigned long)NSMaxRange(range), parseError.localizedDescription]);
+        }
+        return nil;
+    }
+    
+    return [[self class] normalizedObjectsFromArray:array forResource:self.resource];
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  TGRESTLogger.h
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ Number of messages the log buffer holds before new messages are dropped.
+ */
+
+extern NSUInteger const TGRESTLogBufferCapacity;
+
+/**
+ Hands a message to the logger.  Asynchronous messages go into a bounded lock free ring buffer and the block is only called to format the message on the logging thread, so the caller pays for copying the block and nothing else.  When the buffer is full the message is dropped and counted.  Synchronous messages wait for the buffer to drain so they stay in order and are then written on the calling thread.
+ 
+ Because formatting happens later, the block must not capture anything that is only valid for the duration of the call, like a C string from strerror.  Blocks that return nil write nothing.
+ */
+
+extern void TGRESTLogMessage(BOOL asynchronous, NSString * (^messageBlock)(void));
+
+/**
+ Waits until every message handed to the logger so far has been written.
+ */
+
+extern void TGRESTLogFlush(void);
+
+/**
+ Number of messages that were dropped because the buffer was full.
+ */
+
+extern uint64_t TGRESTLogDroppedMessageCount(void);
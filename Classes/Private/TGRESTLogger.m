@@ -0,0 +1,149 @@
+//
+//  TGRESTLogger.m
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import "TGRESTLogger.h"
+#import <stdatomic.h>
+#import <pthread.h>
+
+// Must be a power of two, positions are turned into slots with a mask.
+NSUInteger const TGRESTLogBufferCapacity = 4096;
+
+typedef struct {
+    _Atomic(size_t) sequence;
+    void *messageBlock;
+} TGLogSlot;
+
+static TGLogSlot *TGLogSlots;
+static _Atomic(size_t) TGLogEnqueuePosition;
+static _Atomic(size_t) TGLogDequeuePosition;
+static _Atomic(uint64_t) TGLogDroppedCount;
+static _Atomic(uint64_t) TGLogUnreportedDropCount;
+static dispatch_semaphore_t TGLogSignal;
+static pthread_t TGLogThread;
+
+/**
+ Only the logging thread takes messages out, so unlike enqueueing this doesn't need to compare and swap the position.
+ */
+
+static NSString * (^TGLogDequeue(void))(void)
+{
+    size_t position = atomic_load_explicit(&TGLogDequeuePosition, memory_order_relaxed);
+    TGLogSlot *slot = &TGLogSlots[position & (TGRESTLogBufferCapacity - 1)];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + 1) {
+        return nil;
+    }
+    
+    NSString * (^messageBlock)(void) = (__bridge_transfer id)slot->messageBlock;
+    slot->messageBlock = NULL;
+    atomic_store_explicit(&slot->sequence, position + TGRESTLogBufferCapacity, memory_order_release);
+    atomic_store_explicit(&TGLogDequeuePosition, position + 1, memory_order_release);
+    
+    return messageBlock;
+}
+
+static void *TGLogDrainThread(void *context)
+{
+    for (;;) {
+        @autoreleasepool {
+            NSString * (^messageBlock)(void);
+            while ((messageBlock = TGLogDequeue())) {
+                NSString *message = messageBlock();
+                if (message) {
+                    NSLog(@"%@", message);
+                }
+            }
+            uint64_t dropped = atomic_exchange_explicit(&TGLogUnreportedDropCount, 0, memory_order_relaxed);
+            if (dropped > 0) {
+                NSLog(@"Dropped %llu log messages because the log buffer was full", dropped);
+            }
+        }
+        dispatch_semaphore_wait(TGLogSignal, dispatch_time(DISPATCH_TIME_NOW, 100 * NSEC_PER_MSEC));
+    }
+    
+    return NULL;
+}
+
+static void TGLogStart(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        TGLogSlots = calloc(TGRESTLogBufferCapacity, sizeof(TGLogSlot));
+        for (size_t x = 0; x < TGRESTLogBufferCapacity; x++) {
+            atomic_init(&TGLogSlots[x].sequence, x);
+        }
+        TGLogSignal = dispatch_semaphore_create(0);
+        
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+        pthread_create(&TGLogThread, &attributes, TGLogDrainThread, NULL);
+        pthread_attr_destroy(&attributes);
+        
+        // Whatever is still buffered when the process exits would otherwise be lost.
+        atexit(TGRESTLogFlush);
+    });
+}
+
+void TGRESTLogMessage(BOOL asynchronous, NSString * (^messageBlock)(void))
+{
+    TGLogStart();
+    
+    if (!asynchronous) {
+        TGRESTLogFlush();
+        NSString *message = messageBlock();
+        if (message) {
+            NSLog(@"%@", message);
+        }
+        return;
+    }
+    
+    // A bounded queue in the style of Dmitry Vyukov's, every slot's sequence says whether it is free for the position a producer claimed.
+    size_t position = atomic_load_explicit(&TGLogEnqueuePosition, memory_order_relaxed);
+    TGLogSlot *slot;
+    for (;;) {
+        slot = &TGLogSlots[position & (TGRESTLogBufferCapacity - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&TGLogEnqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            atomic_fetch_add_explicit(&TGLogDroppedCount, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&TGLogUnreportedDropCount, 1, memory_order_relaxed);
+            return;
+        } else {
+            position = atomic_load_explicit(&TGLogEnqueuePosition, memory_order_relaxed);
+        }
+    }
+    
+    slot->messageBlock = (__bridge_retained void *)[messageBlock copy];
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    dispatch_semaphore_signal(TGLogSignal);
+}
+
+void TGRESTLogFlush(void)
+{
+    TGLogStart();
+    
+    // A message that logs while it is being formatted would otherwise wait for itself.
+    if (pthread_equal(pthread_self(), TGLogThread)) {
+        return;
+    }
+    
+    size_t target = atomic_load_explicit(&TGLogEnqueuePosition, memory_order_acquire);
+    while (atomic_load_explicit(&TGLogDequeuePosition, memory_order_acquire) < target) {
+        dispatch_semaphore_signal(TGLogSignal);
+        usleep(1000);
+    }
+}
+
+uint64_t TGRESTLogDroppedMessageCount(void)
+{
+    return atomic_load_explicit(&TGLogDroppedCount, memory_order_relaxed);
+}
@@ -0,0 +1,27 @@
+//
+//  TGRESTRouter.h
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource, TGRESTRoute;
+
+/**
+ Matches request methods and paths to resource routes with a trie of path segments, so a lookup walks the path once no matter how many resources there are.  Literal segments are resource names and a parameter segment stands for any primary key made of word characters, the same as the `\w+` the routes used to be matched with.  A trailing slash is allowed.
+ 
+ The trie is immutable once built.  Adding or removing a resource throws it away and it is rebuilt on the next lookup, so lookups only take a lock right after the resources change.
+ */
+
+@interface TGRESTRouter : NSObject
+
+- (void)addRoutesForResource:(TGRESTResource *)resource;
+- (void)removeRoutesForResource:(TGRESTResource *)resource;
+- (void)removeAllRoutes;
+
+- (TGRESTRoute *)routeForMethod:(NSString *)method path:(NSString *)path;
+
+@end
@@ -0,0 +1,239 @@
+//
+//  TGRESTRouter.m
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import "TGRESTRouter.h"
+#import "TGRESTRoute.h"
+#import "TGRESTResource.h"
+
+static NSUInteger const TGRouteMaximumCaptures = 2;
+
+static BOOL TGRouteIsPrimaryKey(NSString *segment)
+{
+    static NSCharacterSet *nonWordCharacters;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableCharacterSet *wordCharacters = [NSMutableCharacterSet alphanumericCharacterSet];
+        [wordCharacters addCharactersInString:@"_"];
+        nonWordCharacters = [wordCharacters invertedSet];
+    });
+    
+    return [segment rangeOfCharacterFromSet:nonWordCharacters].location == NSNotFound;
+}
+
+@interface TGRESTRouteEndpoint : NSObject
+
+@property (nonatomic, assign) TGRESTRouteAction action;
+@property (nonatomic, strong) TGRESTResource *resource;
+@property (nonatomic, strong) TGRESTResource *parentResource;
+
+@end
+
+@implementation TGRESTRouteEndpoint
+
+@end
+
+@interface TGRESTRouteNode : NSObject
+
+@property (nonatomic, strong) NSMutableDictionary *children;
+@property (nonatomic, strong) TGRESTRouteNode *parameterChild;
+@property (nonatomic, strong) NSMutableDictionary *endpoints;
+
+@end
+
+@implementation TGRESTRouteNode
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.children = [NSMutableDictionary new];
+        self.endpoints = [NSMutableDictionary new];
+    }
+    
+    return self;
+}
+
+- (TGRESTRouteNode *)childForSegment:(NSString *)segment
+{
+    TGRESTRouteNode *child = self.children[segment];
+    if (!child) {
+        child = [TGRESTRouteNode new];
+        [self.children setObject:child forKey:segment];
+    }
+    
+    return child;
+}
+
+- (TGRESTRouteNode *)parameterChildCreatingIfNeeded
+{
+    if (!self.parameterChild) {
+        self.parameterChild = [TGRESTRouteNode new];
+    }
+    
+    return self.parameterChild;
+}
+
+- (void)setAction:(TGRESTRouteAction)action resource:(TGRESTResource *)resource parentResource:(TGRESTResource *)parentResource forMethod:(NSString *)method
+{
+    TGRESTRouteEndpoint *endpoint = [TGRESTRouteEndpoint new];
+    endpoint.action = action;
+    endpoint.resource = resource;
+    endpoint.parentResource = parentResource;
+    [self.endpoints setObject:endpoint forKey:method];
+}
+
+@end
+
+@interface TGRESTRouter ()
+
+@property (nonatomic, strong) NSMutableDictionary *resources;
+@property (atomic, strong) TGRESTRouteNode *root;
+
+@end
+
+@implementation TGRESTRouter
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.resources = [NSMutableDictionary new];
+    }
+    
+    return self;
+}
+
+- (void)addRoutesForResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    @synchronized(self) {
+        [self.resources setObject:resource forKey:resource.name];
+        self.root = nil;
+    }
+}
+
+- (void)removeRoutesForResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    @synchronized(self) {
+        if (self.resources[resource.name] == resource) {
+            [self.resources removeObjectForKey:resource.name];
+            self.root = nil;
+        }
+    }
+}
+
+- (void)removeAllRoutes
+{
+    @synchronized(self) {
+        [self.resources removeAllObjects];
+        self.root = nil;
+    }
+}
+
+- (TGRESTRouteNode *)currentRoot
+{
+    TGRESTRouteNode *root = self.root;
+    if (root) {
+        return root;
+    }
+    
+    // Adding resources one at a time only throws the trie away, it is built once on the first lookup after them.
+    @synchronized(self) {
+        if (!self.root) {
+            [self rebuild];
+        }
+        return self.root;
+    }
+}
+
+- (void)rebuild
+{
+    TGRESTRouteNode *root = [TGRESTRouteNode new];
+    
+    for (TGRESTResource *resource in self.resources.allValues) {
+        TGRESTRouteNode *collection = [root childForSegment:resource.name];
+        TGRESTRouteNode *member = [collection parameterChildCreatingIfNeeded];
+        
+        if (resource.actions & TGResourceRESTActionsGET) {
+            [collection setAction:TGRESTRouteActionIndex resource:resource parentResource:nil forMethod:@"GET"];
+            [member setAction:TGRESTRouteActionShow resource:resource parentResource:nil forMethod:@"GET"];
+        }
+        if (resource.actions & TGResourceRESTActionsPOST) {
+            [collection setAction:TGRESTRouteActionCreate resource:resource parentResource:nil forMethod:@"POST"];
+        }
+        if (resource.actions & TGResourceRESTActionsPUT) {
+            [member setAction:TGRESTRouteActionUpdate resource:resource parentResource:nil forMethod:@"PUT"];
+        }
+        if (resource.actions & TGResourceRESTActionsDELETE) {
+            [member setAction:TGRESTRouteActionDestroy resource:resource parentResource:nil forMethod:@"DELETE"];
+        }
+        
+        // Nested routes are shallow, only the index and create actions can be reached through a parent.
+        for (TGRESTResource *parent in resource.parentResources) {
+            TGRESTRouteNode *nested = [[[root childForSegment:parent.name] parameterChildCreatingIfNeeded] childForSegment:resource.name];
+            if (resource.actions & TGResourceRESTActionsGET) {
+                [nested setAction:TGRESTRouteActionIndex resource:resource parentResource:parent forMethod:@"GET"];
+            }
+            if (resource.actions & TGResourceRESTActionsPOST) {
+                [nested setAction:TGRESTRouteActionCreate resource:resource parentResource:parent forMethod:@"POST"];
+            }
+        }
+    }
+    
+    self.root = root;
+}
+
+- (TGRESTRoute *)routeForMethod:(NSString *)method path:(NSString *)path
+{
+    NSUInteger length = path.length;
+    if (length == 0 || [path characterAtIndex:0] != '/') {
+        return nil;
+    }
+    
+    TGRESTRouteNode *node = [self currentRoot];
+    NSString *captures[TGRouteMaximumCaptures];
+    NSUInteger captureCount = 0;
+    NSUInteger start = 1;
+    
+    while (start < length) {
+        NSRange slash = [path rangeOfString:@"/" options:NSLiteralSearch range:NSMakeRange(start, length - start)];
+        NSUInteger end = (slash.location == NSNotFound) ? length : slash.location;
+        if (end == start) {
+            return nil;
+        }
+        
+        NSString *segment = [path substringWithRange:NSMakeRange(start, end - start)];
+        TGRESTRouteNode *next = node.children[segment];
+        if (!next && node.parameterChild && captureCount < TGRouteMaximumCaptures && TGRouteIsPrimaryKey(segment)) {
+            next = node.parameterChild;
+            captures[captureCount++] = segment;
+        }
+        if (!next) {
+            return nil;
+        }
+        node = next;
+        start = end + 1;
+    }
+    
+    TGRESTRouteEndpoint *endpoint = node.endpoints[method];
+    if (!endpoint) {
+        return nil;
+    }
+    
+    NSString *capture = (captureCount > 0) ? captures[0] : nil;
+    if (endpoint.parentResource) {
+        return [TGRESTRoute routeWithAction:endpoint.action resource:endpoint.resource parentResource:endpoint.parentResource parentPrimaryKey:capture primaryKey:nil];
+    }
+    
+    return [TGRESTRoute routeWithAction:endpoint.action resource:endpoint.resource parentResource:nil parentPrimaryKey:nil primaryKey:capture];
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  TGRESTStoreJournal.h
+//  
+//
+//  Created by John Tumminaro on 5/7/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource;
+
+/**
+ The objects of one resource as they were read back from disk, or as they are captured for a new snapshot.  `objects` maps primary keys to objects, with `NSNull` standing in for deleted objects.
+ */
+
+@interface TGRESTStoreJournalResource : NSObject
+
+@property (nonatomic, copy) NSDictionary *model;
+@property (nonatomic, assign) NSUInteger lastPrimaryKey;
+@property (nonatomic, strong) NSMutableDictionary *objects;
+
+@end
+
+/**
+ A binary snapshot plus an append-only operation log in a directory.  Records are appended on a private serial queue in the order they are submitted, every record carries a sequence number and replaying a record is idempotent, so a snapshot only has to remember the last sequence number it covers.
+ */
+
+@interface TGRESTStoreJournal : NSObject
+
+@property (nonatomic, copy, readonly) NSString *directory;
+@property (nonatomic, copy, readonly) NSDictionary *restoredResources;
+@property (atomic, assign, readonly) unsigned long long logLength;
+
++ (instancetype)journalWithDirectory:(NSString *)directory error:(NSError * __autoreleasing *)error;
+
+- (void)recordResource:(TGRESTResource *)resource;
+- (void)recordObject:(NSDictionary *)object withKey:(id)objectKey resourceName:(NSString *)name;
+- (void)recordDeletionOfKey:(id)objectKey resourceName:(NSString *)name;
+- (void)recordDropOfResourceName:(NSString *)name;
+
+- (BOOL)compactWithResources:(NSDictionary * (^)(void))captureBlock error:(NSError * __autoreleasing *)error;
+- (void)close;
+
+@end
@@ -0,0 +1,760 @@
+//
+//  TGRESTStoreJournal.m
+//  
+//
+//  Created by John Tumminaro on 5/7/14.
+//
+//
+
+#import "TGRESTStoreJournal.h"
+#import "TGRESTResource.h"
+#import "TGRESTServer.h"
+#import "TGRESTStore.h"
+#import "TGRESTEasyLogging.h"
+
+static NSString * const TGJournalSnapshotFileName = @"store.snapshot";
+static NSString * const TGJournalLogFileName = @"store.log";
+static NSString * const TGJournalRotatedLogFileName = @"store.log.old";
+static const char *TGJournalSnapshotMagic = "TGRSNAP1";
+static NSUInteger const TGJournalMagicLength = 8;
+static NSUInteger const TGJournalRecordHeaderSize = 8;
+static NSUInteger const TGJournalChecksumSize = 4;
+static NSUInteger const TGJournalStackBufferSize = 512;
+static NSUInteger const TGJournalMaximumDepth = 64;
+
+typedef NS_ENUM(uint8_t, TGJournalOperation) {
+    TGJournalOperationResource = 1,
+    TGJournalOperationPut = 2,
+    TGJournalOperationDelete = 3,
+    TGJournalOperationDrop = 4
+};
+
+typedef NS_ENUM(uint8_t, TGJournalTag) {
+    TGJournalTagAbsent = 'x',
+    TGJournalTagNull = 'n',
+    TGJournalTagTrue = 't',
+    TGJournalTagFalse = 'f',
+    TGJournalTagInteger = 'i',
+    TGJournalTagUnsigned = 'u',
+    TGJournalTagDouble = 'd',
+    TGJournalTagString = 's',
+    TGJournalTagData = 'b',
+    TGJournalTagArray = 'a',
+    TGJournalTagDictionary = 'o',
+    TGJournalTagArchive = 'k'
+};
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+    BOOL failed;
+} TGJournalReader;
+
+#pragma mark - Writing
+
+static uint32_t TGJournalChecksum(const uint8_t *bytes, NSUInteger length)
+{
+    // 32 bit FNV-1a, only meant to catch torn and damaged records.
+    uint32_t hash = 2166136261u;
+    for (NSUInteger x = 0; x < length; x++) {
+        hash = (hash ^ bytes[x]) * 16777619u;
+    }
+    
+    return hash;
+}
+
+static void TGJournalWriteByte(NSMutableData *data, uint8_t byte)
+{
+    [data appendBytes:&byte length:1];
+}
+
+static void TGJournalWriteVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    [data appendBytes:buffer length:length];
+}
+
+static void TGJournalWriteString(NSMutableData *data, NSString *string)
+{
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    CFIndex length = CFStringGetLength(cfString);
+    CFIndex maxBytes = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+    uint8_t stackBuffer[TGJournalStackBufferSize];
+    uint8_t *bytes = (maxBytes <= (CFIndex)TGJournalStackBufferSize) ? stackBuffer : malloc(maxBytes);
+    CFIndex usedBytes = 0;
+    CFStringGetBytes(cfString, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, bytes, maxBytes, &usedBytes);
+    
+    TGJournalWriteVarint(data, usedBytes);
+    [data appendBytes:bytes length:usedBytes];
+    
+    if (bytes != stackBuffer) {
+        free(bytes);
+    }
+}
+
+static void TGJournalWriteValue(NSMutableData *data, id value)
+{
+    if (!value || value == [NSNull null]) {
+        TGJournalWriteByte(data, TGJournalTagNull);
+    } else if ([value isKindOfClass:[NSString class]]) {
+        TGJournalWriteByte(data, TGJournalTagString);
+        TGJournalWriteString(data, value);
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        char type = [value objCType][0];
+        if (CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID()) {
+            TGJournalWriteByte(data, [value boolValue] ? TGJournalTagTrue : TGJournalTagFalse);
+        } else if (type == 'f' || type == 'd') {
+            double doubleValue = [value doubleValue];
+            uint64_t bits;
+            memcpy(&bits, &doubleValue, sizeof(bits));
+            bits = CFSwapInt64HostToLittle(bits);
+            TGJournalWriteByte(data, TGJournalTagDouble);
+            [data appendBytes:&bits length:sizeof(bits)];
+        } else if (type == 'Q') {
+            TGJournalWriteByte(data, TGJournalTagUnsigned);
+            TGJournalWriteVarint(data, [value unsignedLongLongValue]);
+        } else {
+            // Zigzag encoded so small negative numbers stay small.
+            int64_t integerValue = [value longLongValue];
+            TGJournalWriteByte(data, TGJournalTagInteger);
+            TGJournalWriteVarint(data, ((uint64_t)integerValue << 1) ^ (uint64_t)(integerValue >> 63));
+        }
+    } else if ([value isKindOfClass:[NSData class]]) {
+        TGJournalWriteByte(data, TGJournalTagData);
+        TGJournalWriteVarint(data, [value length]);
+        [data appendData:value];
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        TGJournalWriteByte(data, TGJournalTagArray);
+        TGJournalWriteVarint(data, [value count]);
+        for (id element in value) {
+            TGJournalWriteValue(data, element);
+        }
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        TGJournalWriteByte(data, TGJournalTagDictionary);
+        TGJournalWriteVarint(data, [value count]);
+        [value enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+            TGJournalWriteValue(data, key);
+            TGJournalWriteValue(data, object);
+        }];
+    } else if ([value conformsToProtocol:@protocol(NSCoding)]) {
+        NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:value];
+        TGJournalWriteByte(data, TGJournalTagArchive);
+        TGJournalWriteVarint(data, archive.length);
+        [data appendData:archive];
+    } else {
+        TGLogCWarn(@"%@ can't be written to disk and was stored as null", value);
+        TGJournalWriteByte(data, TGJournalTagNull);
+    }
+}
+
+#pragma mark - Reading
+
+static inline BOOL TGJournalCanRead(TGJournalReader *reader, uint64_t length)
+{
+    if (reader->failed || length > reader->length - reader->position) {
+        reader->failed = YES;
+        return NO;
+    }
+    
+    return YES;
+}
+
+static uint8_t TGJournalReadByte(TGJournalReader *reader)
+{
+    if (!TGJournalCanRead(reader, 1)) {
+        return 0;
+    }
+    
+    return reader->bytes[reader->position++];
+}
+
+static uint64_t TGJournalReadVarint(TGJournalReader *reader)
+{
+    uint64_t value = 0;
+    for (NSUInteger shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = TGJournalReadByte(reader);
+        if (reader->failed) {
+            return 0;
+        }
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    reader->failed = YES;
+    
+    return 0;
+}
+
+static NSString *TGJournalReadString(TGJournalReader *reader)
+{
+    uint64_t length = TGJournalReadVarint(reader);
+    if (!TGJournalCanRead(reader, length)) {
+        return nil;
+    }
+    
+    NSString *string = [[NSString alloc] initWithBytes:reader->bytes + reader->position length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+    reader->position += (NSUInteger)length;
+    if (!string) {
+        reader->failed = YES;
+    }
+    
+    return string;
+}
+
+static id TGJournalReadValue(TGJournalReader *reader, NSUInteger depth)
+{
+    if (depth > TGJournalMaximumDepth) {
+        reader->failed = YES;
+        return nil;
+    }
+    
+    uint8_t tag = TGJournalReadByte(reader);
+    switch (tag) {
+        case TGJournalTagNull:
+            return [NSNull null];
+        case TGJournalTagTrue:
+            return @YES;
+        case TGJournalTagFalse:
+            return @NO;
+        case TGJournalTagInteger: {
+            uint64_t zigzag = TGJournalReadVarint(reader);
+            return reader->failed ? nil : [NSNumber numberWithLongLong:(int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1)];
+        }
+        case TGJournalTagUnsigned: {
+            uint64_t value = TGJournalReadVarint(reader);
+            return reader->failed ? nil : [NSNumber numberWithUnsignedLongLong:value];
+        }
+        case TGJournalTagDouble: {
+            if (!TGJournalCanRead(reader, sizeof(uint64_t))) {
+                return nil;
+            }
+            uint64_t bits;
+            double doubleValue;
+            memcpy(&bits, reader->bytes + reader->position, sizeof(bits));
+            reader->position += sizeof(bits);
+            bits = CFSwapInt64LittleToHost(bits);
+            memcpy(&doubleValue, &bits, sizeof(doubleValue));
+            return [NSNumber numberWithDouble:doubleValue];
+        }
+        case TGJournalTagString:
+            return TGJournalReadString(reader);
+        case TGJournalTagData:
+        case TGJournalTagArchive: {
+            uint64_t length = TGJournalReadVarint(reader);
+            if (!TGJournalCanRead(reader, length)) {
+                return nil;
+            }
+            NSData *data = [NSData dataWithBytes:reader->bytes + reader->position length:(NSUInteger)length];
+            reader->position += (NSUInteger)length;
+            if (tag == TGJournalTagData) {
+                return data;
+            }
+            id object;
+            @try {
+                object = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+            }
+            @catch (NSException *exception) {
+                object = nil;
+            }
+            return object ?: [NSNull null];
+        }
+        case TGJournalTagArray: {
+            uint64_t count = TGJournalReadVarint(reader);
+            NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)MIN(count, reader->length - reader->position)];
+            for (uint64_t x = 0; x < count && !reader->failed; x++) {
+                id element = TGJournalReadValue(reader, depth + 1);
+                if (element) {
+                    [array addObject:element];
+                }
+            }
+            return reader->failed ? nil : [NSArray arrayWithArray:array];
+        }
+        case TGJournalTagDictionary: {
+            uint64_t count = TGJournalReadVarint(reader);
+            NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)MIN(count, reader->length - reader->position)];
+            for (uint64_t x = 0; x < count && !reader->failed; x++) {
+                id key = TGJournalReadValue(reader, depth + 1);
+                id object = TGJournalReadValue(reader, depth + 1);
+                if (key && object) {
+                    [dictionary setObject:object forKey:key];
+                }
+            }
+            return reader->failed ? nil : [NSDictionary dictionaryWithDictionary:dictionary];
+        }
+        default:
+            reader->failed = YES;
+            return nil;
+    }
+}
+
+static NSUInteger TGJournalPrimaryKeyNumber(id objectKey)
+{
+    long long key = [objectKey respondsToSelector:@selector(longLongValue)] ? [objectKey longLongValue] : 0;
+    
+    return key > 0 ? (NSUInteger)key : 0;
+}
+
+static NSError *TGJournalPOSIXError(void)
+{
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+}
+
+@implementation TGRESTStoreJournalResource
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.objects = [NSMutableDictionary new];
+        self.lastPrimaryKey = 0;
+    }
+    
+    return self;
+}
+
+@end
+
+@interface TGRESTStoreJournal ()
+
+@property (nonatomic, copy, readwrite) NSString *directory;
+@property (nonatomic, copy, readwrite) NSDictionary *restoredResources;
+@property (atomic, assign, readwrite) unsigned long long logLength;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, assign) FILE *logFile;
+@property (nonatomic, assign) uint64_t lastSequence;
+
+@end
+
+@implementation TGRESTStoreJournal
+
++ (instancetype)journalWithDirectory:(NSString *)directory error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(directory);
+    
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:error]) {
+        return nil;
+    }
+    
+    TGRESTStoreJournal *journal = [self new];
+    journal.directory = directory;
+    journal.queue = dispatch_queue_create("com.tinylittlegears.resteasy.journal", DISPATCH_QUEUE_SERIAL);
+    if (![journal loadWithError:error]) {
+        return nil;
+    }
+    
+    return journal;
+}
+
+- (void)dealloc
+{
+    if (_logFile) {
+        fclose(_logFile);
+    }
+}
+
+- (NSString *)pathForFileName:(NSString *)fileName
+{
+    return [self.directory stringByAppendingPathComponent:fileName];
+}
+
+#pragma mark - Loading
+
+- (BOOL)loadWithError:(NSError * __autoreleasing *)error
+{
+    NSMutableDictionary *resources = [NSMutableDictionary new];
+    uint64_t snapshotSequence = 0;
+    
+    // The snapshot is mapped rather than read so only the pages that are decoded are ever touched.
+    NSData *snapshot = [NSData dataWithContentsOfFile:[self pathForFileName:TGJournalSnapshotFileName] options:NSDataReadingMappedAlways error:nil];
+    if (snapshot && ![self readSnapshot:snapshot intoResources:resources sequence:&snapshotSequence]) {
+        TGLogError(@"The snapshot in %@ is damaged and was ignored", self.directory);
+        [resources removeAllObjects];
+        snapshotSequence = 0;
+    }
+    self.lastSequence = snapshotSequence;
+    
+    NSString *rotatedLogPath = [self pathForFileName:TGJournalRotatedLogFileName];
+    NSString *logPath = [self pathForFileName:TGJournalLogFileName];
+    BOOL interruptedCompaction = [[NSFileManager defaultManager] fileExistsAtPath:rotatedLogPath];
+    for (NSString *path in @[rotatedLogPath, logPath]) {
+        NSData *log = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+        if (!log) {
+            continue;
+        }
+        NSUInteger validLength = [self replayLog:log intoResources:resources afterSequence:snapshotSequence];
+        if (validLength < log.length) {
+            // Anything after the first bad record is a write that never finished, cut it off so new records don't land behind it.
+            TGLogWarn(@"Ignored %lu bytes at the end of %@ that were not a complete record", (unsigned long)(log.length - validLength), path);
+            NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:path];
+            [handle truncateFileAtOffset:validLength];
+            [handle closeFile];
+        }
+    }
+    self.restoredResources = resources;
+    
+    if (interruptedCompaction) {
+        // A compaction stopped after rotating the log.  Fold everything into a snapshot now so the next rotation can't replace the older log.
+        if (![self writeSnapshotWithResources:resources sequence:self.lastSequence error:error]) {
+            return NO;
+        }
+        [[NSFileManager defaultManager] removeItemAtPath:rotatedLogPath error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:logPath error:nil];
+    }
+    
+    return [self openLogWithError:error];
+}
+
+- (BOOL)readSnapshot:(NSData *)snapshot intoResources:(NSMutableDictionary *)resources sequence:(uint64_t *)sequence
+{
+    const uint8_t *bytes = snapshot.bytes;
+    if (snapshot.length < TGJournalMagicLength + TGJournalChecksumSize || memcmp(bytes, TGJournalSnapshotMagic, TGJournalMagicLength) != 0) {
+        return NO;
+    }
+    
+    NSUInteger bodyLength = snapshot.length - TGJournalChecksumSize;
+    uint32_t checksum;
+    memcpy(&checksum, bytes + bodyLength, sizeof(checksum));
+    if (CFSwapInt32LittleToHost(checksum) != TGJournalChecksum(bytes, bodyLength)) {
+        return NO;
+    }
+    
+    TGJournalReader reader = {bytes, bodyLength, TGJournalMagicLength, NO};
+    *sequence = TGJournalReadVarint(&reader);
+    uint64_t resourceCount = TGJournalReadVarint(&reader);
+    for (uint64_t x = 0; x < resourceCount && !reader.failed; x++) {
+        NSString *name = TGJournalReadString(&reader);
+        NSDictionary *model = TGJournalReadValue(&reader, 0);
+        TGRESTStoreJournalResource *resource = [TGRESTStoreJournalResource new];
+        resource.model = [model isKindOfClass:[NSDictionary class]] ? model : nil;
+        resource.lastPrimaryKey = (NSUInteger)TGJournalReadVarint(&reader);
+        
+        uint64_t propertyCount = TGJournalReadVarint(&reader);
+        NSMutableArray *propertyNames = [NSMutableArray new];
+        for (uint64_t y = 0; y < propertyCount && !reader.failed; y++) {
+            NSString *propertyName = TGJournalReadString(&reader);
+            if (propertyName) {
+                [propertyNames addObject:propertyName];
+            }
+        }
+        
+        uint64_t objectCount = TGJournalReadVarint(&reader);
+        for (uint64_t y = 0; y < objectCount && !reader.failed; y++) {
+            id objectKey = TGJournalReadValue(&reader, 0);
+            if (!TGJournalReadByte(&reader)) {
+                if (objectKey) {
+                    [resource.objects setObject:[NSNull null] forKey:objectKey];
+                }
+                continue;
+            }
+            
+            // Live objects are written as one value per model property in a fixed order, followed by any keys outside the model.
+            NSMutableDictionary *object = [NSMutableDictionary dictionaryWithCapacity:propertyNames.count];
+            for (NSString *propertyName in propertyNames) {
+                if (TGJournalCanRead(&reader, 1) && reader.bytes[reader.position] == TGJournalTagAbsent) {
+                    reader.position++;
+                    continue;
+                }
+                id value = TGJournalReadValue(&reader, 0);
+                if (value) {
+                    [object setObject:value forKey:propertyName];
+                }
+            }
+            uint64_t extraCount = TGJournalReadVarint(&reader);
+            for (uint64_t z = 0; z < extraCount && !reader.failed; z++) {
+                id extraKey = TGJournalReadValue(&reader, 0);
+                id extraValue = TGJournalReadValue(&reader, 0);
+                if (extraKey && extraValue) {
+                    [object setObject:extraValue forKey:extraKey];
+                }
+            }
+            if (objectKey) {
+                [resource.objects setObject:[NSDictionary dictionaryWithDictionary:object] forKey:objectKey];
+            }
+        }
+        
+        if (name && resource.model) {
+            [resources setObject:resource forKey:name];
+        }
+    }
+    
+    return !reader.failed && reader.position == bodyLength;
+}
+
+- (NSUInteger)replayLog:(NSData *)log intoResources:(NSMutableDictionary *)resources afterSequence:(uint64_t)snapshotSequence
+{
+    const uint8_t *bytes = log.bytes;
+    NSUInteger position = 0;
+    
+    while (log.length - position >= TGJournalRecordHeaderSize) {
+        uint32_t header[2];
+        memcpy(header, bytes + position, sizeof(header));
+        uint32_t payloadLength = CFSwapInt32LittleToHost(header[0]);
+        if (payloadLength > log.length - position - TGJournalRecordHeaderSize) {
+            break;
+        }
+        const uint8_t *payload = bytes + position + TGJournalRecordHeaderSize;
+        if (TGJournalChecksum(payload, payloadLength) != CFSwapInt32LittleToHost(header[1])) {
+            break;
+        }
+        TGJournalReader reader = {payload, payloadLength, 0, NO};
+        if (![self applyRecordWithReader:&reader toResources:resources afterSequence:snapshotSequence]) {
+            break;
+        }
+        position += TGJournalRecordHeaderSize + payloadLength;
+    }
+    
+    return position;
+}
+
+- (BOOL)applyRecordWithReader:(TGJournalReader *)reader toResources:(NSMutableDictionary *)resources afterSequence:(uint64_t)snapshotSequence
+{
+    uint64_t sequence = TGJournalReadVarint(reader);
+    TGJournalOperation operation = TGJournalReadByte(reader);
+    NSString *name = TGJournalReadString(reader);
+    if (reader->failed) {
+        return NO;
+    }
+    
+    self.lastSequence = MAX(self.lastSequence, sequence);
+    if (sequence <= snapshotSequence) {
+        return YES;
+    }
+    
+    TGRESTStoreJournalResource *resource = resources[name];
+    switch (operation) {
+        case TGJournalOperationResource: {
+            NSDictionary *model = TGJournalReadValue(reader, 0);
+            if (![model isKindOfClass:[NSDictionary class]]) {
+                return NO;
+            }
+            // Adding a resource with a different model purges it, the same as it does on a running server.
+            if (!resource || ![resource.model isEqualToDictionary:model]) {
+                resource = [TGRESTStoreJournalResource new];
+                resource.model = model;
+                [resources setObject:resource forKey:name];
+            }
+            break;
+        }
+        case TGJournalOperationPut:
+        case TGJournalOperationDelete: {
+            id objectKey = TGJournalReadValue(reader, 0);
+            id object = (operation == TGJournalOperationPut) ? TGJournalReadValue(reader, 0) : [NSNull null];
+            if (!objectKey || !object) {
+                return NO;
+            }
+            [resource.objects setObject:object forKey:objectKey];
+            resource.lastPrimaryKey = MAX(resource.lastPrimaryKey, TGJournalPrimaryKeyNumber(objectKey));
+            break;
+        }
+        case TGJournalOperationDrop:
+            [resources removeObjectForKey:name];
+            break;
+        default:
+            return NO;
+    }
+    
+    return !reader->failed;
+}
+
+#pragma mark - Writing
+
+- (BOOL)openLogWithError:(NSError * __autoreleasing *)error
+{
+    NSString *path = [self pathForFileName:TGJournalLogFileName];
+    FILE *file = fopen([path fileSystemRepresentation], "ab");
+    if (!file) {
+        if (error) {
+            *error = TGJournalPOSIXError();
+        }
+        return NO;
+    }
+    
+    self.logFile = file;
+    self.logLength = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize];
+    
+    return YES;
+}
+
+- (void)appendRecordWithOperation:(TGJournalOperation)operation resourceName:(NSString *)name key:(id)objectKey value:(id)value
+{
+    // Objects are immutable once they are stored, so they are encoded on the journal queue and never hold up the write itself.
+    dispatch_async(self.queue, ^{
+        FILE *file = self.logFile;
+        if (!file) {
+            return;
+        }
+        
+        self.lastSequence++;
+        NSMutableData *record = [NSMutableData dataWithLength:TGJournalRecordHeaderSize];
+        TGJournalWriteVarint(record, self.lastSequence);
+        TGJournalWriteByte(record, operation);
+        TGJournalWriteString(record, name);
+        if (objectKey) {
+            TGJournalWriteValue(record, objectKey);
+        }
+        if (value) {
+            TGJournalWriteValue(record, value);
+        }
+        
+        uint8_t *bytes = record.mutableBytes;
+        uint32_t payloadLength = (uint32_t)(record.length - TGJournalRecordHeaderSize);
+        uint32_t header[2] = {CFSwapInt32HostToLittle(payloadLength), CFSwapInt32HostToLittle(TGJournalChecksum(bytes + TGJournalRecordHeaderSize, payloadLength))};
+        memcpy(bytes, header, sizeof(header));
+        
+        if (fwrite(bytes, 1, record.length, file) != record.length || fflush(file) != 0) {
+            TGLogError(@"Could not append to the log in %@: %s", self.directory, strerror(errno));
+            ftruncate(fileno(file), (off_t)self.logLength);
+            return;
+        }
+        self.logLength = self.logLength + record.length;
+    });
+}
+
+- (void)recordResource:(TGRESTResource *)resource
+{
+    [self appendRecordWithOperation:TGJournalOperationResource resourceName:resource.name key:nil value:resource.model];
+}
+
+- (void)recordObject:(NSDictionary *)object withKey:(id)objectKey resourceName:(NSString *)name
+{
+    [self appendRecordWithOperation:TGJournalOperationPut resourceName:name key:objectKey value:object];
+}
+
+- (void)recordDeletionOfKey:(id)objectKey resourceName:(NSString *)name
+{
+    [self appendRecordWithOperation:TGJournalOperationDelete resourceName:name key:objectKey value:nil];
+}
+
+- (void)recordDropOfResourceName:(NSString *)name
+{
+    [self appendRecordWithOperation:TGJournalOperationDrop resourceName:name key:nil value:nil];
+}
+
+- (BOOL)writeSnapshotWithResources:(NSDictionary *)resources sequence:(uint64_t)sequence error:(NSError * __autoreleasing *)error
+{
+    NSMutableData *data = [NSMutableData dataWithBytes:TGJournalSnapshotMagic length:TGJournalMagicLength];
+    TGJournalWriteVarint(data, sequence);
+    TGJournalWriteVarint(data, resources.count);
+    
+    for (NSString *name in resources) {
+        TGRESTStoreJournalResource *resource = resources[name];
+        NSArray *propertyNames = [resource.model.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        TGJournalWriteString(data, name);
+        TGJournalWriteValue(data, resource.model);
+        TGJournalWriteVarint(data, resource.lastPrimaryKey);
+        TGJournalWriteVarint(data, propertyNames.count);
+        for (NSString *propertyName in propertyNames) {
+            TGJournalWriteString(data, propertyName);
+        }
+        
+        TGJournalWriteVarint(data, resource.objects.count);
+        [resource.objects enumerateKeysAndObjectsUsingBlock:^(id objectKey, NSDictionary *object, BOOL *stop) {
+            TGJournalWriteValue(data, objectKey);
+            if ((id)object == [NSNull null]) {
+                TGJournalWriteByte(data, 0);
+                return;
+            }
+            TGJournalWriteByte(data, 1);
+            
+            NSUInteger writtenCount = 0;
+            for (NSString *propertyName in propertyNames) {
+                id value = object[propertyName];
+                if (value) {
+                    TGJournalWriteValue(data, value);
+                    writtenCount++;
+                } else {
+                    TGJournalWriteByte(data, TGJournalTagAbsent);
+                }
+            }
+            
+            NSMutableArray *extraKeys = [NSMutableArray new];
+            if (object.count > writtenCount) {
+                for (id key in object) {
+                    if (!resource.model[key]) {
+                        [extraKeys addObject:key];
+                    }
+                }
+            }
+            TGJournalWriteVarint(data, extraKeys.count);
+            for (id key in extraKeys) {
+                TGJournalWriteValue(data, key);
+                TGJournalWriteValue(data, object[key]);
+            }
+        }];
+    }
+    
+    uint32_t checksum = CFSwapInt32HostToLittle(TGJournalChecksum(data.bytes, data.length));
+    [data appendBytes:&checksum length:sizeof(checksum)];
+    
+    return [data writeToFile:[self pathForFileName:TGJournalSnapshotFileName] options:NSDataWritingAtomic error:error];
+}
+
+- (BOOL)compactWithResources:(NSDictionary * (^)(void))captureBlock error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(captureBlock);
+    
+    NSString *logPath = [self pathForFileName:TGJournalLogFileName];
+    NSString *rotatedLogPath = [self pathForFileName:TGJournalRotatedLogFileName];
+    __block uint64_t sequence = 0;
+    __block BOOL rotated = NO;
+    __block NSError *rotateError;
+    
+    // Every record up to the rotation lands in the old log, and every write it holds is already in memory by the time the objects are captured.
+    dispatch_sync(self.queue, ^{
+        if (!self.logFile) {
+            rotateError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+            return;
+        }
+        sequence = self.lastSequence;
+        if ([[NSFileManager defaultManager] fileExistsAtPath:rotatedLogPath]) {
+            // The last compaction failed after rotating, keep appending so the older log is never replaced.
+            rotated = YES;
+            return;
+        }
+        fclose(self.logFile);
+        self.logFile = NULL;
+        if (rename([logPath fileSystemRepresentation], [rotatedLogPath fileSystemRepresentation]) != 0) {
+            rotateError = TGJournalPOSIXError();
+            [self openLogWithError:nil];
+            return;
+        }
+        NSError *openError;
+        rotated = [self openLogWithError:&openError];
+        rotateError = openError;
+    });
+    
+    if (!rotated) {
+        if (error) {
+            *error = rotateError;
+        }
+        return NO;
+    }
+    
+    NSDictionary *resources = captureBlock();
+    if (![self writeSnapshotWithResources:resources sequence:sequence error:error]) {
+        return NO;
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:rotatedLogPath error:nil];
+    
+    return YES;
+}
+
+- (void)close
+{
+    dispatch_sync(self.queue, ^{
+        if (self.logFile) {
+            fclose(self.logFile);
+            self.logFile = NULL;
+        }
+    });
+}
+
+@end
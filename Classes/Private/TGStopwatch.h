@@ -7,7 +7,6 @@
 //
 
 #import <Foundation/Foundation.h>
-#import <mach/mach_time.h>
 
 @interface TGStopwatch : NSObject
 
@@ -17,5 +16,6 @@
 - (void)stop;
 
 - (CGFloat)recordedTime;
+- (uint64_t)recordedNanoseconds;
 
 @end
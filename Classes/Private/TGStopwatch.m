@@ -7,6 +7,7 @@
 //
 
 #import "TGStopwatch.h"
+#import "TGPrivateFunctions.h"
 
 @interface TGStopwatch ()
 @property (nonatomic, assign, readwrite, getter=isRunning) BOOL running;
@@ -16,16 +17,12 @@
 @end
 
 @implementation TGStopwatch
-{
-    mach_timebase_info_data_t _info;
-}
 
 - (instancetype)init
 {
     self = [super init];
     if (self) {
         self.running = NO;
-        mach_timebase_info(&_info);
     }
     return self;
 }
@@ -33,26 +30,29 @@
 - (void)start
 {
     self.running = YES;
-    self.startTime = mach_absolute_time();
+    self.startTime = TGMonotonicTime();
 }
 
 - (void)stop
 {
-    self.stopTime = mach_absolute_time();
+    self.stopTime = TGMonotonicTime();
     self.running = NO;
 }
 
 - (CGFloat)recordedTime
 {
-    uint64_t elapsed = self.stopTime - self.startTime;
-    uint64_t nanos = elapsed * _info.numer / _info.denom;
-    return (CGFloat)nanos / NSEC_PER_SEC;
+    return (CGFloat)[self recordedNanoseconds] / NSEC_PER_SEC;
+}
+
+- (uint64_t)recordedNanoseconds
+{
+    return self.stopTime - self.startTime;
 }
 
 - (uint64_t)stopTime
 {
     if (!_stopTime) {
-        return mach_absolute_time();
+        return TGMonotonicTime();
     } else {
         return _stopTime;
     }
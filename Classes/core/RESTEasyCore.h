@@ -12,9 +12,18 @@
 #import "TGRESTResource.h"
 #import "TGRESTServer.h"
 #import "TGRESTStore.h"
+#import "TGRESTStoreOperation.h"
+#import "TGRESTQuery.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTJSONEncoder.h"
+#import "TGRESTBodyDecoder.h"
 #import "TGRESTInMemoryStore.h"
+#import "TGRESTColumnarStore.h"
 #import "TGRESTSerializer.h"
 #import "TGRESTDefaultSerializer.h"
+#import "TGRESTRoute.h"
+#import "TGRESTLatencyProfile.h"
+#import "TGRESTMetrics.h"
 #import "TGRESTController.h"
 #import "TGRESTDefaultController.h"
 
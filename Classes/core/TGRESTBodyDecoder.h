@@ -0,0 +1,67 @@
+//
+//  TGRESTBodyDecoder.h
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource;
+
+/**
+ `TGRESTBodyDecoder` turns the body of a create or update request straight into the properties of a resource.  `TGRESTServer` compiles one from the resource model when the resource is added and the default controller uses it whenever the resource is formatted by `TGRESTDefaultSerializer`, which has nothing to do to the request parameters.
+ 
+ The decoder reads the raw bytes of `application/json` and `application/x-www-form-urlencoded` bodies in a single pass.  Keys that aren't in the model are skipped without being decoded, so the result never has to be copied again to drop them.  Form keys and values are percent decoded in the same pass.
+ 
+ ### Coercion
+ 
+ Values are converted to the `TGPropertyType` of their property, and a value that can't be converted rejects the whole body with a `TGRESTStoreBadRequestErrorCode` error.  `null` is accepted for every type.
+ 
+ - String properties keep strings and take the literal text of numbers and booleans.
+ - Integer properties take integral numbers, booleans and strings that hold an integral number.
+ - Floating point properties take numbers, booleans and strings that hold a number.
+ - Blob properties take base64 strings, the same way `TGRESTJSONEncoder` writes them.
+ - Other properties keep any JSON value as it was.
+ 
+ An empty form value is read as `null` for every type except strings, since that is how forms send blank fields.
+ 
+ Values of unknown JSON keys are only checked for balanced brackets and quotes, they are never parsed.
+ 
+ Decoders are immutable once compiled and can be used from any thread.
+ */
+
+@interface TGRESTBodyDecoder : NSObject
+
+/**
+ The resource the decoder was compiled for.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTResource *resource;
+
+/**
+ *  Compiles a decoder for the resource model.
+ *
+ *  @param resource The resource whose request bodies will be decoded.
+ *
+ *  @return A new decoder.
+ */
+
++ (instancetype)decoderWithResource:(TGRESTResource *)resource;
+
+/**
+ *  Decodes a request body.
+ *
+ *  @param data        The raw request body.
+ *  @param contentType Content type of the request including any charset parameter.
+ *  @param error       If the body is malformed, has an unsupported content type or a value can't be converted to its property type on return will contain an error with the `TGRESTStoreBadRequestErrorCode` code.
+ *
+ *  @return Dictionary of the model properties found in the body, which can be empty, or nil if the body can't be decoded.
+ */
+
+- (NSDictionary *)propertiesWithData:(NSData *)data
+                         contentType:(NSString *)contentType
+                               error:(NSError * __autoreleasing *)error;
+
+@end
@@ -0,0 +1,704 @@
+//
+//  TGRESTBodyDecoder.m
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import "TGRESTBodyDecoder.h"
+#import "TGRESTResource.h"
+#import "TGRESTStore.h"
+#import "TGPrivateFunctions.h"
+
+static NSUInteger const TGBodyMaximumDepth = 512;
+static NSUInteger const TGBodyNumberBufferSize = 64;
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    __unsafe_unretained NSString *name;
+    TGPropertyType type;
+} TGBodyProperty;
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+} TGBodyCursor;
+
+static const TGBodyProperty *TGBodyPropertyWithKey(const TGBodyProperty *properties, NSUInteger count, const uint8_t *key, NSUInteger keyLength)
+{
+    // Models are small enough that comparing lengths first beats hashing the key.
+    for (NSUInteger x = 0; x < count; x++) {
+        if (properties[x].length == keyLength && memcmp(properties[x].bytes, key, keyLength) == 0) {
+            return &properties[x];
+        }
+    }
+    
+    return NULL;
+}
+
+#pragma mark - Numbers
+
+static BOOL TGBodyScanNumber(const uint8_t *bytes, NSUInteger length, NSUInteger *end, BOOL *integral)
+{
+    NSUInteger i = 0;
+    *integral = YES;
+    
+    if (i < length && bytes[i] == '-') {
+        i++;
+    }
+    if (i >= length) {
+        return NO;
+    }
+    if (bytes[i] == '0') {
+        i++;
+    } else if (bytes[i] >= '1' && bytes[i] <= '9') {
+        while (i < length && isdigit(bytes[i])) {
+            i++;
+        }
+    } else {
+        return NO;
+    }
+    
+    if (i < length && bytes[i] == '.') {
+        *integral = NO;
+        NSUInteger digits = ++i;
+        while (i < length && isdigit(bytes[i])) {
+            i++;
+        }
+        if (i == digits) {
+            return NO;
+        }
+    }
+    
+    if (i < length && (bytes[i] == 'e' || bytes[i] == 'E')) {
+        *integral = NO;
+        i++;
+        if (i < length && (bytes[i] == '+' || bytes[i] == '-')) {
+            i++;
+        }
+        NSUInteger digits = i;
+        while (i < length && isdigit(bytes[i])) {
+            i++;
+        }
+        if (i == digits) {
+            return NO;
+        }
+    }
+    
+    *end = i;
+    
+    return YES;
+}
+
+static NSNumber *TGBodyNumberWithBytes(const uint8_t *bytes, NSUInteger length, BOOL integral, TGPropertyType type)
+{
+    char stackBuffer[TGBodyNumberBufferSize];
+    char *buffer = (length < TGBodyNumberBufferSize) ? stackBuffer : malloc(length + 1);
+    memcpy(buffer, bytes, length);
+    buffer[length] = '\0';
+    
+    NSNumber *number;
+    if (integral && type != TGPropertyTypeFloatingPoint) {
+        errno = 0;
+        long long integerValue = strtoll(buffer, NULL, 10);
+        if (errno != ERANGE) {
+            number = [NSNumber numberWithLongLong:integerValue];
+        } else if (type != TGPropertyTypeInteger) {
+            number = [NSNumber numberWithDouble:strtod(buffer, NULL)];
+        }
+    } else {
+        double doubleValue = strtod(buffer, NULL);
+        if (type != TGPropertyTypeInteger) {
+            number = [NSNumber numberWithDouble:doubleValue];
+        } else if (doubleValue == trunc(doubleValue) && fabs(doubleValue) < 9.2e18) {
+            number = [NSNumber numberWithLongLong:(long long)doubleValue];
+        }
+    }
+    
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    
+    return number;
+}
+
+static NSNumber *TGBodyNumberWithString(NSString *string, TGPropertyType type)
+{
+    const uint8_t *bytes = (const uint8_t *)[string UTF8String];
+    NSUInteger length = strlen((const char *)bytes);
+    NSUInteger end;
+    BOOL integral;
+    if (!TGBodyScanNumber(bytes, length, &end, &integral) || end != length) {
+        return nil;
+    }
+    
+    return TGBodyNumberWithBytes(bytes, length, integral, type);
+}
+
+static id TGBodyValueWithString(NSString *string, TGPropertyType type)
+{
+    switch (type) {
+        case TGPropertyTypeInteger:
+        case TGPropertyTypeFloatingPoint:
+            return TGBodyNumberWithString(string, type);
+        case TGPropertyTypeBlob:
+            return [[NSData alloc] initWithBase64EncodedString:string options:0];
+        default:
+            return string;
+    }
+}
+
+#pragma mark - Strings
+
+static BOOL TGBodyScanHex(const uint8_t *bytes, NSUInteger length, uint32_t *value)
+{
+    if (length < 4) {
+        return NO;
+    }
+    
+    uint32_t result = 0;
+    for (NSUInteger i = 0; i < 4; i++) {
+        uint8_t c = bytes[i];
+        result <<= 4;
+        if (c >= '0' && c <= '9') {
+            result |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            result |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            result |= c - 'A' + 10;
+        } else {
+            return NO;
+        }
+    }
+    *value = result;
+    
+    return YES;
+}
+
+static void TGBodyAppendUTF8(NSMutableData *data, uint32_t codePoint)
+{
+    uint8_t bytes[4];
+    NSUInteger length;
+    if (codePoint < 0x80) {
+        bytes[0] = codePoint;
+        length = 1;
+    } else if (codePoint < 0x800) {
+        bytes[0] = 0xC0 | (codePoint >> 6);
+        bytes[1] = 0x80 | (codePoint & 0x3F);
+        length = 2;
+    } else if (codePoint < 0x10000) {
+        bytes[0] = 0xE0 | (codePoint >> 12);
+        bytes[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[2] = 0x80 | (codePoint & 0x3F);
+        length = 3;
+    } else {
+        bytes[0] = 0xF0 | (codePoint >> 18);
+        bytes[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+        bytes[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[3] = 0x80 | (codePoint & 0x3F);
+        length = 4;
+    }
+    [data appendBytes:bytes length:length];
+}
+
+static BOOL TGBodySkipString(TGBodyCursor *cursor, BOOL *escaped)
+{
+    NSUInteger position = cursor->position + 1;
+    while (position < cursor->length) {
+        uint8_t c = cursor->bytes[position];
+        if (c == '"') {
+            cursor->position = position + 1;
+            return YES;
+        } else if (c == '\\') {
+            if (escaped) {
+                *escaped = YES;
+            }
+            position += 2;
+        } else if (c < 0x20) {
+            return NO;
+        } else {
+            position++;
+        }
+    }
+    
+    return NO;
+}
+
+static BOOL TGBodyUnescapeString(const uint8_t *bytes, NSUInteger length, NSMutableData *scratch)
+{
+    [scratch setLength:0];
+    NSUInteger runStart = 0;
+    
+    for (NSUInteger i = 0; i < length; i++) {
+        if (bytes[i] != '\\') {
+            continue;
+        }
+        [scratch appendBytes:bytes + runStart length:i - runStart];
+        if (++i >= length) {
+            return NO;
+        }
+        
+        uint8_t unescaped;
+        switch (bytes[i]) {
+            case '"':
+            case '\\':
+            case '/':
+                unescaped = bytes[i];
+                break;
+            case 'b': unescaped = '\b'; break;
+            case 'f': unescaped = '\f'; break;
+            case 'n': unescaped = '\n'; break;
+            case 'r': unescaped = '\r'; break;
+            case 't': unescaped = '\t'; break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!TGBodyScanHex(bytes + i + 1, length - i - 1, &codePoint)) {
+                    return NO;
+                }
+                i += 4;
+                uint32_t lowSurrogate;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 2 < length && bytes[i + 1] == '\\' && bytes[i + 2] == 'u' && TGBodyScanHex(bytes + i + 3, length - i - 3, &lowSurrogate) && lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    i += 6;
+                } else if (codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+                    // An unpaired surrogate can't be represented in UTF-8.
+                    codePoint = 0xFFFD;
+                }
+                TGBodyAppendUTF8(scratch, codePoint);
+                runStart = i + 1;
+                continue;
+            }
+            default:
+                return NO;
+        }
+        [scratch appendBytes:&unescaped length:1];
+        runStart = i + 1;
+    }
+    [scratch appendBytes:bytes + runStart length:length - runStart];
+    
+    return YES;
+}
+
+static BOOL TGBodyNeedsPercentDecoding(const uint8_t *bytes, NSUInteger length)
+{
+    for (NSUInteger i = 0; i < length; i++) {
+        if (bytes[i] == '%' || bytes[i] == '+') {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+static void TGBodyPercentDecode(const uint8_t *bytes, NSUInteger length, NSMutableData *scratch)
+{
+    [scratch setLength:length];
+    uint8_t *output = scratch.mutableBytes;
+    NSUInteger outputLength = 0;
+    
+    for (NSUInteger i = 0; i < length; i++) {
+        uint8_t c = bytes[i];
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%' && i + 2 < length && isxdigit(bytes[i + 1]) && isxdigit(bytes[i + 2])) {
+            uint8_t high = bytes[i + 1];
+            uint8_t low = bytes[i + 2];
+            high = isdigit(high) ? high - '0' : (tolower(high) - 'a' + 10);
+            low = isdigit(low) ? low - '0' : (tolower(low) - 'a' + 10);
+            c = (high << 4) | low;
+            i += 2;
+        }
+        output[outputLength++] = c;
+    }
+    [scratch setLength:outputLength];
+}
+
+#pragma mark - JSON values
+
+static BOOL TGBodyConsume(TGBodyCursor *cursor, uint8_t c)
+{
+    if (cursor->position < cursor->length && cursor->bytes[cursor->position] == c) {
+        cursor->position++;
+        return YES;
+    }
+    
+    return NO;
+}
+
+static void TGBodySkipWhitespace(TGBodyCursor *cursor)
+{
+    while (cursor->position < cursor->length) {
+        uint8_t c = cursor->bytes[cursor->position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return;
+        }
+        cursor->position++;
+    }
+}
+
+static BOOL TGBodyConsumeLiteral(TGBodyCursor *cursor, const char *literal)
+{
+    size_t length = strlen(literal);
+    if (cursor->length - cursor->position >= length && memcmp(cursor->bytes + cursor->position, literal, length) == 0) {
+        cursor->position += length;
+        return YES;
+    }
+    
+    return NO;
+}
+
+static BOOL TGBodySkipValue(TGBodyCursor *cursor)
+{
+    if (cursor->position >= cursor->length) {
+        return NO;
+    }
+    
+    uint8_t c = cursor->bytes[cursor->position];
+    if (c == '"') {
+        return TGBodySkipString(cursor, NULL);
+    } else if (c == 't') {
+        return TGBodyConsumeLiteral(cursor, "true");
+    } else if (c == 'f') {
+        return TGBodyConsumeLiteral(cursor, "false");
+    } else if (c == 'n') {
+        return TGBodyConsumeLiteral(cursor, "null");
+    } else if (c == '{' || c == '[') {
+        NSUInteger depth = 0;
+        while (cursor->position < cursor->length) {
+            c = cursor->bytes[cursor->position];
+            if (c == '"') {
+                if (!TGBodySkipString(cursor, NULL)) {
+                    return NO;
+                }
+                continue;
+            } else if (c == '{' || c == '[') {
+                if (++depth > TGBodyMaximumDepth) {
+                    return NO;
+                }
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    cursor->position++;
+                    return YES;
+                }
+            }
+            cursor->position++;
+        }
+        return NO;
+    }
+    
+    NSUInteger end;
+    BOOL integral;
+    if (!TGBodyScanNumber(cursor->bytes + cursor->position, cursor->length - cursor->position, &end, &integral)) {
+        return NO;
+    }
+    cursor->position += end;
+    
+    return YES;
+}
+
+static id TGBodyParseValue(TGBodyCursor *cursor, TGPropertyType type, NSMutableData *scratch, BOOL *malformed)
+{
+    *malformed = NO;
+    if (cursor->position >= cursor->length) {
+        *malformed = YES;
+        return nil;
+    }
+    
+    NSUInteger start = cursor->position;
+    uint8_t c = cursor->bytes[start];
+    
+    if (c == '"') {
+        BOOL escaped = NO;
+        if (!TGBodySkipString(cursor, &escaped)) {
+            *malformed = YES;
+            return nil;
+        }
+        const uint8_t *bytes = cursor->bytes + start + 1;
+        NSUInteger length = cursor->position - start - 2;
+        if (escaped) {
+            if (!TGBodyUnescapeString(bytes, length, scratch)) {
+                *malformed = YES;
+                return nil;
+            }
+            bytes = scratch.bytes;
+            length = scratch.length;
+        }
+        NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if (!string) {
+            *malformed = YES;
+            return nil;
+        }
+        return TGBodyValueWithString(string, type);
+    } else if (c == 'n') {
+        if (!TGBodyConsumeLiteral(cursor, "null")) {
+            *malformed = YES;
+            return nil;
+        }
+        return [NSNull null];
+    } else if (c == 't' || c == 'f') {
+        BOOL boolValue = (c == 't');
+        if (!TGBodyConsumeLiteral(cursor, boolValue ? "true" : "false")) {
+            *malformed = YES;
+            return nil;
+        }
+        switch (type) {
+            case TGPropertyTypeString:
+                return boolValue ? @"true" : @"false";
+            case TGPropertyTypeInteger:
+                return [NSNumber numberWithLongLong:boolValue];
+            case TGPropertyTypeFloatingPoint:
+                return [NSNumber numberWithDouble:boolValue];
+            case TGPropertyTypeBlob:
+                return nil;
+            default:
+                return [NSNumber numberWithBool:boolValue];
+        }
+    } else if (c == '{' || c == '[') {
+        if (!TGBodySkipValue(cursor)) {
+            *malformed = YES;
+            return nil;
+        }
+        if (type != TGPropertyTypeOther) {
+            return nil;
+        }
+        NSData *containerData = [NSData dataWithBytesNoCopy:(void *)(cursor->bytes + start) length:cursor->position - start freeWhenDone:NO];
+        id container = [NSJSONSerialization JSONObjectWithData:containerData options:kNilOptions error:nil];
+        if (!container) {
+            *malformed = YES;
+        }
+        return container;
+    }
+    
+    NSUInteger end;
+    BOOL integral;
+    if (!TGBodyScanNumber(cursor->bytes + start, cursor->length - start, &end, &integral)) {
+        *malformed = YES;
+        return nil;
+    }
+    cursor->position += end;
+    
+    if (type == TGPropertyTypeString) {
+        return [[NSString alloc] initWithBytes:cursor->bytes + start length:end encoding:NSUTF8StringEncoding];
+    } else if (type == TGPropertyTypeBlob) {
+        return nil;
+    }
+    
+    return TGBodyNumberWithBytes(cursor->bytes + start, end, integral, type);
+}
+
+@interface TGRESTBodyDecoder ()
+
+@property (nonatomic, strong, readwrite) TGRESTResource *resource;
+@property (nonatomic, copy) NSArray *propertyNames;
+@property (nonatomic, copy) NSArray *propertyKeys;
+@property (nonatomic, strong) NSData *propertyTable;
+@property (nonatomic, assign) NSUInteger propertyCount;
+
+@end
+
+@implementation TGRESTBodyDecoder
+
++ (instancetype)decoderWithResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    TGRESTBodyDecoder *decoder = [self new];
+    decoder.resource = resource;
+    
+    NSArray *propertyNames = resource.model.allKeys;
+    NSMutableArray *propertyKeys = [NSMutableArray arrayWithCapacity:propertyNames.count];
+    NSMutableData *propertyTable = [NSMutableData dataWithLength:propertyNames.count * sizeof(TGBodyProperty)];
+    TGBodyProperty *properties = propertyTable.mutableBytes;
+    
+    for (NSUInteger x = 0; x < propertyNames.count; x++) {
+        NSData *key = [propertyNames[x] dataUsingEncoding:NSUTF8StringEncoding];
+        [propertyKeys addObject:key];
+        properties[x].bytes = key.bytes;
+        properties[x].length = key.length;
+        properties[x].name = propertyNames[x];
+        properties[x].type = [resource.model[propertyNames[x]] integerValue];
+    }
+    
+    // The table only points into these arrays so they have to live as long as the decoder.
+    decoder.propertyNames = propertyNames;
+    decoder.propertyKeys = propertyKeys;
+    decoder.propertyTable = propertyTable;
+    decoder.propertyCount = propertyNames.count;
+    
+    return decoder;
+}
+
+- (NSDictionary *)propertiesWithData:(NSData *)data
+                         contentType:(NSString *)contentType
+                               error:(NSError * __autoreleasing *)error
+{
+    if ([contentType hasPrefix:@"application/json"]) {
+        return [self propertiesWithJSONBytes:data.bytes length:data.length error:error];
+    } else if ([contentType hasPrefix:@"application/x-www-form-urlencoded"]) {
+        NSString *charset = TGExtractHeaderValueParameter(contentType, @"charset");
+        return [self propertiesWithFormBytes:data.bytes length:data.length encoding:TGStringEncodingFromCharset(charset) error:error];
+    }
+    
+    return [self invalidBodyWithReason:[NSString stringWithFormat:@"Unsupported content type %@", contentType] error:error];
+}
+
+#pragma mark - Private
+
+- (NSDictionary *)propertiesWithJSONBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError * __autoreleasing *)error
+{
+    const TGBodyProperty *properties = self.propertyTable.bytes;
+    NSUInteger propertyCount = self.propertyCount;
+    NSMutableDictionary *decodedProperties = [NSMutableDictionary dictionaryWithCapacity:propertyCount];
+    NSMutableData *scratch = [NSMutableData new];
+    TGBodyCursor cursor = {bytes, length, 0};
+    
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        cursor.position = 3;
+    }
+    
+    TGBodySkipWhitespace(&cursor);
+    if (!TGBodyConsume(&cursor, '{')) {
+        return [self invalidBodyWithReason:@"JSON body must be an object" error:error];
+    }
+    TGBodySkipWhitespace(&cursor);
+    
+    BOOL closed = TGBodyConsume(&cursor, '}');
+    while (!closed) {
+        TGBodySkipWhitespace(&cursor);
+        if (cursor.position >= length || bytes[cursor.position] != '"') {
+            return [self malformedJSONAtPosition:cursor.position error:error];
+        }
+        
+        NSUInteger keyStart = cursor.position + 1;
+        BOOL escaped = NO;
+        if (!TGBodySkipString(&cursor, &escaped)) {
+            return [self malformedJSONAtPosition:keyStart error:error];
+        }
+        const uint8_t *key = bytes + keyStart;
+        NSUInteger keyLength = cursor.position - keyStart - 1;
+        if (escaped) {
+            if (!TGBodyUnescapeString(key, keyLength, scratch)) {
+                return [self malformedJSONAtPosition:keyStart error:error];
+            }
+            key = scratch.bytes;
+            keyLength = scratch.length;
+        }
+        const TGBodyProperty *property = TGBodyPropertyWithKey(properties, propertyCount, key, keyLength);
+        
+        TGBodySkipWhitespace(&cursor);
+        if (!TGBodyConsume(&cursor, ':')) {
+            return [self malformedJSONAtPosition:cursor.position error:error];
+        }
+        TGBodySkipWhitespace(&cursor);
+        
+        NSUInteger valueStart = cursor.position;
+        if (property) {
+            BOOL malformed;
+            id value = TGBodyParseValue(&cursor, property->type, scratch, &malformed);
+            if (malformed) {
+                return [self malformedJSONAtPosition:valueStart error:error];
+            } else if (!value) {
+                return [self mismatchedValueForProperty:property->name error:error];
+            }
+            [decodedProperties setObject:value forKey:property->name];
+        } else if (!TGBodySkipValue(&cursor)) {
+            return [self malformedJSONAtPosition:valueStart error:error];
+        }
+        
+        TGBodySkipWhitespace(&cursor);
+        if (TGBodyConsume(&cursor, '}')) {
+            closed = YES;
+        } else if (!TGBodyConsume(&cursor, ',')) {
+            return [self malformedJSONAtPosition:cursor.position error:error];
+        }
+    }
+    
+    TGBodySkipWhitespace(&cursor);
+    if (cursor.position != length) {
+        return [self malformedJSONAtPosition:cursor.position error:error];
+    }
+    
+    return decodedProperties;
+}
+
+- (NSDictionary *)propertiesWithFormBytes:(const uint8_t *)bytes length:(NSUInteger)length encoding:(NSStringEncoding)encoding error:(NSError * __autoreleasing *)error
+{
+    const TGBodyProperty *properties = self.propertyTable.bytes;
+    NSUInteger propertyCount = self.propertyCount;
+    NSMutableDictionary *decodedProperties = [NSMutableDictionary dictionaryWithCapacity:propertyCount];
+    NSMutableData *scratch = [NSMutableData new];
+    NSUInteger position = 0;
+    
+    while (position < length) {
+        const uint8_t *pair = bytes + position;
+        const uint8_t *pairEnd = memchr(pair, '&', length - position);
+        NSUInteger pairLength = pairEnd ? (NSUInteger)(pairEnd - pair) : length - position;
+        position += pairLength + 1;
+        
+        const uint8_t *separator = memchr(pair, '=', pairLength);
+        if (!separator) {
+            continue;
+        }
+        
+        const uint8_t *key = pair;
+        NSUInteger keyLength = separator - pair;
+        if (TGBodyNeedsPercentDecoding(key, keyLength)) {
+            TGBodyPercentDecode(key, keyLength, scratch);
+            key = scratch.bytes;
+            keyLength = scratch.length;
+        }
+        const TGBodyProperty *property = TGBodyPropertyWithKey(properties, propertyCount, key, keyLength);
+        if (!property) {
+            continue;
+        }
+        
+        const uint8_t *value = separator + 1;
+        NSUInteger valueLength = pairLength - (separator - pair) - 1;
+        if (valueLength == 0 && property->type != TGPropertyTypeString) {
+            // Forms send blank fields as empty values, which only means something for a string.
+            [decodedProperties setObject:[NSNull null] forKey:property->name];
+            continue;
+        }
+        if (TGBodyNeedsPercentDecoding(value, valueLength)) {
+            TGBodyPercentDecode(value, valueLength, scratch);
+            value = scratch.bytes;
+            valueLength = scratch.length;
+        }
+        
+        NSString *string = [[NSString alloc] initWithBytes:value length:valueLength encoding:encoding];
+        if (!string) {
+            return [self invalidBodyWithReason:[NSString stringWithFormat:@"Form value of property %@ is not valid in the request charset", property->name] error:error];
+        }
+        id typedValue = TGBodyValueWithString(string, property->type);
+        if (!typedValue) {
+            return [self mismatchedValueForProperty:property->name error:error];
+        }
+        [decodedProperties setObject:typedValue forKey:property->name];
+    }
+    
+    return decodedProperties;
+}
+
+- (id)malformedJSONAtPosition:(NSUInteger)position error:(NSError * __autoreleasing *)error
+{
+    return [self invalidBodyWithReason:[NSString stringWithFormat:@"Malformed JSON body at byte %lu", (unsigned long)position] error:error];
+}
+
+- (id)mismatchedValueForProperty:(NSString *)property error:(NSError * __autoreleasing *)error
+{
+    return [self invalidBodyWithReason:[NSString stringWithFormat:@"Value of property %@ of resource %@ can't be converted to its type", property, self.resource.name] error:error];
+}
+
+- (id)invalidBodyWithReason:(NSString *)reason error:(NSError * __autoreleasing *)error
+{
+    if (error) {
+        *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:@{NSLocalizedDescriptionKey: reason}];
+    }
+    
+    return nil;
+}
+
+@end
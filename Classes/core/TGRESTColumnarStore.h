@@ -0,0 +1,39 @@
+//
+//  TGRESTColumnarStore.h
+//  
+//
+//  Created by John Tumminaro on 5/6/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "TGRESTStore.h"
+
+/**
+ Concrete subclass of TGRESTStore that keeps everything in memory like `TGRESTInMemoryStore`, but lays each resource out as typed columns instead of one dictionary per object.  It is meant for large data sets where the repeated property names, boxed values and per-object dictionaries of the default store cost several times the size of the data itself.  To use it pass its class for the `TGRESTServerDatastoreClassOptionKey` option.
+ 
+ ### Layout
+ 
+ Every property in the resource model gets a column of its own type.
+ 
+ - Integer properties are a flat array of `int64_t` values and floating point properties a flat array of `double` values, each with a null bitmap.
+ - String properties are an array of 32 bit ids into a string table shared by the resource, so each distinct string is only stored once.
+ - Blob properties are an offset and length into a byte arena shared by the resource.
+ - Other properties are kept as the objects they were stored as.
+ 
+ Primary keys are handed out sequentially so they map straight to row numbers and are never stored.  A deletion bitmap marks the rows that have been deleted, which is how deleted objects are told apart from objects that never existed.  Dictionaries are only built for the rows a request actually returns and queries are evaluated against the columns themselves.
+ 
+ ### Differences from TGRESTInMemoryStore
+ 
+ Only the properties in the model are stored, other keys are dropped.  A value that can't be stored as the type of its property fails the write with a `TGRESTStoreBadRequestErrorCode` error: integer and floating point properties take numbers and strings holding a number, string properties take strings and numbers, and blob properties only take data.  Integers are returned as `long long` numbers and floating point values as `double` numbers.
+ 
+ The string table and blob arena only ever grow, so strings and blobs that are replaced or deleted keep their space until the resource is dropped.
+ 
+ ### Concurrency and indexes
+ 
+ Each resource is guarded by its own concurrent queue the same way `TGRESTInMemoryStore` partitions are, with reads in parallel and writes behind barriers.  Foreign keys and the resource's `indexedProperties` are hash indexed from value to rows, every other filter is a scan over the column it filters.
+ */
+
+@interface TGRESTColumnarStore : TGRESTStore
+
+@end
@@ -0,0 +1,1407 @@
+//
+//  TGRESTColumnarStore.m
+//  
+//
+//  Created by John Tumminaro on 5/6/14.
+//
+//
+
+#import "TGRESTColumnarStore.h"
+#import "TGRESTResource.h"
+#import "TGRESTQuery.h"
+#import "TGRESTFragmentCache.h"
+
+static NSUInteger const TGColumnarCursorBatchSize = 256;
+static NSUInteger const TGColumnarScanChunkSize = 4096;
+static NSUInteger const TGColumnarKeyBufferSize = 24;
+static uint64_t const TGColumnarNullBlobLength = UINT64_MAX;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t length;
+} TGColumnarBlobSlot;
+
+/**
+ A value on its way into a column, converted to the column type before anything is written so a bad value never leaves a row half updated.  String, blob and other values are still referenced by the properties dictionary they came from.
+ */
+
+typedef struct {
+    BOOL provided;
+    BOOL null;
+    int64_t integerValue;
+    double doubleValue;
+    __unsafe_unretained id object;
+} TGColumnarCell;
+
+static inline BOOL TGColumnarBitIsSet(const uint8_t *bitmap, NSUInteger bit)
+{
+    return (bitmap[bit >> 3] >> (bit & 7)) & 1;
+}
+
+static inline void TGColumnarSetBit(uint8_t *bitmap, NSUInteger bit, BOOL set)
+{
+    if (set) {
+        bitmap[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+    } else {
+        bitmap[bit >> 3] &= (uint8_t)~(1 << (bit & 7));
+    }
+}
+
+static inline void TGColumnarGrowBitmap(NSMutableData *bitmap, NSUInteger bitCount)
+{
+    NSUInteger length = (bitCount + 7) >> 3;
+    if (bitmap.length < length) {
+        bitmap.length = length;
+    }
+}
+
+static inline NSComparisonResult TGColumnarCompareIntegers(int64_t value, int64_t otherValue)
+{
+    return (value < otherValue) ? NSOrderedAscending : ((value > otherValue) ? NSOrderedDescending : NSOrderedSame);
+}
+
+static inline NSComparisonResult TGColumnarCompareDoubles(double value, double otherValue)
+{
+    return (value < otherValue) ? NSOrderedAscending : ((value > otherValue) ? NSOrderedDescending : NSOrderedSame);
+}
+
+static inline BOOL TGColumnarResultMatches(NSComparisonResult result, TGRESTQueryOperator queryOperator)
+{
+    switch (queryOperator) {
+        case TGRESTQueryOperatorEqual:
+            return result == NSOrderedSame;
+        case TGRESTQueryOperatorGreaterThan:
+            return result == NSOrderedDescending;
+        case TGRESTQueryOperatorGreaterThanOrEqual:
+            return result != NSOrderedAscending;
+        case TGRESTQueryOperatorLessThan:
+            return result == NSOrderedAscending;
+        case TGRESTQueryOperatorLessThanOrEqual:
+            return result != NSOrderedDescending;
+    }
+    
+    return NO;
+}
+
+static BOOL TGColumnarIntegerValue(id value, int64_t *result)
+{
+    if ([value isKindOfClass:[NSNumber class]]) {
+        *result = [value longLongValue];
+        return YES;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        long long scannedValue;
+        NSScanner *scanner = [NSScanner scannerWithString:value];
+        if ([scanner scanLongLong:&scannedValue] && scanner.isAtEnd) {
+            *result = scannedValue;
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+static BOOL TGColumnarDoubleValue(id value, double *result)
+{
+    if ([value isKindOfClass:[NSNumber class]]) {
+        *result = [value doubleValue];
+        return YES;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        double scannedValue;
+        NSScanner *scanner = [NSScanner scannerWithString:value];
+        if ([scanner scanDouble:&scannedValue] && scanner.isAtEnd) {
+            *result = scannedValue;
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+static inline void TGColumnarFormatKey(NSUInteger row, char *buffer)
+{
+    snprintf(buffer, TGColumnarKeyBufferSize, "%lu", (unsigned long)(row + 1));
+}
+
+static int TGColumnarCompareRowsByStringKey(const void *row, const void *otherRow)
+{
+    char key[TGColumnarKeyBufferSize];
+    char otherKey[TGColumnarKeyBufferSize];
+    TGColumnarFormatKey(*(const NSUInteger *)row, key);
+    TGColumnarFormatKey(*(const NSUInteger *)otherRow, otherKey);
+    
+    return strcmp(key, otherKey);
+}
+
+static NSError *TGColumnarStoreError(NSUInteger code)
+{
+    return [NSError errorWithDomain:TGRESTStoreErrorDomain code:code userInfo:nil];
+}
+
+@interface TGRESTColumnarCursor : NSEnumerator
+
+- (instancetype)initWithBatchBlock:(NSArray * (^)(void))batchBlock;
+
+@end
+
+@interface TGRESTColumnarCursor ()
+
+@property (nonatomic, copy) NSArray * (^batchBlock)(void);
+@property (nonatomic, strong) NSArray *batch;
+@property (nonatomic, assign) NSUInteger batchIndex;
+
+@end
+
+@implementation TGRESTColumnarCursor
+
+- (instancetype)initWithBatchBlock:(NSArray * (^)(void))batchBlock
+{
+    NSParameterAssert(batchBlock);
+    
+    self = [super init];
+    if (self) {
+        self.batchBlock = batchBlock;
+    }
+    
+    return self;
+}
+
+- (id)nextObject
+{
+    if (self.batchIndex >= self.batch.count) {
+        self.batch = self.batchBlock ? self.batchBlock() : nil;
+        self.batchIndex = 0;
+        if (self.batch.count == 0) {
+            self.batchBlock = nil;
+            self.batch = nil;
+            return nil;
+        }
+    }
+    
+    return self.batch[self.batchIndex++];
+}
+
+@end
+
+/**
+ A single typed column.  Integer and floating point columns keep their values in `values` with a null bitmap in `nulls`, string columns keep 32 bit string table ids where 0 is null, blob columns keep `TGColumnarBlobSlot` entries and other columns keep their objects in `objects`.
+ */
+
+@interface TGRESTColumnarColumn : NSObject
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, assign) TGPropertyType type;
+@property (nonatomic, strong) NSMutableData *values;
+@property (nonatomic, strong) NSMutableData *nulls;
+@property (nonatomic, strong) NSMutableArray *objects;
+
+- (instancetype)initWithName:(NSString *)name type:(TGPropertyType)type;
+- (void)appendNullRow:(NSUInteger)row;
+
+@end
+
+@implementation TGRESTColumnarColumn
+
+- (instancetype)initWithName:(NSString *)name type:(TGPropertyType)type
+{
+    self = [super init];
+    if (self) {
+        self.name = name;
+        self.type = type;
+        if (type == TGPropertyTypeOther) {
+            self.objects = [NSMutableArray new];
+        } else {
+            self.values = [NSMutableData new];
+        }
+        if (type == TGPropertyTypeInteger || type == TGPropertyTypeFloatingPoint) {
+            self.nulls = [NSMutableData new];
+        }
+    }
+    
+    return self;
+}
+
+- (void)appendNullRow:(NSUInteger)row
+{
+    switch (self.type) {
+        case TGPropertyTypeInteger:
+        case TGPropertyTypeFloatingPoint:
+            [self.values increaseLengthBy:sizeof(int64_t)];
+            TGColumnarGrowBitmap(self.nulls, row + 1);
+            TGColumnarSetBit(self.nulls.mutableBytes, row, YES);
+            break;
+        case TGPropertyTypeString:
+            [self.values increaseLengthBy:sizeof(uint32_t)];
+            break;
+        case TGPropertyTypeBlob: {
+            TGColumnarBlobSlot slot = {0, TGColumnarNullBlobLength};
+            [self.values appendBytes:&slot length:sizeof(slot)];
+            break;
+        }
+        default:
+            [self.objects addObject:[NSNull null]];
+            break;
+    }
+}
+
+@end
+
+/**
+ A table holds all of the rows of a single resource along with the reader/writer queue that guards them, the same way a `TGRESTInMemoryStore` partition does.
+
+ Row `n` always holds the object with primary key `n + 1`, deleted rows are only marked in the deletion bitmap so their primary keys keep answering as deleted.  Integer primary keys are ordered by row, string primary keys are compared as strings so `ordering` keeps the rows in that order instead.
+
+ Foreign keys and indexed properties are hash indexed from the column value (the string id for string columns) to the set of rows holding it.  Every write stamps the table with a new generation from `TGRESTStoreNextGeneration()` and records it as the version of the row it touched, and the snapshot handed out for index requests is only rebuilt the first time it is read after a write.
+ */
+
+@interface TGRESTColumnarTable : NSObject
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) TGRESTResource *resource;
+@property (nonatomic, weak) TGRESTFragmentCache *fragmentCache;
+@property (nonatomic, copy) NSArray *columns;
+@property (nonatomic, copy) NSDictionary *columnsByName;
+@property (nonatomic, copy) NSArray *propertyKeys;
+@property (nonatomic, strong) NSMutableArray *strings;
+@property (nonatomic, strong) NSMutableDictionary *stringIDs;
+@property (nonatomic, strong) NSMutableData *blobArena;
+@property (nonatomic, strong) NSMutableData *deleted;
+@property (nonatomic, strong) NSMutableData *versions;
+@property (nonatomic, strong) NSMutableData *ordering;
+@property (nonatomic, strong) NSMutableDictionary *indexes;
+@property (nonatomic, assign) NSUInteger rowCount;
+@property (nonatomic, assign) NSUInteger liveCount;
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, strong) NSArray *snapshot;
+@property (nonatomic, assign) NSUInteger snapshotGeneration;
+
+- (instancetype)initWithResource:(TGRESTResource *)resource;
+- (NSUInteger)rowForPrimaryKey:(id)primaryKey;
+- (BOOL)isDeletedRow:(NSUInteger)row;
+- (NSUInteger)versionOfRow:(NSUInteger)row;
+- (NSDictionary *)objectAtRow:(NSUInteger)row;
+- (BOOL)stageProperties:(NSDictionary *)properties intoCells:(TGColumnarCell *)cells fillMissing:(BOOL)fillMissing error:(NSError * __autoreleasing *)error;
+- (NSDictionary *)insertRowWithCells:(const TGColumnarCell *)cells;
+- (NSDictionary *)updateRow:(NSUInteger)row withCells:(const TGColumnarCell *)cells;
+- (void)deleteRow:(NSUInteger)row;
+- (NSArray *)currentSnapshot;
+- (NSArray *)objectsAfterPrimaryKey:(id)afterKey limit:(NSUInteger)limit;
+- (NSArray *)objectsWithForeignKey:(NSString *)foreignKey parentKey:(id)parentKey afterPrimaryKey:(id)afterKey limit:(NSUInteger)limit;
+- (NSArray *)objectsMatchingQuery:(TGRESTQuery *)query afterPrimaryKey:(id)afterKey limit:(NSUInteger)limit;
+- (void)nullifyForeignKey:(NSString *)foreignKey parentKey:(id)parentKey;
+- (void)adoptRowsFromTable:(TGRESTColumnarTable *)table;
+
+@end
+
+@implementation TGRESTColumnarTable
+
+- (instancetype)initWithResource:(TGRESTResource *)resource
+{
+    self = [super init];
+    if (self) {
+        self.resource = resource;
+        NSString *label = [NSString stringWithFormat:@"com.tinylittlegears.resteasy.columnar.%@", resource.name];
+        self.queue = dispatch_queue_create([label UTF8String], DISPATCH_QUEUE_CONCURRENT);
+        
+        NSMutableArray *columns = [NSMutableArray new];
+        NSMutableDictionary *columnsByName = [NSMutableDictionary new];
+        NSMutableArray *propertyKeys = [NSMutableArray arrayWithObject:resource.primaryKey];
+        for (NSString *property in [resource.model.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            if ([property isEqualToString:resource.primaryKey]) {
+                continue;
+            }
+            TGRESTColumnarColumn *column = [[TGRESTColumnarColumn alloc] initWithName:property type:[resource.model[property] integerValue]];
+            [columns addObject:column];
+            [columnsByName setObject:column forKey:property];
+            [propertyKeys addObject:property];
+        }
+        self.columns = columns;
+        self.columnsByName = columnsByName;
+        self.propertyKeys = propertyKeys;
+        
+        self.strings = [NSMutableArray arrayWithObject:[NSNull null]];
+        self.stringIDs = [NSMutableDictionary new];
+        self.blobArena = [NSMutableData new];
+        self.deleted = [NSMutableData new];
+        self.versions = [NSMutableData new];
+        if (resource.primaryKeyType == TGPropertyTypeString) {
+            self.ordering = [NSMutableData new];
+        }
+        
+        NSMutableDictionary *indexes = [NSMutableDictionary new];
+        NSArray *indexedProperties = [(resource.foreignKeys.allValues ?: @[]) arrayByAddingObjectsFromArray:resource.indexedProperties ?: @[]];
+        for (NSString *property in indexedProperties) {
+            if (columnsByName[property]) {
+                [indexes setObject:[NSMutableDictionary new] forKey:property];
+            }
+        }
+        self.indexes = indexes;
+        self.rowCount = 0;
+        self.liveCount = 0;
+        self.generation = TGRESTStoreNextGeneration();
+        self.snapshotGeneration = 0;
+    }
+    
+    return self;
+}
+
+#pragma mark - Rows
+
+- (NSUInteger)rowForPrimaryKey:(id)primaryKey
+{
+    if (![primaryKey respondsToSelector:@selector(longLongValue)]) {
+        return NSNotFound;
+    }
+    
+    long long key = [primaryKey longLongValue];
+    if (key <= 0 || (unsigned long long)key > self.rowCount) {
+        return NSNotFound;
+    }
+    // String keys are compared as strings everywhere else, so only their canonical form names a row.
+    if (self.resource.primaryKeyType == TGPropertyTypeString && ![[primaryKey description] isEqualToString:[NSString stringWithFormat:@"%lld", key]]) {
+        return NSNotFound;
+    }
+    
+    return (NSUInteger)(key - 1);
+}
+
+- (id)primaryKeyForRow:(NSUInteger)row
+{
+    if (self.resource.primaryKeyType == TGPropertyTypeInteger) {
+        return [NSNumber numberWithInteger:row + 1];
+    }
+    
+    return [NSString stringWithFormat:@"%lu", (unsigned long)(row + 1)];
+}
+
+- (BOOL)isDeletedRow:(NSUInteger)row
+{
+    return TGColumnarBitIsSet(self.deleted.bytes, row);
+}
+
+- (NSUInteger)versionOfRow:(NSUInteger)row
+{
+    return ((const NSUInteger *)self.versions.bytes)[row];
+}
+
+- (void)stampRow:(NSUInteger)row
+{
+    self.generation = TGRESTStoreNextGeneration();
+    ((NSUInteger *)self.versions.mutableBytes)[row] = self.generation;
+}
+
+- (NSUInteger)rowAtPosition:(NSUInteger)position
+{
+    return self.ordering ? ((const NSUInteger *)self.ordering.bytes)[position] : position;
+}
+
+- (NSUInteger)positionInRows:(const NSUInteger *)rows count:(NSUInteger)count afterPrimaryKey:(id)afterKey
+{
+    if (!afterKey || afterKey == [NSNull null]) {
+        return 0;
+    }
+    
+    NSUInteger lower = 0;
+    NSUInteger upper = count;
+    if (self.resource.primaryKeyType == TGPropertyTypeInteger) {
+        long long key = [afterKey longLongValue];
+        while (lower < upper) {
+            NSUInteger middle = lower + (upper - lower) / 2;
+            if ((long long)(rows[middle] + 1) <= key) {
+                lower = middle + 1;
+            } else {
+                upper = middle;
+            }
+        }
+    } else {
+        const char *key = [[afterKey description] UTF8String];
+        char rowKey[TGColumnarKeyBufferSize];
+        while (lower < upper) {
+            NSUInteger middle = lower + (upper - lower) / 2;
+            TGColumnarFormatKey(rows[middle], rowKey);
+            if (strcmp(rowKey, key) <= 0) {
+                lower = middle + 1;
+            } else {
+                upper = middle;
+            }
+        }
+    }
+    
+    return lower;
+}
+
+- (NSUInteger)positionAfterPrimaryKey:(id)afterKey
+{
+    if (self.ordering) {
+        return [self positionInRows:self.ordering.bytes count:self.rowCount afterPrimaryKey:afterKey];
+    }
+    if (!afterKey || afterKey == [NSNull null]) {
+        return 0;
+    }
+    
+    long long key = [afterKey longLongValue];
+    if (key <= 0) {
+        return 0;
+    }
+    
+    return MIN((NSUInteger)key, self.rowCount);
+}
+
+#pragma mark - Values
+
+- (uint32_t)internString:(id)value
+{
+    NSString *string = [value isKindOfClass:[NSString class]] ? value : [value stringValue];
+    NSNumber *stringID = self.stringIDs[string];
+    if (stringID) {
+        return [stringID unsignedIntValue];
+    }
+    
+    NSString *internedString = [string copy];
+    uint32_t newStringID = (uint32_t)self.strings.count;
+    [self.strings addObject:internedString];
+    [self.stringIDs setObject:[NSNumber numberWithUnsignedInt:newStringID] forKey:internedString];
+    
+    return newStringID;
+}
+
+- (id)valueOfColumn:(TGRESTColumnarColumn *)column row:(NSUInteger)row
+{
+    switch (column.type) {
+        case TGPropertyTypeInteger:
+            if (TGColumnarBitIsSet(column.nulls.bytes, row)) {
+                return [NSNull null];
+            }
+            return [NSNumber numberWithLongLong:((const int64_t *)column.values.bytes)[row]];
+        case TGPropertyTypeFloatingPoint:
+            if (TGColumnarBitIsSet(column.nulls.bytes, row)) {
+                return [NSNull null];
+            }
+            return [NSNumber numberWithDouble:((const double *)column.values.bytes)[row]];
+        case TGPropertyTypeString:
+            return self.strings[((const uint32_t *)column.values.bytes)[row]];
+        case TGPropertyTypeBlob: {
+            TGColumnarBlobSlot slot = ((const TGColumnarBlobSlot *)column.values.bytes)[row];
+            if (slot.length == TGColumnarNullBlobLength) {
+                return [NSNull null];
+            }
+            return [self.blobArena subdataWithRange:NSMakeRange((NSUInteger)slot.offset, (NSUInteger)slot.length)];
+        }
+        default:
+            return column.objects[row];
+    }
+}
+
+- (NSDictionary *)objectAtRow:(NSUInteger)row
+{
+    NSArray *columns = self.columns;
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:columns.count + 1];
+    [values addObject:[self primaryKeyForRow:row]];
+    for (TGRESTColumnarColumn *column in columns) {
+        [values addObject:[self valueOfColumn:column row:row]];
+    }
+    
+    return [NSDictionary dictionaryWithObjects:values forKeys:self.propertyKeys];
+}
+
+- (NSArray *)objectsForRows:(const NSUInteger *)rows count:(NSUInteger)count
+{
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger x = 0; x < count; x++) {
+        [objects addObject:[self objectAtRow:rows[x]]];
+    }
+    
+    return [NSArray arrayWithArray:objects];
+}
+
+#pragma mark - Indexes
+
+- (id)indexKeyForColumn:(TGRESTColumnarColumn *)column row:(NSUInteger)row
+{
+    switch (column.type) {
+        case TGPropertyTypeInteger:
+            if (TGColumnarBitIsSet(column.nulls.bytes, row)) {
+                return nil;
+            }
+            return [NSNumber numberWithLongLong:((const int64_t *)column.values.bytes)[row]];
+        case TGPropertyTypeFloatingPoint:
+            if (TGColumnarBitIsSet(column.nulls.bytes, row)) {
+                return nil;
+            }
+            return [NSNumber numberWithDouble:((const double *)column.values.bytes)[row]];
+        case TGPropertyTypeString: {
+            uint32_t stringID = ((const uint32_t *)column.values.bytes)[row];
+            return stringID ? [NSNumber numberWithUnsignedInt:stringID] : nil;
+        }
+        default:
+            return nil;
+    }
+}
+
+- (id)indexKeyForValue:(id)value column:(TGRESTColumnarColumn *)column
+{
+    if (!value || value == [NSNull null]) {
+        return nil;
+    }
+    
+    switch (column.type) {
+        case TGPropertyTypeInteger:
+            return [value respondsToSelector:@selector(longLongValue)] ? [NSNumber numberWithLongLong:[value longLongValue]] : nil;
+        case TGPropertyTypeFloatingPoint:
+            return [value respondsToSelector:@selector(doubleValue)] ? [NSNumber numberWithDouble:[value doubleValue]] : nil;
+        case TGPropertyTypeString:
+            return self.stringIDs[[value description]];
+        default:
+            return nil;
+    }
+}
+
+- (void)addRow:(NSUInteger)row toIndexOfColumn:(TGRESTColumnarColumn *)column
+{
+    NSMutableDictionary *index = self.indexes[column.name];
+    id key = [self indexKeyForColumn:column row:row];
+    if (!index || !key) {
+        return;
+    }
+    
+    NSMutableIndexSet *rows = index[key];
+    if (!rows) {
+        rows = [NSMutableIndexSet new];
+        [index setObject:rows forKey:key];
+    }
+    [rows addIndex:row];
+}
+
+- (void)removeRow:(NSUInteger)row fromIndexOfColumn:(TGRESTColumnarColumn *)column
+{
+    NSMutableDictionary *index = self.indexes[column.name];
+    id key = [self indexKeyForColumn:column row:row];
+    if (!index || !key) {
+        return;
+    }
+    
+    NSMutableIndexSet *rows = index[key];
+    [rows removeIndex:row];
+    if (rows.count == 0) {
+        [index removeObjectForKey:key];
+    }
+}
+
+- (NSMutableData *)rowsWithValue:(id)value inIndexedColumn:(TGRESTColumnarColumn *)column
+{
+    id key = [self indexKeyForValue:value column:column];
+    NSIndexSet *indexRows = key ? self.indexes[column.name][key] : nil;
+    NSMutableData *rows = [NSMutableData dataWithLength:indexRows.count * sizeof(NSUInteger)];
+    if (indexRows.count == 0) {
+        return rows;
+    }
+    
+    [indexRows getIndexes:rows.mutableBytes maxCount:indexRows.count inIndexRange:nil];
+    if (self.ordering) {
+        qsort(rows.mutableBytes, indexRows.count, sizeof(NSUInteger), TGColumnarCompareRowsByStringKey);
+    }
+    
+    return rows;
+}
+
+#pragma mark - Writes
+
+- (BOOL)stageProperties:(NSDictionary *)properties intoCells:(TGColumnarCell *)cells fillMissing:(BOOL)fillMissing error:(NSError * __autoreleasing *)error
+{
+    NSArray *columns = self.columns;
+    for (NSUInteger x = 0; x < columns.count; x++) {
+        TGRESTColumnarColumn *column = columns[x];
+        TGColumnarCell *cell = &cells[x];
+        id value = properties[column.name];
+        *cell = (TGColumnarCell){NO, YES, 0, 0, nil};
+        if (!value) {
+            cell->provided = fillMissing;
+            continue;
+        }
+        cell->provided = YES;
+        if (value == [NSNull null]) {
+            continue;
+        }
+        
+        BOOL storable;
+        switch (column.type) {
+            case TGPropertyTypeInteger:
+                storable = TGColumnarIntegerValue(value, &cell->integerValue);
+                break;
+            case TGPropertyTypeFloatingPoint:
+                storable = TGColumnarDoubleValue(value, &cell->doubleValue);
+                break;
+            case TGPropertyTypeString:
+                storable = [value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNumber class]];
+                break;
+            case TGPropertyTypeBlob:
+                storable = [value isKindOfClass:[NSData class]];
+                break;
+            default:
+                storable = YES;
+                break;
+        }
+        if (!storable) {
+            if (error) {
+                NSString *reason = [NSString stringWithFormat:@"%@ can't be stored in property %@ of resource %@", value, column.name, self.resource.name];
+                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:@{NSLocalizedDescriptionKey: reason}];
+            }
+            return NO;
+        }
+        cell->null = NO;
+        cell->object = value;
+    }
+    
+    return YES;
+}
+
+- (void)writeCell:(const TGColumnarCell *)cell toColumn:(TGRESTColumnarColumn *)column row:(NSUInteger)row
+{
+    [self removeRow:row fromIndexOfColumn:column];
+    switch (column.type) {
+        case TGPropertyTypeInteger:
+            ((int64_t *)column.values.mutableBytes)[row] = cell->integerValue;
+            TGColumnarSetBit(column.nulls.mutableBytes, row, cell->null);
+            break;
+        case TGPropertyTypeFloatingPoint:
+            ((double *)column.values.mutableBytes)[row] = cell->doubleValue;
+            TGColumnarSetBit(column.nulls.mutableBytes, row, cell->null);
+            break;
+        case TGPropertyTypeString:
+            ((uint32_t *)column.values.mutableBytes)[row] = cell->null ? 0 : [self internString:cell->object];
+            break;
+        case TGPropertyTypeBlob: {
+            TGColumnarBlobSlot slot = {0, TGColumnarNullBlobLength};
+            if (!cell->null) {
+                NSData *blob = cell->object;
+                slot.offset = self.blobArena.length;
+                slot.length = blob.length;
+                [self.blobArena appendData:blob];
+            }
+            ((TGColumnarBlobSlot *)column.values.mutableBytes)[row] = slot;
+            break;
+        }
+        default:
+            [column.objects replaceObjectAtIndex:row withObject:cell->null ? [NSNull null] : cell->object];
+            break;
+    }
+    [self addRow:row toIndexOfColumn:column];
+}
+
+- (void)writeCells:(const TGColumnarCell *)cells toRow:(NSUInteger)row
+{
+    NSArray *columns = self.columns;
+    for (NSUInteger x = 0; x < columns.count; x++) {
+        if (cells[x].provided) {
+            [self writeCell:&cells[x] toColumn:columns[x] row:row];
+        }
+    }
+}
+
+- (NSDictionary *)insertRowWithCells:(const TGColumnarCell *)cells
+{
+    NSUInteger row = self.rowCount;
+    for (TGRESTColumnarColumn *column in self.columns) {
+        [column appendNullRow:row];
+    }
+    self.rowCount = row + 1;
+    TGColumnarGrowBitmap(self.deleted, self.rowCount);
+    [self.versions increaseLengthBy:sizeof(NSUInteger)];
+    
+    if (self.ordering) {
+        NSUInteger position = [self positionInRows:self.ordering.bytes count:row afterPrimaryKey:[self primaryKeyForRow:row]];
+        [self.ordering replaceBytesInRange:NSMakeRange(position * sizeof(NSUInteger), 0) withBytes:&row length:sizeof(NSUInteger)];
+    }
+    
+    [self writeCells:cells toRow:row];
+    self.liveCount++;
+    [self stampRow:row];
+    
+    return [self objectAtRow:row];
+}
+
+- (NSDictionary *)updateRow:(NSUInteger)row withCells:(const TGColumnarCell *)cells
+{
+    [self writeCells:cells toRow:row];
+    [self stampRow:row];
+    [self.fragmentCache invalidateObjectOfResource:self.resource withPrimaryKey:[self primaryKeyForRow:row]];
+    
+    return [self objectAtRow:row];
+}
+
+- (void)deleteRow:(NSUInteger)row
+{
+    for (TGRESTColumnarColumn *column in self.columns) {
+        [self removeRow:row fromIndexOfColumn:column];
+        if (column.type == TGPropertyTypeOther) {
+            [column.objects replaceObjectAtIndex:row withObject:[NSNull null]];
+        }
+    }
+    TGColumnarSetBit(self.deleted.mutableBytes, row, YES);
+    self.liveCount--;
+    [self stampRow:row];
+    [self.fragmentCache invalidateObjectOfResource:self.resource withPrimaryKey:[self primaryKeyForRow:row]];
+}
+
+- (void)nullifyForeignKey:(NSString *)foreignKey parentKey:(id)parentKey
+{
+    TGRESTColumnarColumn *column = self.columnsByName[foreignKey];
+    if (!column) {
+        return;
+    }
+    
+    NSData *rowData = [self rowsWithValue:parentKey inIndexedColumn:column];
+    const NSUInteger *rows = rowData.bytes;
+    TGColumnarCell nullCell = {YES, YES, 0, 0, nil};
+    for (NSUInteger x = 0; x < rowData.length / sizeof(NSUInteger); x++) {
+        [self writeCell:&nullCell toColumn:column row:rows[x]];
+        [self stampRow:rows[x]];
+        [self.fragmentCache invalidateObjectOfResource:self.resource withPrimaryKey:[self primaryKeyForRow:rows[x]]];
+    }
+}
+
+- (void)adoptRowsFromTable:(TGRESTColumnarTable *)table
+{
+    for (TGRESTColumnarColumn *column in self.columns) {
+        TGRESTColumnarColumn *existingColumn = table.columnsByName[column.name];
+        column.values = [existingColumn.values mutableCopy];
+        column.nulls = [existingColumn.nulls mutableCopy];
+        column.objects = [existingColumn.objects mutableCopy];
+    }
+    self.strings = [table.strings mutableCopy];
+    self.stringIDs = [table.stringIDs mutableCopy];
+    self.blobArena = [table.blobArena mutableCopy];
+    self.deleted = [table.deleted mutableCopy];
+    self.versions = [table.versions mutableCopy];
+    self.ordering = [table.ordering mutableCopy];
+    self.rowCount = table.rowCount;
+    self.liveCount = table.liveCount;
+    
+    for (NSUInteger row = 0; row < self.rowCount; row++) {
+        if ([self isDeletedRow:row]) {
+            continue;
+        }
+        for (TGRESTColumnarColumn *column in self.columns) {
+            [self addRow:row toIndexOfColumn:column];
+        }
+    }
+    self.generation = TGRESTStoreNextGeneration();
+}
+
+#pragma mark - Reads
+
+- (NSArray *)currentSnapshot
+{
+    // Readers share the table queue so the rebuild itself is guarded separately.
+    @synchronized(self) {
+        if (self.snapshotGeneration != self.generation) {
+            self.snapshot = [self objectsAfterPrimaryKey:nil limit:NSUIntegerMax];
+            self.snapshotGeneration = self.generation;
+        }
+        
+        return self.snapshot;
+    }
+}
+
+- (NSArray *)objectsAfterPrimaryKey:(id)afterKey limit:(NSUInteger)limit
+{
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:MIN(limit, self.liveCount)];
+    for (NSUInteger position = [self positionAfterPrimaryKey:afterKey]; position < self.rowCount && objects.count < limit; position++) {
+        NSUInteger row = [self rowAtPosition:position];
+        if (![self isDeletedRow:row]) {
+            [objects addObject:[self objectAtRow:row]];
+        }
+    }
+    
+    return [NSArray arrayWithArray:objects];
+}
+
+- (NSArray *)objectsWithForeignKey:(NSString *)foreignKey parentKey:(id)parentKey afterPrimaryKey:(id)afterKey limit:(NSUInteger)limit
+{
+    TGRESTColumnarColumn *column = self.columnsByName[foreignKey];
+    if (!column) {
+        return @[];
+    }
+    
+    NSData *rowData = [self rowsWithValue:parentKey inIndexedColumn:column];
+    const NSUInteger *rows = rowData.bytes;
+    NSUInteger count = rowData.length / sizeof(NSUInteger);
+    NSUInteger start = [self positionInRows:rows count:count afterPrimaryKey:afterKey];
+    
+    return [self objectsForRows:rows + start count:MIN(limit, count - start)];
+}
+
+- (NSUInteger)filterRows:(NSUInteger *)rows count:(NSUInteger)count withFilter:(TGRESTQueryFilter *)filter
+{
+    TGRESTQueryOperator queryOperator = filter.queryOperator;
+    NSUInteger matchCount = 0;
+    
+    if ([filter.property isEqualToString:self.resource.primaryKey]) {
+        if (self.resource.primaryKeyType == TGPropertyTypeInteger) {
+            int64_t target = [filter.value longLongValue];
+            for (NSUInteger x = 0; x < count; x++) {
+                if (TGColumnarResultMatches(TGColumnarCompareIntegers((int64_t)rows[x] + 1, target), queryOperator)) {
+                    rows[matchCount++] = rows[x];
+                }
+            }
+        } else {
+            NSUInteger targetRow = [self rowForPrimaryKey:filter.value];
+            for (NSUInteger x = 0; x < count; x++) {
+                if (rows[x] == targetRow) {
+                    rows[matchCount++] = rows[x];
+                }
+            }
+        }
+        return matchCount;
+    }
+    
+    // Each case is a tight loop over the raw column, nothing is boxed.  Like a sql comparison, null never matches a filter.
+    TGRESTColumnarColumn *column = self.columnsByName[filter.property];
+    switch (column.type) {
+        case TGPropertyTypeInteger: {
+            const int64_t *values = column.values.bytes;
+            const uint8_t *nulls = column.nulls.bytes;
+            int64_t target = [filter.value longLongValue];
+            for (NSUInteger x = 0; x < count; x++) {
+                NSUInteger row = rows[x];
+                if (!TGColumnarBitIsSet(nulls, row) && TGColumnarResultMatches(TGColumnarCompareIntegers(values[row], target), queryOperator)) {
+                    rows[matchCount++] = row;
+                }
+            }
+            break;
+        }
+        case TGPropertyTypeFloatingPoint: {
+            const double *values = column.values.bytes;
+            const uint8_t *nulls = column.nulls.bytes;
+            double target = [filter.value doubleValue];
+            for (NSUInteger x = 0; x < count; x++) {
+                NSUInteger row = rows[x];
+                if (!TGColumnarBitIsSet(nulls, row) && TGColumnarResultMatches(TGColumnarCompareDoubles(values[row], target), queryOperator)) {
+                    rows[matchCount++] = row;
+                }
+            }
+            break;
+        }
+        case TGPropertyTypeString: {
+            // Strings can only be filtered for equality, which is a comparison of string ids.
+            NSNumber *stringID = self.stringIDs[[filter.value description]];
+            if (!stringID || queryOperator != TGRESTQueryOperatorEqual) {
+                break;
+            }
+            const uint32_t *values = column.values.bytes;
+            uint32_t target = [stringID unsignedIntValue];
+            for (NSUInteger x = 0; x < count; x++) {
+                if (values[rows[x]] == target) {
+                    rows[matchCount++] = rows[x];
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    
+    return matchCount;
+}
+
+- (NSArray *)objectsMatchingQuery:(TGRESTQuery *)query afterPrimaryKey:(id)afterKey limit:(NSUInteger)limit
+{
+    BOOL ordersByPrimaryKey = query.ordersByPrimaryKey;
+    
+    // An indexed equality filter narrows the rows down before anything is scanned, otherwise every row from the page start is a candidate.
+    TGRESTQueryFilter *indexedFilter;
+    NSData *indexedRowData;
+    for (TGRESTQueryFilter *filter in query.filters) {
+        if (filter.queryOperator == TGRESTQueryOperatorEqual && self.indexes[filter.property]) {
+            indexedFilter = filter;
+            indexedRowData = [self rowsWithValue:filter.value inIndexedColumn:self.columnsByName[filter.property]];
+            break;
+        }
+    }
+    
+    const NSUInteger *indexedRows = indexedRowData.bytes;
+    NSUInteger sourceCount = indexedRowData ? indexedRowData.length / sizeof(NSUInteger) : self.rowCount;
+    NSUInteger position = 0;
+    if (ordersByPrimaryKey) {
+        position = indexedRowData ? [self positionInRows:indexedRows count:sourceCount afterPrimaryKey:afterKey] : [self positionAfterPrimaryKey:afterKey];
+    }
+    
+    // Rows are filtered a chunk at a time so a page in primary key order stops scanning once it is full.
+    NSMutableData *chunkData = [NSMutableData dataWithLength:TGColumnarScanChunkSize * sizeof(NSUInteger)];
+    NSUInteger *chunk = chunkData.mutableBytes;
+    NSMutableData *matchData = [NSMutableData new];
+    NSUInteger matchCount = 0;
+    while (position < sourceCount && (!ordersByPrimaryKey || matchCount < limit)) {
+        NSUInteger chunkCount = 0;
+        while (position < sourceCount && chunkCount < TGColumnarScanChunkSize) {
+            NSUInteger row = indexedRowData ? indexedRows[position] : [self rowAtPosition:position];
+            position++;
+            if (![self isDeletedRow:row]) {
+                chunk[chunkCount++] = row;
+            }
+        }
+        for (TGRESTQueryFilter *filter in query.filters) {
+            if (filter != indexedFilter && chunkCount > 0) {
+                chunkCount = [self filterRows:chunk count:chunkCount withFilter:filter];
+            }
+        }
+        [matchData appendBytes:chunk length:chunkCount * sizeof(NSUInteger)];
+        matchCount += chunkCount;
+    }
+    
+    if (ordersByPrimaryKey) {
+        return [self objectsForRows:matchData.bytes count:MIN(matchCount, limit)];
+    }
+    
+    return [query objectsMatchingQueryInObjects:[self objectsForRows:matchData.bytes count:matchCount] afterPrimaryKey:afterKey limit:limit];
+}
+
+@end
+
+@interface TGRESTColumnarStore ()
+
+@property (atomic, copy) NSDictionary *tables;
+@property (nonatomic, strong) dispatch_queue_t catalogQueue;
+
+@end
+
+@implementation TGRESTColumnarStore
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.tables = @{};
+        self.catalogQueue = dispatch_queue_create("com.tinylittlegears.resteasy.columnar.catalog", DISPATCH_QUEUE_SERIAL);
+    }
+    
+    return self;
+}
+
+- (TGRESTColumnarTable *)tableForResource:(TGRESTResource *)resource
+{
+    return self.tables[resource.name];
+}
+
+- (NSUInteger)countOfObjectsForResource:(TGRESTResource *)resource
+{
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block NSUInteger count = 0;
+    
+    if (table) {
+        dispatch_sync(table.queue, ^{
+            count = table.liveCount;
+        });
+    }
+    
+    return count;
+}
+
+- (NSUInteger)generationForResource:(TGRESTResource *)resource
+{
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block NSUInteger generation = NSNotFound;
+    
+    if (table) {
+        dispatch_sync(table.queue, ^{
+            generation = table.generation;
+        });
+    }
+    
+    return generation;
+}
+
+- (NSUInteger)versionOfObjectOfResource:(TGRESTResource *)resource
+                         withPrimaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(primaryKey);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block NSUInteger version = NSNotFound;
+    
+    if (table) {
+        dispatch_sync(table.queue, ^{
+            NSUInteger row = [table rowForPrimaryKey:primaryKey];
+            if (row != NSNotFound) {
+                version = [table versionOfRow:row];
+            }
+        });
+    }
+    
+    return version;
+}
+
+- (NSDictionary *)getDataForObjectOfResource:(TGRESTResource *)resource
+                              withPrimaryKey:(NSString *)primaryKey
+                                       error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(primaryKey);
+    NSParameterAssert(resource);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block NSDictionary *object;
+    __block NSUInteger errorCode = TGRESTStoreObjectNotFoundErrorCode;
+    
+    if (table) {
+        dispatch_sync(table.queue, ^{
+            NSUInteger row = [table rowForPrimaryKey:primaryKey];
+            if (row == NSNotFound) {
+                return;
+            }
+            if ([table isDeletedRow:row]) {
+                errorCode = TGRESTStoreObjectAlreadyDeletedErrorCode;
+            } else {
+                object = [table objectAtRow:row];
+            }
+        });
+    }
+    
+    if (!object && error) {
+        *error = TGColumnarStoreError(errorCode);
+    }
+    
+    return object;
+}
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                                   error:(NSError * __autoreleasing *)error
+{
+    return [self getDataForObjectsOfResource:resource withParent:parent parentPrimaryKey:key afterPrimaryKey:nil limit:NSUIntegerMax error:error];
+}
+
+- (NSArray *)getAllObjectsForResource:(TGRESTResource *)resource
+                                error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    if (!table) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreUnknownErrorCode);
+        }
+        return nil;
+    }
+    
+    __block NSArray *snapshot;
+    dispatch_sync(table.queue, ^{
+        snapshot = [table currentSnapshot];
+    });
+    
+    return snapshot;
+}
+
+- (NSEnumerator *)objectEnumeratorForResource:(TGRESTResource *)resource
+                                        error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    if (!table) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreUnknownErrorCode);
+        }
+        return nil;
+    }
+    
+    // Each batch picks up after the last primary key it handed out, so writes between batches never shift the cursor.
+    __block id afterKey;
+    NSString *primaryKey = resource.primaryKey;
+    return [[TGRESTColumnarCursor alloc] initWithBatchBlock:^NSArray *{
+        __block NSArray *batch;
+        dispatch_sync(table.queue, ^{
+            batch = [table objectsAfterPrimaryKey:afterKey limit:TGColumnarCursorBatchSize];
+        });
+        afterKey = [batch.lastObject objectForKey:primaryKey];
+        return batch;
+    }];
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    if (!table) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreUnknownErrorCode);
+        }
+        return nil;
+    }
+    
+    __block NSArray *page;
+    dispatch_sync(table.queue, ^{
+        page = [table objectsAfterPrimaryKey:afterKey limit:limit];
+    });
+    
+    return page;
+}
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                         afterPrimaryKey:(NSString *)afterKey
+                                   limit:(NSUInteger)limit
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(parent);
+    NSParameterAssert(key);
+    
+    NSError *lookup;
+    [self getDataForObjectOfResource:parent withPrimaryKey:key error:&lookup];
+    
+    if (lookup) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreObjectNotFoundErrorCode);
+        }
+        
+        return nil;
+    }
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    NSString *foreignKey = resource.foreignKeys[parent.name];
+    __block NSArray *page = @[];
+    
+    if (table) {
+        dispatch_sync(table.queue, ^{
+            page = [table objectsWithForeignKey:foreignKey parentKey:key afterPrimaryKey:afterKey limit:limit];
+        });
+    }
+    
+    return page;
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                     matchingQuery:(TGRESTQuery *)query
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(query);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    if (!table) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreUnknownErrorCode);
+        }
+        return nil;
+    }
+    
+    __block NSArray *matches;
+    dispatch_sync(table.queue, ^{
+        matches = [table objectsMatchingQuery:query afterPrimaryKey:afterKey limit:limit];
+    });
+    
+    return matches;
+}
+
+- (NSDictionary *)createNewObjectForResource:(TGRESTResource *)resource
+                              withProperties:(NSDictionary *)properties
+                                       error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(properties);
+    NSParameterAssert(resource);
+    
+    NSArray *newObjects = [self createNewObjectsForResource:resource withPropertiesArray:@[properties] error:error];
+    
+    return newObjects.firstObject;
+}
+
+- (NSArray *)createNewObjectsForResource:(TGRESTResource *)resource
+                     withPropertiesArray:(NSArray *)propertiesArray
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(propertiesArray);
+    NSParameterAssert(resource);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    if (!table) {
+        if (error) {
+            *error = TGColumnarStoreError(TGRESTStoreUnknownErrorCode);
+        }
+        return nil;
+    }
+    
+    NSUInteger columnCount = table.columns.count;
+    NSMutableData *cellData = [NSMutableData dataWithLength:propertiesArray.count * columnCount * sizeof(TGColumnarCell)];
+    TGColumnarCell *cells = cellData.mutableBytes;
+    NSMutableArray *newObjects = [NSMutableArray arrayWithCapacity:propertiesArray.count];
+    __block NSError *blockError;
+    
+    dispatch_barrier_sync(table.queue, ^{
+        // Every object is converted before the first row is written so a bad value never leaves part of the batch behind.
+        for (NSUInteger x = 0; x < propertiesArray.count; x++) {
+            NSError *stageError;
+            if (![table stageProperties:propertiesArray[x] intoCells:cells + x * columnCount fillMissing:YES error:&stageError]) {
+                blockError = stageError;
+                return;
+            }
+        }
+        for (NSUInteger x = 0; x < propertiesArray.count; x++) {
+            [newObjects addObject:[table insertRowWithCells:cells + x * columnCount]];
+        }
+    });
+    
+    if (blockError) {
+        if (error) {
+            *error = blockError;
+        }
+        return nil;
+    }
+    
+    return [NSArray arrayWithArray:newObjects];
+}
+
+- (NSDictionary *)modifyObjectOfResource:(TGRESTResource *)resource
+                          withPrimaryKey:(NSString *)primaryKey
+                          withProperties:(NSDictionary *)properties
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(primaryKey);
+    NSParameterAssert(resource);
+    NSParameterAssert(properties);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block NSDictionary *updatedObject;
+    __block NSError *blockError;
+    
+    if (!table) {
+        blockError = TGColumnarStoreError(TGRESTStoreObjectNotFoundErrorCode);
+    } else {
+        NSMutableData *cellData = [NSMutableData dataWithLength:table.columns.count * sizeof(TGColumnarCell)];
+        TGColumnarCell *cells = cellData.mutableBytes;
+        dispatch_barrier_sync(table.queue, ^{
+            NSUInteger row = [table rowForPrimaryKey:primaryKey];
+            NSError *stageError;
+            if (row == NSNotFound) {
+                blockError = TGColumnarStoreError(TGRESTStoreObjectNotFoundErrorCode);
+            } else if ([table isDeletedRow:row]) {
+                blockError = TGColumnarStoreError(TGRESTStoreObjectAlreadyDeletedErrorCode);
+            } else if (![table stageProperties:properties intoCells:cells fillMissing:NO error:&stageError]) {
+                blockError = stageError;
+            } else {
+                updatedObject = [table updateRow:row withCells:cells];
+            }
+        });
+    }
+    
+    if (error) {
+        *error = blockError;
+    }
+    
+    return updatedObject;
+}
+
+- (BOOL)deleteObjectOfResource:(TGRESTResource *)resource
+                withPrimaryKey:(NSString *)primaryKey
+                         error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(primaryKey);
+    
+    TGRESTColumnarTable *table = [self tableForResource:resource];
+    __block BOOL success = NO;
+    __block NSError *blockError;
+    
+    if (!table) {
+        blockError = TGColumnarStoreError(TGRESTStoreObjectNotFoundErrorCode);
+    } else {
+        dispatch_barrier_sync(table.queue, ^{
+            NSUInteger row = [table rowForPrimaryKey:primaryKey];
+            if (row == NSNotFound) {
+                blockError = TGColumnarStoreError(TGRESTStoreObjectNotFoundErrorCode);
+            } else if ([table isDeletedRow:row]) {
+                blockError = TGColumnarStoreError(TGRESTStoreObjectAlreadyDeletedErrorCode);
+            } else {
+                [table deleteRow:row];
+                success = YES;
+            }
+        });
+    }
+    
+    if (success) {
+        // Children live in their own tables, null out their foreign keys one table at a time so no two table locks are ever held together.
+        for (TGRESTResource *child in resource.childResources) {
+            TGRESTColumnarTable *childTable = [self tableForResource:child];
+            if (!childTable) {
+                continue;
+            }
+            NSString *fKeyName = child.foreignKeys[resource.name];
+            
+            dispatch_barrier_sync(childTable.queue, ^{
+                [childTable nullifyForeignKey:fKeyName parentKey:primaryKey];
+            });
+        }
+    }
+    
+    if (error) {
+        *error = blockError;
+    }
+    
+    return success;
+}
+
+- (void)addResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    dispatch_sync(self.catalogQueue, ^{
+        TGRESTColumnarTable *existingTable = self.tables[resource.name];
+        TGRESTColumnarTable *table = [[TGRESTColumnarTable alloc] initWithResource:resource];
+        table.fragmentCache = self.fragmentCache;
+        TGRESTResource *existingResource = existingTable.resource;
+        if (existingResource &&
+            [existingResource.model isEqualToDictionary:resource.model] &&
+            [existingResource.foreignKeys isEqualToDictionary:resource.foreignKeys] &&
+            ![existingResource.indexedProperties isEqualToArray:resource.indexedProperties]) {
+            // Only the indexes changed so the columns carry over and get indexed again.
+            dispatch_barrier_sync(existingTable.queue, ^{
+                [table adoptRowsFromTable:existingTable];
+            });
+        }
+        NSMutableDictionary *tables = [NSMutableDictionary dictionaryWithDictionary:self.tables];
+        [tables setObject:table forKey:resource.name];
+        self.tables = tables;
+    });
+    [self.fragmentCache invalidateResource:resource];
+}
+
+- (void)dropResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    dispatch_sync(self.catalogQueue, ^{
+        NSMutableDictionary *tables = [NSMutableDictionary dictionaryWithDictionary:self.tables];
+        [tables removeObjectForKey:resource.name];
+        self.tables = tables;
+    });
+    [self.fragmentCache invalidateResource:resource];
+}
+
++ (NSString *)description
+{
+    return @"Columnar";
+}
+
+- (NSString *)description
+{
+    NSDictionary *tables = self.tables;
+    __block NSUInteger objectCount = 0;
+    
+    for (TGRESTColumnarTable *table in tables.allValues) {
+        dispatch_sync(table.queue, ^{
+            objectCount = objectCount + table.liveCount;
+        });
+    }
+    
+    return [NSString stringWithFormat:@"%@ with %lu resources and %lu objects", [[self class] description], (unsigned long)tables.allKeys.count, (unsigned long)objectCount];
+}
+
+@end
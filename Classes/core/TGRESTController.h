@@ -28,7 +28,7 @@
  
  ### Requests
  
- The request is of `GCDWebServerRequest` type and you should have a look at the documentation for GCDWebServer if you want to understand these better.  Also have a look at the implementation for `TGRESTDefaultController` but the general approach here is that the controller takes in the GCDWebServerRequest (representing a request to a given RESTful action), processes that action, performs it and then returns a response.  The controller is responsible for deserializing the JSON or FormURL encoded request as well as serializing it back into the response format to build and return a GCDWebServerResponse.
+ The request is of `GCDWebServerRequest` type and you should have a look at the documentation for GCDWebServer if you want to understand these better.  Every request the server routes to a controller is a `TGRESTRouteRequest` whose `route` holds the primary key and, for nested routes, the parent resource and parent primary key that were taken from the path, so there is no need to pick the URL apart again.  If your controller adds the nanoseconds it spends in the datastore and on serialization to the `storeTime` and `serializeTime` of the request they show up in the server metrics.  Also have a look at the implementation for `TGRESTDefaultController` but the general approach here is that the controller takes in the GCDWebServerRequest (representing a request to a given RESTful action), processes that action, performs it and then returns a response.  The controller is responsible for deserializing the JSON or FormURL encoded request as well as serializing it back into the response format to build and return a GCDWebServerResponse.
  
  ### Response
  
@@ -44,7 +44,7 @@
  *  Called when the server receives a route matching a valid INDEX action for the given resource.
  *
  *  @param request  Request that was received.
- *  @param resource Resource that has matched the path regex.
+ *  @param resource Resource the request was routed to.
  *  @param server    Server for the request.
  *
  *  @return Response for the action.
@@ -58,7 +58,7 @@
  *  Called when the server receives a route matching a valid SHOW action for the given resource.
  *
  *  @param request  Request that was received.
- *  @param resource Resource that has matched the path regex.
+ *  @param resource Resource the request was routed to.
  *  @param server    Server for the request.
  *
  *  @return Response for the action.
@@ -72,7 +72,7 @@
  *  Called when the server receives a route matching a valid CREATE action for the given resource.
  *
  *  @param request  Request that was received.
- *  @param resource Resource that has matched the path regex.
+ *  @param resource Resource the request was routed to.
  *  @param server    Server for the request.
  *
  *  @return Response for the action.
@@ -86,7 +86,7 @@
  *  Called when the server receives a route matching a valid UPDATE action for the given resource.
  *
  *  @param request  Request that was received.
- *  @param resource Resource that has matched the path regex.
+ *  @param resource Resource the request was routed to.
  *  @param server    Server for the request.
  *
  *  @return Response for the action.
@@ -100,7 +100,7 @@
  *  Called when the server receives a route matching a valid DESTROY action for the given resource.
  *
  *  @param request  Request that was received.
- *  @param resource Resource that has matched the path regex.
+ *  @param resource Resource the request was routed to.
  *  @param server    Server for the request.
  *
  *  @return Response for the action.
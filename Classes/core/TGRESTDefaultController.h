@@ -11,8 +11,66 @@
 
 /**
  Default implementation of the TGRESTController protocol that is used by TGRESTServer for all requests.  You can add a custom controller to `TGRESTServer` using the `-startWithOptions:` dictionary, but you should look at TGRESTSerializer to see if you can accomplish your goals with a custom serializer first.
+ 
+ ### Pagination
+ 
+ Index and nested index requests can be paged by primary key with the `limit` and `after` query parameters, for example `GET /people?limit=50&after=100`.  When there are more objects after the page the response carries the primary key to pass as `after` for the next page in the `X-Next-Cursor` header.  Requests without either parameter return the whole collection as before.
+ 
+ ### Filtering and sorting
+ 
+ Index and nested index requests also take the filter and sort parameters described in `TGRESTQuery`, for example `GET /people?age[gte]=21&sort=-age`.  The query is validated against the resource model, an invalid one gets a 400 response, and then run inside the datastore.  A filtered request can still be limited, but it can only be paged with `after` when it is ordered by primary key.
+ 
+ ### Streaming
+ 
+ An index request without paging, filter or sort parameters for a resource that uses `TGRESTDefaultSerializer` is sent as a chunked response, with each object written out as the datastore's `-objectEnumeratorForResource:error:` returns it.  Resources with a custom serializer are still collected and handed to `+dataWithCollection:resource:` in one go.
+ 
+ Objects are encoded through the datastore's `TGRESTFragmentCache`, so show responses and every index response that doesn't go through a custom collection serializer copy cached JSON instead of encoding objects that haven't changed.
+ 
+ ### Conditional requests
+ 
+ Index and show responses carry a weak `ETag` made from the datastore's `-generationForResource:` (plus the parent resource's generation for nested index requests) or `-versionOfObjectOfResource:withPrimaryKey:` respectively.  A request whose `If-None-Match` header contains the current tag gets a `304 Not Modified` response without any objects being read or serialized.  Tags include a value that changes with every launch so they never match after a restart, and stores that don't track generations simply don't get tags.
+ 
+ ### Batch requests
+ 
+ `POST /_batch` takes a JSON array of operations and runs them in order through the datastore's `-performOperations:error:`, so either all of them are applied or none are.  Stores that can't roll back, like the columnar store, only take batches that read and answer any other batch with `501 Not Implemented`.  Each operation is an object with a `method` of `GET`, `POST`, `PUT` or `DELETE`, the `resource` name, the `id` of the object for everything but `POST` and a `body` for `POST` and `PUT`, for example `{"method": "POST", "resource": "people", "body": {"name": "John"}}`.  An `id` or foreign key value of `$n` stands for the primary key of the object returned by operation `n` of the same batch.
+ 
+ A batch that succeeds gets a JSON array back with `{"status": 200, "body": object}` for each operation, or `{"status": 204}` for deletes.  A batch that fails gets the status the failing operation would have had on its own and a body of `{"index": n, "status": status}`.
  */
 
 @interface TGRESTDefaultController : NSObject <TGRESTController>
 
+/**
+ *  Runs the operations of a batch request as a single datastore transaction.  The server calls this for `POST /_batch` requests.
+ *
+ *  @param request The request, its body is a JSON array of operations.
+ *  @param server  The server that received the request.
+ *
+ *  @return A response with the result of every operation or the error of the one that failed.
+ */
+
++ (GCDWebServerResponse *)batchWithRequest:(GCDWebServerRequest *)request
+                               usingServer:(TGRESTServer *)server;
+
 @end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ Query parameter for the maximum number of objects returned by an index request.  Must be a positive integer.
+ */
+
+extern NSString * const TGRESTPageLimitQueryKey;
+
+/**
+ Query parameter for the primary key that an index request should start after.
+ */
+
+extern NSString * const TGRESTPageAfterQueryKey;
+
+/**
+ Response header containing the `after` value for the next page when an index request has more objects.
+ */
+
+extern NSString * const TGRESTNextCursorHeader;
@@ -11,11 +11,46 @@
 #import "TGRESTStore.h"
 #import <GCDWebServer/GCDWebServer.h>
 #import <GCDWebServer/GCDWebServerDataResponse.h>
+#import <GCDWebServer/GCDWebServerStreamingResponse.h>
 #import <GCDWebServer/GCDWebServerDataRequest.h>
 #import <GCDWebServer/GCDWebServerURLEncodedFormRequest.h>
 #import "TGPrivateFunctions.h"
 #import "TGRESTEasyLogging.h"
 #import "TGRESTSerializer.h"
+#import "TGRESTDefaultSerializer.h"
+#import "TGRESTQuery.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTBodyDecoder.h"
+#import "TGRESTRoute.h"
+#import "TGRESTStoreOperation.h"
+
+NSString * const TGRESTPageLimitQueryKey = @"limit";
+NSString * const TGRESTPageAfterQueryKey = @"after";
+NSString * const TGRESTNextCursorHeader = @"X-Next-Cursor";
+NSString * const TGRESTBatchMethodKey = @"method";
+NSString * const TGRESTBatchResourceKey = @"resource";
+NSString * const TGRESTBatchPrimaryKeyKey = @"id";
+NSString * const TGRESTBatchBodyKey = @"body";
+
+static NSString * const TGRESTEntityTagHeader = @"ETag";
+static NSString * const TGRESTIfNoneMatchHeader = @"If-None-Match";
+static NSUInteger const TGRESTStreamedObjectsPerChunk = 64;
+
+static void TGRESTAddStoreTime(GCDWebServerRequest *request, uint64_t start)
+{
+    if ([request isKindOfClass:[TGRESTRouteRequest class]]) {
+        TGRESTRouteRequest *routeRequest = (TGRESTRouteRequest *)request;
+        routeRequest.storeTime = routeRequest.storeTime + (TGMonotonicTime() - start);
+    }
+}
+
+static void TGRESTAddSerializeTime(GCDWebServerRequest *request, uint64_t start)
+{
+    if ([request isKindOfClass:[TGRESTRouteRequest class]]) {
+        TGRESTRouteRequest *routeRequest = (TGRESTRouteRequest *)request;
+        routeRequest.serializeTime = routeRequest.serializeTime + (TGMonotonicTime() - start);
+    }
+}
 
 @implementation TGRESTDefaultController
 
@@ -30,26 +65,91 @@
     NSParameterAssert(server);
     
     @autoreleasepool {
-        if (request.URL.pathComponents.count > 2) {
-            NSString *parentName = request.URL.pathComponents[1];
-            NSString *parentID = request.URL.pathComponents[2];
-            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"self.name == %@", parentName];
-            TGRESTResource *parent = [[resource.parentResources filteredArrayUsingPredicate:predicate] firstObject];
+        NSString *afterKey = request.query[TGRESTPageAfterQueryKey];
+        NSString *limitString = request.query[TGRESTPageLimitQueryKey];
+        BOOL paginated = (afterKey || limitString);
+        NSUInteger limit = NSUIntegerMax;
+        
+        if (limitString) {
+            NSScanner *scanner = [NSScanner scannerWithString:limitString];
+            NSInteger scannedLimit;
+            if (![scanner scanInteger:&scannedLimit] || !scanner.isAtEnd || scannedLimit <= 0) {
+                return [GCDWebServerResponse responseWithStatusCode:400];
+            }
+            limit = (NSUInteger)scannedLimit;
+        }
+        
+        NSMutableDictionary *queryParameters = [NSMutableDictionary dictionaryWithDictionary:request.query];
+        [queryParameters removeObjectsForKeys:@[TGRESTPageLimitQueryKey, TGRESTPageAfterQueryKey]];
+        NSError *queryError;
+        TGRESTQuery *query = [TGRESTQuery queryWithParameters:queryParameters resource:resource error:&queryError];
+        if (!query) {
+            TGLogWarn(@"Invalid query for resource %@ %@", resource.name, queryError.localizedDescription);
+            return [GCDWebServerResponse responseWithStatusCode:400];
+        }
+        if (afterKey && !query.ordersByPrimaryKey) {
+            TGLogWarn(@"Request for resource %@ can only be paged with %@ when it is sorted by primary key", resource.name, TGRESTPageAfterQueryKey);
+            return [GCDWebServerResponse responseWithStatusCode:400];
+        }
+        
+        // One extra object is fetched to find out whether there is a next page without a second query.
+        NSUInteger fetchLimit = (limit == NSUIntegerMax) ? limit : limit + 1;
+        
+        TGRESTRoute *route = [(TGRESTRouteRequest *)request route];
+        if (route.parentResource) {
+            TGRESTResource *parent = route.parentResource;
+            NSString *parentID = route.parentPrimaryKey;
+            
+            // The parent generation is part of the tag so deleting a parent without children still changes the response.
+            NSUInteger generation = [server.datastore generationForResource:resource];
+            NSString *entityTag = [self entityTagWithGenerations:@[@(generation), @([server.datastore generationForResource:parent])]];
+            if ([self request:request matchesEntityTag:entityTag]) {
+                return [self notModifiedResponseWithEntityTag:entityTag];
+            }
+            
+            uint64_t storeStart = TGMonotonicTime();
             NSError *error;
-            NSArray *dataWithParent = [server.datastore getDataForObjectsOfResource:resource
-                                                              withParent:parent
-                                                        parentPrimaryKey:parentID
+            NSArray *dataWithParent;
+            if (!query.isEmpty) {
+                query = [query queryByAddingFilterForProperty:resource.foreignKeys[parent.name] queryOperator:TGRESTQueryOperatorEqual value:parentID error:&error];
+                if (!query) {
+                    return [GCDWebServerResponse responseWithStatusCode:404];
+                }
+                dataWithParent = [server.datastore getObjectsForResource:resource
+                                                           matchingQuery:query
+                                                         afterPrimaryKey:afterKey
+                                                                   limit:fetchLimit
                                                                    error:&error];
+            } else if (paginated) {
+                dataWithParent = [server.datastore getDataForObjectsOfResource:resource
+                                                                    withParent:parent
+                                                              parentPrimaryKey:parentID
+                                                               afterPrimaryKey:afterKey
+                                                                         limit:fetchLimit
+                                                                         error:&error];
+            } else {
+                dataWithParent = [server.datastore getDataForObjectsOfResource:resource
+                                                                    withParent:parent
+                                                              parentPrimaryKey:parentID
+                                                                         error:&error];
+            }
+            TGRESTAddStoreTime(request, storeStart);
             
             if (error) {
                 return [self errorResponseBuilderWithError:error];
             }
-            return [GCDWebServerDataResponse responseWithJSONObject:dataWithParent];
-        }
-        NSError *error;
-        NSArray *allData = [server.datastore getAllObjectsForResource:resource error:&error];
-        if (error) {
-            return [self errorResponseBuilderWithError:error];
+            NSString *nextCursor = [self nextCursorForPage:&dataWithParent limit:limit query:query];
+            uint64_t serializeStart = TGMonotonicTime();
+            NSData *body = [server.datastore.fragmentCache collectionDataWithObjects:dataWithParent resource:resource generation:generation];
+            TGRESTAddSerializeTime(request, serializeStart);
+            GCDWebServerResponse *response = [self JSONResponseWithData:body];
+            if (nextCursor) {
+                [response setValue:nextCursor forAdditionalHeader:TGRESTNextCursorHeader];
+            }
+            if (entityTag) {
+                [response setValue:entityTag forAdditionalHeader:TGRESTEntityTagHeader];
+            }
+            return response;
         }
         Class <TGRESTSerializer> serializer;
         if (server.serializers[resource.name]) {
@@ -58,7 +158,61 @@
             serializer = server.defaultSerializer;
         }
         
-        return [GCDWebServerDataResponse responseWithJSONObject:[serializer dataWithCollection:allData resource:resource]];
+        // The generation is read before any objects so a write that lands in between can only make the tag older than the body, never newer.
+        NSUInteger generation = [server.datastore generationForResource:resource];
+        NSString *entityTag = [self entityTagWithGenerations:@[@(generation)]];
+        if ([self request:request matchesEntityTag:entityTag]) {
+            return [self notModifiedResponseWithEntityTag:entityTag];
+        }
+        
+        // The default serializer passes the collection through untouched so the objects can be written out as they are read instead of being collected first.
+        if (!paginated && query.isEmpty && serializer == [TGRESTDefaultSerializer class]) {
+            // Objects are only serialized as the response is written, after the handler is done, so only the store time is counted.
+            uint64_t storeStart = TGMonotonicTime();
+            NSError *error;
+            NSEnumerator *objects = [server.datastore objectEnumeratorForResource:resource error:&error];
+            TGRESTAddStoreTime(request, storeStart);
+            if (error) {
+                return [self errorResponseBuilderWithError:error];
+            }
+            GCDWebServerResponse *response = [self streamedResponseWithObjects:objects resource:resource generation:generation fragmentCache:server.datastore.fragmentCache];
+            if (entityTag) {
+                [response setValue:entityTag forAdditionalHeader:TGRESTEntityTagHeader];
+            }
+            return response;
+        }
+        
+        uint64_t storeStart = TGMonotonicTime();
+        NSError *error;
+        NSArray *allData;
+        if (!query.isEmpty) {
+            allData = [server.datastore getObjectsForResource:resource matchingQuery:query afterPrimaryKey:afterKey limit:fetchLimit error:&error];
+        } else if (paginated) {
+            allData = [server.datastore getObjectsForResource:resource afterPrimaryKey:afterKey limit:fetchLimit error:&error];
+        } else {
+            allData = [server.datastore getAllObjectsForResource:resource error:&error];
+        }
+        TGRESTAddStoreTime(request, storeStart);
+        if (error) {
+            return [self errorResponseBuilderWithError:error];
+        }
+        
+        NSString *nextCursor = [self nextCursorForPage:&allData limit:limit query:query];
+        uint64_t serializeStart = TGMonotonicTime();
+        GCDWebServerResponse *response;
+        if (serializer == [TGRESTDefaultSerializer class]) {
+            response = [self JSONResponseWithData:[server.datastore.fragmentCache collectionDataWithObjects:allData resource:resource generation:generation]];
+        } else {
+            response = [GCDWebServerDataResponse responseWithJSONObject:[serializer dataWithCollection:allData resource:resource]];
+        }
+        TGRESTAddSerializeTime(request, serializeStart);
+        if (nextCursor) {
+            [response setValue:nextCursor forAdditionalHeader:TGRESTNextCursorHeader];
+        }
+        if (entityTag) {
+            [response setValue:entityTag forAdditionalHeader:TGRESTEntityTagHeader];
+        }
+        return response;
     }
 }
 
@@ -71,9 +225,17 @@
     NSParameterAssert(server);
     
     @autoreleasepool {
-        NSString *lastPathComponent = request.URL.lastPathComponent;
+        NSString *primaryKey = [(TGRESTRouteRequest *)request route].primaryKey;
+        NSUInteger version = [server.datastore versionOfObjectOfResource:resource withPrimaryKey:primaryKey];
+        NSString *entityTag = [self entityTagWithGenerations:@[@(version)]];
+        if ([self request:request matchesEntityTag:entityTag]) {
+            return [self notModifiedResponseWithEntityTag:entityTag];
+        }
+        
+        uint64_t storeStart = TGMonotonicTime();
         NSError *error;
-        NSDictionary *resourceResponse = [server.datastore getDataForObjectOfResource:resource withPrimaryKey:lastPathComponent error:&error];
+        NSDictionary *resourceResponse = [server.datastore getDataForObjectOfResource:resource withPrimaryKey:primaryKey error:&error];
+        TGRESTAddStoreTime(request, storeStart);
         if (error) {
             return [self errorResponseBuilderWithError:error];
         }
@@ -84,7 +246,14 @@
             serializer = server.defaultSerializer;
         }
         
-        return [GCDWebServerDataResponse responseWithJSONObject:[serializer dataWithSingularObject:resourceResponse resource:resource]];
+        uint64_t serializeStart = TGMonotonicTime();
+        NSData *body = [server.datastore.fragmentCache fragmentForObject:resourceResponse resource:resource serializer:serializer version:version];
+        TGRESTAddSerializeTime(request, serializeStart);
+        GCDWebServerResponse *response = [self JSONResponseWithData:body];
+        if (entityTag) {
+            [response setValue:entityTag forAdditionalHeader:TGRESTEntityTagHeader];
+        }
+        return response;
     }
 }
 
@@ -97,20 +266,6 @@
     NSParameterAssert(server);
     
     @autoreleasepool {
-        GCDWebServerDataRequest *dataRequest = (GCDWebServerDataRequest *)request;
-        NSDictionary *body;
-        if ([request.contentType hasPrefix:@"application/json"]) {
-            NSError *jsonError;
-            body = [NSJSONSerialization JSONObjectWithData:dataRequest.data options:kNilOptions error:&jsonError];
-            if (jsonError) {
-                return [GCDWebServerResponse responseWithStatusCode:400];
-            }
-        } else if ([request.contentType hasPrefix:@"application/x-www-form-urlencoded"]) {
-            NSString* charset = TGExtractHeaderValueParameter(request.contentType, @"charset");
-            NSString* formURLString = [[NSString alloc] initWithData:dataRequest.data encoding:TGStringEncodingFromCharset(charset)];
-            body = TGParseURLEncodedForm(formURLString);
-        }
-        
         Class <TGRESTSerializer> serializer;
         if (server.serializers[resource.name]) {
             serializer = server.serializers[resource.name];
@@ -118,23 +273,31 @@
             serializer = server.defaultSerializer;
         }
         
-        body = [serializer requestParametersWithBody:body resource:resource];
+        uint64_t decodeStart = TGMonotonicTime();
         NSError *error;
-        NSDictionary *sanitizedBody = [self sanitizedPropertiesForResource:resource withProperties:body];
+        NSDictionary *sanitizedBody = [self sanitizedBodyWithRequest:request resource:resource serializer:serializer server:server error:&error];
+        TGRESTAddSerializeTime(request, decodeStart);
+        if (!sanitizedBody) {
+            return [self errorResponseBuilderWithError:error];
+        }
         if (sanitizedBody.allKeys.count == 0) {
             return [GCDWebServerResponse responseWithStatusCode:400];
         }
         
+        uint64_t storeStart = TGMonotonicTime();
         NSDictionary *newObject = [server.datastore createNewObjectForResource:resource withProperties:sanitizedBody error:&error];
+        TGRESTAddStoreTime(request, storeStart);
         
-        body = nil;
-        dataRequest = nil;
         sanitizedBody = nil;
         
         if (error) {
             return [self errorResponseBuilderWithError:error];
         }
-        return [GCDWebServerDataResponse responseWithJSONObject:[serializer dataWithSingularObject:newObject resource:resource]];
+        uint64_t serializeStart = TGMonotonicTime();
+        // The version can't be read before a write, so the new object is encoded without being cached.
+        NSData *body = [server.datastore.fragmentCache fragmentForObject:newObject resource:resource serializer:serializer version:NSNotFound];
+        TGRESTAddSerializeTime(request, serializeStart);
+        return [self JSONResponseWithData:body];
     }
 }
 
@@ -147,25 +310,10 @@
     NSParameterAssert(server);
     
     @autoreleasepool {
-        NSString *lastPathComponent = request.URL.lastPathComponent;
-        if ([lastPathComponent isEqualToString:resource.name]) {
+        NSString *primaryKey = [(TGRESTRouteRequest *)request route].primaryKey;
+        if ([primaryKey isEqualToString:resource.name]) {
             return [GCDWebServerResponse responseWithStatusCode:403];
         }
-        GCDWebServerDataRequest *dataRequest = (GCDWebServerDataRequest *)request;
-        NSDictionary *body;
-        if ([dataRequest.contentType hasPrefix:@"application/json"]) {
-            NSError *jsonError;
-            body = [NSJSONSerialization JSONObjectWithData:dataRequest.data options:kNilOptions error:&jsonError];
-            if (jsonError) {
-                TGLogError(@"Failed to deserialize JSON payload %@", jsonError);
-                return [GCDWebServerResponse responseWithStatusCode:400];
-            }
-        } else if ([dataRequest.contentType hasPrefix:@"application/x-www-form-urlencoded"]) {
-            NSString *charset = TGExtractHeaderValueParameter(request.contentType, @"charset");
-            NSString *formURLString = [[NSString alloc] initWithData:dataRequest.data encoding:TGStringEncodingFromCharset(charset)];
-            body = TGParseURLEncodedForm(formURLString);
-        }
-        
         Class <TGRESTSerializer> serializer;
         if (server.serializers[resource.name]) {
             serializer = server.serializers[resource.name];
@@ -173,27 +321,33 @@
             serializer = server.defaultSerializer;
         }
         
-        body = [serializer requestParametersWithBody:body resource:resource];
-        
-        NSDictionary *sanitizedBody = [self sanitizedPropertiesForResource:resource withProperties:body];
+        uint64_t decodeStart = TGMonotonicTime();
+        NSError *error;
+        NSDictionary *sanitizedBody = [self sanitizedBodyWithRequest:request resource:resource serializer:serializer server:server error:&error];
+        TGRESTAddSerializeTime(request, decodeStart);
+        if (!sanitizedBody) {
+            return [self errorResponseBuilderWithError:error];
+        }
         if (sanitizedBody.allKeys.count == 0) {
-            TGLogWarn(@"Request contains no keys matching valid parameters for resource %@ %@", resource.name, body);
+            TGLogWarn(@"Request contains no keys matching valid parameters for resource %@", resource.name);
             return [GCDWebServerResponse responseWithStatusCode:400];
         }
         
-        NSError *error;
-        NSDictionary *resourceResponse = [server.datastore modifyObjectOfResource:resource withPrimaryKey:lastPathComponent withProperties:sanitizedBody error:&error];
+        uint64_t storeStart = TGMonotonicTime();
+        NSDictionary *resourceResponse = [server.datastore modifyObjectOfResource:resource withPrimaryKey:primaryKey withProperties:sanitizedBody error:&error];
+        TGRESTAddStoreTime(request, storeStart);
         
-        body = nil;
-        dataRequest = nil;
         sanitizedBody = nil;
         
         if (error) {
-            TGLogError(@"Error modifying object of resource %@ with primary key %@", resource.name, lastPathComponent);
+            TGLogError(@"Error modifying object of resource %@ with primary key %@", resource.name, primaryKey);
             return [self errorResponseBuilderWithError:error];
         } 
         
-        return [GCDWebServerDataResponse responseWithJSONObject:[serializer dataWithSingularObject:resourceResponse resource:resource]];
+        uint64_t serializeStart = TGMonotonicTime();
+        NSData *body = [server.datastore.fragmentCache fragmentForObject:resourceResponse resource:resource serializer:serializer version:NSNotFound];
+        TGRESTAddSerializeTime(request, serializeStart);
+        return [self JSONResponseWithData:body];
     }
 }
 
@@ -206,12 +360,14 @@
     NSParameterAssert(server);
     
     @autoreleasepool {
-        NSString *lastPathComponent = request.URL.lastPathComponent;
-        if ([lastPathComponent isEqualToString:resource.name]) {
+        NSString *primaryKey = [(TGRESTRouteRequest *)request route].primaryKey;
+        if ([primaryKey isEqualToString:resource.name]) {
             return [GCDWebServerResponse responseWithStatusCode:403];
         }
+        uint64_t storeStart = TGMonotonicTime();
         NSError *error;
-        BOOL success = [server.datastore deleteObjectOfResource:resource withPrimaryKey:lastPathComponent error:&error];
+        BOOL success = [server.datastore deleteObjectOfResource:resource withPrimaryKey:primaryKey error:&error];
+        TGRESTAddStoreTime(request, storeStart);
         
         if (!success) {
             return [self errorResponseBuilderWithError:error];
@@ -221,6 +377,77 @@
     }
 }
 
++ (GCDWebServerResponse *)batchWithRequest:(GCDWebServerRequest *)request
+                               usingServer:(TGRESTServer *)server
+{
+    NSParameterAssert(request);
+    NSParameterAssert(server);
+    
+    @autoreleasepool {
+        NSArray *entries;
+        if ([request.contentType hasPrefix:@"application/json"]) {
+            entries = [NSJSONSerialization JSONObjectWithData:[(GCDWebServerDataRequest *)request data] options:kNilOptions error:nil];
+        }
+        if (![entries isKindOfClass:[NSArray class]] || entries.count == 0) {
+            TGLogWarn(@"Batch request body must be a JSON array of operations");
+            return [GCDWebServerResponse responseWithStatusCode:400];
+        }
+        
+        NSMutableDictionary *resources = [NSMutableDictionary new];
+        for (TGRESTResource *resource in [server currentResources]) {
+            [resources setObject:resource forKey:resource.name];
+        }
+        
+        uint64_t decodeStart = TGMonotonicTime();
+        NSMutableArray *operations = [NSMutableArray arrayWithCapacity:entries.count];
+        for (NSUInteger index = 0; index < entries.count; index++) {
+            TGRESTStoreOperation *operation = [self operationWithBatchEntry:entries[index] resources:resources server:server];
+            if (!operation) {
+                TGLogWarn(@"Batch operation %lu is not valid", (unsigned long)index);
+                return [self batchErrorResponseWithStatusCode:400 index:index];
+            }
+            [operations addObject:operation];
+        }
+        TGRESTAddSerializeTime(request, decodeStart);
+        
+        uint64_t storeStart = TGMonotonicTime();
+        NSError *error;
+        NSArray *results = [server.datastore performOperations:operations error:&error];
+        TGRESTAddStoreTime(request, storeStart);
+        if (!results) {
+            NSUInteger index = [error.userInfo[TGRESTStoreFailedOperationIndexErrorKey] unsignedIntegerValue];
+            TGLogError(@"Batch rolled back at operation %lu %@", (unsigned long)index, error);
+            return [self batchErrorResponseWithStatusCode:[self errorResponseBuilderWithError:error].statusCode index:index];
+        }
+        
+        // Each object goes out as its cached fragment, the same bytes a show request for it would send.
+        uint64_t serializeStart = TGMonotonicTime();
+        NSMutableData *body = [NSMutableData dataWithData:[@"[" dataUsingEncoding:NSUTF8StringEncoding]];
+        for (NSUInteger index = 0; index < results.count; index++) {
+            if (index > 0) {
+                [body appendBytes:"," length:1];
+            }
+            if (results[index] == [NSNull null]) {
+                [body appendData:[@"{\"status\":204}" dataUsingEncoding:NSUTF8StringEncoding]];
+                continue;
+            }
+            TGRESTResource *resource = [(TGRESTStoreOperation *)operations[index] resource];
+            Class <TGRESTSerializer> serializer = server.serializers[resource.name] ?: server.defaultSerializer;
+            NSData *fragment = [server.datastore.fragmentCache fragmentForObject:results[index] resource:resource serializer:serializer version:NSNotFound];
+            if (!fragment) {
+                return [GCDWebServerResponse responseWithStatusCode:500];
+            }
+            [body appendData:[@"{\"status\":200,\"body\":" dataUsingEncoding:NSUTF8StringEncoding]];
+            [body appendData:fragment];
+            [body appendBytes:"}" length:1];
+        }
+        [body appendBytes:"]" length:1];
+        TGRESTAddSerializeTime(request, serializeStart);
+        
+        return [self JSONResponseWithData:body];
+    }
+}
+
 
 #pragma mark - Private
 
@@ -234,11 +461,223 @@
         return [GCDWebServerResponse responseWithStatusCode:404];
     } else if (error.code == TGRESTStoreBadRequestErrorCode) {
         return [GCDWebServerResponse responseWithStatusCode:400];
+    } else if (error.code == TGRESTStoreUnsupportedOperationErrorCode) {
+        return [GCDWebServerResponse responseWithStatusCode:501];
     } else {
         return [GCDWebServerResponse responseWithStatusCode:500];
     }
 }
 
++ (GCDWebServerResponse *)batchErrorResponseWithStatusCode:(NSInteger)statusCode index:(NSUInteger)index
+{
+    NSData *body = [NSJSONSerialization dataWithJSONObject:@{@"index": @(index), @"status": @(statusCode)} options:kNilOptions error:nil];
+    GCDWebServerResponse *response = [self JSONResponseWithData:body];
+    response.statusCode = statusCode;
+    
+    return response;
+}
+
++ (TGRESTStoreOperation *)operationWithBatchEntry:(NSDictionary *)entry resources:(NSDictionary *)resources server:(TGRESTServer *)server
+{
+    if (![entry isKindOfClass:[NSDictionary class]] || ![entry[TGRESTBatchMethodKey] isKindOfClass:[NSString class]]) {
+        return nil;
+    }
+    
+    TGRESTResource *resource = [entry[TGRESTBatchResourceKey] isKindOfClass:[NSString class]] ? resources[entry[TGRESTBatchResourceKey]] : nil;
+    id primaryKey = entry[TGRESTBatchPrimaryKeyKey];
+    if (!resource || (primaryKey && ![primaryKey isKindOfClass:[NSString class]] && ![primaryKey isKindOfClass:[NSNumber class]])) {
+        return nil;
+    }
+    primaryKey = [primaryKey description];
+    
+    NSDictionary *properties;
+    if ([entry[TGRESTBatchBodyKey] isKindOfClass:[NSDictionary class]]) {
+        Class <TGRESTSerializer> serializer = server.serializers[resource.name] ?: server.defaultSerializer;
+        properties = [self sanitizedPropertiesForResource:resource withProperties:[serializer requestParametersWithBody:entry[TGRESTBatchBodyKey] resource:resource]];
+    }
+    
+    NSString *method = [entry[TGRESTBatchMethodKey] uppercaseString];
+    if ([method isEqualToString:@"GET"] && primaryKey) {
+        return [TGRESTStoreOperation readOperationWithResource:resource primaryKey:primaryKey];
+    } else if ([method isEqualToString:@"POST"] && !primaryKey && properties.count > 0) {
+        return [TGRESTStoreOperation createOperationWithResource:resource properties:properties];
+    } else if ([method isEqualToString:@"PUT"] && primaryKey && properties.count > 0) {
+        return [TGRESTStoreOperation modifyOperationWithResource:resource primaryKey:primaryKey properties:properties];
+    } else if ([method isEqualToString:@"DELETE"] && primaryKey) {
+        return [TGRESTStoreOperation deleteOperationWithResource:resource primaryKey:primaryKey];
+    }
+    
+    return nil;
+}
+
++ (GCDWebServerResponse *)JSONResponseWithData:(NSData *)data
+{
+    if (!data) {
+        return [GCDWebServerResponse responseWithStatusCode:500];
+    }
+    
+    return [GCDWebServerDataResponse responseWithData:data contentType:@"application/json"];
+}
+
++ (GCDWebServerResponse *)streamedResponseWithObjects:(NSEnumerator *)objects resource:(TGRESTResource *)resource generation:(NSUInteger)generation fragmentCache:(TGRESTFragmentCache *)fragmentCache
+{
+    __block NSEnumerator *enumerator = objects;
+    __block BOOL openedArray = NO;
+    __block BOOL wroteObject = NO;
+    
+    return [GCDWebServerStreamingResponse responseWithContentType:@"application/json" streamBlock:^NSData *(NSError * __autoreleasing *error) {
+        if (!enumerator) {
+            return [NSData data];
+        }
+        
+        NSMutableData *chunk = [NSMutableData new];
+        if (!openedArray) {
+            [chunk appendBytes:"[" length:1];
+            openedArray = YES;
+        }
+        
+        NSError *jsonError;
+        @autoreleasepool {
+            for (NSUInteger count = 0; count < TGRESTStreamedObjectsPerChunk; count++) {
+                NSDictionary *object = [enumerator nextObject];
+                if (!object) {
+                    [chunk appendBytes:"]" length:1];
+                    enumerator = nil;
+                    break;
+                }
+                NSData *objectData = [fragmentCache fragmentForObject:object resource:resource serializer:[TGRESTDefaultSerializer class] version:generation];
+                if (!objectData) {
+                    jsonError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:@{NSLocalizedDescriptionKey: @"Object can't be encoded as JSON"}];
+                    break;
+                }
+                if (wroteObject) {
+                    [chunk appendBytes:"," length:1];
+                }
+                [chunk appendData:objectData];
+                wroteObject = YES;
+            }
+        }
+        
+        if (jsonError) {
+            TGLogError(@"Failed to serialize streamed object %@", jsonError);
+            enumerator = nil;
+            if (error) {
+                *error = jsonError;
+            }
+            return nil;
+        }
+        
+        return chunk;
+    }];
+}
+
++ (NSString *)entityTagWithGenerations:(NSArray *)generations
+{
+    static NSString *processTag;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // Generations start over with every launch so tags handed out by an earlier process must never match.
+        processTag = [[[[NSUUID UUID] UUIDString] substringToIndex:8] lowercaseString];
+    });
+    
+    NSMutableString *entityTag = [NSMutableString stringWithFormat:@"W/\"%@", processTag];
+    for (NSNumber *generation in generations) {
+        if ([generation unsignedIntegerValue] == NSNotFound) {
+            return nil;
+        }
+        [entityTag appendFormat:@"-%lu", (unsigned long)[generation unsignedIntegerValue]];
+    }
+    [entityTag appendString:@"\""];
+    
+    return entityTag;
+}
+
++ (BOOL)request:(GCDWebServerRequest *)request matchesEntityTag:(NSString *)entityTag
+{
+    NSString *ifNoneMatch = request.headers[TGRESTIfNoneMatchHeader];
+    if (!entityTag || !ifNoneMatch) {
+        return NO;
+    }
+    
+    // If-None-Match uses the weak comparison so the W/ prefix is ignored on both sides.
+    NSString *opaqueTag = [entityTag substringFromIndex:2];
+    for (NSString *candidate in [ifNoneMatch componentsSeparatedByString:@","]) {
+        NSString *trimmedCandidate = [candidate stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if ([trimmedCandidate hasPrefix:@"W/"]) {
+            trimmedCandidate = [trimmedCandidate substringFromIndex:2];
+        }
+        if ([trimmedCandidate isEqualToString:opaqueTag]) {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
++ (GCDWebServerResponse *)notModifiedResponseWithEntityTag:(NSString *)entityTag
+{
+    GCDWebServerResponse *response = [GCDWebServerResponse responseWithStatusCode:304];
+    [response setValue:entityTag forAdditionalHeader:TGRESTEntityTagHeader];
+    
+    return response;
+}
+
++ (NSString *)nextCursorForPage:(NSArray * __autoreleasing *)page limit:(NSUInteger)limit query:(TGRESTQuery *)query
+{
+    if ((*page).count <= limit) {
+        return nil;
+    }
+    
+    *page = [*page subarrayWithRange:NSMakeRange(0, limit)];
+    
+    // Any other sort order can be limited but there is no primary key to carry on from.
+    if (!query.ordersByPrimaryKey) {
+        return nil;
+    }
+    
+    return [[[*page lastObject] objectForKey:query.resource.primaryKey] description];
+}
+
++ (NSDictionary *)sanitizedBodyWithRequest:(GCDWebServerRequest *)request
+                                  resource:(TGRESTResource *)resource
+                                serializer:(Class <TGRESTSerializer>)serializer
+                                    server:(TGRESTServer *)server
+                                     error:(NSError * __autoreleasing *)error
+{
+    GCDWebServerDataRequest *dataRequest = (GCDWebServerDataRequest *)request;
+    
+    // The default serializer passes the parameters through untouched so the body can be decoded straight into model properties.
+    TGRESTBodyDecoder *decoder = [server bodyDecoderForResource:resource];
+    if (decoder && serializer == [TGRESTDefaultSerializer class]) {
+        NSDictionary *properties = [decoder propertiesWithData:dataRequest.data contentType:request.contentType error:error];
+        if (!properties) {
+            TGLogError(@"Failed to decode request body for resource %@ %@", resource.name, error ? *error : nil);
+        }
+        return properties;
+    }
+    
+    NSDictionary *body;
+    if ([request.contentType hasPrefix:@"application/json"]) {
+        NSError *jsonError;
+        body = [NSJSONSerialization JSONObjectWithData:dataRequest.data options:kNilOptions error:&jsonError];
+        if (jsonError || ![body isKindOfClass:[NSDictionary class]]) {
+            TGLogError(@"Failed to deserialize JSON payload %@", jsonError);
+            if (error) {
+                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:nil];
+            }
+            return nil;
+        }
+    } else if ([request.contentType hasPrefix:@"application/x-www-form-urlencoded"]) {
+        NSString *charset = TGExtractHeaderValueParameter(request.contentType, @"charset");
+        NSString *formURLString = [[NSString alloc] initWithData:dataRequest.data encoding:TGStringEncodingFromCharset(charset)];
+        body = TGParseURLEncodedForm(formURLString);
+    }
+    
+    body = [serializer requestParametersWithBody:body resource:resource];
+    
+    return [self sanitizedPropertiesForResource:resource withProperties:body];
+}
+
 + (NSDictionary *)sanitizedPropertiesForResource:(TGRESTResource *)resource withProperties:(NSDictionary *)properties
 {
     NSParameterAssert(resource);
@@ -0,0 +1,107 @@
+//
+//  TGRESTFragmentCache.h
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "TGRESTSerializer.h"
+
+@class TGRESTResource;
+@class TGRESTJSONEncoder;
+@class TGRESTStore;
+
+/**
+ `TGRESTFragmentCache` keeps the encoded JSON of individual objects so that index and show responses don't have to run every object through `NSJSONSerialization` on every request.  Fragments are keyed by resource, primary key and serializer class, and a collection response is built by copying the cached fragments into a single buffer.
+ 
+ Every datastore owns a fragment cache and is expected to invalidate the objects it modifies or deletes.  Fragments don't keep the object they were encoded from.  Instead each one is tagged with the version (or the resource generation) that was read before the object was read, and it is only served to a reader whose version it is not older than (or whose store says the object hasn't been written since the tag), so a reader that stores a fragment of an object that was written just after it was read can't hand it to anyone who reads the new version.  This relies on the store drawing versions and generations from `TGRESTStoreNextGeneration()` after the write is visible, and objects of stores that don't track versions are encoded every time.  Serializers are assumed to return the same output for the same object.
+ 
+ Objects formatted by `TGRESTDefaultSerializer` are encoded with the `TGRESTJSONEncoder` registered for their resource if there is one, which `TGRESTServer` does for every resource it adds.  Everything else goes through `NSJSONSerialization`.
+ 
+ The cache is backed by `NSCache` so it is safe to use from any thread and gives its memory back under pressure.
+ */
+
+@interface TGRESTFragmentCache : NSObject
+
+/**
+ The maximum number of encoded bytes to keep before older fragments are evicted.  Defaults to 16MB.
+ */
+
+@property (nonatomic, assign) NSUInteger byteLimit;
+
+/**
+ *  Creates a fragment cache for a datastore.
+ *
+ *  @param store The datastore whose object versions are checked when a fragment is older than the reader.  It is not retained.
+ *
+ *  @return A new fragment cache.
+ */
+
+- (instancetype)initWithStore:(TGRESTStore *)store;
+
+/**
+ The datastore the cache belongs to.
+ */
+
+@property (nonatomic, weak, readonly) TGRESTStore *store;
+
+/**
+ *  Returns the JSON for a single object as formatted by the serializer, encoding and caching it if there is no valid fragment.
+ *
+ *  @param object     Object dictionary as it was read from the datastore.
+ *  @param resource   Resource of the object.
+ *  @param serializer Serializer class whose `+dataWithSingularObject:resource:` output should be encoded.
+ *  @param version    Version of the object as returned by `-versionOfObjectOfResource:withPrimaryKey:`, or generation of the resource as returned by `-generationForResource:`, from before the object was read.  Pass `NSNotFound` to encode the object without caching it, which is what responses to writes should do.
+ *
+ *  @return The encoded object or nil if it can't be encoded as JSON.
+ */
+
+- (NSData *)fragmentForObject:(NSDictionary *)object
+                     resource:(TGRESTResource *)resource
+                   serializer:(Class <TGRESTSerializer>)serializer
+                      version:(NSUInteger)version;
+
+/**
+ *  Returns a JSON array of the objects built by concatenating their cached fragments.  Objects are encoded as they are without going through a serializer, which is what `TGRESTDefaultSerializer` does for collections.
+ *
+ *  @param objects    Array of object dictionaries as they were read from the datastore.
+ *  @param resource   Resource of the objects.
+ *  @param generation Generation of the resource as returned by `-generationForResource:` before the objects were read, or `NSNotFound` to encode the objects without caching them.
+ *
+ *  @return The encoded array or nil if any object can't be encoded as JSON.
+ */
+
+- (NSData *)collectionDataWithObjects:(NSArray *)objects
+                             resource:(TGRESTResource *)resource
+                           generation:(NSUInteger)generation;
+
+/**
+ *  Registers the encoder used for objects of a resource that are formatted by `TGRESTDefaultSerializer` and invalidates the fragments of the resource.
+ *
+ *  @param encoder  Encoder compiled for the resource or nil to go back to `NSJSONSerialization`.
+ *  @param resource The resource the encoder is for.
+ */
+
+- (void)setEncoder:(TGRESTJSONEncoder *)encoder forResource:(TGRESTResource *)resource;
+
+/**
+ *  Removes every fragment of an object.  Datastores call this when an object is modified or deleted.
+ *
+ *  @param resource   Resource of the object.
+ *  @param primaryKey Primary key of the object.
+ */
+
+- (void)invalidateObjectOfResource:(TGRESTResource *)resource
+                    withPrimaryKey:(id)primaryKey;
+
+/**
+ *  Removes every fragment of a resource.  Datastores call this when a resource is added, dropped or has objects changed in bulk.
+ *
+ *  @param resource The resource to invalidate.
+ */
+
+- (void)invalidateResource:(TGRESTResource *)resource;
+
+@end
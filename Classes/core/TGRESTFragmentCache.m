@@ -0,0 +1,232 @@
+//
+//  TGRESTFragmentCache.m
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import "TGRESTFragmentCache.h"
+#import "TGRESTResource.h"
+#import "TGRESTStore.h"
+#import "TGRESTDefaultSerializer.h"
+#import "TGRESTJSONEncoder.h"
+#import "TGRESTEasyLogging.h"
+
+static NSUInteger const TGRESTFragmentCacheDefaultByteLimit = 16 * 1024 * 1024;
+
+@interface TGRESTFragment : NSObject
+
+// Raised by readers of a newer generation once they've checked the object wasn't written, so it is read and written from any thread.
+@property (atomic, assign) NSUInteger version;
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+@implementation TGRESTFragment
+
+@end
+
+@interface TGRESTFragmentCache ()
+
+@property (nonatomic, weak, readwrite) TGRESTStore *store;
+@property (nonatomic, strong) NSCache *cache;
+@property (nonatomic, strong) NSMutableDictionary *resourceEpochs;
+@property (nonatomic, strong) NSMutableDictionary *serializerNames;
+@property (nonatomic, strong) NSMutableDictionary *encoders;
+
+@end
+
+@implementation TGRESTFragmentCache
+
+- (instancetype)init
+{
+    return [self initWithStore:nil];
+}
+
+- (instancetype)initWithStore:(TGRESTStore *)store
+{
+    self = [super init];
+    if (self) {
+        self.store = store;
+        self.cache = [NSCache new];
+        self.cache.name = @"com.tinylittlegears.resteasy.fragments";
+        self.resourceEpochs = [NSMutableDictionary new];
+        self.serializerNames = [NSMutableDictionary new];
+        self.encoders = [NSMutableDictionary new];
+        self.byteLimit = TGRESTFragmentCacheDefaultByteLimit;
+    }
+    
+    return self;
+}
+
+- (void)setByteLimit:(NSUInteger)byteLimit
+{
+    _byteLimit = byteLimit;
+    self.cache.totalCostLimit = byteLimit;
+}
+
+- (NSData *)fragmentForObject:(NSDictionary *)object
+                     resource:(TGRESTResource *)resource
+                   serializer:(Class <TGRESTSerializer>)serializer
+                      version:(NSUInteger)version
+{
+    NSParameterAssert(object);
+    NSParameterAssert(resource);
+    NSParameterAssert(serializer);
+    
+    TGRESTJSONEncoder *encoder = (serializer == [TGRESTDefaultSerializer class]) ? [self encoderForResource:resource] : nil;
+    
+    return [self fragmentForObject:object resource:resource serializer:serializer keyPrefix:[self keyPrefixForResource:resource serializer:serializer] encoder:encoder version:version];
+}
+
+- (NSData *)collectionDataWithObjects:(NSArray *)objects
+                             resource:(TGRESTResource *)resource
+                           generation:(NSUInteger)generation
+{
+    NSParameterAssert(objects);
+    NSParameterAssert(resource);
+    
+    Class serializer = [TGRESTDefaultSerializer class];
+    NSString *keyPrefix = [self keyPrefixForResource:resource serializer:serializer];
+    TGRESTJSONEncoder *encoder = [self encoderForResource:resource];
+    NSMutableData *collectionData = [NSMutableData dataWithBytes:"[" length:1];
+    BOOL wroteObject = NO;
+    
+    for (NSDictionary *object in objects) {
+        NSData *fragment = [self fragmentForObject:object resource:resource serializer:serializer keyPrefix:keyPrefix encoder:encoder version:generation];
+        if (!fragment) {
+            return nil;
+        }
+        if (wroteObject) {
+            [collectionData appendBytes:"," length:1];
+        }
+        [collectionData appendData:fragment];
+        wroteObject = YES;
+    }
+    [collectionData appendBytes:"]" length:1];
+    
+    return collectionData;
+}
+
+- (void)setEncoder:(TGRESTJSONEncoder *)encoder forResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    @synchronized(self) {
+        if (encoder) {
+            [self.encoders setObject:encoder forKey:resource.name];
+        } else {
+            [self.encoders removeObjectForKey:resource.name];
+        }
+    }
+    
+    // Fragments written by the previous encoder may not match the new one byte for byte.
+    [self invalidateResource:resource];
+}
+
+- (void)invalidateObjectOfResource:(TGRESTResource *)resource
+                    withPrimaryKey:(id)primaryKey
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(primaryKey);
+    
+    NSArray *keyPrefixes;
+    @synchronized(self) {
+        NSUInteger epoch = [self.resourceEpochs[resource.name] unsignedIntegerValue];
+        NSMutableArray *prefixes = [NSMutableArray new];
+        for (NSString *serializerName in self.serializerNames[resource.name]) {
+            [prefixes addObject:[NSString stringWithFormat:@"%@/%lu/%@/", resource.name, (unsigned long)epoch, serializerName]];
+        }
+        keyPrefixes = prefixes;
+    }
+    
+    NSString *objectKey = [primaryKey description];
+    for (NSString *keyPrefix in keyPrefixes) {
+        [self.cache removeObjectForKey:[keyPrefix stringByAppendingString:objectKey]];
+    }
+}
+
+- (void)invalidateResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    // NSCache can't be enumerated so the fragments are orphaned by moving the resource to a new key space and left for the cache to evict.
+    @synchronized(self) {
+        NSUInteger epoch = [self.resourceEpochs[resource.name] unsignedIntegerValue];
+        [self.resourceEpochs setObject:[NSNumber numberWithUnsignedInteger:epoch + 1] forKey:resource.name];
+        [self.serializerNames removeObjectForKey:resource.name];
+    }
+}
+
+#pragma mark - Private
+
+- (TGRESTJSONEncoder *)encoderForResource:(TGRESTResource *)resource
+{
+    @synchronized(self) {
+        return self.encoders[resource.name];
+    }
+}
+
+- (NSString *)keyPrefixForResource:(TGRESTResource *)resource serializer:(Class)serializer
+{
+    NSString *serializerName = NSStringFromClass(serializer);
+    @synchronized(self) {
+        NSMutableSet *serializerNames = self.serializerNames[resource.name];
+        if (!serializerNames) {
+            serializerNames = [NSMutableSet new];
+            [self.serializerNames setObject:serializerNames forKey:resource.name];
+        }
+        [serializerNames addObject:serializerName];
+        
+        return [NSString stringWithFormat:@"%@/%lu/%@/", resource.name, (unsigned long)[self.resourceEpochs[resource.name] unsignedIntegerValue], serializerName];
+    }
+}
+
+- (NSData *)fragmentForObject:(NSDictionary *)object resource:(TGRESTResource *)resource serializer:(Class <TGRESTSerializer>)serializer keyPrefix:(NSString *)keyPrefix encoder:(TGRESTJSONEncoder *)encoder version:(NSUInteger)version
+{
+    id primaryKey = [object isKindOfClass:[NSDictionary class]] ? object[resource.primaryKey] : nil;
+    NSString *key = (primaryKey && version != NSNotFound) ? [keyPrefix stringByAppendingString:[primaryKey description]] : nil;
+    
+    if (key) {
+        // The fragment was encoded from an object read after its version was, so it holds every write up to that version.
+        TGRESTFragment *fragment = [self.cache objectForKey:key];
+        if (fragment && fragment.version >= version) {
+            return fragment.data;
+        }
+        TGRESTStore *store = self.store;
+        if (fragment && store) {
+            // An older fragment is still good if the object itself wasn't written since, which is the common case for an index after a write to another object.
+            NSUInteger currentVersion = [store versionOfObjectOfResource:resource withPrimaryKey:[primaryKey description]];
+            if (currentVersion != NSNotFound && currentVersion <= fragment.version) {
+                fragment.version = version;
+                return fragment.data;
+            }
+        }
+    }
+    
+    NSData *data;
+    if (encoder && [object isKindOfClass:[NSDictionary class]]) {
+        data = [encoder dataWithObject:object];
+    } else {
+        id representation = (serializer == [TGRESTDefaultSerializer class]) ? object : [serializer dataWithSingularObject:object resource:resource];
+        if ([NSJSONSerialization isValidJSONObject:representation]) {
+            data = [NSJSONSerialization dataWithJSONObject:representation options:kNilOptions error:nil];
+        }
+    }
+    if (!data) {
+        TGLogError(@"Object of resource %@ can't be encoded as JSON %@", resource.name, object);
+        return nil;
+    }
+    
+    if (key && data) {
+        TGRESTFragment *fragment = [TGRESTFragment new];
+        fragment.version = version;
+        fragment.data = data;
+        [self.cache setObject:fragment forKey:key cost:data.length];
+    }
+    
+    return data;
+}
+
+@end
@@ -10,8 +10,45 @@
 
 /**
  Concrete subclass of TGRESTStore, this is the default store type.  As the name suggests it doesn't do real "persistence", instead it simply stores everything in memory using a key/value store (aka an NSMutableDictionary).  Since there is no disk backing for this store type it will purge itself every time the server restarts (which can be an advantage depending on your use case) and if you need seed data you will need to manually load it each time using the `-addData:` method on TGRESTServer.
+ 
+ ### Concurrency
+ 
+ Each resource lives in its own partition guarded by a concurrent dispatch queue.  Reads for a resource run in parallel with each other and writes use barriers, so a write only blocks access to the resource it touches and never waits on writes to unrelated resources.  Deleting a parent object updates its children's partitions one at a time afterwards so no two partitions are ever locked together.
+ 
+ ### Indexes
+ 
+ Foreign keys and the resource's `indexedProperties` are kept in hash indexes which answer equality filters, and integer and floating point indexed properties also keep a sorted list of their values for range filters.  Re-adding a resource whose model is unchanged but whose indexed properties differ keeps its objects and just rebuilds the indexes.
+ 
+ ### Persistence
+ 
+ Passing a directory for `TGRESTInMemoryStorePersistencePathOptionKey` keeps a copy of the store on disk so it survives a restart.  Every write is appended to an operation log in the background and the log is periodically folded into a compact binary snapshot (see `TGRESTInMemoryStoreCompactionIntervalOptionKey`).  On the next start the snapshot is memory mapped and the tail of the log replayed on top of it, then each resource picks up its objects when it is added again with the same model.  A resource added with a different model starts out empty, just as it would on a running server.  A write that was cut off halfway by a crash is ignored.  The log is flushed to the operating system on every write but not synced to the disk, so it survives the process going away but not the machine losing power.
  */
 
 @interface TGRESTInMemoryStore : TGRESTStore
 
+/**
+ Folds the operation log into a new snapshot right away instead of waiting for the next periodic compaction.
+ 
+ @param error If the snapshot could not be written, upon return contains an error object that describes the problem.
+ @return YES if the snapshot was written, NO if it failed or persistence is not turned on.
+ */
+
+- (BOOL)compactPersistentDataWithError:(NSError * __autoreleasing *)error;
+
 @end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ Option key for the -startServerWithOptions: dictionary which turns on persistence for the in-memory store.  Value is the path of a directory to keep the snapshot and operation log in, it is created if it doesn't exist.  Default is no persistence.
+ */
+
+extern NSString * const TGRESTInMemoryStorePersistencePathOptionKey;
+
+/**
+ Option key for the -startServerWithOptions: dictionary which sets how often in seconds the operation log is folded into a new snapshot.  Value is a boxed NSTimeInterval, 0 turns periodic compaction off.  Default is 30 seconds.
+ */
+
+extern NSString * const TGRESTInMemoryStoreCompactionIntervalOptionKey;
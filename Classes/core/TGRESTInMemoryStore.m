@@ -8,12 +8,395 @@
 
 #import "TGRESTInMemoryStore.h"
 #import "TGRESTResource.h"
+#import "TGRESTQuery.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTStoreJournal.h"
+#import "TGRESTStoreOperation.h"
 #import "TGRESTEasyLogging.h"
 
+NSString * const TGRESTInMemoryStorePersistencePathOptionKey = @"TGRESTInMemoryStorePersistencePathOptionKey";
+NSString * const TGRESTInMemoryStoreCompactionIntervalOptionKey = @"TGRESTInMemoryStoreCompactionIntervalOptionKey";
+
+static NSTimeInterval const TGInMemoryDefaultCompactionInterval = 30;
+
+static id TGInMemoryNormalizedKey(TGPropertyType type, id key)
+{
+    if (!key || key == [NSNull null]) {
+        return nil;
+    }
+    
+    if (type == TGPropertyTypeInteger) {
+        return [key respondsToSelector:@selector(integerValue)] ? [NSNumber numberWithInteger:[key integerValue]] : nil;
+    } else if (type == TGPropertyTypeFloatingPoint) {
+        return [key respondsToSelector:@selector(doubleValue)] ? [NSNumber numberWithDouble:[key doubleValue]] : nil;
+    } else {
+        return [key description];
+    }
+}
+
+/**
+ A partition holds all of the objects for a single resource along with the reader/writer queue that guards them.  Reads are dispatched synchronously onto the concurrent queue and can run in parallel while writes use barriers, so writes to one resource never queue up behind writes to another.
+ 
+ Every foreign key and indexed property of the resource is hash indexed from the normalized value to a sorted array of primary keys so nested lookups, parent deletes and equality queries only touch the matching objects.  Integer and floating point indexed properties also keep their distinct values in sorted order for range queries.  The indexes are only safe to touch from inside the partition queue.
+ 
+ Live primary keys are kept in sorted order alongside a live object count.  Every write stamps the partition with a new generation from `TGRESTStoreNextGeneration()`, records it as the version of the object it touched (deletes included), and the immutable snapshot handed out for index requests is only rebuilt the first time it is read after a write.
+ */
+
+@interface TGRESTInMemoryPartition : NSObject
+
+@property (nonatomic, strong) NSMutableDictionary *objects;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, assign) NSUInteger lastPrimaryKey;
+@property (nonatomic, strong) TGRESTResource *resource;
+@property (nonatomic, weak) TGRESTFragmentCache *fragmentCache;
+@property (nonatomic, weak) TGRESTStoreJournal *journal;
+@property (nonatomic, copy) NSDictionary *indexTypes;
+@property (nonatomic, strong) NSMutableDictionary *indexes;
+@property (nonatomic, strong) NSMutableDictionary *orderedIndexValues;
+@property (nonatomic, strong) NSMutableArray *orderedKeys;
+@property (nonatomic, assign) NSUInteger liveCount;
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, strong) NSMutableDictionary *versions;
+@property (nonatomic, strong) NSArray *snapshot;
+@property (nonatomic, assign) NSUInteger snapshotGeneration;
+
+- (instancetype)initWithResource:(TGRESTResource *)resource;
+- (NSDictionary *)insertObjectWithProperties:(NSDictionary *)properties forResource:(TGRESTResource *)resource;
+- (void)storeObject:(NSDictionary *)object withKey:(id)objectKey;
+- (void)removeObjectWithKey:(id)objectKey;
+- (void)revertObjectWithKey:(id)objectKey toObject:(id)object;
+- (NSArray *)currentSnapshot;
+- (NSArray *)objectsForKeys:(NSArray *)sortedKeys afterKey:(id)afterKey limit:(NSUInteger)limit;
+- (NSArray *)primaryKeysForForeignKey:(NSString *)foreignKey parentKey:(id)parentKey;
+- (NSArray *)primaryKeysMatchingFilter:(TGRESTQueryFilter *)filter;
+- (void)nullifyForeignKey:(NSString *)foreignKey parentKey:(id)parentKey;
+- (void)adoptObjectsFromPartition:(TGRESTInMemoryPartition *)partition;
+- (void)restoreObjectsFromJournalResource:(TGRESTStoreJournalResource *)journalResource;
+
+@end
+
+@implementation TGRESTInMemoryPartition
+
+- (instancetype)initWithResource:(TGRESTResource *)resource
+{
+    self = [super init];
+    if (self) {
+        self.objects = [NSMutableDictionary new];
+        self.lastPrimaryKey = 0;
+        self.orderedKeys = [NSMutableArray new];
+        self.liveCount = 0;
+        self.generation = TGRESTStoreNextGeneration();
+        self.versions = [NSMutableDictionary new];
+        self.snapshotGeneration = 0;
+        NSString *label = [NSString stringWithFormat:@"com.tinylittlegears.resteasy.inmemory.%@", resource.name];
+        self.queue = dispatch_queue_create([label UTF8String], DISPATCH_QUEUE_CONCURRENT);
+        
+        self.resource = resource;
+        
+        NSMutableDictionary *indexTypes = [NSMutableDictionary new];
+        NSMutableDictionary *indexes = [NSMutableDictionary new];
+        NSMutableDictionary *orderedIndexValues = [NSMutableDictionary new];
+        for (TGRESTResource *parent in resource.parentResources) {
+            NSString *foreignKey = resource.foreignKeys[parent.name];
+            if (foreignKey) {
+                [indexTypes setObject:[NSNumber numberWithInteger:parent.primaryKeyType] forKey:foreignKey];
+                [indexes setObject:[NSMutableDictionary new] forKey:foreignKey];
+            }
+        }
+        for (NSString *property in resource.indexedProperties) {
+            TGPropertyType type = [resource.model[property] integerValue];
+            [indexTypes setObject:[NSNumber numberWithInteger:type] forKey:property];
+            [indexes setObject:[NSMutableDictionary new] forKey:property];
+            if (type == TGPropertyTypeInteger || type == TGPropertyTypeFloatingPoint) {
+                [orderedIndexValues setObject:[NSMutableArray new] forKey:property];
+            }
+        }
+        self.indexTypes = indexTypes;
+        self.indexes = indexes;
+        self.orderedIndexValues = orderedIndexValues;
+    }
+    
+    return self;
+}
+
+- (void)insertKey:(id)objectKey intoKeys:(NSMutableArray *)keys
+{
+    NSUInteger position = [keys indexOfObject:objectKey
+                                inSortedRange:NSMakeRange(0, keys.count)
+                                      options:NSBinarySearchingInsertionIndex
+                              usingComparator:^NSComparisonResult(id obj1, id obj2) {
+                                  return [obj1 compare:obj2];
+                              }];
+    [keys insertObject:objectKey atIndex:position];
+}
+
+- (void)removeKey:(id)objectKey fromKeys:(NSMutableArray *)keys
+{
+    NSUInteger position = [keys indexOfObject:objectKey
+                                inSortedRange:NSMakeRange(0, keys.count)
+                                      options:NSBinarySearchingFirstEqual
+                              usingComparator:^NSComparisonResult(id obj1, id obj2) {
+                                  return [obj1 compare:obj2];
+                              }];
+    if (position != NSNotFound) {
+        [keys removeObjectAtIndex:position];
+    }
+}
+
+- (NSDictionary *)insertObjectWithProperties:(NSDictionary *)properties forResource:(TGRESTResource *)resource
+{
+    self.lastPrimaryKey++;
+    id newPrimaryKeyObject;
+    if (resource.primaryKeyType == TGPropertyTypeInteger) {
+        newPrimaryKeyObject = [NSNumber numberWithInteger:self.lastPrimaryKey];
+    } else {
+        newPrimaryKeyObject = [NSString stringWithFormat:@"%lu", (unsigned long)self.lastPrimaryKey];
+    }
+    
+    NSMutableDictionary *propertyDictionary = [NSMutableDictionary dictionaryWithDictionary:properties];
+    [propertyDictionary setObject:newPrimaryKeyObject forKey:resource.primaryKey];
+    for (NSString *key in resource.model.allKeys) {
+        if (!propertyDictionary[key]) {
+            [propertyDictionary setObject:[NSNull null] forKey:key];
+        }
+    }
+    NSDictionary *newObjectDictionary = [NSDictionary dictionaryWithDictionary:propertyDictionary];
+    [self storeObject:newObjectDictionary withKey:newPrimaryKeyObject];
+    
+    return newObjectDictionary;
+}
+
+- (void)storeObject:(NSDictionary *)object withKey:(id)objectKey
+{
+    id existingObject = self.objects[objectKey];
+    if (existingObject && existingObject != [NSNull null]) {
+        [self unindexObject:existingObject withKey:objectKey];
+        [self.fragmentCache invalidateObjectOfResource:self.resource withPrimaryKey:objectKey];
+    } else {
+        [self insertKey:objectKey intoKeys:self.orderedKeys];
+        self.liveCount++;
+    }
+    [self.objects setObject:object forKey:objectKey];
+    [self indexObject:object withKey:objectKey];
+    self.generation = TGRESTStoreNextGeneration();
+    [self.versions setObject:[NSNumber numberWithUnsignedInteger:self.generation] forKey:objectKey];
+    [self.journal recordObject:object withKey:objectKey resourceName:self.resource.name];
+}
+
+- (void)removeObjectWithKey:(id)objectKey
+{
+    id existingObject = self.objects[objectKey];
+    if (!existingObject || existingObject == [NSNull null]) {
+        return;
+    }
+    [self unindexObject:existingObject withKey:objectKey];
+    [self removeKey:objectKey fromKeys:self.orderedKeys];
+    [self.fragmentCache invalidateObjectOfResource:self.resource withPrimaryKey:objectKey];
+    [self.objects setObject:[NSNull null] forKey:objectKey];
+    self.liveCount--;
+    self.generation = TGRESTStoreNextGeneration();
+    [self.versions setObject:[NSNumber numberWithUnsignedInteger:self.generation] forKey:objectKey];
+    [self.journal recordDeletionOfKey:objectKey resourceName:self.resource.name];
+}
+
+- (void)revertObjectWithKey:(id)objectKey toObject:(id)object
+{
+    if (object && object != [NSNull null]) {
+        [self storeObject:object withKey:objectKey];
+        return;
+    }
+    [self removeObjectWithKey:objectKey];
+    if (!object) {
+        // The key did not exist before so it goes away completely rather than reading as deleted.
+        [self.objects removeObjectForKey:objectKey];
+        [self.versions removeObjectForKey:objectKey];
+    }
+}
+
+- (NSArray *)currentSnapshot
+{
+    // Readers share the partition queue so the rebuild itself is guarded separately.
+    @synchronized(self) {
+        if (self.snapshotGeneration != self.generation) {
+            self.snapshot = [self.objects objectsForKeys:self.orderedKeys notFoundMarker:[NSNull null]];
+            self.snapshotGeneration = self.generation;
+        }
+        
+        return self.snapshot;
+    }
+}
+
+- (void)indexObject:(NSDictionary *)object withKey:(id)objectKey
+{
+    for (NSString *property in self.indexTypes) {
+        id value = TGInMemoryNormalizedKey([self.indexTypes[property] integerValue], object[property]);
+        if (!value) {
+            continue;
+        }
+        NSMutableDictionary *index = self.indexes[property];
+        NSMutableArray *primaryKeys = index[value];
+        if (!primaryKeys) {
+            primaryKeys = [NSMutableArray new];
+            [index setObject:primaryKeys forKey:value];
+            NSMutableArray *orderedValues = self.orderedIndexValues[property];
+            if (orderedValues) {
+                [self insertKey:value intoKeys:orderedValues];
+            }
+        }
+        [self insertKey:objectKey intoKeys:primaryKeys];
+    }
+}
+
+- (void)unindexObject:(NSDictionary *)object withKey:(id)objectKey
+{
+    for (NSString *property in self.indexTypes) {
+        id value = TGInMemoryNormalizedKey([self.indexTypes[property] integerValue], object[property]);
+        if (!value) {
+            continue;
+        }
+        NSMutableDictionary *index = self.indexes[property];
+        NSMutableArray *primaryKeys = index[value];
+        [self removeKey:objectKey fromKeys:primaryKeys];
+        if (primaryKeys.count == 0) {
+            [index removeObjectForKey:value];
+            NSMutableArray *orderedValues = self.orderedIndexValues[property];
+            if (orderedValues) {
+                [self removeKey:value fromKeys:orderedValues];
+            }
+        }
+    }
+}
+
+- (NSArray *)objectsForKeys:(NSArray *)sortedKeys afterKey:(id)afterKey limit:(NSUInteger)limit
+{
+    NSUInteger start = 0;
+    if (afterKey) {
+        start = [sortedKeys indexOfObject:afterKey
+                            inSortedRange:NSMakeRange(0, sortedKeys.count)
+                                  options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+                          usingComparator:^NSComparisonResult(id obj1, id obj2) {
+                              return [obj1 compare:obj2];
+                          }];
+    }
+    NSUInteger length = MIN(limit, sortedKeys.count - start);
+    
+    return [self.objects objectsForKeys:[sortedKeys subarrayWithRange:NSMakeRange(start, length)] notFoundMarker:[NSNull null]];
+}
+
+- (NSArray *)primaryKeysForForeignKey:(NSString *)foreignKey parentKey:(id)parentKey
+{
+    if (!parentKey) {
+        return @[];
+    }
+    
+    return [NSArray arrayWithArray:self.indexes[foreignKey][parentKey]];
+}
+
+- (NSArray *)primaryKeysMatchingFilter:(TGRESTQueryFilter *)filter
+{
+    NSDictionary *index = self.indexes[filter.property];
+    id value = TGInMemoryNormalizedKey([self.indexTypes[filter.property] integerValue], filter.value);
+    if (!index || !value) {
+        return nil;
+    }
+    
+    if (filter.queryOperator == TGRESTQueryOperatorEqual) {
+        return [NSArray arrayWithArray:index[value] ?: @[]];
+    }
+    
+    NSArray *orderedValues = self.orderedIndexValues[filter.property];
+    if (!orderedValues) {
+        return nil;
+    }
+    
+    NSComparator comparator = ^NSComparisonResult(id obj1, id obj2) {
+        return [obj1 compare:obj2];
+    };
+    NSRange allValues = NSMakeRange(0, orderedValues.count);
+    NSUInteger firstEqual = [orderedValues indexOfObject:value inSortedRange:allValues options:NSBinarySearchingInsertionIndex | NSBinarySearchingFirstEqual usingComparator:comparator];
+    NSUInteger firstGreater = [orderedValues indexOfObject:value inSortedRange:allValues options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual usingComparator:comparator];
+    
+    NSRange matchingValues;
+    switch (filter.queryOperator) {
+        case TGRESTQueryOperatorGreaterThan:
+            matchingValues = NSMakeRange(firstGreater, orderedValues.count - firstGreater);
+            break;
+        case TGRESTQueryOperatorGreaterThanOrEqual:
+            matchingValues = NSMakeRange(firstEqual, orderedValues.count - firstEqual);
+            break;
+        case TGRESTQueryOperatorLessThan:
+            matchingValues = NSMakeRange(0, firstEqual);
+            break;
+        default:
+            matchingValues = NSMakeRange(0, firstGreater);
+            break;
+    }
+    
+    NSMutableArray *primaryKeys = [NSMutableArray new];
+    for (id matchingValue in [orderedValues subarrayWithRange:matchingValues]) {
+        [primaryKeys addObjectsFromArray:index[matchingValue]];
+    }
+    [primaryKeys sortUsingComparator:comparator];
+    
+    return primaryKeys;
+}
+
+- (void)nullifyForeignKey:(NSString *)foreignKey parentKey:(id)parentKey
+{
+    for (id childKey in [self primaryKeysForForeignKey:foreignKey parentKey:parentKey]) {
+        NSMutableDictionary *updateObject = [NSMutableDictionary dictionaryWithDictionary:self.objects[childKey]];
+        [updateObject setObject:[NSNull null] forKey:foreignKey];
+        [self storeObject:[NSDictionary dictionaryWithDictionary:updateObject] withKey:childKey];
+    }
+}
+
+- (void)adoptObjectsFromPartition:(TGRESTInMemoryPartition *)partition
+{
+    self.objects = [partition.objects mutableCopy];
+    self.orderedKeys = [partition.orderedKeys mutableCopy];
+    self.lastPrimaryKey = partition.lastPrimaryKey;
+    self.liveCount = partition.liveCount;
+    self.versions = [partition.versions mutableCopy];
+    for (id objectKey in self.orderedKeys) {
+        [self indexObject:self.objects[objectKey] withKey:objectKey];
+    }
+    self.generation = TGRESTStoreNextGeneration();
+}
+
+- (void)restoreObjectsFromJournalResource:(TGRESTStoreJournalResource *)journalResource
+{
+    self.objects = journalResource.objects;
+    self.lastPrimaryKey = journalResource.lastPrimaryKey;
+    self.generation = TGRESTStoreNextGeneration();
+    
+    NSMutableArray *liveKeys = [NSMutableArray arrayWithCapacity:self.objects.count];
+    NSNumber *version = [NSNumber numberWithUnsignedInteger:self.generation];
+    for (id objectKey in self.objects) {
+        [self.versions setObject:version forKey:objectKey];
+        if (self.objects[objectKey] != [NSNull null]) {
+            [liveKeys addObject:objectKey];
+        }
+    }
+    [liveKeys sortUsingComparator:^NSComparisonResult(id obj1, id obj2) {
+        return [obj1 compare:obj2];
+    }];
+    self.orderedKeys = liveKeys;
+    self.liveCount = liveKeys.count;
+    for (id objectKey in liveKeys) {
+        [self indexObject:self.objects[objectKey] withKey:objectKey];
+    }
+}
+
+@end
+
 @interface TGRESTInMemoryStore ()
 
-@property (atomic, strong) NSMutableDictionary *inMemoryDatastore;
-@property (nonatomic, strong) NSOperationQueue *dbQueue;
+@property (atomic, copy) NSDictionary *partitions;
+@property (nonatomic, strong) dispatch_queue_t catalogQueue;
+@property (nonatomic, strong) TGRESTStoreJournal *journal;
+@property (nonatomic, strong) NSMutableDictionary *restoredResources;
+@property (nonatomic, strong) dispatch_queue_t compactionQueue;
+@property (nonatomic, strong) dispatch_source_t compactionTimer;
 
 @end
 
@@ -23,17 +406,143 @@
 {
     self = [super init];
     if (self) {
-        self.inMemoryDatastore = [NSMutableDictionary new];
-        self.dbQueue = [NSOperationQueue new];
-        self.dbQueue.maxConcurrentOperationCount = 1;
+        self.partitions = @{};
+        self.catalogQueue = dispatch_queue_create("com.tinylittlegears.resteasy.inmemory.catalog", DISPATCH_QUEUE_SERIAL);
+        self.compactionQueue = dispatch_queue_create("com.tinylittlegears.resteasy.inmemory.compaction", DISPATCH_QUEUE_SERIAL);
     }
     
     return self;
 }
 
+- (void)dealloc
+{
+    if (_compactionTimer) {
+        dispatch_source_cancel(_compactionTimer);
+    }
+    [_journal close];
+}
+
+- (void)configureWithOptions:(NSDictionary *)options
+{
+    NSString *path = options[TGRESTInMemoryStorePersistencePathOptionKey];
+    if (!path) {
+        return;
+    }
+    
+    NSError *error;
+    TGRESTStoreJournal *journal = [TGRESTStoreJournal journalWithDirectory:path error:&error];
+    if (!journal) {
+        TGLogError(@"Could not open the persistent store in %@, continuing without persistence: %@", path, error);
+        return;
+    }
+    
+    dispatch_sync(self.catalogQueue, ^{
+        self.journal = journal;
+        self.restoredResources = [journal.restoredResources mutableCopy];
+    });
+    TGLogInfo(@"Restored %lu resources from %@", (unsigned long)journal.restoredResources.count, path);
+    
+    NSTimeInterval interval = options[TGRESTInMemoryStoreCompactionIntervalOptionKey] ? [options[TGRESTInMemoryStoreCompactionIntervalOptionKey] doubleValue] : TGInMemoryDefaultCompactionInterval;
+    if (interval > 0) {
+        __weak typeof(self) weakSelf = self;
+        self.compactionTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.compactionQueue);
+        dispatch_source_set_timer(self.compactionTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), (uint64_t)(interval * NSEC_PER_SEC), NSEC_PER_SEC / 10);
+        dispatch_source_set_event_handler(self.compactionTimer, ^{
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (strongSelf.journal.logLength > 0) {
+                NSError *compactionError;
+                if (![strongSelf compactPersistentDataWithError:&compactionError]) {
+                    TGLogError(@"Could not compact the persistent store: %@", compactionError);
+                }
+            }
+        });
+        dispatch_resume(self.compactionTimer);
+    }
+}
+
+- (BOOL)compactPersistentDataWithError:(NSError * __autoreleasing *)error
+{
+    TGRESTStoreJournal *journal = self.journal;
+    if (!journal) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return NO;
+    }
+    
+    return [journal compactWithResources:^NSDictionary *{
+        __block NSDictionary *partitions;
+        NSMutableDictionary *resources = [NSMutableDictionary new];
+        dispatch_sync(self.catalogQueue, ^{
+            partitions = self.partitions;
+            [resources addEntriesFromDictionary:self.restoredResources];
+        });
+        
+        // Stored objects are immutable so copying the dictionaries is enough, the encoding happens outside of the partition queues.
+        for (NSString *name in partitions) {
+            TGRESTInMemoryPartition *partition = partitions[name];
+            TGRESTStoreJournalResource *resource = [TGRESTStoreJournalResource new];
+            dispatch_sync(partition.queue, ^{
+                resource.model = partition.resource.model;
+                resource.lastPrimaryKey = partition.lastPrimaryKey;
+                resource.objects = [partition.objects mutableCopy];
+            });
+            [resources setObject:resource forKey:name];
+        }
+        
+        return resources;
+    } error:error];
+}
+
+- (TGRESTInMemoryPartition *)partitionForResource:(TGRESTResource *)resource
+{
+    return self.partitions[resource.name];
+}
+
 - (NSUInteger)countOfObjectsForResource:(TGRESTResource *)resource
 {
-    return [[self getAllObjectsForResource:resource error:nil] count];
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    __block NSUInteger count = 0;
+    
+    if (partition) {
+        dispatch_sync(partition.queue, ^{
+            count = partition.liveCount;
+        });
+    }
+    
+    return count;
+}
+
+- (NSUInteger)generationForResource:(TGRESTResource *)resource
+{
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    __block NSUInteger generation = NSNotFound;
+    
+    if (partition) {
+        dispatch_sync(partition.queue, ^{
+            generation = partition.generation;
+        });
+    }
+    
+    return generation;
+}
+
+- (NSUInteger)versionOfObjectOfResource:(TGRESTResource *)resource
+                         withPrimaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(primaryKey);
+    
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    id objectKey = TGInMemoryNormalizedKey(resource.primaryKeyType, primaryKey);
+    __block NSNumber *version;
+    
+    if (partition && objectKey) {
+        dispatch_sync(partition.queue, ^{
+            version = partition.versions[objectKey];
+        });
+    }
+    
+    return version ? [version unsignedIntegerValue] : NSNotFound;
 }
 
 - (NSDictionary *)getDataForObjectOfResource:(TGRESTResource *)resource
@@ -43,24 +552,21 @@
     NSParameterAssert(primaryKey);
     NSParameterAssert(resource);
     
-    NSMutableDictionary *objects = self.inMemoryDatastore[resource.name];
-    NSDictionary *object;
-    if (resource.primaryKeyType == TGPropertyTypeInteger) {
-        if (objects[[NSNumber numberWithInteger:[primaryKey integerValue]]] == [NSNull null]) {
-            if (error) {
-                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
-            }
-            return nil;
-        }
-        object = objects[[NSNumber numberWithInteger:[primaryKey integerValue]]];
-    } else {
-        if (objects[primaryKey] == [NSNull null]) {
-            if (error) {
-                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
-            }
-            return nil;
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    id objectKey = TGInMemoryNormalizedKey(resource.primaryKeyType, primaryKey);
+    __block id object;
+    
+    if (partition) {
+        dispatch_sync(partition.queue, ^{
+            object = partition.objects[objectKey];
+        });
+    }
+    
+    if (object == [NSNull null]) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
         }
-        object = objects[primaryKey];
+        return nil;
     }
     
     if (!object && error) {
@@ -74,6 +580,61 @@
                                   withParent:(TGRESTResource *)parent
                             parentPrimaryKey:(NSString *)key
                                        error:(NSError * __autoreleasing *)error
+{
+    return [self getDataForObjectsOfResource:resource withParent:parent parentPrimaryKey:key afterPrimaryKey:nil limit:NSUIntegerMax error:error];
+}
+
+- (NSArray *)getAllObjectsForResource:(TGRESTResource *)resource
+                                error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    if (!partition) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
+    __block NSArray *snapshot;
+    dispatch_sync(partition.queue, ^{
+        snapshot = [partition currentSnapshot];
+    });
+    
+    return snapshot;
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    if (!partition) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
+    id normalizedAfterKey = TGInMemoryNormalizedKey(resource.primaryKeyType, afterKey);
+    __block NSArray *page;
+    dispatch_sync(partition.queue, ^{
+        page = [partition objectsForKeys:partition.orderedKeys afterKey:normalizedAfterKey limit:limit];
+    });
+    
+    return page;
+}
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                         afterPrimaryKey:(NSString *)afterKey
+                                   limit:(NSUInteger)limit
+                                   error:(NSError * __autoreleasing *)error
 {
     NSParameterAssert(resource);
     NSParameterAssert(parent);
@@ -90,47 +651,66 @@
         return nil;
     }
     
-    NSMutableDictionary *objects = self.inMemoryDatastore[resource.name];
-    id normalizedKey;
-    if (parent.primaryKeyType == TGPropertyTypeInteger) {
-        normalizedKey = [NSNumber numberWithInteger:[key integerValue]];
-    } else {
-        normalizedKey = key;
-    }
-    NSPredicate *matchPredicate = [NSPredicate predicateWithFormat:@"self.%@ == %@", resource.foreignKeys[parent.name], normalizedKey];
-    NSMutableArray *returnArray = [NSMutableArray new];
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    id normalizedKey = TGInMemoryNormalizedKey(parent.primaryKeyType, key);
+    id normalizedAfterKey = TGInMemoryNormalizedKey(resource.primaryKeyType, afterKey);
+    NSString *foreignKey = resource.foreignKeys[parent.name];
+    __block NSArray *page = @[];
     
-    for (NSDictionary *object in objects.allValues) {
-        if ([matchPredicate evaluateWithObject:object]) {
-            [returnArray addObject:object];
-        }
+    if (partition) {
+        dispatch_sync(partition.queue, ^{
+            NSArray *childKeys = partition.indexes[foreignKey][normalizedKey];
+            if (childKeys) {
+                page = [partition objectsForKeys:childKeys afterKey:normalizedAfterKey limit:limit];
+            }
+        });
     }
     
-    NSSortDescriptor *sortByID = [NSSortDescriptor sortDescriptorWithKey:resource.primaryKey ascending:YES];
-    
-    return [returnArray sortedArrayUsingDescriptors:@[sortByID]];
+    return page;
 }
 
-- (NSArray *)getAllObjectsForResource:(TGRESTResource *)resource
-                                error:(NSError * __autoreleasing *)error
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                     matchingQuery:(TGRESTQuery *)query
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
 {
     NSParameterAssert(resource);
-
-    NSMutableDictionary *objects = self.inMemoryDatastore[resource.name];
-    if (!objects) {
+    NSParameterAssert(query);
+    
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    if (!partition) {
         if (error) {
             *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
         }
         return nil;
-    } else if (objects.count == 0) {
-        return @[];
     }
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"self != %@", [NSNull null]];
-    NSSet *filteredKeys = [objects keysOfEntriesPassingTest:^BOOL(id key, id obj, BOOL *stop) {
-        return [predicate evaluateWithObject:obj];
-    }];
-    NSArray *filteredObjects = [objects objectsForKeys:[filteredKeys allObjects] notFoundMarker:@""];
-    return [filteredObjects sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:resource.primaryKey ascending:YES]]];
+    
+    id normalizedAfterKey = query.ordersByPrimaryKey ? TGInMemoryNormalizedKey(resource.primaryKeyType, afterKey) : nil;
+    __block NSArray *candidates;
+    dispatch_sync(partition.queue, ^{
+        // An indexed filter narrows the candidates down before the rest of the query runs.  Equality is the most selective so it wins over a range.
+        NSArray *candidateKeys;
+        for (TGRESTQueryFilter *filter in query.filters) {
+            if (filter.queryOperator != TGRESTQueryOperatorEqual && candidateKeys) {
+                continue;
+            }
+            NSArray *matchingKeys = [partition primaryKeysMatchingFilter:filter];
+            if (matchingKeys) {
+                candidateKeys = matchingKeys;
+                if (filter.queryOperator == TGRESTQueryOperatorEqual) {
+                    break;
+                }
+            }
+        }
+        if (candidateKeys) {
+            candidates = [partition objectsForKeys:candidateKeys afterKey:normalizedAfterKey limit:NSUIntegerMax];
+        } else {
+            candidates = [partition currentSnapshot];
+        }
+    });
+    
+    return [query objectsMatchingQueryInObjects:candidates afterPrimaryKey:afterKey limit:limit];
 }
 
 - (NSDictionary *)createNewObjectForResource:(TGRESTResource *)resource
@@ -140,40 +720,47 @@
     NSParameterAssert(properties);
     NSParameterAssert(resource);
     
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    if (!partition) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
     __block NSDictionary *newObjectDictionary;
     
-    NSBlockOperation *write = [NSBlockOperation blockOperationWithBlock:^{
-        NSMutableDictionary *resourceDictionary = [self.inMemoryDatastore objectForKey:resource.name];
-        if (!resourceDictionary) {
-            if (error) {
-                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
-            }
-            newObjectDictionary = nil;
-        }
-        NSUInteger newPrimaryKey = [resourceDictionary allKeys].count + 1;
-        id newPrimaryKeyObject;
-        if (resource.primaryKeyType == TGPropertyTypeInteger) {
-            newPrimaryKeyObject = [NSNumber numberWithInteger:newPrimaryKey];
-        } else {
-            newPrimaryKeyObject = [NSString stringWithFormat:@"%lu", (unsigned long)newPrimaryKey];
-        }
-        
-        NSMutableDictionary *propertyDictionary = [NSMutableDictionary dictionaryWithDictionary:properties];
-        [propertyDictionary setObject:newPrimaryKeyObject forKey:resource.primaryKey];
-        for (NSString *key in resource.model.allKeys) {
-            if (!propertyDictionary[key]) {
-                [propertyDictionary setObject:[NSNull null] forKey:key];
-            }
+    dispatch_barrier_sync(partition.queue, ^{
+        newObjectDictionary = [partition insertObjectWithProperties:properties forResource:resource];
+    });
+    
+    return newObjectDictionary;
+}
+
+- (NSArray *)createNewObjectsForResource:(TGRESTResource *)resource
+                     withPropertiesArray:(NSArray *)propertiesArray
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(propertiesArray);
+    NSParameterAssert(resource);
+    
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    if (!partition) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
         }
-        newObjectDictionary = [NSDictionary dictionaryWithDictionary:propertyDictionary];
-        [resourceDictionary setObject:newObjectDictionary forKey:newPrimaryKeyObject];
-    }];
+        return nil;
+    }
     
-    [self.dbQueue addOperation:write];
+    NSMutableArray *newObjects = [NSMutableArray arrayWithCapacity:propertiesArray.count];
     
-    [write waitUntilFinished];
+    dispatch_barrier_sync(partition.queue, ^{
+        for (NSDictionary *properties in propertiesArray) {
+            [newObjects addObject:[partition insertObjectWithProperties:properties forResource:resource]];
+        }
+    });
     
-    return newObjectDictionary;
+    return [NSArray arrayWithArray:newObjects];
 }
 
 - (NSDictionary *)modifyObjectOfResource:(TGRESTResource *)resource
@@ -185,35 +772,28 @@
     NSParameterAssert(resource);
     NSParameterAssert(properties);
     
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    id objectKey = TGInMemoryNormalizedKey(resource.primaryKeyType, primaryKey);
     __block NSDictionary *updatedObject;
     __block NSError *blockError;
-    __weak typeof(self) weakSelf = self;
     
-    NSBlockOperation *write = [NSBlockOperation blockOperationWithBlock:^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-
-        NSError *getError;
-        NSDictionary *object = [self getDataForObjectOfResource:resource withPrimaryKey:primaryKey error:&getError];
-        if (getError) {
-            blockError = getError;
-            updatedObject = nil;
-        } else {
-            NSMutableDictionary *mergeDict = [NSMutableDictionary dictionaryWithDictionary:object];
-            [mergeDict addEntriesFromDictionary:properties];
-            updatedObject = [NSDictionary dictionaryWithDictionary:mergeDict];
-            
-            NSMutableDictionary *resourceDictionary = [strongSelf.inMemoryDatastore objectForKey:resource.name];
-            if (resource.primaryKeyType == TGPropertyTypeInteger) {
-                [resourceDictionary setObject:updatedObject forKey:[NSNumber numberWithInteger:[primaryKey integerValue]]];
+    if (!partition) {
+        blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
+    } else {
+        dispatch_barrier_sync(partition.queue, ^{
+            id object = partition.objects[objectKey];
+            if (object == [NSNull null]) {
+                blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
+            } else if (!object) {
+                blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
             } else {
-                [resourceDictionary setObject:updatedObject forKey:primaryKey];
+                NSMutableDictionary *mergeDict = [NSMutableDictionary dictionaryWithDictionary:object];
+                [mergeDict addEntriesFromDictionary:properties];
+                updatedObject = [NSDictionary dictionaryWithDictionary:mergeDict];
+                [partition storeObject:updatedObject withKey:objectKey];
             }
-        }
-    }];
-    
-    [self.dbQueue addOperation:write];
-    
-    [write waitUntilFinished];
+        });
+    }
     
     if (error) {
         *error = blockError;
@@ -229,61 +809,42 @@
     NSParameterAssert(resource);
     NSParameterAssert(primaryKey);
     
-    __block BOOL success;
-    __weak typeof(self) weakSelf = self;
+    TGRESTInMemoryPartition *partition = [self partitionForResource:resource];
+    id objectKey = TGInMemoryNormalizedKey(resource.primaryKeyType, primaryKey);
+    __block BOOL success = NO;
     __block NSError *blockError;
     
-    NSBlockOperation *write = [NSBlockOperation blockOperationWithBlock:^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        NSMutableDictionary *objects = strongSelf.inMemoryDatastore[resource.name];
-        id objectKey;
-        if (resource.primaryKeyType == TGPropertyTypeInteger) {
-            objectKey = [NSNumber numberWithInteger:[primaryKey integerValue]];
-        } else {
-            objectKey = primaryKey;
-        }
-        
-        if (objects[objectKey] == [NSNull null]) {
-            blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
-            success = NO;
-        } else {
-            NSDictionary *object = objects[objectKey];
-            
-            if (!object) {
+    if (!partition) {
+        blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
+    } else {
+        dispatch_barrier_sync(partition.queue, ^{
+            id object = partition.objects[objectKey];
+            if (object == [NSNull null]) {
+                blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
+            } else if (!object) {
                 blockError = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
-                success = NO;
             } else {
-                [objects setObject:[NSNull null] forKey:objectKey];
-                
-                for (TGRESTResource *child in resource.childResources) {
-                    id normalizedKey;
-                    if (resource.primaryKeyType == TGPropertyTypeInteger) {
-                        normalizedKey = [NSNumber numberWithInteger:[primaryKey integerValue]];
-                    } else {
-                        normalizedKey = primaryKey;
-                    }
-                    NSString *fKeyName = child.foreignKeys[resource.name];
-                    NSPredicate *matchPredicate = [NSPredicate predicateWithFormat:@"self.%@ == %@", child.foreignKeys[resource.name], normalizedKey];
-                    NSMutableDictionary *childObjects = strongSelf.inMemoryDatastore[child.name];
-                    
-                    for (NSString *childKey in childObjects.allKeys) {
-                        NSDictionary *existingChildDict = childObjects[childKey];
-                        if ([matchPredicate evaluateWithObject:existingChildDict]) {
-                            NSMutableDictionary *updateObject = [NSMutableDictionary dictionaryWithDictionary:existingChildDict];
-                            [updateObject setObject:[NSNull null] forKey:fKeyName];
-                            [childObjects setObject:[NSDictionary dictionaryWithDictionary:updateObject] forKey:childKey];
-                        }
-                    }
-                }
-                
+                [partition removeObjectWithKey:objectKey];
                 success = YES;
             }
-        }
-    }];
-    
-    [self.dbQueue addOperation:write];
+        });
+    }
     
-    [write waitUntilFinished];
+    if (success) {
+        // Children live in their own partitions, null out their foreign keys one partition at a time so no two partition locks are ever held together.
+        
+        for (TGRESTResource *child in resource.childResources) {
+            TGRESTInMemoryPartition *childPartition = [self partitionForResource:child];
+            if (!childPartition) {
+                continue;
+            }
+            NSString *fKeyName = child.foreignKeys[resource.name];
+            
+            dispatch_barrier_sync(childPartition.queue, ^{
+                [childPartition nullifyForeignKey:fKeyName parentKey:objectKey];
+            });
+        }
+    }
     
     if (error) {
         *error = blockError;
@@ -292,35 +853,236 @@
     return success;
 }
 
-- (void)addResource:(TGRESTResource *)resource
+- (NSArray *)performOperations:(NSArray *)operations
+                         error:(NSError * __autoreleasing *)error
 {
-    NSParameterAssert(resource);
+    NSParameterAssert(operations);
+    
+    NSDictionary *allPartitions = self.partitions;
+    NSMutableDictionary *partitions = [NSMutableDictionary new];
+    for (NSUInteger index = 0; index < operations.count; index++) {
+        TGRESTResource *resource = [(TGRESTStoreOperation *)operations[index] resource];
+        TGRESTInMemoryPartition *partition = allPartitions[resource.name];
+        if (!partition) {
+            if (error) {
+                *error = TGRESTStoreErrorForOperationAtIndex([NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil], index);
+            }
+            return nil;
+        }
+        [partitions setObject:partition forKey:resource.name];
+        for (TGRESTResource *child in resource.childResources) {
+            TGRESTInMemoryPartition *childPartition = allPartitions[child.name];
+            if (childPartition) {
+                [partitions setObject:childPartition forKey:child.name];
+            }
+        }
+    }
+    
+    // Every partition the batch can touch is locked up front in name order, which is the one place more than one partition lock is held so two batches can never wait on each other.
+    NSArray *lockOrder = [partitions objectsForKeys:[partitions.allKeys sortedArrayUsingSelector:@selector(compare:)] notFoundMarker:[NSNull null]];
+    __block NSArray *results;
+    __block NSError *blockError;
     
-    __weak typeof(self) weakSelf = self;
-    NSBlockOperation *write = [NSBlockOperation blockOperationWithBlock:^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        [strongSelf.inMemoryDatastore setObject:[NSMutableDictionary new] forKey:resource.name];
+    [self performBarrierOnPartitions:lockOrder fromIndex:0 block:^{
+        results = [self applyOperations:operations toPartitions:partitions error:&blockError];
     }];
     
-    [self.dbQueue addOperation:write];
+    if (!results && error) {
+        *error = blockError;
+    }
     
-    [write waitUntilFinished];
+    return results;
+}
+
+- (void)addResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    dispatch_sync(self.catalogQueue, ^{
+        TGRESTInMemoryPartition *existingPartition = self.partitions[resource.name];
+        TGRESTInMemoryPartition *partition = [[TGRESTInMemoryPartition alloc] initWithResource:resource];
+        partition.fragmentCache = self.fragmentCache;
+        partition.journal = self.journal;
+        TGRESTResource *existingResource = existingPartition.resource;
+        TGRESTStoreJournalResource *restoredResource = self.restoredResources[resource.name];
+        if (existingResource &&
+            [existingResource.model isEqualToDictionary:resource.model] &&
+            [existingResource.foreignKeys isEqualToDictionary:resource.foreignKeys] &&
+            ![existingResource.indexedProperties isEqualToArray:resource.indexedProperties]) {
+            // Only the indexes changed so the objects carry over and get indexed again.
+            dispatch_barrier_sync(existingPartition.queue, ^{
+                [partition adoptObjectsFromPartition:existingPartition];
+            });
+        } else if (!existingResource && [restoredResource.model isEqualToDictionary:resource.model]) {
+            [partition restoreObjectsFromJournalResource:restoredResource];
+            [self.journal recordResource:resource];
+        } else {
+            // Anything left on disk for this resource is purged along with the old partition.
+            [self.journal recordDropOfResourceName:resource.name];
+            [self.journal recordResource:resource];
+        }
+        [self.restoredResources removeObjectForKey:resource.name];
+        NSMutableDictionary *partitions = [NSMutableDictionary dictionaryWithDictionary:self.partitions];
+        [partitions setObject:partition forKey:resource.name];
+        self.partitions = partitions;
+    });
+    [self.fragmentCache invalidateResource:resource];
 }
 
 - (void)dropResource:(TGRESTResource *)resource
 {
     NSParameterAssert(resource);
     
-    __weak typeof(self) weakSelf = self;
-    NSBlockOperation *write = [NSBlockOperation blockOperationWithBlock:^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        [strongSelf.inMemoryDatastore removeObjectForKey:resource.name];
-    }];
+    dispatch_sync(self.catalogQueue, ^{
+        NSMutableDictionary *partitions = [NSMutableDictionary dictionaryWithDictionary:self.partitions];
+        [partitions removeObjectForKey:resource.name];
+        self.partitions = partitions;
+        [self.restoredResources removeObjectForKey:resource.name];
+        [self.journal recordDropOfResourceName:resource.name];
+    });
+    [self.fragmentCache invalidateResource:resource];
+}
+
+#pragma mark - Private
+
+- (void)performBarrierOnPartitions:(NSArray *)partitions fromIndex:(NSUInteger)index block:(dispatch_block_t)block
+{
+    if (index == partitions.count) {
+        block();
+        return;
+    }
     
-    [self.dbQueue addOperation:write];
+    TGRESTInMemoryPartition *partition = partitions[index];
+    dispatch_barrier_sync(partition.queue, ^{
+        [self performBarrierOnPartitions:partitions fromIndex:index + 1 block:block];
+    });
+}
+
+- (NSArray *)applyOperations:(NSArray *)operations
+                toPartitions:(NSDictionary *)partitions
+                       error:(NSError * __autoreleasing *)error
+{
+    // Writes are journaled once the whole batch has succeeded so a rolled back batch never reaches the disk.
+    NSMutableArray *undoLog = [NSMutableArray new];
+    NSMutableDictionary *touchedKeys = [NSMutableDictionary new];
+    for (TGRESTInMemoryPartition *partition in partitions.allValues) {
+        NSUInteger lastPrimaryKey = partition.lastPrimaryKey;
+        [undoLog addObject:^{
+            partition.lastPrimaryKey = lastPrimaryKey;
+        }];
+        [touchedKeys setObject:[NSMutableOrderedSet new] forKey:partition.resource.name];
+        partition.journal = nil;
+    }
+    
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:operations.count];
+    NSError *operationError;
+    for (TGRESTStoreOperation *unresolvedOperation in operations) {
+        TGRESTStoreOperation *operation = [unresolvedOperation operationByResolvingReferencesWithOperations:operations results:results error:&operationError];
+        id result = operation ? [self applyOperation:operation toPartitions:partitions undoLog:undoLog touchedKeys:touchedKeys error:&operationError] : nil;
+        if (!result) {
+            break;
+        }
+        [results addObject:result];
+    }
     
-    [write waitUntilFinished];
+    BOOL committed = results.count == operations.count;
+    if (!committed) {
+        for (dispatch_block_t undo in [undoLog reverseObjectEnumerator]) {
+            undo();
+        }
+    }
     
+    for (TGRESTInMemoryPartition *partition in partitions.allValues) {
+        partition.journal = self.journal;
+        if (!committed) {
+            continue;
+        }
+        for (id objectKey in touchedKeys[partition.resource.name]) {
+            id object = partition.objects[objectKey];
+            if (object == [NSNull null]) {
+                [self.journal recordDeletionOfKey:objectKey resourceName:partition.resource.name];
+            } else {
+                [self.journal recordObject:object withKey:objectKey resourceName:partition.resource.name];
+            }
+        }
+    }
+    
+    if (!committed) {
+        if (error) {
+            *error = TGRESTStoreErrorForOperationAtIndex(operationError, results.count);
+        }
+        return nil;
+    }
+    
+    return [NSArray arrayWithArray:results];
+}
+
+- (id)applyOperation:(TGRESTStoreOperation *)operation
+        toPartitions:(NSDictionary *)partitions
+             undoLog:(NSMutableArray *)undoLog
+         touchedKeys:(NSDictionary *)touchedKeys
+               error:(NSError * __autoreleasing *)error
+{
+    TGRESTResource *resource = operation.resource;
+    TGRESTInMemoryPartition *partition = partitions[resource.name];
+    
+    if (operation.type == TGRESTStoreOperationTypeCreate) {
+        NSDictionary *newObject = [partition insertObjectWithProperties:operation.properties forResource:resource];
+        [self recordKey:newObject[resource.primaryKey] withPreviousObject:nil ofPartition:partition undoLog:undoLog touchedKeys:touchedKeys];
+        return newObject;
+    }
+    
+    id objectKey = TGInMemoryNormalizedKey(resource.primaryKeyType, operation.primaryKey);
+    id object = objectKey ? partition.objects[objectKey] : nil;
+    if (object == [NSNull null]) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
+        }
+        return nil;
+    } else if (!object) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
+    switch (operation.type) {
+        case TGRESTStoreOperationTypeModify: {
+            NSMutableDictionary *mergeDict = [NSMutableDictionary dictionaryWithDictionary:object];
+            [mergeDict addEntriesFromDictionary:operation.properties];
+            NSDictionary *updatedObject = [NSDictionary dictionaryWithDictionary:mergeDict];
+            [self recordKey:objectKey withPreviousObject:object ofPartition:partition undoLog:undoLog touchedKeys:touchedKeys];
+            [partition storeObject:updatedObject withKey:objectKey];
+            return updatedObject;
+        }
+        case TGRESTStoreOperationTypeDelete: {
+            [self recordKey:objectKey withPreviousObject:object ofPartition:partition undoLog:undoLog touchedKeys:touchedKeys];
+            [partition removeObjectWithKey:objectKey];
+            for (TGRESTResource *child in resource.childResources) {
+                TGRESTInMemoryPartition *childPartition = partitions[child.name];
+                NSString *fKeyName = child.foreignKeys[resource.name];
+                for (id childKey in [childPartition primaryKeysForForeignKey:fKeyName parentKey:objectKey]) {
+                    [self recordKey:childKey withPreviousObject:childPartition.objects[childKey] ofPartition:childPartition undoLog:undoLog touchedKeys:touchedKeys];
+                }
+                [childPartition nullifyForeignKey:fKeyName parentKey:objectKey];
+            }
+            return [NSNull null];
+        }
+        default:
+            return object;
+    }
+}
+
+- (void)recordKey:(id)objectKey
+withPreviousObject:(id)previousObject
+      ofPartition:(TGRESTInMemoryPartition *)partition
+          undoLog:(NSMutableArray *)undoLog
+      touchedKeys:(NSDictionary *)touchedKeys
+{
+    [undoLog addObject:^{
+        [partition revertObjectWithKey:objectKey toObject:previousObject];
+    }];
+    [touchedKeys[partition.resource.name] addObject:objectKey];
 }
 
 + (NSString *)description
@@ -330,13 +1092,16 @@
 
 - (NSString *)description
 {
-    NSUInteger objectCount = 0;
+    NSDictionary *partitions = self.partitions;
+    __block NSUInteger objectCount = 0;
     
-    for (NSMutableArray *resourceArray in self.inMemoryDatastore.allValues) {
-        objectCount = objectCount + resourceArray.count;
+    for (TGRESTInMemoryPartition *partition in partitions.allValues) {
+        dispatch_sync(partition.queue, ^{
+            objectCount = objectCount + partition.liveCount;
+        });
     }
     
-    return [NSString stringWithFormat:@"%@ with %lu resources and %lu objects", [[self class] description], (unsigned long)self.inMemoryDatastore.allKeys.count, (unsigned long)objectCount];
+    return [NSString stringWithFormat:@"%@ with %lu resources and %lu objects", [[self class] description], (unsigned long)partitions.allKeys.count, (unsigned long)objectCount];
 }
 
 @end
@@ -0,0 +1,70 @@
+//
+//  TGRESTJSONEncoder.h
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource;
+
+/**
+ `TGRESTJSONEncoder` writes the objects of a single resource as JSON.  `TGRESTServer` compiles one from the resource model when the resource is added: every property gets its quoted key escaped up front and a writer picked by its `TGPropertyType`, so encoding an object is a walk over a fixed list of properties that appends straight into a byte buffer instead of the generic walk `NSJSONSerialization` does.
+ 
+ Blob properties are written as base64 strings, which `NSJSONSerialization` can't encode at all.  A value that doesn't match its property type (for example a string posted to an integer property) is written as whatever JSON type it actually is and keys that aren't in the model are written the generic way, so apart from blobs the output decodes to the same values `NSJSONSerialization` would produce.  Properties are always written in name order.
+ 
+ Encoders are immutable once compiled and can be used from any thread.
+ */
+
+@interface TGRESTJSONEncoder : NSObject
+
+/**
+ The resource the encoder was compiled for.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTResource *resource;
+
+/**
+ *  Compiles an encoder for the resource model.
+ *
+ *  @param resource The resource whose objects will be encoded.
+ *
+ *  @return A new encoder.
+ */
+
++ (instancetype)encoderWithResource:(TGRESTResource *)resource;
+
+/**
+ *  Appends the JSON for an object to a buffer.
+ *
+ *  @param object Object dictionary with keys matching the resource model.
+ *  @param data   The buffer to append to.  It is left unchanged if the object can't be encoded.
+ *
+ *  @return `YES` if the object was written, `NO` if one of its values can't be represented in JSON (for example a floating point value that is not a number).
+ */
+
+- (BOOL)appendObject:(NSDictionary *)object toData:(NSMutableData *)data;
+
+/**
+ *  Encodes a single object.
+ *
+ *  @param object Object dictionary with keys matching the resource model.
+ *
+ *  @return The encoded object or nil if it can't be encoded.
+ */
+
+- (NSData *)dataWithObject:(NSDictionary *)object;
+
+/**
+ *  Encodes an array of objects into a single buffer.
+ *
+ *  @param objects Array of object dictionaries with keys matching the resource model.
+ *
+ *  @return The encoded array or nil if any object can't be encoded.
+ */
+
+- (NSData *)dataWithObjects:(NSArray *)objects;
+
+@end
@@ -0,0 +1,282 @@
+//
+//  TGRESTJSONEncoder.m
+//  
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import "TGRESTJSONEncoder.h"
+#import "TGRESTResource.h"
+
+static NSUInteger const TGJSONStackBufferSize = 512;
+static NSUInteger const TGJSONEstimatedObjectSize = 64;
+
+static void TGJSONAppendString(NSMutableData *data, NSString *string)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    
+    CFIndex length = CFStringGetLength((__bridge CFStringRef)string);
+    CFIndex maxBytes = length * 3;
+    uint8_t stackBuffer[TGJSONStackBufferSize];
+    uint8_t *bytes = (maxBytes <= (CFIndex)TGJSONStackBufferSize) ? stackBuffer : malloc(maxBytes);
+    CFIndex usedBytes = 0;
+    CFStringGetBytes((__bridge CFStringRef)string, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, bytes, maxBytes, &usedBytes);
+    
+    [data appendBytes:"\"" length:1];
+    CFIndex runStart = 0;
+    for (CFIndex i = 0; i < usedBytes; i++) {
+        uint8_t c = bytes[i];
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        [data appendBytes:bytes + runStart length:i - runStart];
+        runStart = i + 1;
+        switch (c) {
+            case '"': [data appendBytes:"\\\"" length:2]; break;
+            case '\\': [data appendBytes:"\\\\" length:2]; break;
+            case '\n': [data appendBytes:"\\n" length:2]; break;
+            case '\r': [data appendBytes:"\\r" length:2]; break;
+            case '\t': [data appendBytes:"\\t" length:2]; break;
+            case '\b': [data appendBytes:"\\b" length:2]; break;
+            case '\f': [data appendBytes:"\\f" length:2]; break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF]};
+                [data appendBytes:escape length:6];
+                break;
+            }
+        }
+    }
+    [data appendBytes:bytes + runStart length:usedBytes - runStart];
+    [data appendBytes:"\"" length:1];
+    
+    if (bytes != stackBuffer) {
+        free(bytes);
+    }
+}
+
+static BOOL TGJSONAppendDouble(NSMutableData *data, double value)
+{
+    if (!isfinite(value)) {
+        return NO;
+    }
+    
+    // The shortest of the two precisions that survives a round trip, so 0.1 stays 0.1.
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (strtod(buffer, NULL) != value) {
+        length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    [data appendBytes:buffer length:length];
+    
+    return YES;
+}
+
+static BOOL TGJSONAppendNumber(NSMutableData *data, NSNumber *number)
+{
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        if ([number boolValue]) {
+            [data appendBytes:"true" length:4];
+        } else {
+            [data appendBytes:"false" length:5];
+        }
+        return YES;
+    }
+    
+    char type = [number objCType][0];
+    char buffer[32];
+    int length;
+    if (type == 'f' || type == 'd') {
+        return TGJSONAppendDouble(data, [number doubleValue]);
+    } else if (type == 'Q') {
+        length = snprintf(buffer, sizeof(buffer), "%llu", [number unsignedLongLongValue]);
+    } else {
+        length = snprintf(buffer, sizeof(buffer), "%lld", [number longLongValue]);
+    }
+    [data appendBytes:buffer length:length];
+    
+    return YES;
+}
+
+static void TGJSONAppendBlob(NSMutableData *data, NSData *blob)
+{
+    [data appendBytes:"\"" length:1];
+    [data appendData:[blob base64EncodedDataWithOptions:0]];
+    [data appendBytes:"\"" length:1];
+}
+
+static BOOL TGJSONAppendValue(NSMutableData *data, id value)
+{
+    if ([value isKindOfClass:[NSString class]]) {
+        TGJSONAppendString(data, value);
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        return TGJSONAppendNumber(data, value);
+    } else if (value == [NSNull null]) {
+        [data appendBytes:"null" length:4];
+    } else if ([value isKindOfClass:[NSData class]]) {
+        TGJSONAppendBlob(data, value);
+    } else if (([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) && [NSJSONSerialization isValidJSONObject:value]) {
+        [data appendData:[NSJSONSerialization dataWithJSONObject:value options:kNilOptions error:nil]];
+    } else {
+        return NO;
+    }
+    
+    return YES;
+}
+
+static BOOL TGJSONAppendTypedValue(NSMutableData *data, id value, TGPropertyType type)
+{
+    switch (type) {
+        case TGPropertyTypeString:
+            if ([value isKindOfClass:[NSString class]]) {
+                TGJSONAppendString(data, value);
+                return YES;
+            }
+            break;
+        case TGPropertyTypeInteger:
+        case TGPropertyTypeFloatingPoint:
+            if ([value isKindOfClass:[NSNumber class]]) {
+                return TGJSONAppendNumber(data, value);
+            }
+            break;
+        case TGPropertyTypeBlob:
+            if ([value isKindOfClass:[NSData class]]) {
+                TGJSONAppendBlob(data, value);
+                return YES;
+            }
+            break;
+        default:
+            break;
+    }
+    
+    return TGJSONAppendValue(data, value);
+}
+
+@interface TGRESTJSONEncoder ()
+
+@property (nonatomic, strong, readwrite) TGRESTResource *resource;
+@property (nonatomic, copy) NSArray *propertyNames;
+@property (nonatomic, copy) NSSet *propertyNameSet;
+@property (nonatomic, copy) NSArray *keyPrefixes;
+@property (nonatomic, strong) NSData *propertyTypes;
+
+@end
+
+@implementation TGRESTJSONEncoder
+
++ (instancetype)encoderWithResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    TGRESTJSONEncoder *encoder = [self new];
+    encoder.resource = resource;
+    
+    NSArray *propertyNames = [resource.model.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    NSMutableArray *keyPrefixes = [NSMutableArray arrayWithCapacity:propertyNames.count];
+    NSMutableData *propertyTypes = [NSMutableData dataWithLength:propertyNames.count * sizeof(TGPropertyType)];
+    TGPropertyType *types = propertyTypes.mutableBytes;
+    
+    for (NSUInteger x = 0; x < propertyNames.count; x++) {
+        NSMutableData *keyPrefix = [NSMutableData new];
+        TGJSONAppendString(keyPrefix, propertyNames[x]);
+        [keyPrefix appendBytes:":" length:1];
+        [keyPrefixes addObject:keyPrefix];
+        types[x] = [resource.model[propertyNames[x]] integerValue];
+    }
+    
+    encoder.propertyNames = propertyNames;
+    encoder.propertyNameSet = [NSSet setWithArray:propertyNames];
+    encoder.keyPrefixes = keyPrefixes;
+    encoder.propertyTypes = propertyTypes;
+    
+    return encoder;
+}
+
+- (BOOL)appendObject:(NSDictionary *)object toData:(NSMutableData *)data
+{
+    NSParameterAssert(object);
+    NSParameterAssert(data);
+    
+    NSUInteger startLength = data.length;
+    NSArray *propertyNames = self.propertyNames;
+    NSArray *keyPrefixes = self.keyPrefixes;
+    const TGPropertyType *types = self.propertyTypes.bytes;
+    NSUInteger propertyCount = propertyNames.count;
+    NSUInteger writtenCount = 0;
+    
+    [data appendBytes:"{" length:1];
+    for (NSUInteger x = 0; x < propertyCount; x++) {
+        id value = object[propertyNames[x]];
+        if (!value) {
+            continue;
+        }
+        if (writtenCount > 0) {
+            [data appendBytes:"," length:1];
+        }
+        [data appendData:keyPrefixes[x]];
+        if (!TGJSONAppendTypedValue(data, value, types[x])) {
+            data.length = startLength;
+            return NO;
+        }
+        writtenCount++;
+    }
+    
+    // Keys outside the model are rare so they only cost a set lookup when the counts don't add up.
+    if (object.count > writtenCount) {
+        for (id key in object) {
+            if ([self.propertyNameSet containsObject:key]) {
+                continue;
+            }
+            if (![key isKindOfClass:[NSString class]]) {
+                data.length = startLength;
+                return NO;
+            }
+            if (writtenCount > 0) {
+                [data appendBytes:"," length:1];
+            }
+            TGJSONAppendString(data, key);
+            [data appendBytes:":" length:1];
+            if (!TGJSONAppendValue(data, object[key])) {
+                data.length = startLength;
+                return NO;
+            }
+            writtenCount++;
+        }
+    }
+    [data appendBytes:"}" length:1];
+    
+    return YES;
+}
+
+- (NSData *)dataWithObject:(NSDictionary *)object
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:TGJSONEstimatedObjectSize];
+    if (![self appendObject:object toData:data]) {
+        return nil;
+    }
+    
+    return data;
+}
+
+- (NSData *)dataWithObjects:(NSArray *)objects
+{
+    NSParameterAssert(objects);
+    
+    NSMutableData *data = [NSMutableData dataWithCapacity:objects.count * TGJSONEstimatedObjectSize + 2];
+    [data appendBytes:"[" length:1];
+    BOOL wroteObject = NO;
+    for (NSDictionary *object in objects) {
+        if (wroteObject) {
+            [data appendBytes:"," length:1];
+        }
+        if (![object isKindOfClass:[NSDictionary class]] || ![self appendObject:object toData:data]) {
+            return nil;
+        }
+        wroteObject = YES;
+    }
+    [data appendBytes:"]" length:1];
+    
+    return data;
+}
+
+@end
@@ -0,0 +1,79 @@
+//
+//  TGRESTLatencyProfile.h
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ `TGRESTLatencyProfile` describes how long the server should hold back a response to simulate a real network and backend.  Every time a response is ready the server asks the profile for a latency with `-nextLatency` and delivers the response once that much time has passed since the request came in, without holding a thread while it waits.
+ 
+ Profiles can be set for the whole server with `TGRESTServerLatencyProfileOptionKey`, or for a single resource or route with `-setLatencyProfile:forResource:` and `-setLatencyProfile:forResource:action:` on `TGRESTServer`.  Profiles are immutable and safe to share between resources and threads.
+ */
+
+@interface TGRESTLatencyProfile : NSObject
+
+///-------------------------
+/// @name Creating a profile
+///-------------------------
+
+/**
+ *  Creates a profile that always returns the same latency.
+ *
+ *  @param latency Latency in seconds.
+ *
+ *  @return A new profile.
+ */
+
++ (instancetype)fixedProfileWithLatency:(NSTimeInterval)latency;
+
+/**
+ *  Creates a profile with latencies spread evenly between a minimum and a maximum.  This is what the `TGLatencyRangeMinimumOptionKey` and `TGLatencyRangeMaximumOptionKey` options use.
+ *
+ *  @param minimum Lowest latency in seconds.
+ *  @param maximum Highest latency in seconds, if it is lower than the minimum the minimum is used.
+ *
+ *  @return A new profile.
+ */
+
++ (instancetype)uniformProfileWithMinimum:(NSTimeInterval)minimum maximum:(NSTimeInterval)maximum;
+
+/**
+ *  Creates a profile with normally distributed latencies.  Samples below zero are returned as zero.
+ *
+ *  @param mean              Mean latency in seconds.
+ *  @param standardDeviation Standard deviation in seconds.
+ *
+ *  @return A new profile.
+ */
+
++ (instancetype)normalProfileWithMean:(NSTimeInterval)mean standardDeviation:(NSTimeInterval)standardDeviation;
+
+/**
+ *  Creates a profile from a table of latency percentiles, which is the easiest way to reproduce the tail latency of a real service.  For example `@{@50: @0.05, @99: @0.4, @99.9: @1.2}` returns 50ms or less for half of the responses, 400ms or less for 99% of them and up to 1.2 seconds for the rest.
+ *
+ *  Latencies between two percentiles are interpolated linearly.  Below the lowest percentile they are interpolated from zero unless the table has an entry for the 0th percentile, and above the highest percentile the highest latency is returned.
+ *
+ *  @param latencies Dictionary with percentiles between 0 and 100 as keys and latencies in seconds as values.  Latencies must not decrease as the percentile increases.
+ *
+ *  @return A new profile.
+ */
+
++ (instancetype)percentileProfileWithLatencies:(NSDictionary *)latencies;
+
+///-------------------------
+/// @name Sampling latencies
+///-------------------------
+
+/**
+ *  Draws the latency for the next response.  Safe to call from any thread.
+ *
+ *  @return Latency in seconds, never negative.
+ */
+
+- (NSTimeInterval)nextLatency;
+
+@end
@@ -0,0 +1,135 @@
+//
+//  TGRESTLatencyProfile.m
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import "TGRESTLatencyProfile.h"
+
+/**
+ Uniform sample in (0, 1], arc4random is thread safe unlike drand48 and never hands out a zero for the logarithm in the normal distribution.
+ */
+
+static inline double TGLatencyUnitSample(void)
+{
+    return ((double)arc4random() + 1.0) / ((double)UINT32_MAX + 1.0);
+}
+
+@interface TGRESTLatencyProfile ()
+
+@property (nonatomic, copy) NSString *summary;
+@property (nonatomic, copy) NSTimeInterval (^sampleBlock)(void);
+
+@end
+
+@implementation TGRESTLatencyProfile
+
++ (instancetype)profileWithSummary:(NSString *)summary sampleBlock:(NSTimeInterval (^)(void))sampleBlock
+{
+    TGRESTLatencyProfile *profile = [self new];
+    profile.summary = summary;
+    profile.sampleBlock = sampleBlock;
+    
+    return profile;
+}
+
++ (instancetype)fixedProfileWithLatency:(NSTimeInterval)latency
+{
+    latency = MAX(latency, 0);
+    
+    return [self profileWithSummary:[NSString stringWithFormat:@"fixed %.3f sec", latency] sampleBlock:^NSTimeInterval{
+        return latency;
+    }];
+}
+
++ (instancetype)uniformProfileWithMinimum:(NSTimeInterval)minimum maximum:(NSTimeInterval)maximum
+{
+    minimum = MAX(minimum, 0);
+    maximum = MAX(maximum, minimum);
+    NSTimeInterval range = maximum - minimum;
+    
+    return [self profileWithSummary:[NSString stringWithFormat:@"uniform %.3f - %.3f sec", minimum, maximum] sampleBlock:^NSTimeInterval{
+        return minimum + (TGLatencyUnitSample() * range);
+    }];
+}
+
++ (instancetype)normalProfileWithMean:(NSTimeInterval)mean standardDeviation:(NSTimeInterval)standardDeviation
+{
+    standardDeviation = fabs(standardDeviation);
+    
+    return [self profileWithSummary:[NSString stringWithFormat:@"normal mean %.3f sec deviation %.3f sec", mean, standardDeviation] sampleBlock:^NSTimeInterval{
+        // Box-Muller, only one of the pair is used so nothing has to be cached between threads.
+        double radius = sqrt(-2.0 * log(TGLatencyUnitSample()));
+        double angle = 2.0 * M_PI * TGLatencyUnitSample();
+        return MAX(mean + (standardDeviation * radius * cos(angle)), 0);
+    }];
+}
+
++ (instancetype)percentileProfileWithLatencies:(NSDictionary *)latencies
+{
+    NSParameterAssert(latencies.count > 0);
+    
+    NSArray *sortedPercentiles = [latencies.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    NSUInteger count = sortedPercentiles.count;
+    NSMutableData *percentileData = [NSMutableData dataWithLength:(count + 1) * sizeof(double)];
+    NSMutableData *latencyData = [NSMutableData dataWithLength:(count + 1) * sizeof(double)];
+    double *percentiles = percentileData.mutableBytes;
+    double *values = latencyData.mutableBytes;
+    NSMutableArray *summaryParts = [NSMutableArray arrayWithCapacity:count];
+    
+    // The table always starts from the 0th percentile so every sample falls between two entries.
+    NSUInteger points = 1;
+    percentiles[0] = 0;
+    values[0] = 0;
+    for (NSNumber *percentile in sortedPercentiles) {
+        double p = percentile.doubleValue;
+        double latency = MAX([latencies[percentile] doubleValue], 0);
+        if (p < 0 || p > 100) {
+            @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                           reason:[NSString stringWithFormat:@"Percentile %@ is not between 0 and 100", percentile]
+                                         userInfo:nil];
+        }
+        if (latency < values[points - 1]) {
+            @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                           reason:[NSString stringWithFormat:@"The latency for percentile %@ is lower than the latency of a lower percentile", percentile]
+                                         userInfo:nil];
+        }
+        if (p == 0) {
+            values[0] = latency;
+        } else {
+            percentiles[points] = p;
+            values[points] = latency;
+            points++;
+        }
+        [summaryParts addObject:[NSString stringWithFormat:@"p%@ %.3f sec", percentile, latency]];
+    }
+    
+    return [self profileWithSummary:[NSString stringWithFormat:@"percentiles %@", [summaryParts componentsJoinedByString:@", "]] sampleBlock:^NSTimeInterval{
+        const double *percentiles = percentileData.bytes;
+        const double *values = latencyData.bytes;
+        double p = TGLatencyUnitSample() * 100.0;
+        if (p >= percentiles[points - 1]) {
+            return values[points - 1];
+        }
+        NSUInteger upper = 1;
+        while (percentiles[upper] < p) {
+            upper++;
+        }
+        double fraction = (p - percentiles[upper - 1]) / (percentiles[upper] - percentiles[upper - 1]);
+        return values[upper - 1] + (fraction * (values[upper] - values[upper - 1]));
+    }];
+}
+
+- (NSTimeInterval)nextLatency
+{
+    return self.sampleBlock();
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> %@", NSStringFromClass([self class]), self, self.summary];
+}
+
+@end
@@ -0,0 +1,158 @@
+//
+//  TGRESTMetrics.h
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "TGRESTRoute.h"
+
+/**
+ `TGRESTHistogram` counts values in logarithmic buckets the way an HDR histogram does: every power of two is split into 16 linear buckets, so any percentile is reported within about 6% of the real value no matter how large the values get.  Recording is lock free and safe from any number of threads, and copying a histogram takes a snapshot of it.
+ */
+
+@interface TGRESTHistogram : NSObject <NSCopying>
+
+/**
+ Number of recorded values.
+ */
+
+@property (nonatomic, assign, readonly) uint64_t count;
+
+/**
+ Sum of the recorded values.
+ */
+
+@property (nonatomic, assign, readonly) uint64_t sum;
+
+/**
+ Smallest recorded value, or 0 if nothing has been recorded.
+ */
+
+@property (nonatomic, assign, readonly) uint64_t minimum;
+
+/**
+ Largest recorded value, or 0 if nothing has been recorded.
+ */
+
+@property (nonatomic, assign, readonly) uint64_t maximum;
+
+/**
+ *  Records a value.
+ *
+ *  @param value The value to record.
+ */
+
+- (void)recordValue:(uint64_t)value;
+
+/**
+ *  The value at a percentile of the recorded values, which is the highest value that falls into the same bucket.
+ *
+ *  @param percentile Percentile between 0 and 100, for example 99.9.
+ *
+ *  @return The value at the percentile or 0 if nothing has been recorded.
+ */
+
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+@end
+
+/**
+ `TGRESTRouteMetrics` collects the metrics of one action of one resource.  Times are in nanoseconds and don't include the simulated latency of a latency profile, sizes are in bytes.  Get a snapshot from the server with `-metricsForResource:action:`.
+ */
+
+@interface TGRESTRouteMetrics : NSObject <NSCopying>
+
+@property (nonatomic, copy, readonly) NSString *resourceName;
+@property (nonatomic, assign, readonly) TGRESTRouteAction action;
+
+/**
+ Time from the controller being called until it returned a response.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTHistogram *handlerTime;
+
+/**
+ Time spent in the datastore.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTHistogram *storeTime;
+
+/**
+ Time spent decoding request bodies and serializing responses.  Responses that are streamed, like the index of a whole resource, are serialized after the handler is done and don't count.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTHistogram *serializeTime;
+
+/**
+ Size of the request bodies.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTHistogram *requestBytes;
+
+/**
+ Size of the response bodies, streamed responses of unknown length are not recorded.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTHistogram *responseBytes;
+
+/**
+ *  Creates empty metrics for an action of a resource.
+ *
+ *  @param resourceName Name of the resource.
+ *  @param action       Route action.
+ *
+ *  @return New metrics.
+ */
+
++ (instancetype)metricsWithResourceName:(NSString *)resourceName action:(TGRESTRouteAction)action;
+
+/**
+ *  Records a handled request.  Safe to call from any thread.
+ *
+ *  @param handlerTime   Nanoseconds the handler took.
+ *  @param storeTime     Nanoseconds spent in the datastore.
+ *  @param serializeTime Nanoseconds spent decoding and serializing.
+ *  @param requestBytes  Size of the request body.
+ *  @param responseBytes Size of the response body, or NSUIntegerMax if it is not known.
+ *  @param statusCode    HTTP status code of the response.
+ */
+
+- (void)recordRequestWithHandlerTime:(uint64_t)handlerTime
+                           storeTime:(uint64_t)storeTime
+                       serializeTime:(uint64_t)serializeTime
+                        requestBytes:(NSUInteger)requestBytes
+                       responseBytes:(NSUInteger)responseBytes
+                          statusCode:(NSInteger)statusCode;
+
+/**
+ *  Number of responses with a status code.
+ *
+ *  @param statusCode HTTP status code.
+ *
+ *  @return Number of responses.
+ */
+
+- (uint64_t)countForStatusCode:(NSInteger)statusCode;
+
+/**
+ *  Every status code that has been returned.
+ *
+ *  @return Dictionary with status codes as keys and the number of responses as values.
+ */
+
+- (NSDictionary *)statusCodeCounts;
+
+/**
+ *  Renders metrics in the Prometheus text exposition format.  Times and sizes are summaries with the 50th, 90th, 99th and 99.9th percentiles, times are converted to seconds, and the status codes are a counter.
+ *
+ *  @param metrics Array of TGRESTRouteMetrics.
+ *
+ *  @return The metrics as text.
+ */
+
++ (NSString *)prometheusTextWithMetrics:(NSArray *)metrics;
+
+@end
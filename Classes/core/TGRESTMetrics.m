@@ -0,0 +1,325 @@
+//
+//  TGRESTMetrics.m
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import "TGRESTMetrics.h"
+#import <stdatomic.h>
+
+// An enum rather than constants because the bucket count sizes an array.
+enum {
+    TGHistogramSubBucketBits = 4,
+    TGHistogramSubBucketCount = 1 << TGHistogramSubBucketBits,
+    TGHistogramBucketCount = (64 - TGHistogramSubBucketBits + 1) * TGHistogramSubBucketCount
+};
+
+static NSInteger const TGMetricsStatusCodeLimit = 600;
+
+typedef struct {
+    _Atomic(uint64_t) count;
+    _Atomic(uint64_t) sum;
+    _Atomic(uint64_t) minimum;
+    _Atomic(uint64_t) maximum;
+    _Atomic(uint64_t) buckets[TGHistogramBucketCount];
+} TGHistogramCounts;
+
+/**
+ Values below the sub bucket count get a bucket each, above that the position of the highest bit picks the power of two and the next bits pick the linear bucket inside it.
+ */
+
+static inline NSUInteger TGHistogramBucketIndex(uint64_t value)
+{
+    if (value < TGHistogramSubBucketCount) {
+        return (NSUInteger)value;
+    }
+    NSUInteger highestBit = 63 - __builtin_clzll(value);
+    NSUInteger shift = highestBit - TGHistogramSubBucketBits;
+    return ((shift + 1) * TGHistogramSubBucketCount) + (NSUInteger)((value >> shift) & (TGHistogramSubBucketCount - 1));
+}
+
+static inline uint64_t TGHistogramHighestValueInBucket(NSUInteger index)
+{
+    if (index < TGHistogramSubBucketCount) {
+        return index;
+    }
+    NSUInteger shift = (index / TGHistogramSubBucketCount) - 1;
+    uint64_t lowest = (uint64_t)(TGHistogramSubBucketCount + (index % TGHistogramSubBucketCount)) << shift;
+    return lowest + ((1ULL << shift) - 1);
+}
+
+static NSString *TGPrometheusLabelValue(NSString *value)
+{
+    value = [value stringByReplacingOccurrencesOfString:@"\\" withString:@"\\\\"];
+    value = [value stringByReplacingOccurrencesOfString:@"\"" withString:@"\\\""];
+    return [value stringByReplacingOccurrencesOfString:@"\n" withString:@"\\n"];
+}
+
+@implementation TGRESTHistogram
+{
+    TGHistogramCounts *_counts;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _counts = calloc(1, sizeof(TGHistogramCounts));
+        atomic_store(&_counts->minimum, UINT64_MAX);
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_counts);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    TGRESTHistogram *copy = [[[self class] allocWithZone:zone] init];
+    for (NSUInteger x = 0; x < TGHistogramBucketCount; x++) {
+        atomic_store_explicit(&copy->_counts->buckets[x], atomic_load_explicit(&_counts->buckets[x], memory_order_relaxed), memory_order_relaxed);
+    }
+    atomic_store(&copy->_counts->count, atomic_load(&_counts->count));
+    atomic_store(&copy->_counts->sum, atomic_load(&_counts->sum));
+    atomic_store(&copy->_counts->minimum, atomic_load(&_counts->minimum));
+    atomic_store(&copy->_counts->maximum, atomic_load(&_counts->maximum));
+    
+    return copy;
+}
+
+- (void)recordValue:(uint64_t)value
+{
+    atomic_fetch_add_explicit(&_counts->buckets[TGHistogramBucketIndex(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_counts->sum, value, memory_order_relaxed);
+    
+    uint64_t minimum = atomic_load_explicit(&_counts->minimum, memory_order_relaxed);
+    while (value < minimum && !atomic_compare_exchange_weak_explicit(&_counts->minimum, &minimum, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    uint64_t maximum = atomic_load_explicit(&_counts->maximum, memory_order_relaxed);
+    while (value > maximum && !atomic_compare_exchange_weak_explicit(&_counts->maximum, &maximum, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    
+    // The count goes last so a reader that sees it also sees the bucket it belongs to.
+    atomic_fetch_add_explicit(&_counts->count, 1, memory_order_release);
+}
+
+- (uint64_t)count
+{
+    return atomic_load_explicit(&_counts->count, memory_order_acquire);
+}
+
+- (uint64_t)sum
+{
+    return atomic_load_explicit(&_counts->sum, memory_order_relaxed);
+}
+
+- (uint64_t)minimum
+{
+    uint64_t minimum = atomic_load_explicit(&_counts->minimum, memory_order_relaxed);
+    return (minimum == UINT64_MAX) ? 0 : minimum;
+}
+
+- (uint64_t)maximum
+{
+    return atomic_load_explicit(&_counts->maximum, memory_order_relaxed);
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile
+{
+    uint64_t count = self.count;
+    if (count == 0) {
+        return 0;
+    }
+    
+    percentile = MIN(MAX(percentile, 0.0), 100.0);
+    uint64_t rank = MAX((uint64_t)ceil((percentile / 100.0) * count), 1);
+    uint64_t seen = 0;
+    for (NSUInteger x = 0; x < TGHistogramBucketCount; x++) {
+        seen = seen + atomic_load_explicit(&_counts->buckets[x], memory_order_relaxed);
+        if (seen >= rank) {
+            return MAX(MIN(TGHistogramHighestValueInBucket(x), self.maximum), self.minimum);
+        }
+    }
+    
+    return self.maximum;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> count %llu p50 %llu p99 %llu max %llu", NSStringFromClass([self class]), self, self.count, [self valueAtPercentile:50], [self valueAtPercentile:99], self.maximum];
+}
+
+@end
+
+@interface TGRESTRouteMetrics ()
+
+@property (nonatomic, copy, readwrite) NSString *resourceName;
+@property (nonatomic, assign, readwrite) TGRESTRouteAction action;
+@property (nonatomic, strong, readwrite) TGRESTHistogram *handlerTime;
+@property (nonatomic, strong, readwrite) TGRESTHistogram *storeTime;
+@property (nonatomic, strong, readwrite) TGRESTHistogram *serializeTime;
+@property (nonatomic, strong, readwrite) TGRESTHistogram *requestBytes;
+@property (nonatomic, strong, readwrite) TGRESTHistogram *responseBytes;
+
+@end
+
+@implementation TGRESTRouteMetrics
+{
+    _Atomic(uint64_t) *_statusCodeCounts;
+}
+
++ (instancetype)metricsWithResourceName:(NSString *)resourceName action:(TGRESTRouteAction)action
+{
+    NSParameterAssert(resourceName);
+    
+    TGRESTRouteMetrics *metrics = [self new];
+    metrics.resourceName = resourceName;
+    metrics.action = action;
+    
+    return metrics;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.handlerTime = [TGRESTHistogram new];
+        self.storeTime = [TGRESTHistogram new];
+        self.serializeTime = [TGRESTHistogram new];
+        self.requestBytes = [TGRESTHistogram new];
+        self.responseBytes = [TGRESTHistogram new];
+        _statusCodeCounts = calloc(TGMetricsStatusCodeLimit, sizeof(_Atomic(uint64_t)));
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_statusCodeCounts);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    TGRESTRouteMetrics *copy = [[[self class] allocWithZone:zone] init];
+    copy.resourceName = self.resourceName;
+    copy.action = self.action;
+    copy.handlerTime = [self.handlerTime copy];
+    copy.storeTime = [self.storeTime copy];
+    copy.serializeTime = [self.serializeTime copy];
+    copy.requestBytes = [self.requestBytes copy];
+    copy.responseBytes = [self.responseBytes copy];
+    for (NSInteger x = 0; x < TGMetricsStatusCodeLimit; x++) {
+        atomic_store_explicit(&copy->_statusCodeCounts[x], atomic_load_explicit(&_statusCodeCounts[x], memory_order_relaxed), memory_order_relaxed);
+    }
+    
+    return copy;
+}
+
+- (void)recordRequestWithHandlerTime:(uint64_t)handlerTime
+                           storeTime:(uint64_t)storeTime
+                       serializeTime:(uint64_t)serializeTime
+                        requestBytes:(NSUInteger)requestBytes
+                       responseBytes:(NSUInteger)responseBytes
+                          statusCode:(NSInteger)statusCode
+{
+    [self.handlerTime recordValue:handlerTime];
+    [self.storeTime recordValue:storeTime];
+    [self.serializeTime recordValue:serializeTime];
+    [self.requestBytes recordValue:requestBytes];
+    if (responseBytes != NSUIntegerMax) {
+        [self.responseBytes recordValue:responseBytes];
+    }
+    if (statusCode >= 0 && statusCode < TGMetricsStatusCodeLimit) {
+        atomic_fetch_add_explicit(&_statusCodeCounts[statusCode], 1, memory_order_relaxed);
+    }
+}
+
+- (uint64_t)countForStatusCode:(NSInteger)statusCode
+{
+    if (statusCode < 0 || statusCode >= TGMetricsStatusCodeLimit) {
+        return 0;
+    }
+    
+    return atomic_load_explicit(&_statusCodeCounts[statusCode], memory_order_relaxed);
+}
+
+- (NSDictionary *)statusCodeCounts
+{
+    NSMutableDictionary *counts = [NSMutableDictionary new];
+    for (NSInteger x = 0; x < TGMetricsStatusCodeLimit; x++) {
+        uint64_t count = [self countForStatusCode:x];
+        if (count > 0) {
+            [counts setObject:@(count) forKey:@(x)];
+        }
+    }
+    
+    return [NSDictionary dictionaryWithDictionary:counts];
+}
+
++ (NSString *)prometheusTextWithMetrics:(NSArray *)metrics
+{
+    NSArray *sortedMetrics = [metrics sortedArrayUsingComparator:^NSComparisonResult(TGRESTRouteMetrics *first, TGRESTRouteMetrics *second) {
+        NSComparisonResult result = [first.resourceName compare:second.resourceName];
+        if (result == NSOrderedSame) {
+            result = [@(first.action) compare:@(second.action)];
+        }
+        return result;
+    }];
+    NSArray *families = @[
+                          @[@"resteasy_handler_seconds", @"handlerTime", @"Time spent handling requests, without simulated latency."],
+                          @[@"resteasy_store_seconds", @"storeTime", @"Time spent in the datastore."],
+                          @[@"resteasy_serialize_seconds", @"serializeTime", @"Time spent decoding request bodies and serializing responses."],
+                          @[@"resteasy_request_bytes", @"requestBytes", @"Size of request bodies."],
+                          @[@"resteasy_response_bytes", @"responseBytes", @"Size of response bodies."]
+                          ];
+    NSArray *quantiles = @[@50, @90, @99, @99.9];
+    NSMutableString *text = [NSMutableString new];
+    
+    for (NSArray *family in families) {
+        NSString *name = family[0];
+        BOOL seconds = [name hasSuffix:@"_seconds"];
+        [text appendFormat:@"# HELP %@ %@\n# TYPE %@ summary\n", name, family[2], name];
+        for (TGRESTRouteMetrics *routeMetrics in sortedMetrics) {
+            TGRESTHistogram *histogram = [routeMetrics valueForKey:family[1]];
+            NSString *labels = [NSString stringWithFormat:@"resource=\"%@\",action=\"%@\"", TGPrometheusLabelValue(routeMetrics.resourceName), TGRESTRouteActionName(routeMetrics.action)];
+            for (NSNumber *quantile in quantiles) {
+                uint64_t value = [histogram valueAtPercentile:quantile.doubleValue];
+                NSString *quantileLabel = [NSString stringWithFormat:@"%g", quantile.doubleValue / 100.0];
+                if (seconds) {
+                    [text appendFormat:@"%@{%@,quantile=\"%@\"} %.9g\n", name, labels, quantileLabel, (double)value / NSEC_PER_SEC];
+                } else {
+                    [text appendFormat:@"%@{%@,quantile=\"%@\"} %llu\n", name, labels, quantileLabel, value];
+                }
+            }
+            if (seconds) {
+                [text appendFormat:@"%@_sum{%@} %.9g\n", name, labels, (double)histogram.sum / NSEC_PER_SEC];
+            } else {
+                [text appendFormat:@"%@_sum{%@} %llu\n", name, labels, histogram.sum];
+            }
+            [text appendFormat:@"%@_count{%@} %llu\n", name, labels, histogram.count];
+        }
+    }
+    
+    [text appendString:@"# HELP resteasy_responses_total Responses by status code.\n# TYPE resteasy_responses_total counter\n"];
+    for (TGRESTRouteMetrics *routeMetrics in sortedMetrics) {
+        NSDictionary *statusCodeCounts = [routeMetrics statusCodeCounts];
+        for (NSNumber *statusCode in [statusCodeCounts.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            [text appendFormat:@"resteasy_responses_total{resource=\"%@\",action=\"%@\",code=\"%@\"} %@\n", TGPrometheusLabelValue(routeMetrics.resourceName), TGRESTRouteActionName(routeMetrics.action), statusCode, statusCodeCounts[statusCode]];
+        }
+    }
+    
+    return text;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> %@ %@ handler %@", NSStringFromClass([self class]), self, self.resourceName, TGRESTRouteActionName(self.action), self.handlerTime];
+}
+
+@end
@@ -0,0 +1,174 @@
+//
+//  TGRESTQuery.h
+//  
+//
+//  Created by John Tumminaro on 5/4/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "TGRESTResource.h"
+
+/**
+ Comparison used by a `TGRESTQueryFilter`.
+ */
+
+typedef NS_ENUM(NSUInteger, TGRESTQueryOperator) {
+    
+    /**
+     Property value is equal to the filter value, `?name=Jane`.
+     */
+    TGRESTQueryOperatorEqual = 1,
+    
+    /**
+     Property value is greater than the filter value, `?age[gt]=30`.
+     */
+    TGRESTQueryOperatorGreaterThan = 2,
+    
+    /**
+     Property value is greater than or equal to the filter value, `?age[gte]=30`.
+     */
+    TGRESTQueryOperatorGreaterThanOrEqual = 3,
+    
+    /**
+     Property value is less than the filter value, `?age[lt]=30`.
+     */
+    TGRESTQueryOperatorLessThan = 4,
+    
+    /**
+     Property value is less than or equal to the filter value, `?age[lte]=30`.
+     */
+    TGRESTQueryOperatorLessThanOrEqual = 5
+};
+
+/**
+ A single condition of a `TGRESTQuery`.  The value has already been converted to match the `TGPropertyType` of the property: an `NSString` for string properties and an `NSNumber` for integer and floating point properties.
+ */
+
+@interface TGRESTQueryFilter : NSObject
+
+/**
+ Name of the model property the filter applies to.
+ */
+
+@property (nonatomic, copy, readonly) NSString *property;
+
+/**
+ The comparison to apply.
+ */
+
+@property (nonatomic, assign, readonly) TGRESTQueryOperator queryOperator;
+
+/**
+ The typed value to compare against.
+ */
+
+@property (nonatomic, strong, readonly) id value;
+
+@end
+
+/**
+ `TGRESTQuery` is the validated form of the filter and sort parameters of an index request.  The default controller builds one from the query string and hands it to the datastore through `-[TGRESTStore getObjectsForResource:matchingQuery:afterPrimaryKey:limit:error:]` so the filtering happens inside the store instead of on the client.
+ 
+ ### Parameters
+ 
+ - `field=value` matches objects whose property equals the value.  Works for string, integer and floating point properties.
+ - `field[gt]=value`, `field[gte]=value`, `field[lt]=value` and `field[lte]=value` compare integer and floating point properties.
+ - `sort=field` orders by the property ascending and `sort=-field` descending.  Without a sort parameter objects are ordered by primary key.
+ 
+ Every field must be a property in the resource model and every value must be valid for the property type, otherwise the query is rejected with a `TGRESTStoreBadRequestErrorCode` error.  Blob and other properties can't be filtered or sorted on.
+ */
+
+@interface TGRESTQuery : NSObject
+
+/**
+ The resource the query was built for.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTResource *resource;
+
+/**
+ Array of `TGRESTQueryFilter` objects that an object must all match, ordered by property name.
+ */
+
+@property (nonatomic, copy, readonly) NSArray *filters;
+
+/**
+ Property the results are ordered by or nil to order by primary key.
+ */
+
+@property (nonatomic, copy, readonly) NSString *sortProperty;
+
+/**
+ `YES` if the results are ordered from the highest to the lowest value of the sort property.
+ */
+
+@property (nonatomic, assign, readonly) BOOL sortDescending;
+
+/**
+ `YES` if the query has neither filters nor a sort property.
+ */
+
+@property (nonatomic, assign, readonly, getter = isEmpty) BOOL empty;
+
+/**
+ `YES` if the results are ordered by ascending primary key which is the only order that can be paged through with an `after` key.
+ */
+
+@property (nonatomic, assign, readonly) BOOL ordersByPrimaryKey;
+
+/**
+ *  Builds a query from request parameters.
+ *
+ *  @param parameters Dictionary of query string keys and values.  Any paging parameters should be removed first.
+ *  @param resource   The resource that is being queried.
+ *  @param error      If a parameter is not valid for the resource on return will contain an error with the `TGRESTStoreBadRequestErrorCode` code.
+ *
+ *  @return A new query or nil if any of the parameters were not valid.
+ */
+
++ (instancetype)queryWithParameters:(NSDictionary *)parameters
+                           resource:(TGRESTResource *)resource
+                              error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Returns a copy of the query with one more filter, for example to restrict a nested index request to the children of a parent.
+ *
+ *  @param property      Name of the model property to filter on.
+ *  @param queryOperator The comparison to apply.
+ *  @param value         Value as it appeared in the request, it will be validated against the property type.
+ *  @param error         If the filter is not valid for the resource on return will contain an error with the `TGRESTStoreBadRequestErrorCode` code.
+ *
+ *  @return A new query or nil if the filter was not valid.
+ */
+
+- (instancetype)queryByAddingFilterForProperty:(NSString *)property
+                                 queryOperator:(TGRESTQueryOperator)queryOperator
+                                         value:(NSString *)value
+                                         error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Evaluates the query against objects in memory in a single typed pass.  This is what `TGRESTStore` and `TGRESTInMemoryStore` use, a store that can run the query natively should do that instead.
+ *
+ *  @param objects  Array of object dictionaries ordered by primary key.
+ *  @param afterKey Only objects with a primary key greater than this key are returned.  Only valid if the query orders by primary key.  Can be nil.
+ *  @param limit    The maximum number of objects to return.  Pass `NSUIntegerMax` for no limit.
+ *
+ *  @return Array of the matching objects in query order.
+ */
+
+- (NSArray *)objectsMatchingQueryInObjects:(NSArray *)objects
+                           afterPrimaryKey:(NSString *)afterKey
+                                     limit:(NSUInteger)limit;
+
+@end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ Query parameter for the sort property of an index request.  Prefix the property name with `-` to sort descending.
+ */
+
+extern NSString * const TGRESTQuerySortKey;
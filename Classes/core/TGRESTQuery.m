@@ -0,0 +1,311 @@
+//
+//  TGRESTQuery.m
+//  
+//
+//  Created by John Tumminaro on 5/4/14.
+//
+//
+
+#import "TGRESTQuery.h"
+#import "TGRESTStore.h"
+
+NSString * const TGRESTQuerySortKey = @"sort";
+
+static NSComparisonResult TGQueryCompareValues(id value, id otherValue, TGPropertyType type)
+{
+    BOOL valueIsNull = (!value || value == [NSNull null]);
+    BOOL otherValueIsNull = (!otherValue || otherValue == [NSNull null]);
+    if (valueIsNull || otherValueIsNull) {
+        // Null sorts before everything else, the same as it does in sqlite.
+        if (valueIsNull && otherValueIsNull) {
+            return NSOrderedSame;
+        }
+        return valueIsNull ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    if (type == TGPropertyTypeInteger) {
+        long long left = [value longLongValue];
+        long long right = [otherValue longLongValue];
+        return (left < right) ? NSOrderedAscending : ((left > right) ? NSOrderedDescending : NSOrderedSame);
+    } else if (type == TGPropertyTypeFloatingPoint) {
+        double left = [value doubleValue];
+        double right = [otherValue doubleValue];
+        return (left < right) ? NSOrderedAscending : ((left > right) ? NSOrderedDescending : NSOrderedSame);
+    } else {
+        return [[value description] compare:[otherValue description]];
+    }
+}
+
+@interface TGRESTQueryFilter ()
+
+@property (nonatomic, copy, readwrite) NSString *property;
+@property (nonatomic, assign, readwrite) TGRESTQueryOperator queryOperator;
+@property (nonatomic, strong, readwrite) id value;
+@property (nonatomic, assign) TGPropertyType propertyType;
+
+@end
+
+@implementation TGRESTQueryFilter
+
+- (BOOL)matchesValue:(id)objectValue
+{
+    // Like a sql comparison, null never matches a filter.
+    if (!objectValue || objectValue == [NSNull null]) {
+        return NO;
+    }
+    if (self.propertyType != TGPropertyTypeString && ![objectValue respondsToSelector:@selector(doubleValue)]) {
+        return NO;
+    }
+    
+    NSComparisonResult result = TGQueryCompareValues(objectValue, self.value, self.propertyType);
+    switch (self.queryOperator) {
+        case TGRESTQueryOperatorEqual:
+            return result == NSOrderedSame;
+        case TGRESTQueryOperatorGreaterThan:
+            return result == NSOrderedDescending;
+        case TGRESTQueryOperatorGreaterThanOrEqual:
+            return result != NSOrderedAscending;
+        case TGRESTQueryOperatorLessThan:
+            return result == NSOrderedAscending;
+        case TGRESTQueryOperatorLessThanOrEqual:
+            return result != NSOrderedDescending;
+    }
+    
+    return NO;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@ %lu %@", self.property, (unsigned long)self.queryOperator, self.value];
+}
+
+@end
+
+@interface TGRESTQuery ()
+
+@property (nonatomic, strong, readwrite) TGRESTResource *resource;
+@property (nonatomic, copy, readwrite) NSArray *filters;
+@property (nonatomic, copy, readwrite) NSString *sortProperty;
+@property (nonatomic, assign, readwrite) BOOL sortDescending;
+
+@end
+
+@implementation TGRESTQuery
+
++ (instancetype)queryWithParameters:(NSDictionary *)parameters
+                           resource:(TGRESTResource *)resource
+                              error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    TGRESTQuery *query = [self new];
+    query.resource = resource;
+    query.filters = @[];
+    
+    NSMutableArray *filters = [NSMutableArray new];
+    for (NSString *key in parameters) {
+        NSString *value = parameters[key];
+        if (![value isKindOfClass:[NSString class]]) {
+            return [self invalidQueryWithReason:[NSString stringWithFormat:@"Query parameter %@ must have a single value", key] error:error];
+        }
+        
+        if ([key isEqualToString:TGRESTQuerySortKey]) {
+            BOOL descending = [value hasPrefix:@"-"];
+            NSString *sortProperty = descending ? [value substringFromIndex:1] : value;
+            TGPropertyType type = [resource.model[sortProperty] integerValue];
+            if (type != TGPropertyTypeString && type != TGPropertyTypeInteger && type != TGPropertyTypeFloatingPoint) {
+                return [self invalidQueryWithReason:[NSString stringWithFormat:@"Resource %@ can't be sorted by %@", resource.name, sortProperty] error:error];
+            }
+            query.sortProperty = sortProperty;
+            query.sortDescending = descending;
+            continue;
+        }
+        
+        NSString *property = key;
+        TGRESTQueryOperator queryOperator = TGRESTQueryOperatorEqual;
+        NSRange bracket = [key rangeOfString:@"["];
+        if (bracket.location != NSNotFound && [key hasSuffix:@"]"]) {
+            NSDictionary *operators = @{@"eq": @(TGRESTQueryOperatorEqual),
+                                        @"gt": @(TGRESTQueryOperatorGreaterThan),
+                                        @"gte": @(TGRESTQueryOperatorGreaterThanOrEqual),
+                                        @"lt": @(TGRESTQueryOperatorLessThan),
+                                        @"lte": @(TGRESTQueryOperatorLessThanOrEqual)};
+            NSString *operatorName = [key substringWithRange:NSMakeRange(bracket.location + 1, key.length - bracket.location - 2)];
+            if (!operators[operatorName]) {
+                return [self invalidQueryWithReason:[NSString stringWithFormat:@"Unknown query operator %@", operatorName] error:error];
+            }
+            property = [key substringToIndex:bracket.location];
+            queryOperator = [operators[operatorName] integerValue];
+        }
+        
+        TGRESTQueryFilter *filter = [self filterForProperty:property queryOperator:queryOperator value:value resource:resource error:error];
+        if (!filter) {
+            return nil;
+        }
+        [filters addObject:filter];
+    }
+    
+    query.filters = [self sortedFilters:filters];
+    
+    return query;
+}
+
+- (instancetype)queryByAddingFilterForProperty:(NSString *)property
+                                 queryOperator:(TGRESTQueryOperator)queryOperator
+                                         value:(NSString *)value
+                                         error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(property);
+    NSParameterAssert(value);
+    
+    TGRESTQueryFilter *filter = [[self class] filterForProperty:property queryOperator:queryOperator value:value resource:self.resource error:error];
+    if (!filter) {
+        return nil;
+    }
+    
+    TGRESTQuery *query = [[self class] new];
+    query.resource = self.resource;
+    query.filters = [[self class] sortedFilters:[self.filters arrayByAddingObject:filter]];
+    query.sortProperty = self.sortProperty;
+    query.sortDescending = self.sortDescending;
+    
+    return query;
+}
+
+- (BOOL)isEmpty
+{
+    return self.filters.count == 0 && !self.sortProperty;
+}
+
+- (BOOL)ordersByPrimaryKey
+{
+    return !self.sortProperty || ([self.sortProperty isEqualToString:self.resource.primaryKey] && !self.sortDescending);
+}
+
+- (NSArray *)objectsMatchingQueryInObjects:(NSArray *)objects
+                           afterPrimaryKey:(NSString *)afterKey
+                                     limit:(NSUInteger)limit
+{
+    NSParameterAssert(objects);
+    
+    NSString *primaryKey = self.resource.primaryKey;
+    TGPropertyType primaryKeyType = self.resource.primaryKeyType;
+    BOOL ordersByPrimaryKey = self.ordersByPrimaryKey;
+    NSArray *filters = self.filters;
+    NSMutableArray *matches = [NSMutableArray new];
+    
+    for (NSDictionary *object in objects) {
+        if ((id)object == [NSNull null]) {
+            continue;
+        }
+        if (afterKey && TGQueryCompareValues(object[primaryKey], afterKey, primaryKeyType) != NSOrderedDescending) {
+            continue;
+        }
+        BOOL matched = YES;
+        for (TGRESTQueryFilter *filter in filters) {
+            if (![filter matchesValue:object[filter.property]]) {
+                matched = NO;
+                break;
+            }
+        }
+        if (!matched) {
+            continue;
+        }
+        [matches addObject:object];
+        // The objects are already in primary key order so there is nothing left to sort once the page is full.
+        if (ordersByPrimaryKey && matches.count >= limit) {
+            break;
+        }
+    }
+    
+    if (ordersByPrimaryKey) {
+        return [NSArray arrayWithArray:matches];
+    }
+    
+    NSString *sortProperty = self.sortProperty;
+    TGPropertyType sortType = [self.resource.model[sortProperty] integerValue];
+    BOOL descending = self.sortDescending;
+    // A stable sort keeps objects with equal values in primary key order.
+    NSArray *sorted = [matches sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary *object, NSDictionary *otherObject) {
+        NSComparisonResult result = TGQueryCompareValues(object[sortProperty], otherObject[sortProperty], sortType);
+        return descending ? -result : result;
+    }];
+    
+    if (sorted.count > limit) {
+        return [sorted subarrayWithRange:NSMakeRange(0, limit)];
+    }
+    
+    return sorted;
+}
+
+#pragma mark - Private
+
++ (TGRESTQueryFilter *)filterForProperty:(NSString *)property
+                           queryOperator:(TGRESTQueryOperator)queryOperator
+                                   value:(NSString *)value
+                                resource:(TGRESTResource *)resource
+                                   error:(NSError * __autoreleasing *)error
+{
+    if (!resource.model[property]) {
+        return [self invalidQueryWithReason:[NSString stringWithFormat:@"Resource %@ has no property %@", resource.name, property] error:error];
+    }
+    
+    TGPropertyType type = [resource.model[property] integerValue];
+    id typedValue;
+    NSScanner *scanner = [NSScanner scannerWithString:value];
+    if (type == TGPropertyTypeString && queryOperator == TGRESTQueryOperatorEqual) {
+        typedValue = value;
+    } else if (type == TGPropertyTypeInteger) {
+        long long integerValue;
+        if ([scanner scanLongLong:&integerValue] && scanner.isAtEnd) {
+            typedValue = [NSNumber numberWithLongLong:integerValue];
+        }
+    } else if (type == TGPropertyTypeFloatingPoint) {
+        double doubleValue;
+        if ([scanner scanDouble:&doubleValue] && scanner.isAtEnd) {
+            typedValue = [NSNumber numberWithDouble:doubleValue];
+        }
+    } else {
+        return [self invalidQueryWithReason:[NSString stringWithFormat:@"Property %@ of resource %@ can't be filtered with that operator", property, resource.name] error:error];
+    }
+    
+    if (!typedValue) {
+        return [self invalidQueryWithReason:[NSString stringWithFormat:@"%@ is not a valid value for property %@ of resource %@", value, property, resource.name] error:error];
+    }
+    
+    TGRESTQueryFilter *filter = [TGRESTQueryFilter new];
+    filter.property = property;
+    filter.queryOperator = queryOperator;
+    filter.value = typedValue;
+    filter.propertyType = type;
+    
+    return filter;
+}
+
++ (NSArray *)sortedFilters:(NSArray *)filters
+{
+    // A stable filter order means the same kind of request always builds the same sql.
+    return [filters sortedArrayUsingComparator:^NSComparisonResult(TGRESTQueryFilter *filter, TGRESTQueryFilter *otherFilter) {
+        NSComparisonResult result = [filter.property compare:otherFilter.property];
+        if (result == NSOrderedSame) {
+            result = [@(filter.queryOperator) compare:@(otherFilter.queryOperator)];
+        }
+        return result;
+    }];
+}
+
++ (id)invalidQueryWithReason:(NSString *)reason error:(NSError * __autoreleasing *)error
+{
+    if (error) {
+        *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:@{NSLocalizedDescriptionKey: reason}];
+    }
+    
+    return nil;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %@ filters %@ sort %@%@>", NSStringFromClass([self class]), self.resource.name, self.filters, self.sortDescending ? @"-" : @"", self.sortProperty ?: self.resource.primaryKey];
+}
+
+@end
@@ -125,6 +125,12 @@ typedef NS_OPTIONS(NSUInteger, TGResourceRESTActions) {
 
 @property (nonatomic, copy, readonly) NSDictionary *foreignKeys;
 
+/**
+ Array of property names that the datastore keeps secondary indexes for so that queries filtering on them don't have to scan every object.  The primary key and foreign keys are always indexed and don't need to be listed.  Adding or removing indexed properties never changes the stored data.
+ */
+
+@property (nonatomic, copy, readonly) NSArray *indexedProperties;
+
 /**
  Bitmask of REST verbs enabled for this resource.
  */
@@ -178,7 +184,7 @@ typedef NS_OPTIONS(NSUInteger, TGResourceRESTActions) {
                     parentResources:(NSArray *)parents;
 
 /**
- *  Designated constructor for this class, includes the ability to set explict primary keys for parent resources.
+ *  Constructor that includes the ability to set explict primary keys for parent resources.
  *
  *  @param name    Name of the resource, must be unique on the server you are adding it to.
  *  @param model   Keys representing property names and values that must be boxed values of `TGPropertyType`.
@@ -197,4 +203,26 @@ typedef NS_OPTIONS(NSUInteger, TGResourceRESTActions) {
                     parentResources:(NSArray *)parents
                         foreignKeys:(NSDictionary *)fkeys;
 
+/**
+ *  Designated constructor for this class, includes the ability to declare indexed properties along with everything from the other constructors.
+ *
+ *  @param name    Name of the resource, must be unique on the server you are adding it to.
+ *  @param model   Keys representing property names and values that must be boxed values of `TGPropertyType`.
+ *  @param actions `TGResourceRESTActions` bitmask of enabled HTTP verbs.
+ *  @param key     Custom name for the primary key of the resource.  Note that if you explictly set a primary key it MUST be defined in the model or else an exception will be thrown.  Can be nil.
+ *  @param parents Array of objects of `TGRESTResource` type.  For each parent resource added routes will be generated to this resource using shallow nesting (Create, Index actions only) and a foreign key will be added to the model with the default value of "parent_name_id".  Can be nil.
+ *  @param fkeys   Dictionary of explict foreign keys with the keys being the name of the parent resource and the values being the desired foreign key to be used.  Can be nil.
+ *  @param indexes Array of property names to keep secondary indexes for.  Every property must be in the model and be of `TGPropertyTypeString`, `TGPropertyTypeInteger` or `TGPropertyTypeFloatingPoint` type or else an exception will be thrown.  Can be nil.
+ *
+ *  @return A new instance of `TGRESTResource`.
+ */
+
++ (instancetype)newResourceWithName:(NSString *)name
+                              model:(NSDictionary *)model
+                            actions:(TGResourceRESTActions)actions
+                         primaryKey:(NSString *)key
+                    parentResources:(NSArray *)parents
+                        foreignKeys:(NSDictionary *)fkeys
+                  indexedProperties:(NSArray *)indexes;
+
 @end
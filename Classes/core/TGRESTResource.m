@@ -19,6 +19,7 @@
 @property (nonatomic, copy, readwrite) NSArray *parentResources;
 @property (nonatomic, copy, readwrite) NSArray *childResources;
 @property (nonatomic, copy, readwrite) NSDictionary *foreignKeys;
+@property (nonatomic, copy, readwrite) NSArray *indexedProperties;
 @property (nonatomic, assign, readwrite) TGPropertyType primaryKeyType;
 @property (nonatomic, assign, readwrite) TGResourceRESTActions actions;
 
@@ -37,6 +38,7 @@
         self.primaryKey = @"id";
         self.parentResources = @[];
         self.foreignKeys = @{};
+        self.indexedProperties = @[];
         self.primaryKeyType = TGPropertyTypeInteger;
         self.actions = TGResourceRESTActionsGET;
     }
@@ -88,6 +90,23 @@
                          primaryKey:(NSString *)key
                     parentResources:(NSArray *)parents
                         foreignKeys:(NSDictionary *)fkeys
+{
+    return [self newResourceWithName:name
+                               model:model
+                             actions:actions
+                          primaryKey:key
+                     parentResources:parents
+                         foreignKeys:fkeys
+                   indexedProperties:nil];
+}
+
++ (instancetype)newResourceWithName:(NSString *)name
+                              model:(NSDictionary *)model
+                            actions:(TGResourceRESTActions)actions
+                         primaryKey:(NSString *)key
+                    parentResources:(NSArray *)parents
+                        foreignKeys:(NSDictionary *)fkeys
+                  indexedProperties:(NSArray *)indexes
 {
     NSParameterAssert(name);
     NSParameterAssert(model);
@@ -197,6 +216,23 @@
     resource.primaryKeyType = [resource.model[resource.primaryKey] integerValue];
     resource.foreignKeys = [NSDictionary dictionaryWithDictionary:foreignKeyBuilder];
     
+    NSMutableArray *validIndexes = [NSMutableArray new];
+    for (NSString *indexedProperty in indexes) {
+        TGPropertyType indexedType = [resource.model[indexedProperty] integerValue];
+        if (!resource.model[indexedProperty]) {
+            @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                           reason:[NSString stringWithFormat:@"Indexed property %@ not found in model", indexedProperty]
+                                         userInfo:nil];
+        } else if (indexedType != TGPropertyTypeString && indexedType != TGPropertyTypeInteger && indexedType != TGPropertyTypeFloatingPoint) {
+            @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                           reason:[NSString stringWithFormat:@"Indexed property %@ must be of text, integer or floating point type", indexedProperty]
+                                         userInfo:nil];
+        } else if (![indexedProperty isEqualToString:resource.primaryKey] && ![resource.foreignKeys.allValues containsObject:indexedProperty] && ![validIndexes containsObject:indexedProperty]) {
+            [validIndexes addObject:indexedProperty];
+        }
+    }
+    resource.indexedProperties = [validIndexes sortedArrayUsingSelector:@selector(compare:)];
+    
     for (TGRESTResource *parentResource in resource.parentResources) {
         NSMutableArray *newChildren = [NSMutableArray arrayWithArray:parentResource.childResources];
         [newChildren addObject:resource];
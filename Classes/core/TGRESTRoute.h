@@ -0,0 +1,103 @@
+//
+//  TGRESTRoute.h
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import <GCDWebServer/GCDWebServerDataRequest.h>
+
+@class TGRESTResource;
+
+/**
+ The RESTful actions a route can lead to.  `TGRESTRouteActionBatch` is never routed to, it only labels the metrics of the `/_batch` endpoint.
+ */
+
+typedef NS_ENUM(NSUInteger, TGRESTRouteAction) {
+    TGRESTRouteActionIndex,
+    TGRESTRouteActionShow,
+    TGRESTRouteActionCreate,
+    TGRESTRouteActionUpdate,
+    TGRESTRouteActionDestroy,
+    TGRESTRouteActionBatch
+};
+
+/**
+ *  The lowercase name of a route action, for example `index` or `destroy`.
+ *
+ *  @param action The route action.
+ *
+ *  @return Name of the action.
+ */
+
+extern NSString * TGRESTRouteActionName(TGRESTRouteAction action);
+
+/**
+ `TGRESTRoute` is what the server found when it matched the method and path of a request: the resource and action it leads to, and the primary keys that were captured from the path.  Controllers should use these instead of taking the URL apart again.
+ 
+ - `GET /people` is the index action of people.
+ - `GET /people/1`, `PUT /people/1` and `DELETE /people/1` are the show, update and destroy actions with a `primaryKey` of `1`.
+ - `GET /people/1/emails` and `POST /people/1/emails` are the index and create actions of emails with people as the `parentResource` and a `parentPrimaryKey` of `1`.
+ */
+
+@interface TGRESTRoute : NSObject
+
+@property (nonatomic, assign, readonly) TGRESTRouteAction action;
+@property (nonatomic, strong, readonly) TGRESTResource *resource;
+
+/**
+ The parent resource of a nested index or create route, nil otherwise.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTResource *parentResource;
+
+/**
+ The primary key of the parent object of a nested index or create route, nil otherwise.
+ */
+
+@property (nonatomic, copy, readonly) NSString *parentPrimaryKey;
+
+/**
+ The primary key of the object of a show, update or destroy route, nil otherwise.
+ */
+
+@property (nonatomic, copy, readonly) NSString *primaryKey;
+
++ (instancetype)routeWithAction:(TGRESTRouteAction)action
+                       resource:(TGRESTResource *)resource
+                 parentResource:(TGRESTResource *)parentResource
+               parentPrimaryKey:(NSString *)parentPrimaryKey
+                     primaryKey:(NSString *)primaryKey;
+
+@end
+
+/**
+ Every request the server hands to a controller is a `TGRESTRouteRequest`, a `GCDWebServerDataRequest` that also carries the route it was matched to.  Requests without a body simply have no data, and batch requests have no route.
+ */
+
+@interface TGRESTRouteRequest : GCDWebServerDataRequest
+
+@property (nonatomic, strong, readonly) TGRESTRoute *route;
+
+/**
+ Nanoseconds spent in the datastore while handling the request.  Controllers add to it so the server can report it in its metrics.
+ */
+
+@property (nonatomic, assign) uint64_t storeTime;
+
+/**
+ Nanoseconds spent decoding the request body and serializing the response while handling the request.  Controllers add to it so the server can report it in its metrics.
+ */
+
+@property (nonatomic, assign) uint64_t serializeTime;
+
+- (instancetype)initWithMethod:(NSString *)method
+                           url:(NSURL *)url
+                       headers:(NSDictionary *)headers
+                          path:(NSString *)path
+                         query:(NSDictionary *)query
+                         route:(TGRESTRoute *)route;
+
+@end
@@ -0,0 +1,92 @@
+//
+//  TGRESTRoute.m
+//  
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import "TGRESTRoute.h"
+#import "TGRESTResource.h"
+
+NSString *TGRESTRouteActionName(TGRESTRouteAction action)
+{
+    switch (action) {
+        case TGRESTRouteActionIndex:
+            return @"index";
+        case TGRESTRouteActionShow:
+            return @"show";
+        case TGRESTRouteActionCreate:
+            return @"create";
+        case TGRESTRouteActionUpdate:
+            return @"update";
+        case TGRESTRouteActionDestroy:
+            return @"destroy";
+        case TGRESTRouteActionBatch:
+            return @"batch";
+        default:
+            return @"unknown";
+    }
+}
+
+@interface TGRESTRoute ()
+
+@property (nonatomic, assign, readwrite) TGRESTRouteAction action;
+@property (nonatomic, strong, readwrite) TGRESTResource *resource;
+@property (nonatomic, strong, readwrite) TGRESTResource *parentResource;
+@property (nonatomic, copy, readwrite) NSString *parentPrimaryKey;
+@property (nonatomic, copy, readwrite) NSString *primaryKey;
+
+@end
+
+@implementation TGRESTRoute
+
++ (instancetype)routeWithAction:(TGRESTRouteAction)action
+                       resource:(TGRESTResource *)resource
+                 parentResource:(TGRESTResource *)parentResource
+               parentPrimaryKey:(NSString *)parentPrimaryKey
+                     primaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(resource);
+    
+    TGRESTRoute *route = [self new];
+    route.action = action;
+    route.resource = resource;
+    route.parentResource = parentResource;
+    route.parentPrimaryKey = parentPrimaryKey;
+    route.primaryKey = primaryKey;
+    
+    return route;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %@ %@ parent %@ %@ key %@>", NSStringFromClass([self class]), TGRESTRouteActionName(self.action), self.resource.name, self.parentResource.name, self.parentPrimaryKey, self.primaryKey];
+}
+
+@end
+
+@interface TGRESTRouteRequest ()
+
+@property (nonatomic, strong, readwrite) TGRESTRoute *route;
+
+@end
+
+@implementation TGRESTRouteRequest
+
+- (instancetype)initWithMethod:(NSString *)method
+                           url:(NSURL *)url
+                       headers:(NSDictionary *)headers
+                          path:(NSString *)path
+                         query:(NSDictionary *)query
+                         route:(TGRESTRoute *)route
+{
+    self = [super initWithMethod:method url:url headers:headers path:path query:query];
+    if (self) {
+        self.route = route;
+    }
+    
+    return self;
+}
+
+@end
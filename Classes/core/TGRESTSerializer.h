@@ -57,7 +57,7 @@
 + (id)dataWithCollection:(NSArray *)collection resource:(TGRESTResource *)resource;
 
 /**
- *  Used for deserialization of parameters of a request for a Create or Update operation.  By default the controller assumes that the property names in the request need to exactly match the property names of the object they are trying to Create or Update but if you want to change the representation then you can do it here.  This is called AFTER the request properties have been converted from JSON or FormURL encoding to an dictionary of properties but BEFORE the controller applies parameter sanitization.
+ *  Used for deserialization of parameters of a request for a Create or Update operation.  By default the controller assumes that the property names in the request need to exactly match the property names of the object they are trying to Create or Update but if you want to change the representation then you can do it here.  This is called AFTER the request properties have been converted from JSON or FormURL encoding to an dictionary of properties but BEFORE the controller applies parameter sanitization.  Resources formatted by `TGRESTDefaultSerializer` skip this step entirely and have their request bodies decoded by a `TGRESTBodyDecoder`.
  *
  *  @param body     A dictionary representing the parameter keys and values in the request.
  *  @param resource The resource that this action is be used on.
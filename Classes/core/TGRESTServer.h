@@ -8,10 +8,14 @@
 
 #import <Foundation/Foundation.h>
 #import "TGRESTSerializer.h"
+#import "TGRESTRoute.h"
 
 @class TGRESTStore;
 @class TGRESTResource;
 @class TGRESTSerializer;
+@class TGRESTBodyDecoder;
+@class TGRESTLatencyProfile;
+@class TGRESTRouteMetrics;
 
 /**
  *  Options for setting the logging level.
@@ -159,6 +163,32 @@ typedef NS_OPTIONS(NSUInteger, TGRESTServerLogLevel) {
 
 - (void)addData:(NSArray *)data forResource:(TGRESTResource *)resource;
 
+/**
+ *  Load a JSON file into the server without parsing the whole file into memory first.  The file is memory mapped and can either be a single JSON array of objects or newline delimited JSON with one object per line, which is detected from the first character.  The file is cut into chunks that are parsed and normalized against the resource model on every core, and the objects go into the datastore through its bulk insert in the order they appear in the file, so memory use stays bounded no matter how large the file is.  Keys that aren't in the resource model are dropped the same way as with `-addData:forResource:`.
+ *
+ *  Chunks are inserted as soon as they are parsed, so a load is not rolled back when the file turns out to be malformed partway through (or an insert fails).  The objects ahead of the bad chunk stay in the datastore, and how many were loaded is logged either way.
+ *
+ *  @param path     Path of the JSON or newline delimited JSON file.
+ *  @param resource Resource that is a representation of the data you are loading, it must already be added to the server.
+ *  @param error    If the file can't be read or is malformed on return will contain an error, malformed JSON has the `TGRESTStoreBadRequestErrorCode` code.
+ *
+ *  @return YES if every object in the file was loaded.
+ */
+
+- (BOOL)loadDataFromFileAtPath:(NSString *)path forResource:(TGRESTResource *)resource error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Same as `-loadDataFromFileAtPath:forResource:error:` but for a buffer that is already in memory or mapped.
+ *
+ *  @param data     Buffer holding a JSON array of objects or newline delimited JSON.
+ *  @param resource Resource that is a representation of the data you are loading, it must already be added to the server.
+ *  @param error    If the buffer is malformed on return will contain an error with the `TGRESTStoreBadRequestErrorCode` code.
+ *
+ *  @return YES if every object in the buffer was loaded.  On NO the objects ahead of the error are left loaded, as with a file.
+ */
+
+- (BOOL)loadDataFromJSONData:(NSData *)data forResource:(TGRESTResource *)resource error:(NSError * __autoreleasing *)error;
+
 ///--------------------------------
 /// @name Managing server resources
 ///--------------------------------
@@ -204,6 +234,51 @@ typedef NS_OPTIONS(NSUInteger, TGRESTServerLogLevel) {
 
 - (void)removeAllResourcesWithData:(BOOL)removeData;
 
+///--------------
+/// @name Metrics
+///--------------
+
+/**
+ *  A snapshot of the metrics of an action of a resource.  Every request a resource route handles is measured, the metrics start over when the server is started and are removed along with the resource.
+ *
+ *  @param resource Resource to get the metrics for.
+ *  @param action   Route action to get the metrics for.
+ *
+ *  @return Metrics or nil if the action hasn't handled a request yet.
+ */
+
+- (TGRESTRouteMetrics *)metricsForResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action;
+
+/**
+ *  A snapshot of the metrics of the `/_batch` endpoint, which are reported with a resource name of `_batch` and the `TGRESTRouteActionBatch` action.  The store and serialize times cover every operation of a batch.
+ *
+ *  @return Metrics or nil if no batch has been handled yet.
+ */
+
+- (TGRESTRouteMetrics *)batchMetrics;
+
+/**
+ *  Snapshots of the metrics of every route that has handled a request.
+ *
+ *  @return Array of TGRESTRouteMetrics.
+ */
+
+- (NSArray *)allRouteMetrics;
+
+/**
+ *  The metrics of every route in the Prometheus text exposition format, which is also what the `/_metrics` endpoint returns when it is turned on with `TGRESTServerMetricsEndpointOptionKey`.
+ *
+ *  @return Metrics as text.
+ */
+
+- (NSString *)prometheusMetrics;
+
+/**
+ *  Throws away the metrics collected so far.
+ */
+
+- (void)resetMetrics;
+
 ///-----------------------------
 /// @name Advanced configuration
 ///-----------------------------
@@ -232,6 +307,16 @@ typedef NS_OPTIONS(NSUInteger, TGRESTServerLogLevel) {
 
 - (NSDictionary *)serializers;
 
+/**
+ *  The body decoder compiled for a resource when it was added to the server.
+ *
+ *  @param resource The resource to get the decoder for.
+ *
+ *  @return The decoder or nil if the resource has not been added.
+ */
+
+- (TGRESTBodyDecoder *)bodyDecoderForResource:(TGRESTResource *)resource;
+
 /**
  *  Sets a custom serializer class for the given resource.
  *
@@ -249,6 +334,36 @@ typedef NS_OPTIONS(NSUInteger, TGRESTServerLogLevel) {
 
 - (void)removeCustomSerializerForResource:(TGRESTResource *)resource;
 
+/**
+ *  Sets the latency profile for every route of a resource, overriding the server wide profile from the start options.  Responses are held back without blocking a thread, so high latencies can be simulated for many concurrent clients.  Profiles are removed along with the resource.
+ *
+ *  @param profile  Latency profile to use, or nil to go back to the server wide profile.
+ *  @param resource Resource to set the profile for.
+ */
+
+- (void)setLatencyProfile:(TGRESTLatencyProfile *)profile forResource:(TGRESTResource *)resource;
+
+/**
+ *  Sets the latency profile for a single action of a resource, which takes precedence over the profile of the resource and the server wide profile.  Useful when for example writes should be slower than reads.
+ *
+ *  @param profile  Latency profile to use, or nil to go back to the profile of the resource.
+ *  @param resource Resource to set the profile for.
+ *  @param action   Route action to set the profile for.
+ */
+
+- (void)setLatencyProfile:(TGRESTLatencyProfile *)profile forResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action;
+
+/**
+ *  The latency profile that is used for an action of a resource, which is the profile of the action if one is set, otherwise the profile of the resource and otherwise the server wide profile.
+ *
+ *  @param resource Resource to get the profile for.
+ *  @param action   Route action to get the profile for.
+ *
+ *  @return The latency profile or nil if responses are not delayed.
+ */
+
+- (TGRESTLatencyProfile *)latencyProfileForResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action;
+
 @end
 
 ///----------------
@@ -267,12 +382,24 @@ extern NSString * const TGLatencyRangeMinimumOptionKey;
 
 extern NSString * const TGLatencyRangeMaximumOptionKey;
 
+/**
+ Option key for the -startServerWithOptions: dictionary which sets a TGRESTLatencyProfile used for every response that doesn't have a resource or action profile.  Takes precedence over TGLatencyRangeMinimumOptionKey and TGLatencyRangeMaximumOptionKey.  Default is a uniform profile between the latency minimum and maximum, or no latency if they are not set.
+ */
+
+extern NSString * const TGRESTServerLatencyProfileOptionKey;
+
 /**
  Option key for the -startServerWithOptions: dictionary which sets the port number.  Default is 8888.
  */
 
 extern NSString * const TGWebServerPortNumberOptionKey;
 
+/**
+ Option key for the -startServerWithOptions: dictionary which turns on a `GET /_metrics` endpoint with the metrics of every route in the Prometheus text format.  It takes precedence over a resource named `_metrics`.  Default is NO.
+ */
+
+extern NSString * const TGRESTServerMetricsEndpointOptionKey;
+
 /**
  Option key for the -startServerWithOptions: dictionary which sets the datastore class you want the server to use.  Default is TGRESTInMemoryStore.
  */
@@ -18,19 +18,21 @@
 #import "TGRESTEasyLogging.h"
 #import "TGRESTDefaultController.h"
 #import "TGRESTDefaultSerializer.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTJSONEncoder.h"
+#import "TGRESTBodyDecoder.h"
+#import "TGRESTFixtureLoader.h"
+#import "TGRESTRoute.h"
+#import "TGRESTRouter.h"
+#import "TGRESTLatencyProfile.h"
+#import "TGRESTMetrics.h"
 #import "TGStopwatch.h"
 
-typedef NS_ENUM(NSUInteger, TGControllerAction) {
-    TGControllerActionIndex,
-    TGControllerActionShow,
-    TGControllerActionCreate,
-    TGControllerActionUpdate,
-    TGControllerActionDestroy
-};
-
 NSString * const TGLatencyRangeMinimumOptionKey = @"TGLatencyRangeMinimumOptionKey";
 NSString * const TGLatencyRangeMaximumOptionKey = @"TGLatencyRangeMaximumOptionKey";
+NSString * const TGRESTServerLatencyProfileOptionKey = @"TGRESTServerLatencyProfileOptionKey";
 NSString * const TGWebServerPortNumberOptionKey = @"TGWebServerPortNumberOptionKey";
+NSString * const TGRESTServerMetricsEndpointOptionKey = @"TGRESTServerMetricsEndpointOptionKey";
 NSString * const TGRESTServerDatastoreClassOptionKey = @"TGRESTServerDatastoreClassOptionKey";
 NSString * const TGRESTServerControllerClassOptionKey = @"TGRESTServerControllerClassOptionKey";
 NSString * const TGRESTServerDefaultSerializerClassOptionKey = @"TGRESTServerDefaultSerializerClassOptionKey";
@@ -38,18 +40,34 @@ NSString * const TGRESTServerDefaultSerializerClassOptionKey = @"TGRESTServerDef
 NSString * const TGRESTServerDidStartNotification = @"TGRESTServerDidStartNotification";
 NSString * const TGRESTServerDidShutdownNotification = @"TGRESTServerDidShutdownNotification";
 
+static NSString * const TGRESTServerMetricsPath = @"/_metrics";
+static NSString * const TGRESTServerBatchPath = @"/_batch";
+static NSString * const TGRESTServerBatchMetricsName = @"_batch";
+
 static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
 
+static NSString *TGRouteKey(NSString *resourceName, TGRESTRouteAction action)
+{
+    return [NSString stringWithFormat:@"%@/%lu", resourceName, (unsigned long)action];
+}
+
 @interface TGRESTServer () <GCDWebServerDelegate>
 
 @property (nonatomic, strong) GCDWebServer *webServer;
+@property (nonatomic, strong) TGRESTRouter *router;
 @property (nonatomic, assign) CGFloat latencyMin;
 @property (nonatomic, assign) CGFloat latencyMax;
+@property (atomic, strong) TGRESTLatencyProfile *defaultLatencyProfile;
+@property (atomic, copy) NSDictionary *latencyProfiles;
+@property (nonatomic, strong) dispatch_queue_t latencyQueue;
+@property (atomic, copy) NSDictionary *routeMetrics;
+@property (atomic, assign) BOOL metricsEndpointEnabled;
 @property (nonatomic, strong) NSMutableDictionary *resources;
 @property (nonatomic, strong, readwrite) TGRESTStore *datastore;
 @property (nonatomic, copy, readwrite) NSString *serverName;
 @property (nonatomic, copy) NSDictionary *lastOptions;
 @property (nonatomic, strong) NSMutableDictionary *resourceSerializers;
+@property (nonatomic, strong) NSMutableDictionary *bodyDecoders;
 @property (nonatomic, strong, readwrite) Class<TGRESTSerializer> defaultSerializer;
 @end
 
@@ -82,18 +100,119 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     self = [super init];
     if (self) {
         self.webServer = [[GCDWebServer alloc] init];
+        self.router = [TGRESTRouter new];
         self.resources = [NSMutableDictionary new];
         self.datastore = [TGRESTInMemoryStore new];
         self.datastore.server = self;
         self.serverName = @"";
         self.resourceSerializers = [NSMutableDictionary new];
+        self.bodyDecoders = [NSMutableDictionary new];
         self.defaultSerializer = [TGRESTDefaultSerializer class];
-        srand48(time(0));
+        self.latencyProfiles = @{};
+        self.routeMetrics = @{};
+        self.latencyQueue = dispatch_queue_create("com.tinylittlegears.resteasy.latency", DISPATCH_QUEUE_CONCURRENT);
+        [self addRouteHandler];
+        [self addMetricsHandler];
+        [self addBatchHandler];
     }
     
     return self;
 }
 
+- (void)addRouteHandler
+{
+    // One handler owns every resource route, GCDWebServer would otherwise try a regex per action of every resource in turn.
+    TGRESTRouter *router = self.router;
+    __weak typeof(self) weakSelf = self;
+    
+    [self.webServer addHandlerWithMatchBlock:^GCDWebServerRequest *(NSString *requestMethod, NSURL *requestURL, NSDictionary *requestHeaders, NSString *urlPath, NSDictionary *urlQuery) {
+        TGRESTRoute *route = [router routeForMethod:requestMethod path:urlPath];
+        if (!route) {
+            return nil;
+        }
+        return [[TGRESTRouteRequest alloc] initWithMethod:requestMethod url:requestURL headers:requestHeaders path:urlPath query:urlQuery route:route];
+    } asyncProcessBlock:^(GCDWebServerRequest *request, GCDWebServerCompletionBlock completionBlock) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        TGRESTRouteRequest *routeRequest = (TGRESTRouteRequest *)request;
+        TGRESTRoute *route = routeRequest.route;
+        TGStopwatch *stopwatch = [TGStopwatch new];
+        [stopwatch start];
+        NSTimeInterval latency = [[strongSelf latencyProfileForResource:route.resource action:route.action] nextLatency];
+        GCDWebServerResponse *response = [strongSelf controllerAction:route.action withRequest:request withResource:route.resource];
+        [stopwatch stop];
+        
+        [[strongSelf liveMetricsForResourceName:route.resource.name action:route.action] recordRequestWithHandlerTime:[stopwatch recordedNanoseconds]
+                                                                                                           storeTime:routeRequest.storeTime
+                                                                                                       serializeTime:routeRequest.serializeTime
+                                                                                                        requestBytes:routeRequest.data.length
+                                                                                                       responseBytes:response.contentLength
+                                                                                                          statusCode:response.statusCode];
+        
+        // The rest of the latency is waited out on a timer instead of on this thread, so slow responses don't use up the workers.
+        NSTimeInterval remaining = latency - [stopwatch recordedTime];
+        if (remaining <= 0) {
+            completionBlock(response);
+            return;
+        }
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(remaining * NSEC_PER_SEC)), strongSelf.latencyQueue, ^{
+            completionBlock(response);
+        });
+    }];
+}
+
+- (void)addMetricsHandler
+{
+    __weak typeof(self) weakSelf = self;
+    
+    [self.webServer addHandlerWithMatchBlock:^GCDWebServerRequest *(NSString *requestMethod, NSURL *requestURL, NSDictionary *requestHeaders, NSString *urlPath, NSDictionary *urlQuery) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf.metricsEndpointEnabled || ![requestMethod isEqualToString:@"GET"] || ![urlPath isEqualToString:TGRESTServerMetricsPath]) {
+            return nil;
+        }
+        return [[GCDWebServerRequest alloc] initWithMethod:requestMethod url:requestURL headers:requestHeaders path:urlPath query:urlQuery];
+    } processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        return [GCDWebServerDataResponse responseWithData:[[strongSelf prometheusMetrics] dataUsingEncoding:NSUTF8StringEncoding] contentType:@"text/plain; version=0.0.4; charset=utf-8"];
+    }];
+}
+
+- (void)addBatchHandler
+{
+    __weak typeof(self) weakSelf = self;
+    
+    [self.webServer addHandlerWithMatchBlock:^GCDWebServerRequest *(NSString *requestMethod, NSURL *requestURL, NSDictionary *requestHeaders, NSString *urlPath, NSDictionary *urlQuery) {
+        if (![requestMethod isEqualToString:@"POST"] || ![urlPath isEqualToString:TGRESTServerBatchPath]) {
+            return nil;
+        }
+        return [[TGRESTRouteRequest alloc] initWithMethod:requestMethod url:requestURL headers:requestHeaders path:urlPath query:urlQuery route:nil];
+    } asyncProcessBlock:^(GCDWebServerRequest *request, GCDWebServerCompletionBlock completionBlock) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        TGRESTRouteRequest *batchRequest = (TGRESTRouteRequest *)request;
+        TGStopwatch *stopwatch = [TGStopwatch new];
+        [stopwatch start];
+        // A batch is one round trip so it waits out the default latency once rather than once per operation.
+        NSTimeInterval latency = [strongSelf.defaultLatencyProfile nextLatency];
+        GCDWebServerResponse *response = [TGRESTDefaultController batchWithRequest:request usingServer:strongSelf];
+        [stopwatch stop];
+        
+        [[strongSelf liveMetricsForResourceName:TGRESTServerBatchMetricsName action:TGRESTRouteActionBatch] recordRequestWithHandlerTime:[stopwatch recordedNanoseconds]
+                                                                                                                             storeTime:batchRequest.storeTime
+                                                                                                                         serializeTime:batchRequest.serializeTime
+                                                                                                                          requestBytes:batchRequest.data.length
+                                                                                                                         responseBytes:response.contentLength
+                                                                                                                            statusCode:response.statusCode];
+        
+        NSTimeInterval remaining = latency - [stopwatch recordedTime];
+        if (remaining <= 0) {
+            completionBlock(response);
+            return;
+        }
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(remaining * NSEC_PER_SEC)), strongSelf.latencyQueue, ^{
+            completionBlock(response);
+        });
+    }];
+}
+
 #pragma mark - Class logging methods
 
 + (TGRESTServerLogLevel)logLevel
@@ -147,9 +266,12 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     }
     
     self.datastore.server = self;
+    [self.datastore configureWithOptions:options];
     [self addResourcesWithArray:[self.resources allValues]];
     
     [options[TGWebServerPortNumberOptionKey] integerValue];
+    [self resetMetrics];
+    self.metricsEndpointEnabled = [options[TGRESTServerMetricsEndpointOptionKey] boolValue];
     self.latencyMin = [options[TGLatencyRangeMinimumOptionKey] doubleValue];
     self.latencyMax = [options[TGLatencyRangeMaximumOptionKey] doubleValue];
     
@@ -157,10 +279,12 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
         self.latencyMax = self.latencyMin;
     }
     
-    if (self.latencyMin > 0.0f || self.latencyMax > 0.0f) {
-        NSArray *resources = [self.resources allValues];
-        [self removeAllResourcesWithData:NO];
-        [self addResourcesWithArray:resources];
+    if (options[TGRESTServerLatencyProfileOptionKey]) {
+        self.defaultLatencyProfile = options[TGRESTServerLatencyProfileOptionKey];
+    } else if (self.latencyMax > 0.0f) {
+        self.defaultLatencyProfile = [TGRESTLatencyProfile uniformProfileWithMinimum:self.latencyMin maximum:self.latencyMax];
+    } else {
+        self.defaultLatencyProfile = nil;
     }
     
     NSMutableDictionary *serverOptionsDict = [NSMutableDictionary new];
@@ -195,6 +319,8 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
         [status appendFormat:@"Server Port:         %lu\n", (unsigned long)self.webServer.port];
         [status appendFormat:@"Server Latency Min:  %.2f sec\n", self.latencyMin];
         [status appendFormat:@"Server Latency Max:  %.2f sec\n", self.latencyMax];
+        [status appendFormat:@"Latency Profile:     %@\n", self.defaultLatencyProfile];
+        [status appendFormat:@"Metrics Endpoint:    %@\n", self.metricsEndpointEnabled ? TGRESTServerMetricsPath : @"off"];
         [status appendFormat:@"Store:               %@\n", self.datastore];
         [status appendFormat:@"------------------------------------ \n"];
         
@@ -210,7 +336,6 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
 - (void)stopServer
 {
     [self.webServer stop];
-    [self.webServer removeAllHandlers];
     self.datastore = nil;
     [[NSNotificationCenter defaultCenter] postNotificationName:TGRESTServerDidShutdownNotification object:self];
 }
@@ -246,65 +371,12 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     
     if (self.datastore) {
         [self.datastore addResource:resource];
+        [self.datastore.fragmentCache setEncoder:[TGRESTJSONEncoder encoderWithResource:resource] forResource:resource];
     }
     [self.resources setObject:resource forKey:resource.name];
+    [self.bodyDecoders setObject:[TGRESTBodyDecoder decoderWithResource:resource] forKey:resource.name];
     
-    if (resource.actions & TGResourceRESTActionsGET) {
-        __weak typeof(self) weakSelf = self;
-        
-        [self.webServer addHandlerForMethod:@"GET"
-                                  pathRegex:TGIndexRegex(resource)
-                               requestClass:[GCDWebServerRequest class]
-                               processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
-                                   __strong typeof(weakSelf) strongSelf = weakSelf;
-                                   return [strongSelf controllerAction:TGControllerActionIndex withRequest:request withResource:resource];
-                               }];
-        
-        [self.webServer addHandlerForMethod:@"GET"
-                                  pathRegex:TGShowRegex(resource)
-                               requestClass:[GCDWebServerRequest class]
-                               processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
-                                   __strong typeof(weakSelf) strongSelf = weakSelf;
-                                   return [strongSelf controllerAction:TGControllerActionShow withRequest:request withResource:resource];
-                               }];
-    }
-    
-    if (resource.actions & TGResourceRESTActionsPOST) {
-        __weak typeof(self) weakSelf = self;
-        
-        [self.webServer addHandlerForMethod:@"POST"
-                                  pathRegex:TGCreateRegex(resource)
-                               requestClass:[GCDWebServerDataRequest class]
-                               processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
-                                   __strong typeof(weakSelf) strongSelf = weakSelf;
-                                   return [strongSelf controllerAction:TGControllerActionCreate withRequest:request withResource:resource];
-                               }];
-        
-    }
-    
-    if (resource.actions & TGResourceRESTActionsDELETE) {
-        __weak typeof(self) weakSelf = self;
-        
-        [self.webServer addHandlerForMethod:@"DELETE"
-                                  pathRegex:TGDestroyRegex(resource)
-                               requestClass:[GCDWebServerRequest class]
-                               processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
-                                   __strong typeof(weakSelf) strongSelf = weakSelf;
-                                   return [strongSelf controllerAction:TGControllerActionDestroy withRequest:request withResource:resource];
-                               }];
-    }
-    
-    if (resource.actions & TGResourceRESTActionsPUT) {
-        __weak typeof(self) weakSelf = self;
-        
-        [self.webServer addHandlerForMethod:@"PUT"
-                                  pathRegex:TGUpdateRegex(resource)
-                               requestClass:[GCDWebServerDataRequest class]
-                               processBlock:^GCDWebServerResponse *(GCDWebServerRequest *request) {
-                                   __strong typeof(weakSelf) strongSelf = weakSelf;
-                                   return [strongSelf controllerAction:TGControllerActionUpdate withRequest:request withResource:resource];
-                               }];
-    }
+    [self.router addRoutesForResource:resource];
 }
 
 - (void)addResourcesWithArray:(NSArray *)resources
@@ -319,13 +391,17 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     if (removeData) {
         [self.datastore dropResource:resource];
     }
+    [self.datastore.fragmentCache setEncoder:nil forResource:resource];
+    [self.router removeRoutesForResource:resource];
     [self.resources removeObjectForKey:resource.name];
     [self.resourceSerializers removeObjectForKey:resource.name];
+    [self.bodyDecoders removeObjectForKey:resource.name];
+    [self removeRouteSettingsForResource:resource];
 }
 
 - (void)removeAllResourcesWithData:(BOOL)removeData
 {
-    [self.webServer removeAllHandlers];
+    [self.router removeAllRoutes];
     
     NSMutableArray *operations = [NSMutableArray new];
     
@@ -349,6 +425,11 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     return [NSDictionary dictionaryWithDictionary:self.resourceSerializers];
 }
 
+- (TGRESTBodyDecoder *)bodyDecoderForResource:(TGRESTResource *)resource
+{
+    return self.bodyDecoders[resource.name];
+}
+
 - (void)setSerializerClass:(Class)class forResource:(TGRESTResource *)resource
 {
     [self.resourceSerializers setObject:class forKey:resource.name];
@@ -359,6 +440,59 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
     [self.resourceSerializers removeObjectForKey:resource.name];
 }
 
+- (void)setLatencyProfile:(TGRESTLatencyProfile *)profile forResource:(TGRESTResource *)resource
+{
+    NSParameterAssert(resource);
+    
+    [self setLatencyProfile:profile forKey:resource.name];
+}
+
+- (void)setLatencyProfile:(TGRESTLatencyProfile *)profile forResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action
+{
+    NSParameterAssert(resource);
+    
+    [self setLatencyProfile:profile forKey:TGRouteKey(resource.name, action)];
+}
+
+- (TGRESTLatencyProfile *)latencyProfileForResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action
+{
+    NSDictionary *profiles = self.latencyProfiles;
+    
+    return profiles[TGRouteKey(resource.name, action)] ?: profiles[resource.name] ?: self.defaultLatencyProfile;
+}
+
+- (TGRESTRouteMetrics *)metricsForResource:(TGRESTResource *)resource action:(TGRESTRouteAction)action
+{
+    return [self.routeMetrics[TGRouteKey(resource.name, action)] copy];
+}
+
+- (TGRESTRouteMetrics *)batchMetrics
+{
+    return [self.routeMetrics[TGRouteKey(TGRESTServerBatchMetricsName, TGRESTRouteActionBatch)] copy];
+}
+
+- (NSArray *)allRouteMetrics
+{
+    NSMutableArray *snapshots = [NSMutableArray new];
+    for (TGRESTRouteMetrics *metrics in self.routeMetrics.allValues) {
+        [snapshots addObject:[metrics copy]];
+    }
+    
+    return [NSArray arrayWithArray:snapshots];
+}
+
+- (NSString *)prometheusMetrics
+{
+    return [TGRESTRouteMetrics prometheusTextWithMetrics:[self allRouteMetrics]];
+}
+
+- (void)resetMetrics
+{
+    @synchronized(self) {
+        self.routeMetrics = @{};
+    }
+}
+
 - (NSUInteger)numberOfObjectsForResource:(TGRESTResource *)resource
 {
     NSParameterAssert(resource);
@@ -392,64 +526,143 @@ static TGRESTServerLogLevel kRESTServerLogLevel = TGRESTServerLogLevelInfo;
 
 - (void)addData:(NSArray *)data forResource:(TGRESTResource *)resource
 {
-    for (NSDictionary *objectDictionary in data) {
-        NSMutableDictionary *newObjectStub = [NSMutableDictionary new];
-        
-        for (NSString *key in resource.model.allKeys) {
-            if (objectDictionary[key]) {
-                [newObjectStub setObject:objectDictionary[key] forKey:key];
-            }
-        }
-        
-        if (newObjectStub.allKeys.count > 0) {
-            NSError *error;
-            [self.datastore createNewObjectForResource:resource
-                                        withProperties:[NSDictionary dictionaryWithDictionary:newObjectStub]
-                                                 error:&error];
-            if (error) {
-                TGLogError(@"Can't create object with properties %@ %@", newObjectStub, error);
-            }
-        } else {
-            TGLogWarn(@"No matching keys for object %@", objectDictionary);
+    NSArray *newObjectStubs = [TGRESTFixtureLoader normalizedObjectsFromArray:data forResource:resource];
+    
+    if (newObjectStubs.count == 0) {
+        return;
+    }
+    
+    NSError *error;
+    if ([self.datastore createNewObjectsForResource:resource withPropertiesArray:newObjectStubs error:&error]) {
+        return;
+    }
+    
+    // The bulk insert creates nothing when any row fails, so seed one row at a time and only drop the rows that fail.
+    TGLogWarn(@"Bulk insert of %lu objects for resource %@ failed, retrying one at a time %@", (unsigned long)newObjectStubs.count, resource.name, error);
+    for (NSDictionary *newObjectStub in newObjectStubs) {
+        NSError *createError;
+        if (![self.datastore createNewObjectForResource:resource withProperties:newObjectStub error:&createError]) {
+            TGLogError(@"Can't create object with properties %@ %@", newObjectStub, createError);
         }
     }
 }
 
-#pragma mark - Private
+- (BOOL)loadDataFromFileAtPath:(NSString *)path forResource:(TGRESTResource *)resource error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(path);
+    
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:error];
+    if (!data) {
+        return NO;
+    }
+    
+    return [self loadDataFromJSONData:data forResource:resource error:error];
+}
 
-- (GCDWebServerResponse *)controllerAction:(TGControllerAction)action withRequest:(GCDWebServerRequest *)request withResource:(TGRESTResource *)resource
+- (BOOL)loadDataFromJSONData:(NSData *)data forResource:(TGRESTResource *)resource error:(NSError * __autoreleasing *)error
 {
+    NSParameterAssert(data);
+    NSParameterAssert(resource);
+    
+    if (!self.resources[resource.name]) {
+        TGLogWarn(@"The resource %@ has not been added to the server", resource.name);
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return NO;
+    }
+    
     TGStopwatch *stopwatch = [TGStopwatch new];
     [stopwatch start];
-    CGFloat randomInLatencyRange = TGRandomInRange(self.latencyMin, self.latencyMax);
+    NSUInteger loadedCount = 0;
+    BOOL success = [[TGRESTFixtureLoader loaderWithResource:resource store:self.datastore] loadData:data loadedCount:&loadedCount error:error];
+    [stopwatch stop];
+    if (success) {
+        TGLogInfo(@"Loaded %lu objects for resource %@ in %f seconds", (unsigned long)loadedCount, resource.name, [stopwatch recordedTime]);
+    } else {
+        TGLogWarn(@"Load for resource %@ stopped with %lu objects already loaded %@", resource.name, (unsigned long)loadedCount, error ? *error : nil);
+    }
+    
+    return success;
+}
+
+#pragma mark - Private
+
+- (void)setLatencyProfile:(TGRESTLatencyProfile *)profile forKey:(NSString *)key
+{
+    // Requests read the profiles without a lock, so changes swap in a new dictionary.
+    @synchronized(self) {
+        NSMutableDictionary *profiles = [self.latencyProfiles mutableCopy];
+        if (profile) {
+            [profiles setObject:profile forKey:key];
+        } else {
+            [profiles removeObjectForKey:key];
+        }
+        self.latencyProfiles = profiles;
+    }
+}
+
+- (void)removeRouteSettingsForResource:(TGRESTResource *)resource
+{
+    @synchronized(self) {
+        NSMutableDictionary *profiles = [self.latencyProfiles mutableCopy];
+        NSMutableDictionary *metrics = [self.routeMetrics mutableCopy];
+        [profiles removeObjectForKey:resource.name];
+        for (TGRESTRouteAction action = TGRESTRouteActionIndex; action <= TGRESTRouteActionDestroy; action++) {
+            [profiles removeObjectForKey:TGRouteKey(resource.name, action)];
+            [metrics removeObjectForKey:TGRouteKey(resource.name, action)];
+        }
+        self.latencyProfiles = profiles;
+        self.routeMetrics = metrics;
+    }
+}
+
+- (TGRESTRouteMetrics *)liveMetricsForResourceName:(NSString *)resourceName action:(TGRESTRouteAction)action
+{
+    NSString *key = TGRouteKey(resourceName, action);
+    TGRESTRouteMetrics *metrics = self.routeMetrics[key];
+    if (metrics) {
+        return metrics;
+    }
+    
+    // Only the first request of a route takes the lock, recording into the metrics after that is lock free.
+    @synchronized(self) {
+        metrics = self.routeMetrics[key];
+        if (!metrics) {
+            metrics = [TGRESTRouteMetrics metricsWithResourceName:resourceName action:action];
+            NSMutableDictionary *allMetrics = [self.routeMetrics mutableCopy];
+            [allMetrics setObject:metrics forKey:key];
+            self.routeMetrics = allMetrics;
+        }
+    }
+    
+    return metrics;
+}
+
+- (GCDWebServerResponse *)controllerAction:(TGRESTRouteAction)action withRequest:(GCDWebServerRequest *)request withResource:(TGRESTResource *)resource
+{
     GCDWebServerResponse *response;
     
     switch (action) {
-        case TGControllerActionIndex:
+        case TGRESTRouteActionIndex:
             response = [TGRESTDefaultController indexWithRequest:request withResource:resource usingServer:self];
             break;
-        case TGControllerActionShow:
+        case TGRESTRouteActionShow:
             response = [TGRESTDefaultController showWithRequest:request withResource:resource usingServer:self];
             break;
-        case TGControllerActionCreate:
+        case TGRESTRouteActionCreate:
             response = [TGRESTDefaultController createWithRequest:request withResource:resource usingServer:self];
             break;
-        case TGControllerActionUpdate:
+        case TGRESTRouteActionUpdate:
             response = [TGRESTDefaultController updateWithRequest:request withResource:resource usingServer:self];
             break;
-        case TGControllerActionDestroy:
+        case TGRESTRouteActionDestroy:
             response = [TGRESTDefaultController destroyWithRequest:request withResource:resource usingServer:self];
             break;
         default:
             break;
     }
     
-    while ([stopwatch recordedTime] < randomInLatencyRange) {
-        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
-    }
-    [stopwatch stop];
-    TGLogInfo(@"Returning response with latency %f", [stopwatch recordedTime]);
-    stopwatch = nil;
     return response;
 }
 
@@ -10,6 +10,9 @@
 
 @class TGRESTServer;
 @class TGRESTResource;
+@class TGRESTQuery;
+@class TGRESTFragmentCache;
+@class TGRESTStoreOperation;
 
 
 /**
@@ -25,6 +28,20 @@ See TGRESTInMemoryStore for the default concrete implementation and TGRESTSqlite
 
 @property (nonatomic, weak) TGRESTServer *server;
 
+/**
+ Cache of encoded JSON for the objects in this datastore that the controller builds responses from.  Subclasses must call `-invalidateObjectOfResource:withPrimaryKey:` on it after modifying or deleting an object and `-invalidateResource:` after adding or dropping a resource or changing objects in bulk.
+ */
+
+@property (nonatomic, strong, readonly) TGRESTFragmentCache *fragmentCache;
+
+/**
+ *  Called by the server with the options dictionary passed to `-startServerWithOptions:` right after the datastore has been created and before any resources are added.  Store types that have tuning options of their own should read their option keys here and ignore any keys they don't recognize.  The default implementation does nothing.
+ *
+ *  @param options The server start options.
+ */
+
+- (void)configureWithOptions:(NSDictionary *)options;
+
 /**
  *  Returns a count of objects in the datastore for the given resource.  Asking for the count of objects for a resource not in the datastore will return 0.
  *
@@ -35,6 +52,28 @@ See TGRESTInMemoryStore for the default concrete implementation and TGRESTSqlite
 
 - (NSUInteger)countOfObjectsForResource:(TGRESTResource *)resource;
 
+/**
+ *  Returns the current generation of a resource.  The generation must change every time an object of the resource is created, modified or deleted (including when a parent delete nulls its foreign key) and must never go back to a value it had before, which is what lets the controller answer conditional index requests without reading any objects.  Stores should take new values from `TGRESTStoreNextGeneration()` after the write is visible to readers.  The default implementation returns `NSNotFound` which means generations are not tracked and index responses won't carry an `ETag`.
+ *
+ *  @param resource A valid `TGRESTResource` that has been added to the datastore.
+ *
+ *  @return The resource generation or `NSNotFound` if it is not tracked.
+ */
+
+- (NSUInteger)generationForResource:(TGRESTResource *)resource;
+
+/**
+ *  Returns the current version of a single object.  The version follows the same rules as `-generationForResource:` but only changes when that object is written.  The default implementation returns `NSNotFound` which means versions are not tracked and show responses won't carry an `ETag`.
+ *
+ *  @param resource   A valid `TGRESTResource` that has been added to the datastore.
+ *  @param primaryKey The primary key of the object.
+ *
+ *  @return The object version or `NSNotFound` if it is not tracked or the object is unknown.
+ */
+
+- (NSUInteger)versionOfObjectOfResource:(TGRESTResource *)resource
+                         withPrimaryKey:(NSString *)primaryKey;
+
 /**
  *  Request for a single object of a given resource using the primary key value.
  *
@@ -77,6 +116,74 @@ See TGRESTInMemoryStore for the default concrete implementation and TGRESTSqlite
 - (NSArray *)getAllObjectsForResource:(TGRESTResource *)resource
                                 error:(NSError * __autoreleasing *)error;
 
+/**
+ *  Returns an enumerator over all of the objects for a given resource ordered by primary key.  This is what the default controller uses to stream index responses so a store that can hand out objects one at a time (for example from a database cursor) never has to build the whole collection in memory.  The default implementation enumerates the result of `getAllObjectsForResource:error:`.
+ *
+ *  Stores should report errors such as an unknown resource here rather than part way through the enumeration since the response headers have already been sent by the time the objects are read.
+ *
+ *  @param resource Resource of the objects you want to enumerate.
+ *  @param error    If an error occurs on return will contain the `NSError` object.
+ *
+ *  @return Enumerator that returns a dictionary for each object and then nil once every object has been returned.
+ */
+
+- (NSEnumerator *)objectEnumeratorForResource:(TGRESTResource *)resource
+                                        error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Returns a page of objects for a given resource ordered by primary key.  The default implementation slices the result of `getAllObjectsForResource:error:` so custom stores should override this if they can read a range of keys directly.
+ *
+ *  @param resource Resource of the objects you want to return.
+ *  @param afterKey Only objects with a primary key greater than this key are returned.  Pass nil to start from the first object.
+ *  @param limit    The maximum number of objects to return.  Pass `NSUIntegerMax` for no limit.
+ *  @param error    If an error occurs on return will contain the `NSError` object.
+ *
+ *  @return Array of dictionary objects ordered by primary key.  If there are no objects after the key an empty array will be returned.
+ */
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Relational request to return a page of the child objects owned by the parent object ordered by primary key.  The default implementation slices the result of `getDataForObjectsOfResource:withParent:parentPrimaryKey:error:`.
+ *
+ *  @param resource Resource of the child objects you want to find.
+ *  @param parent   Resource of the parent object.
+ *  @param key      Primary key of the parent object.
+ *  @param afterKey Only child objects with a primary key greater than this key are returned.  Pass nil to start from the first child.
+ *  @param limit    The maximum number of objects to return.  Pass `NSUIntegerMax` for no limit.
+ *  @param error    If an error occurs on return will contain the `NSError` object.
+ *
+ *  @return Array of dictionary objects ordered by primary key.  If the parent exists but has no children after the key an empty array will be returned.
+ */
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                         afterPrimaryKey:(NSString *)afterKey
+                                   limit:(NSUInteger)limit
+                                   error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Returns the objects for a given resource that match a query from an index request, ordered by the query sort property.  The default implementation evaluates the query against the result of `getAllObjectsForResource:error:` in memory so custom stores that can filter and sort natively should override this.
+ *
+ *  @param resource Resource of the objects you want to return.
+ *  @param query    A validated `TGRESTQuery` for the resource.
+ *  @param afterKey Only objects with a primary key greater than this key are returned.  Only used when the query orders by primary key, pass nil to start from the first match.
+ *  @param limit    The maximum number of objects to return.  Pass `NSUIntegerMax` for no limit.
+ *  @param error    If an error occurs on return will contain the `NSError` object.
+ *
+ *  @return Array of the matching dictionary objects.  If no objects match an empty array will be returned.
+ */
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                     matchingQuery:(TGRESTQuery *)query
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error;
+
 /**
  *  Inserts a new object with the given properties and resource into the datastore.
  *
@@ -91,6 +198,20 @@ See TGRESTInMemoryStore for the default concrete implementation and TGRESTSqlite
                               withProperties:(NSDictionary *)properties
                                        error:(NSError * __autoreleasing *)error;
 
+/**
+ *  Inserts a batch of new objects for the given resource into the datastore.  The default implementation simply calls `createNewObjectForResource:withProperties:error:` for each entry so custom stores only need to override this if they can do better, for example by applying the whole batch inside a single transaction.
+ *
+ *  @param resource        The resource of the objects you wish to create.
+ *  @param propertiesArray An array of property dictionaries, each in the same form as the properties passed to `createNewObjectForResource:withProperties:error:`.
+ *  @param error           If an error occurs on return will contain the `NSError` object.
+ *
+ *  @return Array of the created objects in the same order as the property dictionaries or nil if any of the objects could not be created, in which case none of them are kept.  The default implementation deletes the objects it already created when a later one fails.
+ */
+
+- (NSArray *)createNewObjectsForResource:(TGRESTResource *)resource
+                     withPropertiesArray:(NSArray *)propertiesArray
+                                   error:(NSError * __autoreleasing *)error;
+
 /**
  *  Modifies an object of a given resource and primary key.  Note that the property dictionary that is passed does not need to contain more than a single valid change property.
  *
@@ -121,6 +242,18 @@ See TGRESTInMemoryStore for the default concrete implementation and TGRESTSqlite
                 withPrimaryKey:(NSString *)primaryKey
                          error:(NSError * __autoreleasing *)error;
 
+/**
+ *  Runs an ordered list of operations as a single transaction.  Each operation sees the writes of the operations before it and can reference the primary keys of objects they returned (see `TGRESTStoreOperation`), and either every operation is applied or none are.  Stores that can roll back should override it.  The default implementation can't undo a write, so it only runs batches made up entirely of read operations and fails any other batch with `TGRESTStoreUnsupportedOperationErrorCode` before touching the datastore.
+ *
+ *  @param operations An array of `TGRESTStoreOperation` objects.
+ *  @param error      If an operation fails on return will contain its `NSError` with the position of the operation under `TGRESTStoreFailedOperationIndexErrorKey` in the user info.
+ *
+ *  @return Array with a result for each operation in the same order, the object dictionary for read, create and modify operations and `NSNull` for delete operations, or nil if any operation failed.
+ */
+
+- (NSArray *)performOperations:(NSArray *)operations
+                         error:(NSError * __autoreleasing *)error;
+
 /**
  *  Adds a resource to the datastore.  Note that this method might get called with an identical existing resource model in the datastore which should be a no-op.  If a resource model has changed though the resource should be dropped and rebuit (no migrations expected when a resource model changes).  The method should not return until the datastore is ready to start accepting requests for this resource.
  *
@@ -173,3 +306,30 @@ extern NSUInteger const TGRESTStoreBadRequestErrorCode;
 
 extern NSUInteger const TGRESTStoreUnknownErrorCode;
 
+/**
+ *  The datastore can't perform the request as asked, for example a batch with writes on a store that can't apply it atomically.  Will lead to an HTTP 501 response.
+ */
+
+extern NSUInteger const TGRESTStoreUnsupportedOperationErrorCode;
+
+/**
+ *  User info key of the errors returned by `-performOperations:error:` whose value is an `NSNumber` with the position of the operation that failed.
+ */
+
+extern NSString * const TGRESTStoreFailedOperationIndexErrorKey;
+
+///----------------
+/// @name Functions
+///----------------
+
+/**
+ *  Returns a new generation number for stamping resource generations and object versions.  Every call returns a larger number than any call before it in the process so values are never reused, even across resources, stores or a resource that is dropped and added again.  Safe to call from any thread.
+ */
+
+extern NSUInteger TGRESTStoreNextGeneration(void);
+
+/**
+ *  Returns a copy of an error from a store method with the position of the batch operation that caused it added under `TGRESTStoreFailedOperationIndexErrorKey`.  Stores that override `-performOperations:error:` should use it for the errors they return.
+ */
+
+extern NSError * TGRESTStoreErrorForOperationAtIndex(NSError *error, NSUInteger index);
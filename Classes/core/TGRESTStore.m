@@ -7,16 +7,60 @@
 //
 
 #import "TGRESTStore.h"
+#import "TGRESTResource.h"
+#import "TGRESTQuery.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTStoreOperation.h"
+#import <stdatomic.h>
 
 NSString * const TGRESTStoreErrorDomain = @"TGRESTStoreErrorDomain";
 NSUInteger const TGRESTStoreUnknownErrorCode = 1000;
 NSUInteger const TGRESTStoreObjectAlreadyDeletedErrorCode = 1001;
 NSUInteger const TGRESTStoreObjectNotFoundErrorCode = 1002;
 NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
+NSUInteger const TGRESTStoreUnsupportedOperationErrorCode = 1004;
+NSString * const TGRESTStoreFailedOperationIndexErrorKey = @"TGRESTStoreFailedOperationIndexErrorKey";
 
+NSUInteger TGRESTStoreNextGeneration(void)
+{
+    static _Atomic uint64_t generation = 0;
+    
+    return (NSUInteger)(atomic_fetch_add(&generation, 1) + 1);
+}
+
+NSError * TGRESTStoreErrorForOperationAtIndex(NSError *error, NSUInteger index)
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:error.userInfo];
+    userInfo[TGRESTStoreFailedOperationIndexErrorKey] = @(index);
+    
+    return [NSError errorWithDomain:error.domain ?: TGRESTStoreErrorDomain
+                               code:error ? error.code : TGRESTStoreUnknownErrorCode
+                           userInfo:userInfo];
+}
+
+@interface TGRESTStore ()
+
+@property (nonatomic, strong, readwrite) TGRESTFragmentCache *fragmentCache;
+
+@end
 
 @implementation TGRESTStore
 
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        self.fragmentCache = [[TGRESTFragmentCache alloc] initWithStore:self];
+    }
+    
+    return self;
+}
+
+- (void)configureWithOptions:(NSDictionary *)options
+{
+    
+}
+
 - (NSUInteger)countOfObjectsForResource:(TGRESTResource *)resource
 {
     @throw [NSException exceptionWithName:NSInternalInconsistencyException
@@ -24,6 +68,17 @@ NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
                                  userInfo:nil];
 }
 
+- (NSUInteger)generationForResource:(TGRESTResource *)resource
+{
+    return NSNotFound;
+}
+
+- (NSUInteger)versionOfObjectOfResource:(TGRESTResource *)resource
+                         withPrimaryKey:(NSString *)primaryKey
+{
+    return NSNotFound;
+}
+
 - (NSDictionary *)getDataForObjectOfResource:(TGRESTResource *)resource
                               withPrimaryKey:(NSString *)primaryKey
                                        error:(NSError * __autoreleasing *)error
@@ -51,6 +106,56 @@ NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
                                  userInfo:nil];
 }
 
+- (NSEnumerator *)objectEnumeratorForResource:(TGRESTResource *)resource
+                                        error:(NSError * __autoreleasing *)error
+{
+    return [[self getAllObjectsForResource:resource error:error] objectEnumerator];
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSArray *allObjects = [self getAllObjectsForResource:resource error:error];
+    if (!allObjects) {
+        return nil;
+    }
+    
+    return [self pageOfObjects:allObjects forResource:resource afterPrimaryKey:afterKey limit:limit];
+}
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                         afterPrimaryKey:(NSString *)afterKey
+                                   limit:(NSUInteger)limit
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSArray *children = [self getDataForObjectsOfResource:resource withParent:parent parentPrimaryKey:key error:error];
+    if (!children) {
+        return nil;
+    }
+    
+    return [self pageOfObjects:children forResource:resource afterPrimaryKey:afterKey limit:limit];
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                     matchingQuery:(TGRESTQuery *)query
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(query);
+    
+    NSArray *allObjects = [self getAllObjectsForResource:resource error:error];
+    if (!allObjects) {
+        return nil;
+    }
+    
+    return [query objectsMatchingQueryInObjects:allObjects afterPrimaryKey:afterKey limit:limit];
+}
+
 - (NSDictionary *)createNewObjectForResource:(TGRESTResource *)resource
                               withProperties:(NSDictionary *)properties
                                        error:(NSError * __autoreleasing *)error
@@ -60,6 +165,33 @@ NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
                                  userInfo:nil];
 }
 
+- (NSArray *)createNewObjectsForResource:(TGRESTResource *)resource
+                     withPropertiesArray:(NSArray *)propertiesArray
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(propertiesArray);
+    
+    NSMutableArray *newObjects = [NSMutableArray arrayWithCapacity:propertiesArray.count];
+    for (NSDictionary *properties in propertiesArray) {
+        NSError *createError;
+        NSDictionary *newObject = [self createNewObjectForResource:resource withProperties:properties error:&createError];
+        if (!newObject) {
+            // Remove the objects created so far so a failed batch leaves nothing behind.
+            for (NSDictionary *createdObject in newObjects) {
+                [self deleteObjectOfResource:resource withPrimaryKey:[createdObject[resource.primaryKey] description] error:nil];
+            }
+            if (error) {
+                *error = createError;
+            }
+            return nil;
+        }
+        [newObjects addObject:newObject];
+    }
+    
+    return [NSArray arrayWithArray:newObjects];
+}
+
 - (NSDictionary *)modifyObjectOfResource:(TGRESTResource *)resource
                           withPrimaryKey:(NSString *)primaryKey
                           withProperties:(NSDictionary *)properties
@@ -79,6 +211,56 @@ NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
                                  userInfo:nil];
 }
 
+- (NSArray *)performOperations:(NSArray *)operations
+                         error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(operations);
+    
+    // The single object methods can't be rolled back, so a batch is only run here when it has nothing to undo.
+    for (NSUInteger index = 0; index < operations.count; index++) {
+        if ([(TGRESTStoreOperation *)operations[index] type] != TGRESTStoreOperationTypeRead) {
+            if (error) {
+                *error = TGRESTStoreErrorForOperationAtIndex([NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnsupportedOperationErrorCode userInfo:nil], index);
+            }
+            return nil;
+        }
+    }
+    
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:operations.count];
+    for (TGRESTStoreOperation *unresolvedOperation in operations) {
+        NSError *operationError;
+        id result = nil;
+        TGRESTStoreOperation *operation = [unresolvedOperation operationByResolvingReferencesWithOperations:operations results:results error:&operationError];
+        if (operation) {
+            switch (operation.type) {
+                case TGRESTStoreOperationTypeRead:
+                    result = [self getDataForObjectOfResource:operation.resource withPrimaryKey:operation.primaryKey error:&operationError];
+                    break;
+                case TGRESTStoreOperationTypeCreate:
+                    result = [self createNewObjectForResource:operation.resource withProperties:operation.properties error:&operationError];
+                    break;
+                case TGRESTStoreOperationTypeModify:
+                    result = [self modifyObjectOfResource:operation.resource withPrimaryKey:operation.primaryKey withProperties:operation.properties error:&operationError];
+                    break;
+                case TGRESTStoreOperationTypeDelete:
+                    if ([self deleteObjectOfResource:operation.resource withPrimaryKey:operation.primaryKey error:&operationError]) {
+                        result = [NSNull null];
+                    }
+                    break;
+            }
+        }
+        if (!result) {
+            if (error) {
+                *error = TGRESTStoreErrorForOperationAtIndex(operationError, results.count);
+            }
+            return nil;
+        }
+        [results addObject:result];
+    }
+    
+    return [NSArray arrayWithArray:results];
+}
+
 - (void)addResource:(TGRESTResource *)resource
 {
     @throw [NSException exceptionWithName:NSInternalInconsistencyException
@@ -93,4 +275,29 @@ NSUInteger const TGRESTStoreBadRequestErrorCode = 1003;
                                  userInfo:nil];
 }
 
+#pragma mark - Private
+
+- (NSArray *)pageOfObjects:(NSArray *)objects forResource:(TGRESTResource *)resource afterPrimaryKey:(NSString *)afterKey limit:(NSUInteger)limit
+{
+    NSMutableArray *page = [NSMutableArray new];
+    for (NSDictionary *object in objects) {
+        if (page.count >= limit) {
+            break;
+        }
+        id primaryKey = object[resource.primaryKey];
+        if (afterKey) {
+            if (resource.primaryKeyType == TGPropertyTypeInteger) {
+                if ([primaryKey integerValue] <= [afterKey integerValue]) {
+                    continue;
+                }
+            } else if ([[primaryKey description] compare:afterKey] != NSOrderedDescending) {
+                continue;
+            }
+        }
+        [page addObject:object];
+    }
+    
+    return [NSArray arrayWithArray:page];
+}
+
 @end
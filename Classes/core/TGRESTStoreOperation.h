@@ -0,0 +1,136 @@
+//
+//  TGRESTStoreOperation.h
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource;
+
+/**
+ *  The kind of work a `TGRESTStoreOperation` does.
+ */
+
+typedef NS_ENUM(NSUInteger, TGRESTStoreOperationType) {
+    /**
+     Reads an object by primary key.
+     */
+    TGRESTStoreOperationTypeRead,
+    /**
+     Creates an object.
+     */
+    TGRESTStoreOperationTypeCreate,
+    /**
+     Modifies an object by primary key.
+     */
+    TGRESTStoreOperationTypeModify,
+    /**
+     Deletes an object by primary key.
+     */
+    TGRESTStoreOperationTypeDelete
+};
+
+/**
+ `TGRESTStoreOperation` is one step of a batch that is handed to `-[TGRESTStore performOperations:error:]` to run as a single transaction.
+ 
+ An operation can use the primary key of an object created or read earlier in the same batch before it is known.  Wherever a primary key is expected, either as the primary key of the operation or as the value of a foreign key property, put the string `$n` (see `+referenceToOperationAtIndex:`) where `n` is the zero based position of the earlier operation in the batch.  Only the primary key and foreign keys are looked at, any other property that happens to start with `$` is stored as it is.
+ */
+
+@interface TGRESTStoreOperation : NSObject
+
+@property (nonatomic, assign, readonly) TGRESTStoreOperationType type;
+@property (nonatomic, strong, readonly) TGRESTResource *resource;
+
+/**
+ Primary key of the object for read, modify and delete operations, or a reference to an earlier operation.  Nil for create operations.
+ */
+
+@property (nonatomic, copy, readonly) NSString *primaryKey;
+
+/**
+ Properties for create and modify operations.  Nil for read and delete operations.
+ */
+
+@property (nonatomic, copy, readonly) NSDictionary *properties;
+
+///-----------------------------
+/// @name Creating an operation
+///-----------------------------
+
+/**
+ *  Creates an operation that reads an object.
+ *
+ *  @param resource   Resource of the object.
+ *  @param primaryKey Primary key of the object or a reference to an earlier operation.
+ *
+ *  @return A new operation.
+ */
+
++ (instancetype)readOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey;
+
+/**
+ *  Creates an operation that creates an object.
+ *
+ *  @param resource   Resource of the object.
+ *  @param properties Properties of the new object.
+ *
+ *  @return A new operation.
+ */
+
++ (instancetype)createOperationWithResource:(TGRESTResource *)resource properties:(NSDictionary *)properties;
+
+/**
+ *  Creates an operation that modifies an object.
+ *
+ *  @param resource   Resource of the object.
+ *  @param primaryKey Primary key of the object or a reference to an earlier operation.
+ *  @param properties The properties to change.
+ *
+ *  @return A new operation.
+ */
+
++ (instancetype)modifyOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey properties:(NSDictionary *)properties;
+
+/**
+ *  Creates an operation that deletes an object.
+ *
+ *  @param resource   Resource of the object.
+ *  @param primaryKey Primary key of the object or a reference to an earlier operation.
+ *
+ *  @return A new operation.
+ */
+
++ (instancetype)deleteOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey;
+
+/**
+ *  The reference to use in place of the primary key of the object an earlier operation created or read.
+ *
+ *  @param index Zero based position of the earlier operation in the batch.
+ *
+ *  @return A reference like `$0`.
+ */
+
++ (NSString *)referenceToOperationAtIndex:(NSUInteger)index;
+
+///---------------------------
+/// @name Resolving references
+///---------------------------
+
+/**
+ *  Replaces the references in the primary key and foreign keys with the primary keys of the objects that earlier operations returned.  Stores call this right before running each operation of a batch.
+ *
+ *  @param operations Every operation of the batch.
+ *  @param results    Results of the operations that have run so far, so the count is the position of this operation.  Delete operations have `NSNull` results and can't be referenced.
+ *  @param error      If a reference points at an operation that hasn't run yet or has no object on return will contain an `NSError` with `TGRESTStoreBadRequestErrorCode`.
+ *
+ *  @return The operation with every reference resolved, the receiver if it has no references, or nil if a reference can't be resolved.
+ */
+
+- (instancetype)operationByResolvingReferencesWithOperations:(NSArray *)operations
+                                                     results:(NSArray *)results
+                                                       error:(NSError * __autoreleasing *)error;
+
+@end
@@ -0,0 +1,148 @@
+//
+//  TGRESTStoreOperation.m
+//  
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import "TGRESTStoreOperation.h"
+#import "TGRESTResource.h"
+#import "TGRESTStore.h"
+
+static NSString * const TGRESTStoreOperationReferencePrefix = @"$";
+
+@interface TGRESTStoreOperation ()
+
+@property (nonatomic, assign, readwrite) TGRESTStoreOperationType type;
+@property (nonatomic, strong, readwrite) TGRESTResource *resource;
+@property (nonatomic, copy, readwrite) NSString *primaryKey;
+@property (nonatomic, copy, readwrite) NSDictionary *properties;
+
+@end
+
+@implementation TGRESTStoreOperation
+
++ (instancetype)operationWithType:(TGRESTStoreOperationType)type resource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey properties:(NSDictionary *)properties
+{
+    NSParameterAssert(resource);
+    
+    TGRESTStoreOperation *operation = [self new];
+    operation.type = type;
+    operation.resource = resource;
+    operation.primaryKey = primaryKey;
+    operation.properties = properties;
+    
+    return operation;
+}
+
++ (instancetype)readOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(primaryKey);
+    
+    return [self operationWithType:TGRESTStoreOperationTypeRead resource:resource primaryKey:primaryKey properties:nil];
+}
+
++ (instancetype)createOperationWithResource:(TGRESTResource *)resource properties:(NSDictionary *)properties
+{
+    NSParameterAssert(properties);
+    
+    return [self operationWithType:TGRESTStoreOperationTypeCreate resource:resource primaryKey:nil properties:properties];
+}
+
++ (instancetype)modifyOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey properties:(NSDictionary *)properties
+{
+    NSParameterAssert(primaryKey);
+    NSParameterAssert(properties);
+    
+    return [self operationWithType:TGRESTStoreOperationTypeModify resource:resource primaryKey:primaryKey properties:properties];
+}
+
++ (instancetype)deleteOperationWithResource:(TGRESTResource *)resource primaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(primaryKey);
+    
+    return [self operationWithType:TGRESTStoreOperationTypeDelete resource:resource primaryKey:primaryKey properties:nil];
+}
+
++ (NSString *)referenceToOperationAtIndex:(NSUInteger)index
+{
+    return [NSString stringWithFormat:@"%@%lu", TGRESTStoreOperationReferencePrefix, (unsigned long)index];
+}
+
+- (instancetype)operationByResolvingReferencesWithOperations:(NSArray *)operations
+                                                     results:(NSArray *)results
+                                                       error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(operations);
+    NSParameterAssert(results);
+    
+    BOOL resolved = YES;
+    NSString *primaryKey = self.primaryKey;
+    if ([self isReference:primaryKey]) {
+        primaryKey = [[self primaryKeyForReference:primaryKey operations:operations results:results] description];
+        resolved = primaryKey != nil;
+    }
+    
+    NSMutableDictionary *properties = nil;
+    for (NSString *foreignKey in self.resource.foreignKeys.allValues) {
+        id value = self.properties[foreignKey];
+        if (!resolved || ![self isReference:value]) {
+            continue;
+        }
+        id parentKey = [self primaryKeyForReference:value operations:operations results:results];
+        if (!parentKey) {
+            resolved = NO;
+            break;
+        }
+        properties = properties ?: [self.properties mutableCopy];
+        [properties setObject:parentKey forKey:foreignKey];
+    }
+    
+    if (!resolved) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreBadRequestErrorCode userInfo:@{NSLocalizedDescriptionKey: @"A reference must point at an earlier operation that returned an object"}];
+        }
+        return nil;
+    }
+    
+    if (primaryKey == self.primaryKey && !properties) {
+        return self;
+    }
+    
+    return [[self class] operationWithType:self.type resource:self.resource primaryKey:primaryKey properties:properties ?: self.properties];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %lu %@ key %@ %@>", NSStringFromClass([self class]), (unsigned long)self.type, self.resource.name, self.primaryKey, self.properties];
+}
+
+#pragma mark - Private
+
+- (BOOL)isReference:(id)value
+{
+    if (![value isKindOfClass:[NSString class]] || ![value hasPrefix:TGRESTStoreOperationReferencePrefix] || [value length] < 2) {
+        return NO;
+    }
+    
+    NSString *digits = [value substringFromIndex:TGRESTStoreOperationReferencePrefix.length];
+    return [digits rangeOfCharacterFromSet:[[NSCharacterSet decimalDigitCharacterSet] invertedSet]].location == NSNotFound;
+}
+
+- (id)primaryKeyForReference:(NSString *)reference operations:(NSArray *)operations results:(NSArray *)results
+{
+    NSUInteger index = (NSUInteger)[[reference substringFromIndex:TGRESTStoreOperationReferencePrefix.length] longLongValue];
+    if (index >= results.count || index >= operations.count) {
+        return nil;
+    }
+    
+    NSDictionary *object = results[index];
+    if (![object isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    
+    return object[[(TGRESTStoreOperation *)operations[index] resource].primaryKey];
+}
+
+@end
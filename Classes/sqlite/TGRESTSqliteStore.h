@@ -12,9 +12,41 @@
 /**
  Concrete subclass of TGRESTStore, this store type uses a sqlite3 database as the backing store offering a measure of persistence.  However this is still not meant for anything permanent which is reflected in the fact that this store do a table drop anytime it adds a resource whose model doesn't match the existing structure.
  
- Note that the sqlite database is configured with `FOREIGN KEY` support and is thread safe as it has a DB queue and transactional operations where appropriate.
+ Note that the sqlite database is configured with `FOREIGN KEY` support and is thread safe as it has a DB queue and transactional operations where appropriate.  The SQL for each resource is built once when the resource is added, every value is bound as a parameter and the prepared statements are cached on the connection until the resource is dropped.
+ 
+ ### WAL mode
+ 
+ By default every operation goes through a single connection.  Passing `TGRESTSqliteStoreWALModeOptionKey` to `-startServerWithOptions:` switches the database to write-ahead logging and serves reads from a pool of read-only connections so that reads no longer wait on each other or on a writer.  Writes still go through the single writer connection.  In WAL mode an object enumerator (used to stream index responses) reads from a cursor on its own read-only connection, outside of WAL mode it reads the table in small batches by primary key so the writer is never locked out while a response is being sent.  Foreign key columns and every property listed in `indexedProperties` get a sqlite index, re-adding a resource with different indexed properties creates and drops indexes in place without rebuilding the table.
  */
 
 @interface TGRESTSqliteStore : TGRESTStore
 
 @end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ Option key for the -startServerWithOptions: dictionary which puts the sqlite database in WAL journal mode and serves reads from a pool of read-only connections.  Value is a boxed BOOL, default is NO.
+ */
+
+extern NSString * const TGRESTSqliteStoreWALModeOptionKey;
+
+/**
+ Option key for the -startServerWithOptions: dictionary which sets the maximum number of read-only connections used in WAL mode.  Default is the number of active processors.
+ */
+
+extern NSString * const TGRESTSqliteStoreReaderPoolSizeOptionKey;
+
+/**
+ Option key for the -startServerWithOptions: dictionary which sets `PRAGMA mmap_size` in bytes on every connection.  Default leaves the sqlite default in place.
+ */
+
+extern NSString * const TGRESTSqliteStoreMmapSizeOptionKey;
+
+/**
+ Option key for the -startServerWithOptions: dictionary which sets `PRAGMA cache_size` on every connection.  Positive values are a number of pages and negative values are a size in KiB, as with the pragma itself.  Default leaves the sqlite default in place.
+ */
+
+extern NSString * const TGRESTSqliteStoreCacheSizeOptionKey;
@@ -9,15 +9,111 @@
 #import "TGRESTSqliteStore.h"
 #import <FMDB/FMDatabase.h>
 #import <FMDB/FMDatabaseQueue.h>
+#import <FMDB/FMDatabasePool.h>
 #import <FMDB/FMDatabaseAdditions.h>
 #import "TGPrivateFunctions.h"
 #import "TGRESTResource.h"
+#import "TGRESTQuery.h"
 #import "TGRESTEasyLogging.h"
 #import "TGRESTStore.h"
+#import "TGRESTFragmentCache.h"
+#import "TGRESTStoreOperation.h"
 
-@interface TGRESTSqliteStore ()
+NSString * const TGRESTSqliteStoreWALModeOptionKey = @"TGRESTSqliteStoreWALModeOptionKey";
+NSString * const TGRESTSqliteStoreReaderPoolSizeOptionKey = @"TGRESTSqliteStoreReaderPoolSizeOptionKey";
+NSString * const TGRESTSqliteStoreMmapSizeOptionKey = @"TGRESTSqliteStoreMmapSizeOptionKey";
+NSString * const TGRESTSqliteStoreCacheSizeOptionKey = @"TGRESTSqliteStoreCacheSizeOptionKey";
 
+static NSString * const TGSqliteCountStatement = @"count";
+static NSString * const TGSqliteShowStatement = @"show";
+static NSString * const TGSqliteIndexStatement = @"index";
+static NSString * const TGSqliteNestedIndexStatement = @"nested";
+static NSString * const TGSqlitePageStatement = @"page";
+static NSString * const TGSqliteFirstPageStatement = @"firstpage";
+static NSString * const TGSqliteNestedPageStatement = @"nestedpage";
+static NSString * const TGSqliteNestedFirstPageStatement = @"nestedfirstpage";
+static NSString * const TGSqliteInsertStatement = @"insert";
+static NSString * const TGSqliteUpdateStatement = @"update";
+static NSString * const TGSqliteDeleteStatement = @"delete";
+static NSString * const TGSqliteNullifyStatement = @"nullify";
+static NSString * const TGSqliteUpdateFlagPrefix = @"tg_set_";
+static NSUInteger const TGSqliteCursorBatchSize = 64;
+
+@interface TGRESTSqliteStore () <FMDatabasePoolDelegate>
+
+@property (nonatomic, copy) NSString *databasePath;
 @property (nonatomic, strong) FMDatabaseQueue *dbQueue;
+@property (nonatomic, strong) FMDatabasePool *readPool;
+@property (nonatomic, strong) dispatch_semaphore_t readSemaphore;
+@property (nonatomic, strong) NSNumber *mmapSize;
+@property (nonatomic, strong) NSNumber *cacheSize;
+@property (atomic, copy) NSDictionary *statements;
+@property (nonatomic, assign) BOOL cachesStatements;
+@property (nonatomic, strong) dispatch_queue_t versionQueue;
+@property (nonatomic, strong) NSMutableDictionary *generations;
+@property (nonatomic, strong) NSMutableDictionary *baseVersions;
+@property (nonatomic, strong) NSMutableDictionary *objectVersions;
+
+@end
+
+@interface TGRESTSqliteCursor : NSEnumerator
+
+- (instancetype)initWithBatchBlock:(NSArray * (^)(void))batchBlock completionBlock:(void (^)(void))completionBlock;
+
+@end
+
+@interface TGRESTSqliteCursor ()
+
+@property (nonatomic, copy) NSArray * (^batchBlock)(void);
+@property (nonatomic, copy) void (^completionBlock)(void);
+@property (nonatomic, strong) NSArray *batch;
+@property (nonatomic, assign) NSUInteger batchIndex;
+
+@end
+
+@implementation TGRESTSqliteCursor
+
+- (instancetype)initWithBatchBlock:(NSArray * (^)(void))batchBlock completionBlock:(void (^)(void))completionBlock
+{
+    NSParameterAssert(batchBlock);
+    
+    self = [super init];
+    if (self) {
+        self.batchBlock = batchBlock;
+        self.completionBlock = completionBlock;
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    [self finish];
+}
+
+- (id)nextObject
+{
+    if (self.batchIndex >= self.batch.count) {
+        self.batch = self.batchBlock ? self.batchBlock() : nil;
+        self.batchIndex = 0;
+        if (self.batch.count == 0) {
+            [self finish];
+            return nil;
+        }
+    }
+    
+    return self.batch[self.batchIndex++];
+}
+
+- (void)finish
+{
+    if (self.completionBlock) {
+        self.completionBlock();
+    }
+    self.batchBlock = nil;
+    self.completionBlock = nil;
+    self.batch = nil;
+}
 
 @end
 
@@ -27,45 +123,126 @@
 {
     self = [super init];
     if (self) {
-        self.dbQueue = [FMDatabaseQueue databaseQueueWithPath:[NSString stringWithFormat:@"%@/RESTeasy.sqlite", TGApplicationDataDirectory()] flags:SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_DBCONFIG_ENABLE_FKEY];
+        self.databasePath = [NSString stringWithFormat:@"%@/RESTeasy.sqlite", TGApplicationDataDirectory()];
+        self.dbQueue = [FMDatabaseQueue databaseQueueWithPath:self.databasePath flags:SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_DBCONFIG_ENABLE_FKEY];
+        self.statements = @{};
+        self.cachesStatements = YES;
+        self.versionQueue = dispatch_queue_create("com.tinylittlegears.resteasy.sqlite.versions", DISPATCH_QUEUE_CONCURRENT);
+        self.generations = [NSMutableDictionary new];
+        self.baseVersions = [NSMutableDictionary new];
+        self.objectVersions = [NSMutableDictionary new];
     }
     
     return self;
 }
 
+- (void)dealloc
+{
+    [_readPool releaseAllDatabases];
+}
+
+- (void)configureWithOptions:(NSDictionary *)options
+{
+    self.mmapSize = options[TGRESTSqliteStoreMmapSizeOptionKey];
+    self.cacheSize = options[TGRESTSqliteStoreCacheSizeOptionKey];
+    
+    [self.dbQueue inDatabase:^(FMDatabase *db) {
+        [self applyConnectionPragmasToDatabase:db];
+    }];
+    
+    if (![options[TGRESTSqliteStoreWALModeOptionKey] boolValue]) {
+        [self.readPool releaseAllDatabases];
+        self.readPool = nil;
+        return;
+    }
+    
+    __block NSString *journalMode;
+    [self.dbQueue inDatabase:^(FMDatabase *db) {
+        journalMode = [db stringForQuery:@"PRAGMA journal_mode = WAL"];
+    }];
+    
+    if (![[journalMode lowercaseString] isEqualToString:@"wal"]) {
+        TGLogWarn(@"Sqlite database could not be switched to WAL mode (journal mode is %@), reads will share the writer connection", journalMode);
+        return;
+    }
+    
+    NSUInteger poolSize = [[NSProcessInfo processInfo] activeProcessorCount];
+    if (options[TGRESTSqliteStoreReaderPoolSizeOptionKey]) {
+        poolSize = MAX([options[TGRESTSqliteStoreReaderPoolSizeOptionKey] unsignedIntegerValue], 1);
+    }
+    
+    [self.readPool releaseAllDatabases];
+    // The pool hands out nil instead of waiting once every connection is checked out, so readers wait their turn on the semaphore.
+    self.readSemaphore = dispatch_semaphore_create((long)poolSize);
+    FMDatabasePool *readPool = [[FMDatabasePool alloc] initWithPath:self.databasePath flags:SQLITE_OPEN_READONLY];
+    readPool.maximumNumberOfDatabasesToCreate = poolSize;
+    readPool.delegate = self;
+    self.readPool = readPool;
+}
+
 - (NSUInteger)countOfObjectsForResource:(TGRESTResource *)resource
 {
+    NSString *countSQL = [self statement:TGSqliteCountStatement forResource:resource];
     __block NSUInteger returnCount;
-    [self.dbQueue inDatabase:^(FMDatabase *db) {
-        returnCount = [db intForQuery:[NSString stringWithFormat:@"SELECT COUNT(%@) FROM %@", resource.primaryKey, resource.name]];
+    [self readDatabase:^(FMDatabase *db) {
+        returnCount = [db intForQuery:countSQL];
     }];
     
     return returnCount;
 }
 
+- (NSUInteger)generationForResource:(TGRESTResource *)resource
+{
+    __block NSNumber *generation;
+    dispatch_sync(self.versionQueue, ^{
+        generation = self.generations[resource.name];
+    });
+    
+    return generation ? [generation unsignedIntegerValue] : NSNotFound;
+}
+
+- (NSUInteger)versionOfObjectOfResource:(TGRESTResource *)resource
+                         withPrimaryKey:(NSString *)primaryKey
+{
+    NSParameterAssert(primaryKey);
+    
+    id versionKey = [self boundPrimaryKey:primaryKey forResource:resource];
+    __block NSNumber *version;
+    dispatch_sync(self.versionQueue, ^{
+        version = self.objectVersions[resource.name][versionKey] ?: self.baseVersions[resource.name];
+    });
+    
+    return version ? [version unsignedIntegerValue] : NSNotFound;
+}
+
 - (NSDictionary *)getDataForObjectOfResource:(TGRESTResource *)resource
                               withPrimaryKey:(NSString *)primaryKey
                                        error:(NSError * __autoreleasing *)error
 {
-    TGLogInfo(@"Getting data for resource %@ with primary key %@ using sqlite store", resource.name, resource.primaryKey);
-    __block NSMutableDictionary *returnDictionary = [NSMutableDictionary new];
-    [self.dbQueue inDatabase:^(FMDatabase *db) {
-        FMResultSet *results = [db executeQuery:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE %@ = %@", resource.name, resource.primaryKey, primaryKey]];
+    TGLogVerbose(@"Getting data for resource %@ with primary key %@ using sqlite store", resource.name, resource.primaryKey);
+    NSString *showSQL = [self statement:TGSqliteShowStatement forResource:resource];
+    __block NSDictionary *returnDictionary;
+    [self readDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:showSQL, primaryKey];
         if ([results next]) {
-            for (NSString *key in resource.model) {
-                [returnDictionary setObject:[results objectForColumnName:key] forKey:key];
-            }
-        } else {
-            if (error && primaryKey.integerValue <= db.lastInsertRowId) {
-                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
-            } else {
-                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
-            }
-            returnDictionary = nil;
+            returnDictionary = [self objectFromResultSet:results forResource:resource];
         }
         [results close];
     }];
     
+    if (!returnDictionary && error) {
+        // Only the writer connection knows the last row that was inserted.
+        __block int64_t lastInsertRowID;
+        [self.dbQueue inDatabase:^(FMDatabase *db) {
+            lastInsertRowID = db.lastInsertRowId;
+        }];
+        if ([primaryKey integerValue] <= lastInsertRowID) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
+        } else {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
+        }
+    }
+    
     return returnDictionary;
 }
 
@@ -74,16 +251,13 @@
                         parentPrimaryKey:(NSString *)key
                                    error:(NSError * __autoreleasing *)error
 {
+    NSString *nestedSQL = [self statement:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedIndexStatement, parent.name] forResource:resource];
     NSMutableArray *returnArray = [NSMutableArray new];
     
-    [self.dbQueue inDatabase:^(FMDatabase *db) {
-        FMResultSet *results = [db executeQuery:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE %@ = %@", resource.name, resource.foreignKeys[parent.name], key]];
+    [self readDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:nestedSQL, key];
         while ([results next]) {
-            NSMutableDictionary *objectDict = [NSMutableDictionary new];
-            for (NSString *key in resource.model) {
-                [objectDict setObject:[results objectForColumnName:key] forKey:key];
-            }
-            [returnArray addObject:objectDict];
+            [returnArray addObject:[self objectFromResultSet:results forResource:resource]];
         }
         [results close];
     }];
@@ -94,15 +268,12 @@
 - (NSArray *)getAllObjectsForResource:(TGRESTResource *)resource
                                 error:(NSError * __autoreleasing *)error
 {
+    NSString *indexSQL = [self statement:TGSqliteIndexStatement forResource:resource];
     NSMutableArray *returnArray = [NSMutableArray new];
-    [self.dbQueue inDatabase:^(FMDatabase *db) {
-        FMResultSet *results = [db executeQuery:[NSString stringWithFormat:@"SELECT * FROM %@", resource.name]];
+    [self readDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:indexSQL];
         while ([results next]) {
-            NSMutableDictionary *objectDict = [NSMutableDictionary new];
-            for (NSString *key in resource.model) {
-                [objectDict setObject:[results objectForColumnName:key] forKey:key];
-            }
-            [returnArray addObject:objectDict];
+            [returnArray addObject:[self objectFromResultSet:results forResource:resource]];
         }
         [results close];
     }];
@@ -110,6 +281,132 @@
     return returnArray;
 }
 
+- (NSEnumerator *)objectEnumeratorForResource:(TGRESTResource *)resource
+                                        error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    
+    if (!self.readPool) {
+        return [self keysetCursorForResource:resource];
+    }
+    
+    // In WAL mode the cursor gets a connection of its own so it can keep its result set open against one snapshot without holding up the writer or the reader pool.
+    NSString *indexSQL = [self statement:TGSqliteIndexStatement forResource:resource];
+    FMDatabaseQueue *cursorQueue = [FMDatabaseQueue databaseQueueWithPath:self.databasePath flags:SQLITE_OPEN_READONLY];
+    __block FMResultSet *results;
+    [cursorQueue inDatabase:^(FMDatabase *db) {
+        [self applyConnectionPragmasToDatabase:db];
+        results = [db executeQuery:indexSQL];
+        if (!results) {
+            TGLogError(@"ERROR: Can't open cursor for resource %@ %@", resource.name, [db lastError]);
+        }
+    }];
+    
+    if (!results) {
+        [cursorQueue close];
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
+    return [[TGRESTSqliteCursor alloc] initWithBatchBlock:^NSArray *{
+        NSMutableArray *batch = [NSMutableArray arrayWithCapacity:TGSqliteCursorBatchSize];
+        [cursorQueue inDatabase:^(FMDatabase *db) {
+            while (batch.count < TGSqliteCursorBatchSize && [results next]) {
+                [batch addObject:[self objectFromResultSet:results forResource:resource]];
+            }
+        }];
+        return batch;
+    } completionBlock:^{
+        [cursorQueue inDatabase:^(FMDatabase *db) {
+            [results close];
+        }];
+        [cursorQueue close];
+    }];
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSString *pageSQL;
+    NSMutableArray *arguments = [NSMutableArray new];
+    if (afterKey) {
+        pageSQL = [self statement:TGSqlitePageStatement forResource:resource];
+        [arguments addObject:[self boundPrimaryKey:afterKey forResource:resource]];
+    } else {
+        pageSQL = [self statement:TGSqliteFirstPageStatement forResource:resource];
+    }
+    [arguments addObject:[self boundLimit:limit]];
+    
+    return [self objectsForResource:resource withQuery:pageSQL arguments:arguments];
+}
+
+- (NSArray *)getDataForObjectsOfResource:(TGRESTResource *)resource
+                              withParent:(TGRESTResource *)parent
+                        parentPrimaryKey:(NSString *)key
+                         afterPrimaryKey:(NSString *)afterKey
+                                   limit:(NSUInteger)limit
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSString *pageSQL;
+    NSMutableArray *arguments = [NSMutableArray arrayWithObject:key];
+    if (afterKey) {
+        pageSQL = [self statement:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedPageStatement, parent.name] forResource:resource];
+        [arguments addObject:[self boundPrimaryKey:afterKey forResource:resource]];
+    } else {
+        pageSQL = [self statement:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedFirstPageStatement, parent.name] forResource:resource];
+    }
+    [arguments addObject:[self boundLimit:limit]];
+    
+    return [self objectsForResource:resource withQuery:pageSQL arguments:arguments];
+}
+
+- (NSArray *)getObjectsForResource:(TGRESTResource *)resource
+                     matchingQuery:(TGRESTQuery *)query
+                   afterPrimaryKey:(NSString *)afterKey
+                             limit:(NSUInteger)limit
+                             error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(query);
+    
+    NSDictionary *comparisons = @{@(TGRESTQueryOperatorEqual): @"=",
+                                  @(TGRESTQueryOperatorGreaterThan): @">",
+                                  @(TGRESTQueryOperatorGreaterThanOrEqual): @">=",
+                                  @(TGRESTQueryOperatorLessThan): @"<",
+                                  @(TGRESTQueryOperatorLessThanOrEqual): @"<="};
+    NSMutableArray *conditions = [NSMutableArray new];
+    NSMutableArray *arguments = [NSMutableArray new];
+    
+    // Property names have been checked against the model by the query so only the values need to be bound, which keeps one cached statement per shape of query.
+    for (TGRESTQueryFilter *filter in query.filters) {
+        [conditions addObject:[NSString stringWithFormat:@"\"%@\" %@ ?", filter.property, comparisons[@(filter.queryOperator)]]];
+        [arguments addObject:filter.value];
+    }
+    if (afterKey && query.ordersByPrimaryKey) {
+        [conditions addObject:[NSString stringWithFormat:@"\"%@\" > ?", resource.primaryKey]];
+        [arguments addObject:[self boundPrimaryKey:afterKey forResource:resource]];
+    }
+    
+    NSMutableString *querySQL = [NSMutableString stringWithFormat:@"SELECT * FROM %@", resource.name];
+    if (conditions.count > 0) {
+        [querySQL appendFormat:@" WHERE %@", [conditions componentsJoinedByString:@" AND "]];
+    }
+    NSString *direction = query.sortDescending ? @"DESC" : @"ASC";
+    if (query.sortProperty && ![query.sortProperty isEqualToString:resource.primaryKey]) {
+        [querySQL appendFormat:@" ORDER BY \"%@\" %@, \"%@\" ASC", query.sortProperty, direction, resource.primaryKey];
+    } else {
+        [querySQL appendFormat:@" ORDER BY \"%@\" %@", resource.primaryKey, direction];
+    }
+    [querySQL appendString:@" LIMIT ?"];
+    [arguments addObject:[self boundLimit:limit]];
+    
+    return [self objectsForResource:resource withQuery:querySQL arguments:arguments];
+}
+
 - (NSDictionary *)createNewObjectForResource:(TGRESTResource *)resource
                               withProperties:(NSDictionary *)properties
                                        error:(NSError * __autoreleasing *)error
@@ -117,31 +414,21 @@
     NSParameterAssert(resource);
     NSParameterAssert(properties);
     
+    NSString *insertSQL = [self statement:TGSqliteInsertStatement forResource:resource];
+    NSDictionary *parameters = [self insertParametersWithProperties:properties forResource:resource];
     __block BOOL saveSuccess;
     __block uint64_t lastInsertRowID;
-    NSMutableString *keyString = [NSMutableString new];
-    NSMutableString *valueString = [NSMutableString new];
-    for (NSString *key in properties) {
-        [keyString appendString:[NSString stringWithFormat:@"'%@', ", key]];
-        [valueString appendString:[NSString stringWithFormat:@":%@, ", key]];
-    }
-    [keyString deleteCharactersInRange:NSMakeRange(keyString.length - 2, 2)];
-    [valueString deleteCharactersInRange:NSMakeRange(valueString.length - 2, 2)];
 
     [self.dbQueue inDatabase:^(FMDatabase *db) {
-        saveSuccess = [db executeUpdate:[NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES (%@)", resource.name, keyString, valueString] withParameterDictionary:properties];
+        saveSuccess = [db executeUpdate:insertSQL withParameterDictionary:parameters];
         if (saveSuccess) {
             lastInsertRowID = db.lastInsertRowId;
         }
     }];
     if (saveSuccess) {
-        NSMutableDictionary *dict = [properties mutableCopy];
-        if (resource.primaryKeyType == TGPropertyTypeString) {
-            [dict setObject:[NSString stringWithFormat:@"%llu", lastInsertRowID] forKey:resource.primaryKey];
-        } else {
-            [dict setObject:[NSNumber numberWithInteger:(unsigned long)lastInsertRowID] forKey:resource.primaryKey];
-        }
-        return [NSDictionary dictionaryWithDictionary:dict];
+        NSDictionary *newObject = [self createdObjectWithProperties:properties forResource:resource rowID:lastInsertRowID];
+        [self bumpVersionsForResource:resource primaryKeys:@[newObject[resource.primaryKey]]];
+        return newObject;
     } else {
         if (error) {
             *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
@@ -150,6 +437,46 @@
     }
 }
 
+- (NSArray *)createNewObjectsForResource:(TGRESTResource *)resource
+                     withPropertiesArray:(NSArray *)propertiesArray
+                                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(resource);
+    NSParameterAssert(propertiesArray);
+    
+    if (propertiesArray.count == 0) {
+        return @[];
+    }
+    
+    NSString *insertSQL = [self statement:TGSqliteInsertStatement forResource:resource];
+    NSMutableArray *newObjects = [NSMutableArray arrayWithCapacity:propertiesArray.count];
+    __block BOOL saveSuccess = YES;
+    
+    // Every row reuses the cached insert statement inside one transaction so the journal is only synced on commit.
+    [self.dbQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        for (NSDictionary *properties in propertiesArray) {
+            if (![db executeUpdate:insertSQL withParameterDictionary:[self insertParametersWithProperties:properties forResource:resource]]) {
+                TGLogError(@"Can't insert batch object for resource %@ %@", resource.name, [db lastError]);
+                saveSuccess = NO;
+                *rollback = YES;
+                break;
+            }
+            [newObjects addObject:[self createdObjectWithProperties:properties forResource:resource rowID:db.lastInsertRowId]];
+        }
+    }];
+    
+    if (!saveSuccess) {
+        if (error) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:nil];
+        }
+        return nil;
+    }
+    
+    [self bumpVersionsForResource:resource primaryKeys:[newObjects valueForKey:resource.primaryKey]];
+    
+    return [NSArray arrayWithArray:newObjects];
+}
+
 - (NSDictionary *)modifyObjectOfResource:(TGRESTResource *)resource
                           withPrimaryKey:(NSString *)primaryKey
                           withProperties:(NSDictionary *)properties
@@ -157,23 +484,39 @@
 {
     NSParameterAssert(resource);
     
-    __block BOOL updateSuccess;
-    NSMutableString *updateString = [NSMutableString new];
-    for (NSString *key in properties) {
-        [updateString appendString:[NSString stringWithFormat:@"%@ = :%@", key, key]];
+    NSString *updateSQL = [self statement:TGSqliteUpdateStatement forResource:resource];
+    NSMutableDictionary *parameters = [NSMutableDictionary new];
+    for (NSString *key in resource.model) {
+        if ([key isEqualToString:resource.primaryKey]) {
+            continue;
+        }
+        id value = properties[key];
+        [parameters setObject:value ?: [NSNull null] forKey:key];
+        [parameters setObject:[NSNumber numberWithBool:(value != nil)] forKey:[TGSqliteUpdateFlagPrefix stringByAppendingString:key]];
     }
+    [parameters setObject:primaryKey forKey:resource.primaryKey];
+    
+    __block BOOL updateSuccess;
+    __block BOOL rowChanged = NO;
 
     [self.dbQueue inDatabase:^(FMDatabase *db) {
-        updateSuccess = [db executeUpdate:[NSString stringWithFormat:@"UPDATE OR ROLLBACK %@ SET %@ WHERE %@ = %@", resource.name, updateString, resource.primaryKey, primaryKey] withParameterDictionary:properties];
+        updateSuccess = [db executeUpdate:updateSQL withParameterDictionary:parameters];
         if (!updateSuccess && error) {
             *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:@{NSLocalizedDescriptionKey: db.lastErrorMessage}];
         }
+        rowChanged = updateSuccess && db.changes > 0;
     }];
     
     if (!updateSuccess) {
         return nil;
     }
     
+    // A key that matches no row leaves the versions alone, the read below reports it as missing or deleted.
+    if (rowChanged) {
+        [self bumpVersionsForResource:resource primaryKeys:@[primaryKey]];
+        [self.fragmentCache invalidateObjectOfResource:resource withPrimaryKey:[self boundPrimaryKey:primaryKey forResource:resource]];
+    }
+    
     return [self getDataForObjectOfResource:resource withPrimaryKey:primaryKey error:error];
 }
 
@@ -184,18 +527,94 @@
     NSParameterAssert(resource);
     NSParameterAssert(primaryKey);
     
+    NSString *deleteSQL = [self statement:TGSqliteDeleteStatement forResource:resource];
+    NSMutableArray *nullifySQL = [NSMutableArray new];
+    NSMutableArray *nullifiedChildren = [NSMutableArray new];
+    for (TGRESTResource *child in resource.childResources) {
+        NSString *childSQL = [self statement:[NSString stringWithFormat:@"%@.%@", TGSqliteNullifyStatement, resource.name] forResource:child];
+        if (childSQL) {
+            [nullifySQL addObject:childSQL];
+            [nullifiedChildren addObject:child];
+        }
+    }
     __block BOOL deleteSuccess;
+    __block BOOL rowDeleted = NO;
     
-    [self.dbQueue inDatabase:^(FMDatabase *db) {
-        deleteSuccess = [db executeUpdate:[NSString stringWithFormat:@"DELETE FROM %@ WHERE %@ = %@", resource.name, resource.primaryKey, primaryKey]];
-        if (!deleteSuccess && error) {
-            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:@{NSLocalizedDescriptionKey: db.lastErrorMessage}];
+    [self.dbQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        deleteSuccess = [db executeUpdate:deleteSQL, primaryKey];
+        rowDeleted = deleteSuccess && db.changes > 0;
+        for (NSString *childSQL in nullifySQL) {
+            if (!deleteSuccess || !rowDeleted) {
+                break;
+            }
+            deleteSuccess = [db executeUpdate:childSQL, primaryKey];
+        }
+        if (!deleteSuccess) {
+            if (error) {
+                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:@{NSLocalizedDescriptionKey: db.lastErrorMessage}];
+            }
+            *rollback = YES;
         }
     }];
     
+    if (deleteSuccess && rowDeleted) {
+        [self bumpVersionsForResource:resource primaryKeys:@[primaryKey]];
+        [self.fragmentCache invalidateObjectOfResource:resource withPrimaryKey:[self boundPrimaryKey:primaryKey forResource:resource]];
+        // The nulled children aren't known individually so every version of the child resource moves on.
+        for (TGRESTResource *child in nullifiedChildren) {
+            [self resetVersionsForResource:child];
+            [self.fragmentCache invalidateResource:child];
+        }
+    }
+    
     return deleteSuccess;
 }
 
+- (NSArray *)performOperations:(NSArray *)operations
+                         error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(operations);
+    
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:operations.count];
+    NSMutableArray *writtenObjects = [NSMutableArray new];
+    NSMutableSet *nullifiedChildren = [NSMutableSet new];
+    __block NSError *operationError;
+    
+    [self.dbQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        for (TGRESTStoreOperation *unresolvedOperation in operations) {
+            TGRESTStoreOperation *operation = [unresolvedOperation operationByResolvingReferencesWithOperations:operations results:results error:&operationError];
+            id result = operation ? [self applyOperation:operation toDatabase:db nullifiedChildren:nullifiedChildren error:&operationError] : nil;
+            if (!result) {
+                *rollback = YES;
+                return;
+            }
+            [results addObject:result];
+            if (operation.type != TGRESTStoreOperationTypeRead) {
+                [writtenObjects addObject:@[operation.resource, operation.primaryKey ?: [result[operation.resource.primaryKey] description]]];
+            }
+        }
+    }];
+    
+    if (results.count != operations.count) {
+        if (error) {
+            *error = TGRESTStoreErrorForOperationAtIndex(operationError, results.count);
+        }
+        return nil;
+    }
+    
+    for (NSArray *writtenObject in writtenObjects) {
+        TGRESTResource *resource = writtenObject[0];
+        [self bumpVersionsForResource:resource primaryKeys:@[writtenObject[1]]];
+        [self.fragmentCache invalidateObjectOfResource:resource withPrimaryKey:[self boundPrimaryKey:writtenObject[1] forResource:resource]];
+    }
+    for (TGRESTResource *child in nullifiedChildren) {
+        [self resetVersionsForResource:child];
+        [self.fragmentCache invalidateResource:child];
+    }
+    
+    return [NSArray arrayWithArray:results];
+}
+
 - (void)addResource:(TGRESTResource *)resource
 {
     NSParameterAssert(resource);
@@ -245,19 +664,388 @@
                 *rollback = YES;
                 return;
             }
+            
+            [db clearCachedStatements];
         }];
+        [self.readPool releaseAllDatabases];
     }
+    
+    [self updateIndexesForResource:resource];
+    
+    NSMutableDictionary *statements = [NSMutableDictionary dictionaryWithDictionary:self.statements];
+    [statements setObject:[self statementsForResource:resource] forKey:resource.name];
+    self.statements = statements;
+    
+    [self resetVersionsForResource:resource];
+    [self.fragmentCache invalidateResource:resource];
 }
 
 - (void)dropResource:(TGRESTResource *)resource
 {
     NSParameterAssert(resource);
     
+    NSMutableDictionary *statements = [NSMutableDictionary dictionaryWithDictionary:self.statements];
+    [statements removeObjectForKey:resource.name];
+    self.statements = statements;
+    
     [self.dbQueue inDatabase:^(FMDatabase *db) {
+        [db clearCachedStatements];
         if (![db executeUpdate:[NSString stringWithFormat:@"DROP TABLE IF EXISTS %@", resource.name]]) {
             TGLogError(@"ERROR: Can't drop table for resource %@ %@", resource.name, [db lastError]);
         }
     }];
+    [self.readPool releaseAllDatabases];
+    
+    dispatch_barrier_sync(self.versionQueue, ^{
+        [self.generations removeObjectForKey:resource.name];
+        [self.baseVersions removeObjectForKey:resource.name];
+        [self.objectVersions removeObjectForKey:resource.name];
+    });
+    [self.fragmentCache invalidateResource:resource];
+}
+
+#pragma mark - Private
+
+- (void)setCachesStatements:(BOOL)cachesStatements
+{
+    _cachesStatements = cachesStatements;
+    
+    [self.dbQueue inDatabase:^(FMDatabase *db) {
+        db.shouldCacheStatements = cachesStatements;
+        if (!cachesStatements) {
+            [db clearCachedStatements];
+        }
+    }];
+    [self.readPool releaseAllDatabases];
+}
+
+- (void)readDatabase:(void (^)(FMDatabase *db))block
+{
+    FMDatabasePool *readPool = self.readPool;
+    if (readPool) {
+        dispatch_semaphore_t readSemaphore = self.readSemaphore;
+        dispatch_semaphore_wait(readSemaphore, DISPATCH_TIME_FOREVER);
+        [readPool inDatabase:block];
+        dispatch_semaphore_signal(readSemaphore);
+    } else {
+        [self.dbQueue inDatabase:block];
+    }
+}
+
+- (void)applyConnectionPragmasToDatabase:(FMDatabase *)db
+{
+    db.shouldCacheStatements = self.cachesStatements;
+    if (self.mmapSize) {
+        // The pragma echoes back the size it settled on so it has to be stepped like a query.
+        [db longForQuery:[NSString stringWithFormat:@"PRAGMA mmap_size = %lld", [self.mmapSize longLongValue]]];
+    }
+    if (self.cacheSize) {
+        [db executeUpdate:[NSString stringWithFormat:@"PRAGMA cache_size = %lld", [self.cacheSize longLongValue]]];
+    }
+}
+
+#pragma mark - FMDatabasePoolDelegate
+
+- (BOOL)databasePool:(FMDatabasePool *)pool shouldAddDatabaseToPool:(FMDatabase *)database
+{
+    [self applyConnectionPragmasToDatabase:database];
+    
+    return YES;
+}
+
+- (NSDictionary *)statementsForResource:(TGRESTResource *)resource
+{
+    NSMutableDictionary *statements = [NSMutableDictionary new];
+    NSString *table = resource.name;
+    NSString *primaryKey = resource.primaryKey;
+    
+    [statements setObject:[NSString stringWithFormat:@"SELECT COUNT(\"%@\") FROM %@", primaryKey, table] forKey:TGSqliteCountStatement];
+    [statements setObject:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ?", table, primaryKey] forKey:TGSqliteShowStatement];
+    [statements setObject:[NSString stringWithFormat:@"SELECT * FROM %@ ORDER BY \"%@\"", table, primaryKey] forKey:TGSqliteIndexStatement];
+    [statements setObject:[NSString stringWithFormat:@"DELETE FROM %@ WHERE \"%@\" = ?", table, primaryKey] forKey:TGSqliteDeleteStatement];
+    [statements setObject:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" > ? ORDER BY \"%@\" LIMIT ?", table, primaryKey, primaryKey] forKey:TGSqlitePageStatement];
+    [statements setObject:[NSString stringWithFormat:@"SELECT * FROM %@ ORDER BY \"%@\" LIMIT ?", table, primaryKey] forKey:TGSqliteFirstPageStatement];
+    
+    for (TGRESTResource *parent in resource.parentResources) {
+        NSString *foreignKey = resource.foreignKeys[parent.name];
+        NSString *nestedSQL = [NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ? ORDER BY \"%@\"", table, foreignKey, primaryKey];
+        NSString *nullifySQL = [NSString stringWithFormat:@"UPDATE %@ SET \"%@\" = NULL WHERE \"%@\" = ?", table, foreignKey, foreignKey];
+        [statements setObject:nestedSQL forKey:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedIndexStatement, parent.name]];
+        [statements setObject:nullifySQL forKey:[NSString stringWithFormat:@"%@.%@", TGSqliteNullifyStatement, parent.name]];
+        NSString *nestedPageSQL = [NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ? AND \"%@\" > ? ORDER BY \"%@\" LIMIT ?", table, foreignKey, primaryKey, primaryKey];
+        NSString *nestedFirstPageSQL = [NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ? ORDER BY \"%@\" LIMIT ?", table, foreignKey, primaryKey];
+        [statements setObject:nestedPageSQL forKey:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedPageStatement, parent.name]];
+        [statements setObject:nestedFirstPageSQL forKey:[NSString stringWithFormat:@"%@.%@", TGSqliteNestedFirstPageStatement, parent.name]];
+    }
+    
+    NSMutableArray *columns = [NSMutableArray new];
+    NSMutableArray *values = [NSMutableArray new];
+    NSMutableArray *assignments = [NSMutableArray new];
+    for (NSString *key in resource.model) {
+        if ([key isEqualToString:primaryKey]) {
+            continue;
+        }
+        [columns addObject:[NSString stringWithFormat:@"\"%@\"", key]];
+        [values addObject:[NSString stringWithFormat:@":%@", key]];
+        // Columns that were not part of the request keep their current value so one statement covers every partial update.
+        [assignments addObject:[NSString stringWithFormat:@"\"%@\" = CASE WHEN :%@%@ THEN :%@ ELSE \"%@\" END", key, TGSqliteUpdateFlagPrefix, key, key, key]];
+    }
+    
+    if (columns.count > 0) {
+        [statements setObject:[NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES (%@)", table, [columns componentsJoinedByString:@", "], [values componentsJoinedByString:@", "]] forKey:TGSqliteInsertStatement];
+        [statements setObject:[NSString stringWithFormat:@"UPDATE OR ROLLBACK %@ SET %@ WHERE \"%@\" = :%@", table, [assignments componentsJoinedByString:@", "], primaryKey, primaryKey] forKey:TGSqliteUpdateStatement];
+    } else {
+        [statements setObject:[NSString stringWithFormat:@"INSERT INTO %@ DEFAULT VALUES", table] forKey:TGSqliteInsertStatement];
+        [statements setObject:[NSString stringWithFormat:@"UPDATE OR ROLLBACK %@ SET \"%@\" = \"%@\" WHERE \"%@\" = :%@", table, primaryKey, primaryKey, primaryKey, primaryKey] forKey:TGSqliteUpdateStatement];
+    }
+    
+    return [NSDictionary dictionaryWithDictionary:statements];
+}
+
+- (NSDictionary *)indexColumnsForResource:(TGRESTResource *)resource
+{
+    NSMutableDictionary *indexColumns = [NSMutableDictionary new];
+    for (TGRESTResource *parent in resource.parentResources) {
+        NSString *foreignKey = resource.foreignKeys[parent.name];
+        if (foreignKey && resource.model[foreignKey]) {
+            [indexColumns setObject:foreignKey forKey:[NSString stringWithFormat:@"%@_%@_fk_index", resource.name, foreignKey]];
+        }
+    }
+    for (NSString *property in resource.indexedProperties) {
+        [indexColumns setObject:property forKey:[NSString stringWithFormat:@"%@_%@_index", resource.name, property]];
+    }
+    
+    return indexColumns;
+}
+
+- (void)updateIndexesForResource:(TGRESTResource *)resource
+{
+    NSDictionary *indexColumns = [self indexColumnsForResource:resource];
+    NSString *indexPrefix = [resource.name stringByAppendingString:@"_"];
+    
+    // Indexes are not part of the column schema so a table that is kept around only gets the ones it is missing and loses the ones that are no longer declared.
+    [self.dbQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        NSMutableSet *existingIndexes = [NSMutableSet new];
+        FMResultSet *indexList = [db executeQuery:[NSString stringWithFormat:@"PRAGMA index_list(%@)", resource.name]];
+        while ([indexList next]) {
+            [existingIndexes addObject:[indexList stringForColumn:@"name"]];
+        }
+        [indexList close];
+        
+        for (NSString *indexName in existingIndexes) {
+            if (indexColumns[indexName] || ![indexName hasPrefix:indexPrefix] || ![indexName hasSuffix:@"_index"]) {
+                continue;
+            }
+            if (![db executeUpdate:[NSString stringWithFormat:@"DROP INDEX IF EXISTS \"%@\"", indexName]]) {
+                TGLogError(@"ERROR: Can't drop index %@ for resource %@ %@", indexName, resource.name, [db lastError]);
+                *rollback = YES;
+                return;
+            }
+        }
+        
+        for (NSString *indexName in indexColumns) {
+            if ([existingIndexes containsObject:indexName]) {
+                continue;
+            }
+            if (![db executeUpdate:[NSString stringWithFormat:@"CREATE INDEX IF NOT EXISTS \"%@\" ON %@ (\"%@\")", indexName, resource.name, indexColumns[indexName]]]) {
+                TGLogError(@"ERROR: Can't create index %@ for resource %@ %@", indexName, resource.name, [db lastError]);
+                *rollback = YES;
+                return;
+            }
+        }
+    }];
+}
+
+- (id)applyOperation:(TGRESTStoreOperation *)operation
+          toDatabase:(FMDatabase *)db
+   nullifiedChildren:(NSMutableSet *)nullifiedChildren
+               error:(NSError * __autoreleasing *)error
+{
+    TGRESTResource *resource = operation.resource;
+    
+    if (operation.type == TGRESTStoreOperationTypeCreate) {
+        if (![db executeUpdate:[self statement:TGSqliteInsertStatement forResource:resource] withParameterDictionary:[self insertParametersWithProperties:operation.properties forResource:resource]]) {
+            if (error) {
+                *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreUnknownErrorCode userInfo:@{NSLocalizedDescriptionKey: db.lastErrorMessage}];
+            }
+            return nil;
+        }
+        return [self createdObjectWithProperties:operation.properties forResource:resource rowID:db.lastInsertRowId];
+    }
+    
+    NSString *primaryKey = operation.primaryKey;
+    BOOL success = YES;
+    if (operation.type == TGRESTStoreOperationTypeModify) {
+        NSMutableDictionary *parameters = [NSMutableDictionary new];
+        for (NSString *key in resource.model) {
+            if ([key isEqualToString:resource.primaryKey]) {
+                continue;
+            }
+            id value = operation.properties[key];
+            [parameters setObject:value ?: [NSNull null] forKey:key];
+            [parameters setObject:[NSNumber numberWithBool:(value != nil)] forKey:[TGSqliteUpdateFlagPrefix stringByAppendingString:key]];
+        }
+        [parameters setObject:primaryKey forKey:resource.primaryKey];
+        success = [db executeUpdate:[self statement:TGSqliteUpdateStatement forResource:resource] withParameterDictionary:parameters] && db.changes > 0;
+    } else if (operation.type == TGRESTStoreOperationTypeDelete) {
+        success = [db executeUpdate:[self statement:TGSqliteDeleteStatement forResource:resource], primaryKey] && db.changes > 0;
+        for (TGRESTResource *child in resource.childResources) {
+            NSString *childSQL = [self statement:[NSString stringWithFormat:@"%@.%@", TGSqliteNullifyStatement, resource.name] forResource:child];
+            if (!success || !childSQL) {
+                continue;
+            }
+            success = [db executeUpdate:childSQL, primaryKey];
+            [nullifiedChildren addObject:child];
+        }
+        if (success) {
+            return [NSNull null];
+        }
+    }
+    
+    NSDictionary *object;
+    if (success) {
+        FMResultSet *results = [db executeQuery:[self statement:TGSqliteShowStatement forResource:resource], primaryKey];
+        if ([results next]) {
+            object = [self objectFromResultSet:results forResource:resource];
+        }
+        [results close];
+    }
+    
+    if (!object && error) {
+        // Same rule as a single read, a missing key at or below the last inserted row is taken to be deleted.
+        if ([primaryKey integerValue] <= db.lastInsertRowId) {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectAlreadyDeletedErrorCode userInfo:nil];
+        } else {
+            *error = [NSError errorWithDomain:TGRESTStoreErrorDomain code:TGRESTStoreObjectNotFoundErrorCode userInfo:nil];
+        }
+    }
+    
+    return object;
+}
+
+- (NSString *)statement:(NSString *)statementName forResource:(TGRESTResource *)resource
+{
+    NSDictionary *statements = self.statements[resource.name];
+    if (!statements) {
+        statements = [self statementsForResource:resource];
+    }
+    
+    return statements[statementName];
+}
+
+- (NSDictionary *)insertParametersWithProperties:(NSDictionary *)properties forResource:(TGRESTResource *)resource
+{
+    NSMutableDictionary *parameters = [NSMutableDictionary dictionaryWithCapacity:resource.model.count];
+    for (NSString *key in resource.model) {
+        if (![key isEqualToString:resource.primaryKey]) {
+            [parameters setObject:properties[key] ?: [NSNull null] forKey:key];
+        }
+    }
+    
+    return parameters;
+}
+
+- (NSArray *)objectsForResource:(TGRESTResource *)resource withQuery:(NSString *)sql arguments:(NSArray *)arguments
+{
+    NSMutableArray *returnArray = [NSMutableArray new];
+    [self readDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:sql withArgumentsInArray:arguments];
+        while ([results next]) {
+            [returnArray addObject:[self objectFromResultSet:results forResource:resource]];
+        }
+        [results close];
+    }];
+    
+    return returnArray;
+}
+
+- (NSEnumerator *)keysetCursorForResource:(TGRESTResource *)resource
+{
+    // Without WAL an open result set would keep writers out of the database for as long as the cursor lives, so each batch is a short keyset query instead.
+    NSString *firstPageSQL = [self statement:TGSqliteFirstPageStatement forResource:resource];
+    NSString *pageSQL = [self statement:TGSqlitePageStatement forResource:resource];
+    NSNumber *batchLimit = [self boundLimit:TGSqliteCursorBatchSize];
+    __block id lastKey;
+    
+    return [[TGRESTSqliteCursor alloc] initWithBatchBlock:^NSArray *{
+        NSArray *batch;
+        if (lastKey) {
+            batch = [self objectsForResource:resource withQuery:pageSQL arguments:@[lastKey, batchLimit]];
+        } else {
+            batch = [self objectsForResource:resource withQuery:firstPageSQL arguments:@[batchLimit]];
+        }
+        lastKey = [[batch lastObject] objectForKey:resource.primaryKey];
+        return batch;
+    } completionBlock:nil];
+}
+
+- (void)bumpVersionsForResource:(TGRESTResource *)resource primaryKeys:(NSArray *)primaryKeys
+{
+    // Called once the write has committed so a reader never pairs a new version with old data.
+    dispatch_barrier_sync(self.versionQueue, ^{
+        NSNumber *generation = [NSNumber numberWithUnsignedInteger:TGRESTStoreNextGeneration()];
+        NSMutableDictionary *versions = self.objectVersions[resource.name];
+        if (!versions) {
+            versions = [NSMutableDictionary new];
+            [self.objectVersions setObject:versions forKey:resource.name];
+        }
+        for (id primaryKey in primaryKeys) {
+            [versions setObject:generation forKey:[self boundPrimaryKey:[primaryKey description] forResource:resource]];
+        }
+        [self.generations setObject:generation forKey:resource.name];
+    });
+}
+
+- (void)resetVersionsForResource:(TGRESTResource *)resource
+{
+    // Rows that were already in the table when the resource was added, or that were changed in bulk, fall back to the base version.
+    dispatch_barrier_sync(self.versionQueue, ^{
+        NSNumber *generation = [NSNumber numberWithUnsignedInteger:TGRESTStoreNextGeneration()];
+        [self.generations setObject:generation forKey:resource.name];
+        [self.baseVersions setObject:generation forKey:resource.name];
+        [self.objectVersions setObject:[NSMutableDictionary new] forKey:resource.name];
+    });
+}
+
+- (id)boundPrimaryKey:(NSString *)primaryKey forResource:(TGRESTResource *)resource
+{
+    if (resource.primaryKeyType == TGPropertyTypeInteger) {
+        return [NSNumber numberWithLongLong:[primaryKey longLongValue]];
+    }
+    
+    return [primaryKey description];
+}
+
+- (NSNumber *)boundLimit:(NSUInteger)limit
+{
+    // A negative limit means no limit to sqlite.
+    if (limit > LLONG_MAX) {
+        return @(-1);
+    }
+    
+    return [NSNumber numberWithLongLong:(long long)limit];
+}
+
+- (NSDictionary *)objectFromResultSet:(FMResultSet *)results forResource:(TGRESTResource *)resource
+{
+    NSMutableDictionary *objectDict = [NSMutableDictionary new];
+    for (NSString *key in resource.model) {
+        [objectDict setObject:[results objectForColumnName:key] forKey:key];
+    }
+    
+    return objectDict;
+}
+
+- (NSDictionary *)createdObjectWithProperties:(NSDictionary *)properties forResource:(TGRESTResource *)resource rowID:(uint64_t)rowID
+{
+    NSMutableDictionary *dict = [properties mutableCopy];
+    if (resource.primaryKeyType == TGPropertyTypeString) {
+        [dict setObject:[NSString stringWithFormat:@"%llu", rowID] forKey:resource.primaryKey];
+    } else {
+        [dict setObject:[NSNumber numberWithInteger:(unsigned long)rowID] forKey:resource.primaryKey];
+    }
+    
+    return [NSDictionary dictionaryWithDictionary:dict];
 }
 
 + (NSString *)description
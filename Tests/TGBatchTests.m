@@ -0,0 +1,242 @@
+//
+//  TGBatchTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "TGRESTSqliteStore.h"
+#import "TGRESTColumnarStore.h"
+#import "TGRESTStoreOperation.h"
+
+@interface TGBatchTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testParentResource;
+@property (nonatomic, strong) TGRESTResource *testChildResource;
+@property (nonatomic, strong) NSArray *stores;
+
+@end
+
+@implementation TGBatchTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.testParentResource = [TGTestFactory testResource];
+    self.testChildResource = [TGTestFactory testResourceWithParent:self.testParentResource];
+    self.stores = @[[TGRESTInMemoryStore new], [TGRESTSqliteStore new]];
+    for (TGRESTStore *store in self.stores) {
+        [store addResource:self.testParentResource];
+        [store addResource:self.testChildResource];
+    }
+}
+
+- (void)tearDown
+{
+    for (TGRESTStore *store in self.stores) {
+        [store dropResource:self.testParentResource];
+        [store dropResource:self.testChildResource];
+    }
+    [[TGRESTServer sharedServer] removeAllResourcesWithData:YES];
+    [[TGRESTServer sharedServer] stopServer];
+    
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)sendBatch:(id)batch data:(NSData **)data
+{
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@_batch", [[TGRESTServer sharedServer] serverURL]]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"POST";
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    request.HTTPBody = [batch isKindOfClass:[NSData class]] ? batch : [NSJSONSerialization dataWithJSONObject:batch options:kNilOptions error:nil];
+    
+    NSHTTPURLResponse *response;
+    NSData *responseData = [NSURLConnection sendSynchronousRequest:request returningResponse:&response error:nil];
+    if (data) {
+        *data = responseData;
+    }
+    
+    return response;
+}
+
+- (void)testOperationsReferenceEarlierResults
+{
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSArray *operations = @[[TGRESTStoreOperation createOperationWithResource:self.testParentResource properties:@{@"name": @"John"}],
+                            [TGRESTStoreOperation createOperationWithResource:self.testChildResource properties:@{@"name": @"Mustang", foreignKey: [TGRESTStoreOperation referenceToOperationAtIndex:0]}],
+                            [TGRESTStoreOperation modifyOperationWithResource:self.testParentResource primaryKey:[TGRESTStoreOperation referenceToOperationAtIndex:0] properties:@{@"name": @"Johnny"}],
+                            [TGRESTStoreOperation readOperationWithResource:self.testChildResource primaryKey:[TGRESTStoreOperation referenceToOperationAtIndex:1]]];
+    
+    for (TGRESTStore *store in self.stores) {
+        NSError *error;
+        NSArray *results = [store performOperations:operations error:&error];
+        
+        XCTAssert(results.count == 4 && !error, @"Every operation must have a result in %@ %@", store, error);
+        id parentKey = results[0][self.testParentResource.primaryKey];
+        XCTAssert([[results[1][foreignKey] description] isEqualToString:[parentKey description]], @"The reference must be replaced with the key of the created parent in %@", store);
+        XCTAssert([results[2][@"name"] isEqualToString:@"Johnny"], @"The modify must see the created object in %@", store);
+        XCTAssert([[results[3][foreignKey] description] isEqualToString:[parentKey description]], @"The read must see the created child in %@", store);
+        
+        NSDictionary *parent = [store getDataForObjectOfResource:self.testParentResource withPrimaryKey:[parentKey description] error:nil];
+        XCTAssert([parent[@"name"] isEqualToString:@"Johnny"], @"The batch must be committed in %@", store);
+    }
+}
+
+- (void)testDeleteNullsChildren
+{
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    
+    for (TGRESTStore *store in self.stores) {
+        NSDictionary *parent = [store createNewObjectForResource:self.testParentResource withProperties:@{@"name": @"John"} error:nil];
+        NSString *parentKey = [parent[self.testParentResource.primaryKey] description];
+        NSDictionary *child = [store createNewObjectForResource:self.testChildResource withProperties:@{@"name": @"Mustang", foreignKey: parentKey} error:nil];
+        NSString *childKey = [child[self.testChildResource.primaryKey] description];
+        
+        NSError *error;
+        NSArray *results = [store performOperations:@[[TGRESTStoreOperation deleteOperationWithResource:self.testParentResource primaryKey:parentKey],
+                                                      [TGRESTStoreOperation readOperationWithResource:self.testChildResource primaryKey:childKey]]
+                                              error:&error];
+        
+        XCTAssert(results[0] == [NSNull null], @"Deletes must have a null result in %@ %@", store, error);
+        XCTAssert(results[1][foreignKey] == [NSNull null], @"The child must be nulled before the next operation runs in %@", store);
+        [store getDataForObjectOfResource:self.testParentResource withPrimaryKey:parentKey error:&error];
+        XCTAssert(error.code == TGRESTStoreObjectAlreadyDeletedErrorCode, @"The parent must be deleted in %@", store);
+    }
+}
+
+#pragma mark - Negative testing
+
+- (void)testFailedBatchRollsBack
+{
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    
+    for (TGRESTStore *store in self.stores) {
+        NSDictionary *parent = [store createNewObjectForResource:self.testParentResource withProperties:@{@"name": @"John"} error:nil];
+        NSString *parentKey = [parent[self.testParentResource.primaryKey] description];
+        NSDictionary *child = [store createNewObjectForResource:self.testChildResource withProperties:@{@"name": @"Mustang", foreignKey: parentKey} error:nil];
+        NSString *childKey = [child[self.testChildResource.primaryKey] description];
+        
+        NSError *error;
+        NSArray *results = [store performOperations:@[[TGRESTStoreOperation createOperationWithResource:self.testParentResource properties:@{@"name": @"Jane"}],
+                                                      [TGRESTStoreOperation modifyOperationWithResource:self.testChildResource primaryKey:childKey properties:@{@"name": @"Pinto"}],
+                                                      [TGRESTStoreOperation deleteOperationWithResource:self.testParentResource primaryKey:parentKey],
+                                                      [TGRESTStoreOperation modifyOperationWithResource:self.testParentResource primaryKey:@"999" properties:@{@"name": @"Nobody"}]]
+                                              error:&error];
+        
+        XCTAssertNil(results, @"A failed batch must not return results in %@", store);
+        XCTAssert(error.code == TGRESTStoreObjectNotFoundErrorCode, @"The error must be the one of the failed operation in %@ %@", store, error);
+        XCTAssert([error.userInfo[TGRESTStoreFailedOperationIndexErrorKey] unsignedIntegerValue] == 3, @"The error must carry the index of the failed operation in %@", store);
+        
+        XCTAssert([store countOfObjectsForResource:self.testParentResource] == 1, @"The create must be rolled back in %@", store);
+        NSDictionary *storedParent = [store getDataForObjectOfResource:self.testParentResource withPrimaryKey:parentKey error:nil];
+        XCTAssert([storedParent[@"name"] isEqualToString:@"John"], @"The delete must be rolled back in %@", store);
+        NSDictionary *storedChild = [store getDataForObjectOfResource:self.testChildResource withPrimaryKey:childKey error:nil];
+        XCTAssert([storedChild[@"name"] isEqualToString:@"Mustang"], @"The modify must be rolled back in %@", store);
+        XCTAssert([[storedChild[foreignKey] description] isEqualToString:parentKey], @"The nulled foreign key must be rolled back in %@", store);
+    }
+}
+
+- (void)testUnresolvableReferenceFails
+{
+    NSArray *operations = @[[TGRESTStoreOperation createOperationWithResource:self.testParentResource properties:@{@"name": @"John"}],
+                            [TGRESTStoreOperation deleteOperationWithResource:self.testParentResource primaryKey:[TGRESTStoreOperation referenceToOperationAtIndex:0]],
+                            [TGRESTStoreOperation readOperationWithResource:self.testParentResource primaryKey:[TGRESTStoreOperation referenceToOperationAtIndex:1]]];
+    
+    for (TGRESTStore *store in self.stores) {
+        NSError *error;
+        NSArray *results = [store performOperations:operations error:&error];
+        
+        XCTAssertNil(results, @"A reference to a delete must fail in %@", store);
+        XCTAssert(error.code == TGRESTStoreBadRequestErrorCode && [error.userInfo[TGRESTStoreFailedOperationIndexErrorKey] unsignedIntegerValue] == 2, @"The reference must be a bad request in %@ %@", store, error);
+        XCTAssert([store countOfObjectsForResource:self.testParentResource] == 0, @"The batch must be rolled back in %@", store);
+    }
+}
+
+- (void)testStoreWithoutRollbackRefusesWrites
+{
+    TGRESTColumnarStore *store = [TGRESTColumnarStore new];
+    [store addResource:self.testParentResource];
+    NSDictionary *parent = [store createNewObjectForResource:self.testParentResource withProperties:@{@"name": @"John"} error:nil];
+    NSString *parentKey = [parent[self.testParentResource.primaryKey] description];
+    
+    NSError *error;
+    NSArray *results = [store performOperations:@[[TGRESTStoreOperation readOperationWithResource:self.testParentResource primaryKey:parentKey],
+                                                  [TGRESTStoreOperation createOperationWithResource:self.testParentResource properties:@{@"name": @"Jane"}],
+                                                  [TGRESTStoreOperation deleteOperationWithResource:self.testParentResource primaryKey:parentKey]]
+                                          error:&error];
+    
+    XCTAssertNil(results, @"A batch with writes must be refused");
+    XCTAssert(error.code == TGRESTStoreUnsupportedOperationErrorCode && [error.userInfo[TGRESTStoreFailedOperationIndexErrorKey] unsignedIntegerValue] == 1, @"The error must point at the first write %@", error);
+    XCTAssert([store countOfObjectsForResource:self.testParentResource] == 1, @"Nothing must be written");
+    XCTAssert([store getDataForObjectOfResource:self.testParentResource withPrimaryKey:parentKey error:nil], @"Nothing must be deleted");
+    
+    results = [store performOperations:@[[TGRESTStoreOperation readOperationWithResource:self.testParentResource primaryKey:parentKey]] error:&error];
+    XCTAssert([results.firstObject[@"name"] isEqualToString:@"John"], @"A batch that only reads must still run");
+    
+    [store dropResource:self.testParentResource];
+}
+
+#pragma mark - Endpoint
+
+- (void)testBatchEndpoint
+{
+    TGRESTServer *server = [TGRESTServer sharedServer];
+    [server addResource:self.testParentResource];
+    [server addResource:self.testChildResource];
+    [server startServerWithOptions:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    
+    NSData *data;
+    NSHTTPURLResponse *response = [self sendBatch:@[@{@"method": @"POST", @"resource": self.testParentResource.name, @"body": @{@"name": @"John"}},
+                                                    @{@"method": @"POST", @"resource": self.testChildResource.name, @"body": @{@"name": @"Mustang", foreignKey: @"$0"}},
+                                                    @{@"method": @"GET", @"resource": self.testParentResource.name, @"id": @"$0"},
+                                                    @{@"method": @"DELETE", @"resource": self.testChildResource.name, @"id": @"$1"}]
+                                             data:&data];
+    NSArray *results = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:nil];
+    
+    XCTAssert(response.statusCode == 200 && results.count == 4, @"The batch must succeed %@", results);
+    XCTAssert([results[0][@"status"] integerValue] == 200 && [results[0][@"body"][@"name"] isEqualToString:@"John"], @"Creates must return the object");
+    XCTAssert([[results[1][@"body"][foreignKey] description] isEqualToString:[results[0][@"body"][self.testParentResource.primaryKey] description]], @"References must be resolved");
+    XCTAssert([results[3][@"status"] integerValue] == 204 && !results[3][@"body"], @"Deletes must not have a body");
+    XCTAssert([server numberOfObjectsForResource:self.testChildResource] == 0, @"The batch must be applied");
+    
+    response = [self sendBatch:@[@{@"method": @"POST", @"resource": self.testParentResource.name, @"body": @{@"name": @"Jane"}},
+                                 @{@"method": @"PUT", @"resource": self.testParentResource.name, @"id": @"999", @"body": @{@"name": @"Nobody"}}]
+                          data:&data];
+    NSDictionary *failure = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:nil];
+    
+    XCTAssert(response.statusCode == 404, @"The batch must fail with the status of the failed operation");
+    XCTAssert([failure[@"index"] integerValue] == 1, @"The response must say which operation failed %@", failure);
+    XCTAssert([server numberOfObjectsForResource:self.testParentResource] == 1, @"The failed batch must be rolled back");
+    
+    TGRESTRouteMetrics *metrics = [server batchMetrics];
+    XCTAssert(metrics.handlerTime.count == 2 && metrics.storeTime.count == 2, @"Every batch must be measured");
+    XCTAssert([metrics countForStatusCode:200] == 1 && [metrics countForStatusCode:404] == 1, @"Batch status codes must be counted %@", [metrics statusCodeCounts]);
+    XCTAssert(metrics.requestBytes.maximum > 0 && metrics.storeTime.maximum <= metrics.handlerTime.maximum, @"Batch sizes and store time must be measured");
+}
+
+- (void)testBatchEndpointRejectsInvalidOperations
+{
+    TGRESTServer *server = [TGRESTServer sharedServer];
+    [server addResource:self.testParentResource];
+    [server startServerWithOptions:nil];
+    
+    XCTAssert([self sendBatch:[@"{\"method\": \"GET\"}" dataUsingEncoding:NSUTF8StringEncoding] data:nil].statusCode == 400, @"The body must be an array");
+    XCTAssert([self sendBatch:@[] data:nil].statusCode == 400, @"An empty batch must be rejected");
+    
+    NSData *data;
+    NSHTTPURLResponse *response = [self sendBatch:@[@{@"method": @"POST", @"resource": self.testParentResource.name, @"body": @{@"name": @"John"}},
+                                                    @{@"method": @"POST", @"resource": @"unknown", @"body": @{@"name": @"John"}}]
+                                             data:&data];
+    NSDictionary *failure = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:nil];
+    
+    XCTAssert(response.statusCode == 400 && [failure[@"index"] integerValue] == 1, @"Unknown resources must be rejected %@", failure);
+    XCTAssert([server numberOfObjectsForResource:self.testParentResource] == 0, @"Nothing must run when an operation is invalid");
+}
+
+@end
@@ -0,0 +1,104 @@
+//
+//  TGBodyDecoderTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+#import "TGRESTBodyDecoder.h"
+
+@interface TGBodyDecoderTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testResource;
+@property (nonatomic, strong) TGRESTBodyDecoder *decoder;
+
+@end
+
+@implementation TGBodyDecoderTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.testResource = [TGRESTResource newResourceWithName:@"measurement" model:@{
+                                                                                  @"label": [NSNumber numberWithInteger:TGPropertyTypeString],
+                                                                                  @"count": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                                                                                  @"reading": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint],
+                                                                                  @"payload": [NSNumber numberWithInteger:TGPropertyTypeBlob]
+                                                                                  }];
+    self.decoder = [TGRESTBodyDecoder decoderWithResource:self.testResource];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+- (NSDictionary *)propertiesWithBody:(NSString *)body contentType:(NSString *)contentType error:(NSError * __autoreleasing *)error
+{
+    return [self.decoder propertiesWithData:[body dataUsingEncoding:NSUTF8StringEncoding] contentType:contentType error:error];
+}
+
+- (void)testJSONValuesAreConvertedToPropertyTypes
+{
+    NSError *error;
+    NSDictionary *properties = [self propertiesWithBody:@"{\"label\": 12.50, \"count\": \"7\", \"reading\": 3, \"payload\": \"Ynl0ZXM=\"}" contentType:@"application/json" error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error decoding the body %@", error);
+    XCTAssert([properties[@"label"] isEqualToString:@"12.50"], @"A number posted to a string property must keep its literal text");
+    XCTAssert([properties[@"count"] isEqualToNumber:@7], @"A numeric string posted to an integer property must become a number");
+    XCTAssert(strcmp([properties[@"reading"] objCType], @encode(double)) == 0, @"An integer posted to a floating point property must become a double");
+    XCTAssert([properties[@"payload"] isEqualToData:[@"bytes" dataUsingEncoding:NSUTF8StringEncoding]], @"A base64 string posted to a blob property must become data");
+}
+
+- (void)testUnknownKeysAreSkipped
+{
+    NSError *error;
+    NSDictionary *properties = [self propertiesWithBody:@"{\"extra\": {\"nested\": [1, \"]}\", {\"deep\": null}]}, \"label\": \"Jane\", \"more\": true, \"count\": null}" contentType:@"application/json; charset=utf-8" error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error decoding the body %@", error);
+    XCTAssert(properties.count == 2, @"Only model properties must be decoded %@", properties);
+    XCTAssert([properties[@"label"] isEqualToString:@"Jane"], @"The label must be decoded");
+    XCTAssert(properties[@"count"] == [NSNull null], @"Null must be accepted for any property type");
+}
+
+- (void)testEscapedJSONStrings
+{
+    NSDictionary *properties = [self propertiesWithBody:@"{\"la\\u0062el\": \"Quote \\\" slash \\/ line\\n snowman \\u2603 face \\ud83d\\ude00\"}" contentType:@"application/json" error:nil];
+    
+    XCTAssert([properties[@"label"] isEqualToString:@"Quote \" slash / line\n snowman ☃ face \U0001F600"], @"Escapes in keys and values must be decoded %@", properties[@"label"]);
+}
+
+- (void)testInvalidBodiesAreRejected
+{
+    NSArray *malformedBodies = @[@"", @"[]", @"{\"label\": \"Jane\",}", @"{\"label\": \"Jane\"} trailing", @"{\"extra\": [1, 2}", @"{\"count\": 01}"];
+    for (NSString *body in malformedBodies) {
+        NSError *error;
+        XCTAssertNil([self propertiesWithBody:body contentType:@"application/json" error:&error], @"Malformed body %@ must be rejected", body);
+        XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"The error must be a bad request");
+    }
+    
+    NSError *error;
+    XCTAssertNil([self propertiesWithBody:@"{\"count\": 1.5}" contentType:@"application/json" error:&error], @"A fractional number can't be an integer property");
+    XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"The error must be a bad request");
+    XCTAssertNil([self propertiesWithBody:@"count=seven" contentType:@"application/x-www-form-urlencoded" error:nil], @"A non numeric form value can't be an integer property");
+    XCTAssertNil([self propertiesWithBody:@"label=Jane" contentType:@"text/plain" error:nil], @"Unsupported content types must be rejected");
+}
+
+- (void)testFormBodiesArePercentDecoded
+{
+    NSError *error;
+    NSDictionary *properties = [self propertiesWithBody:@"extra=1&la%62el=Jane+Doe%21%20%E2%98%83&count=42&reading=&ignored" contentType:@"application/x-www-form-urlencoded" error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error decoding the body %@", error);
+    XCTAssert(properties.count == 3, @"Only model properties must be decoded %@", properties);
+    XCTAssert([properties[@"label"] isEqualToString:@"Jane Doe! ☃"], @"Form keys and values must be percent decoded %@", properties[@"label"]);
+    XCTAssert([properties[@"count"] isEqualToNumber:@42], @"Form values must be converted to their property type");
+    XCTAssert(properties[@"reading"] == [NSNull null], @"An empty form value of a number property must be null");
+}
+
+@end
@@ -81,6 +81,142 @@
     XCTAssert(response.count == 100, @"The response must include 100 objects");
 }
 
+- (void)testGetAllObjectsIsStreamed
+{
+    [TGTestFactory createTestDataForResource:self.testResource count:500];
+    
+    __weak typeof(self) weakSelf = self;
+    __block NSArray *response;
+    __block NSString *transferEncoding;
+    
+    [[TGRESTClient sharedClient] GET:self.testResource.name
+                          parameters:nil
+                             success:^(NSURLSessionDataTask *task, id responseObject) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 response = responseObject;
+                                 transferEncoding = [[(NSHTTPURLResponse *)task.response allHeaderFields] objectForKey:@"Transfer-Encoding"];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }
+                             failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 XCTFail(@"The request should not have failed %@", error);
+                                 [strongSelf notify:XCTAsyncTestCaseStatusFailed];
+                             }];
+    
+    [self waitForTimeout:2];
+    
+    XCTAssert([transferEncoding isEqualToString:@"chunked"], @"The index response must be streamed");
+    XCTAssert(response.count == 500, @"The streamed response must include 500 objects");
+    XCTAssert([[response.lastObject objectForKey:self.testResource.primaryKey] isEqualToNumber:@500], @"The streamed objects must be ordered by primary key");
+}
+
+- (void)testGetObjectsByPage
+{
+    [TGTestFactory createTestDataForResource:self.testResource count:30];
+    
+    __weak typeof(self) weakSelf = self;
+    __block NSArray *response;
+    __block NSString *nextCursor;
+    
+    [[TGRESTClient sharedClient] GET:self.testResource.name
+                          parameters:@{@"limit": @10, @"after": @5}
+                             success:^(NSURLSessionDataTask *task, id responseObject) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 response = responseObject;
+                                 nextCursor = [[(NSHTTPURLResponse *)task.response allHeaderFields] objectForKey:@"X-Next-Cursor"];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }
+                             failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 XCTFail(@"The request must not have failed %@", error);
+                                 [strongSelf notify:XCTAsyncTestCaseStatusFailed];
+                             }];
+    
+    [self waitForTimeout:1];
+    
+    XCTAssert(response.count == 10, @"The response must be limited to 10 objects");
+    XCTAssert([[response.firstObject objectForKey:self.testResource.primaryKey] isEqualToNumber:@6], @"The page must start after the cursor");
+    XCTAssert([nextCursor isEqualToString:@"15"], @"The next cursor must be the primary key of the last object in the page");
+}
+
+- (void)testGetObjectsWithInvalidLimit
+{
+    __weak typeof(self) weakSelf = self;
+    __block NSUInteger statusCode;
+    
+    [[TGRESTClient sharedClient] GET:self.testResource.name
+                          parameters:@{@"limit": @"ten"}
+                             success:^(NSURLSessionDataTask *task, id responseObject) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 XCTFail(@"The request must have failed");
+                                 [strongSelf notify:XCTAsyncTestCaseStatusFailed];
+                             }
+                             failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 statusCode = [(NSHTTPURLResponse *)task.response statusCode];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }];
+    
+    [self waitForTimeout:1];
+    
+    XCTAssert(statusCode == 400, @"An invalid limit must be a bad request");
+}
+
+- (void)testGetObjectsWithFilterAndSort
+{
+    [TGTestFactory createTestDataForResource:self.testResource count:30];
+    
+    __weak typeof(self) weakSelf = self;
+    __block NSArray *response;
+    __block NSString *nextCursor;
+    
+    [[TGRESTClient sharedClient] GET:self.testResource.name
+                          parameters:@{@"id": @{@"gt": @10}, @"sort": @"-id", @"limit": @5}
+                             success:^(NSURLSessionDataTask *task, id responseObject) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 response = responseObject;
+                                 nextCursor = [[(NSHTTPURLResponse *)task.response allHeaderFields] objectForKey:@"X-Next-Cursor"];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }
+                             failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 XCTFail(@"The request must not have failed %@", error);
+                                 [strongSelf notify:XCTAsyncTestCaseStatusFailed];
+                             }];
+    
+    [self waitForTimeout:1];
+    
+    XCTAssert([[response valueForKey:self.testResource.primaryKey] isEqualToArray:@[@30, @29, @28, @27, @26]], @"The response must be filtered, sorted descending and limited");
+    XCTAssertNil(nextCursor, @"A response that is not ordered by primary key must not have a next cursor");
+}
+
+- (void)testGetObjectsWithInvalidQuery
+{
+    NSArray *invalidQueries = @[@{@"age": @"30"}, @{@"name": @{@"gt": @"a"}}, @{@"id": @"abc"}, @{@"sort": @"age"}, @{@"sort": @"name", @"after": @"5"}];
+    
+    for (NSDictionary *parameters in invalidQueries) {
+        __weak typeof(self) weakSelf = self;
+        __block NSUInteger statusCode;
+        
+        [[TGRESTClient sharedClient] GET:self.testResource.name
+                              parameters:parameters
+                                 success:^(NSURLSessionDataTask *task, id responseObject) {
+                                     __strong typeof(weakSelf) strongSelf = weakSelf;
+                                     XCTFail(@"The request must have failed %@", parameters);
+                                     [strongSelf notify:XCTAsyncTestCaseStatusFailed];
+                                 }
+                                 failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                     __strong typeof(weakSelf) strongSelf = weakSelf;
+                                     statusCode = [(NSHTTPURLResponse *)task.response statusCode];
+                                     [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                                 }];
+        
+        [self waitForTimeout:1];
+        
+        XCTAssert(statusCode == 400, @"The query %@ must be a bad request", parameters);
+    }
+}
+
 - (void)testGetSpecificObject
 {
     [TGTestFactory createTestDataForResource:self.testResource count:10];
@@ -107,6 +243,73 @@
     XCTAssert([response[self.testResource.primaryKey] isEqualToNumber:@1], @"The primary key must equal 1");
 }
 
+- (NSUInteger)statusCodeForGET:(NSString *)path ifNoneMatch:(NSString *)ifNoneMatch entityTag:(NSString * __autoreleasing *)entityTag
+{
+    __weak typeof(self) weakSelf = self;
+    __block NSUInteger statusCode;
+    __block NSString *responseTag;
+    
+    [[TGRESTClient sharedClient].requestSerializer setValue:ifNoneMatch forHTTPHeaderField:@"If-None-Match"];
+    [[TGRESTClient sharedClient] GET:path
+                          parameters:nil
+                             success:^(NSURLSessionDataTask *task, id responseObject) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 statusCode = [[task.response valueForKey:@"statusCode"] integerValue];
+                                 responseTag = [[(NSHTTPURLResponse *)task.response allHeaderFields] objectForKey:@"ETag"];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }
+                             failure:^(NSURLSessionDataTask *task, NSError *error) {
+                                 __strong typeof(weakSelf) strongSelf = weakSelf;
+                                 statusCode = [[task.response valueForKey:@"statusCode"] integerValue];
+                                 responseTag = [[(NSHTTPURLResponse *)task.response allHeaderFields] objectForKey:@"ETag"];
+                                 [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                             }];
+    
+    [self waitForTimeout:1];
+    [[TGRESTClient sharedClient].requestSerializer setValue:nil forHTTPHeaderField:@"If-None-Match"];
+    
+    if (entityTag) {
+        *entityTag = responseTag;
+    }
+    return statusCode;
+}
+
+- (void)testGetAllObjectsWithMatchingEntityTag
+{
+    [TGTestFactory createTestDataForResource:self.testResource count:10];
+    
+    NSString *entityTag;
+    XCTAssert([self statusCodeForGET:self.testResource.name ifNoneMatch:nil entityTag:&entityTag] == 200, @"The first request must return the objects");
+    XCTAssert(entityTag.length > 0, @"The index response must carry an ETag");
+    
+    NSString *notModifiedTag;
+    XCTAssert([self statusCodeForGET:self.testResource.name ifNoneMatch:entityTag entityTag:&notModifiedTag] == 304, @"An unchanged resource must return 304 Not Modified");
+    XCTAssert([notModifiedTag isEqualToString:entityTag], @"The 304 response must repeat the current ETag");
+    
+    [TGTestFactory createTestDataForResource:self.testResource count:1];
+    
+    NSString *changedTag;
+    XCTAssert([self statusCodeForGET:self.testResource.name ifNoneMatch:entityTag entityTag:&changedTag] == 200, @"Creating an object must invalidate the ETag");
+    XCTAssert(![changedTag isEqualToString:entityTag], @"The ETag must change after a write");
+}
+
+- (void)testGetSpecificObjectWithMatchingEntityTag
+{
+    [TGTestFactory createTestDataForResource:self.testResource count:2];
+    TGRESTStore *datastore = [TGRESTServer sharedServer].datastore;
+    NSString *path = [NSString stringWithFormat:@"%@/%@", self.testResource.name, @1];
+    
+    NSString *entityTag;
+    XCTAssert([self statusCodeForGET:path ifNoneMatch:nil entityTag:&entityTag] == 200, @"The first request must return the object");
+    XCTAssert(entityTag.length > 0, @"The show response must carry an ETag");
+    
+    [datastore modifyObjectOfResource:self.testResource withPrimaryKey:@"2" withProperties:[TGTestFactory buildTestDataForResource:self.testResource] error:nil];
+    XCTAssert([self statusCodeForGET:path ifNoneMatch:entityTag entityTag:nil] == 304, @"Writes to other objects must not invalidate the ETag");
+    
+    [datastore modifyObjectOfResource:self.testResource withPrimaryKey:@"1" withProperties:[TGTestFactory buildTestDataForResource:self.testResource] error:nil];
+    XCTAssert([self statusCodeForGET:path ifNoneMatch:entityTag entityTag:nil] == 200, @"Modifying the object must invalidate the ETag");
+}
+
 - (void)testGetNonexistantObject
 {
     [TGTestFactory createTestDataForResource:self.testResource count:10];
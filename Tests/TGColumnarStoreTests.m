@@ -0,0 +1,281 @@
+//
+//  TGColumnarStoreTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/6/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+
+@interface TGColumnarStoreTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testNormalResource;
+@property (nonatomic, strong) TGRESTResource *testParentResource;
+@property (nonatomic, strong) TGRESTResource *testChildResource;
+@property (nonatomic, strong) TGRESTResource *testTypedResource;
+
+@property (nonatomic, strong) TGRESTColumnarStore *store;
+
+@end
+
+@implementation TGColumnarStoreTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.store = [TGRESTColumnarStore new];
+    self.testNormalResource = [TGTestFactory testResource];
+    self.testParentResource = [TGTestFactory testResource];
+    self.testChildResource = [TGTestFactory testResourceWithParent:self.testParentResource];
+    self.testTypedResource = [TGRESTResource newResourceWithName:@"measurement" model:@{
+                                                                                       @"label": [NSNumber numberWithInteger:TGPropertyTypeString],
+                                                                                       @"count": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                                                                                       @"reading": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint],
+                                                                                       @"payload": [NSNumber numberWithInteger:TGPropertyTypeBlob],
+                                                                                       @"extra": [NSNumber numberWithInteger:TGPropertyTypeOther]
+                                                                                       }];
+    
+    [self.store addResource:self.testNormalResource];
+    [self.store addResource:self.testParentResource];
+    [self.store addResource:self.testChildResource];
+    [self.store addResource:self.testTypedResource];
+}
+
+- (void)tearDown
+{
+    [self.store dropResource:self.testNormalResource];
+    [self.store dropResource:self.testParentResource];
+    [self.store dropResource:self.testChildResource];
+    [self.store dropResource:self.testTypedResource];
+    
+    [super tearDown];
+}
+
+- (void)testTypedValuesRoundTrip
+{
+    NSData *payload = [@"bytes" dataUsingEncoding:NSUTF8StringEncoding];
+    NSError *error;
+    NSDictionary *object = [self.store createNewObjectForResource:self.testTypedResource
+                                                   withProperties:@{@"label": @"Jane", @"count": @"-9000000000", @"reading": @0.1, @"payload": payload, @"extra": @[@1, @"two"], @"ignored": @YES}
+                                                            error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error %@", error);
+    NSDictionary *expected = @{@"id": @1, @"label": @"Jane", @"count": @-9000000000, @"reading": @0.1, @"payload": payload, @"extra": @[@1, @"two"]};
+    XCTAssert([object isEqualToDictionary:expected], @"Values must be stored as their property types and keys outside the model dropped %@", object);
+    XCTAssert([[self.store getDataForObjectOfResource:self.testTypedResource withPrimaryKey:@"1" error:nil] isEqualToDictionary:expected], @"The stored object must read back the same");
+    
+    NSDictionary *empty = [self.store createNewObjectForResource:self.testTypedResource withProperties:@{} error:nil];
+    for (NSString *property in self.testTypedResource.model) {
+        if (![property isEqualToString:self.testTypedResource.primaryKey]) {
+            XCTAssert(empty[property] == [NSNull null], @"A property that was never set must be null");
+        }
+    }
+    
+    NSDictionary *modified = [self.store modifyObjectOfResource:self.testTypedResource withPrimaryKey:@"1" withProperties:@{@"label": @42, @"payload": [NSNull null]} error:&error];
+    XCTAssertNil(error, @"There must not be an error %@", error);
+    XCTAssert([modified[@"label"] isEqualToString:@"42"], @"A number stored in a string property must become a string");
+    XCTAssert(modified[@"payload"] == [NSNull null], @"A property must be able to go back to null");
+    XCTAssert([modified[@"count"] isEqualToNumber:@-9000000000], @"Properties that weren't modified must keep their values");
+}
+
+- (void)testValuesThatDontFitTheColumnAreRejected
+{
+    NSError *error;
+    XCTAssertNil([self.store createNewObjectForResource:self.testTypedResource withProperties:@{@"count": @"seven"} error:&error], @"A non numeric string can't be stored in an integer property");
+    XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"The error must be a bad request");
+    
+    error = nil;
+    NSArray *batch = @[@{@"label": @"Fine"}, @{@"payload": @"not data"}];
+    XCTAssertNil([self.store createNewObjectsForResource:self.testTypedResource withPropertiesArray:batch error:&error], @"A string can't be stored in a blob property");
+    XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"The error must be a bad request");
+    XCTAssert([self.store countOfObjectsForResource:self.testTypedResource] == 0, @"A rejected batch must not leave any objects behind");
+    
+    [self.store createNewObjectForResource:self.testTypedResource withProperties:@{@"reading": @1.5} error:nil];
+    error = nil;
+    XCTAssertNil([self.store modifyObjectOfResource:self.testTypedResource withPrimaryKey:@"1" withProperties:@{@"label": @"Changed", @"reading": @"high"} error:&error], @"A non numeric string can't be stored in a floating point property");
+    XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"The error must be a bad request");
+    NSDictionary *object = [self.store getDataForObjectOfResource:self.testTypedResource withPrimaryKey:@"1" error:nil];
+    XCTAssert(object[@"label"] == [NSNull null] && [object[@"reading"] isEqualToNumber:@1.5], @"A rejected update must not change any property");
+}
+
+- (void)testDeletedObjectsAreToldApartFromMissingObjects
+{
+    [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:3] error:nil];
+    
+    NSError *error;
+    XCTAssert([self.store deleteObjectOfResource:self.testNormalResource withPrimaryKey:@"2" error:&error], @"The object must be deleted");
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == 2, @"There must be 2 objects left");
+    
+    [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"2" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectAlreadyDeletedErrorCode, @"A deleted object must answer as deleted");
+    [self.store deleteObjectOfResource:self.testNormalResource withPrimaryKey:@"2" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectAlreadyDeletedErrorCode, @"Deleting an object twice must answer as deleted");
+    [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"4" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectNotFoundErrorCode, @"An object that never existed must not be found");
+    [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"0" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectNotFoundErrorCode, @"An object that never existed must not be found");
+    
+    NSArray *objects = [self.store getAllObjectsForResource:self.testNormalResource error:nil];
+    XCTAssert([[objects valueForKey:@"id"] isEqualToArray:@[@1, @3]], @"Deleted objects must be skipped");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:@"2"] != NSNotFound, @"A deleted object must keep a version");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:@"4"] == NSNotFound, @"An object that never existed must not have a version");
+    
+    NSDictionary *next = [self.store createNewObjectForResource:self.testNormalResource withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:nil];
+    XCTAssert([next[@"id"] isEqualToNumber:@4], @"Primary keys of deleted objects must never be reused");
+}
+
+- (void)testChildObjectsFollowTheirParent
+{
+    NSArray *parents = [self.store createNewObjectsForResource:self.testParentResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testParentResource count:2] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSMutableArray *childProperties = [NSMutableArray new];
+    for (NSUInteger x = 0; x < 10; x++) {
+        NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithDictionary:[TGTestFactory buildTestDataForResource:self.testChildResource]];
+        [properties setObject:parents[x % 2][@"id"] forKey:foreignKey];
+        [childProperties addObject:properties];
+    }
+    [self.store createNewObjectsForResource:self.testChildResource withPropertiesArray:childProperties error:nil];
+    
+    NSError *error;
+    NSArray *children = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:@"1" error:&error];
+    XCTAssertNil(error, @"There must not be an error %@", error);
+    XCTAssert([[children valueForKey:@"id"] isEqualToArray:@[@1, @3, @5, @7, @9]], @"Only the children of the parent must be returned in primary key order");
+    NSArray *page = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:@"1" afterPrimaryKey:@"3" limit:2 error:nil];
+    XCTAssert([[page valueForKey:@"id"] isEqualToArray:@[@5, @7]], @"A page of children must start after the key");
+    
+    [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:@"3" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectNotFoundErrorCode, @"Children of a missing parent must not be found");
+    
+    [self.store deleteObjectOfResource:self.testParentResource withPrimaryKey:@"1" error:nil];
+    for (NSDictionary *child in [self.store getAllObjectsForResource:self.testChildResource error:nil]) {
+        if ([child[@"id"] integerValue] % 2 == 1) {
+            XCTAssert(child[foreignKey] == [NSNull null], @"Deleting a parent must null the foreign key of its children");
+        } else {
+            XCTAssert([child[foreignKey] isEqualToNumber:@2], @"Children of other parents must keep their foreign key");
+        }
+    }
+}
+
+- (void)testStringPrimaryKeysAreOrderedAsStrings
+{
+    TGRESTResource *resource = [TGRESTResource newResourceWithName:@"tag" model:@{@"slug": [NSNumber numberWithInteger:TGPropertyTypeString], @"label": [NSNumber numberWithInteger:TGPropertyTypeString]} actions:TGResourceRESTActionsGET | TGResourceRESTActionsPOST primaryKey:@"slug"];
+    [self.store addResource:resource];
+    [self.store createNewObjectsForResource:resource withPropertiesArray:[TGTestFactory buildTestDataForResource:resource count:12] error:nil];
+    NSArray *expectedKeys = @[@"1", @"10", @"11", @"12", @"2", @"3", @"4", @"5", @"6", @"7", @"8", @"9"];
+    
+    XCTAssert([[[self.store getAllObjectsForResource:resource error:nil] valueForKey:@"slug"] isEqualToArray:expectedKeys], @"String primary keys must be ordered as strings");
+    XCTAssert([[[[self.store objectEnumeratorForResource:resource error:nil] allObjects] valueForKey:@"slug"] isEqualToArray:expectedKeys], @"The enumerator must use the same order");
+    NSArray *page = [self.store getObjectsForResource:resource afterPrimaryKey:@"12" limit:3 error:nil];
+    XCTAssert([[page valueForKey:@"slug"] isEqualToArray:@[@"2", @"3", @"4"]], @"A page must start after the key in string order");
+    XCTAssertNil([self.store getDataForObjectOfResource:resource withPrimaryKey:@"01" error:nil], @"A string primary key must match exactly");
+    
+    [self.store dropResource:resource];
+}
+
+- (void)testQueriesMatchInMemoryStore
+{
+    TGRESTResource *resource = [TGTestFactory randomModelTestResource];
+    TGRESTInMemoryStore *inMemoryStore = [TGRESTInMemoryStore new];
+    [inMemoryStore addResource:resource];
+    [self.store addResource:resource];
+    
+    NSArray *data = [TGTestFactory buildTestDataForResource:resource count:500];
+    [inMemoryStore createNewObjectsForResource:resource withPropertiesArray:data error:nil];
+    [self.store createNewObjectsForResource:resource withPropertiesArray:data error:nil];
+    for (NSUInteger x = 1; x <= 500; x += 7) {
+        NSString *primaryKey = [NSString stringWithFormat:@"%lu", (unsigned long)x];
+        [inMemoryStore deleteObjectOfResource:resource withPrimaryKey:primaryKey error:nil];
+        [self.store deleteObjectOfResource:resource withPrimaryKey:primaryKey error:nil];
+    }
+    
+    XCTAssert([[self.store getAllObjectsForResource:resource error:nil] isEqualToArray:[inMemoryStore getAllObjectsForResource:resource error:nil]], @"Both stores must hold the same objects");
+    
+    NSDictionary *sample = data[42];
+    NSMutableArray *queries = [NSMutableArray arrayWithObject:@{@"id[gt]": @"100", @"id[lte]": @"300"}];
+    for (NSString *property in resource.model) {
+        TGPropertyType type = [resource.model[property] integerValue];
+        if (type == TGPropertyTypeString && ![property isEqualToString:resource.primaryKey]) {
+            [queries addObject:@{property: sample[property]}];
+        } else if ((type == TGPropertyTypeInteger || type == TGPropertyTypeFloatingPoint) && ![property isEqualToString:resource.primaryKey]) {
+            NSString *value = [sample[property] description];
+            [queries addObject:@{[property stringByAppendingString:@"[gte]"]: value}];
+            [queries addObject:@{[property stringByAppendingString:@"[lt]"]: value, TGRESTQuerySortKey: [@"-" stringByAppendingString:property]}];
+        }
+    }
+    
+    for (NSDictionary *parameters in queries) {
+        TGRESTQuery *query = [TGRESTQuery queryWithParameters:parameters resource:resource error:nil];
+        XCTAssertNotNil(query, @"The query %@ must be valid", parameters);
+        NSArray *columnarResults = [self.store getObjectsForResource:resource matchingQuery:query afterPrimaryKey:@"50" limit:40 error:nil];
+        NSArray *inMemoryResults = [inMemoryStore getObjectsForResource:resource matchingQuery:query afterPrimaryKey:@"50" limit:40 error:nil];
+        XCTAssert([columnarResults isEqualToArray:inMemoryResults], @"The query %@ must return the same objects from both stores", parameters);
+    }
+    
+    [self.store dropResource:resource];
+}
+
+- (void)measureLoadOnStore:(TGRESTStore *)store
+{
+    TGRESTResource *resource = [TGTestFactory randomModelTestResource];
+    NSArray *data = [TGTestFactory buildTestDataForResource:resource count:50000];
+    
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        [store addResource:resource];
+        [self startMeasuring];
+        NSArray *objects = [store createNewObjectsForResource:resource withPropertiesArray:data error:nil];
+        [self stopMeasuring];
+        XCTAssert(objects.count == data.count, @"Every object must be loaded into %@", store);
+        [store dropResource:resource];
+    }];
+}
+
+- (void)measureScanOnStore:(TGRESTStore *)store
+{
+    TGRESTResource *resource = [TGTestFactory randomModelTestResource];
+    [store addResource:resource];
+    NSArray *data = [TGTestFactory buildTestDataForResource:resource count:50000];
+    [store createNewObjectsForResource:resource withPropertiesArray:data error:nil];
+    
+    NSMutableDictionary *parameters = [NSMutableDictionary new];
+    for (NSString *property in resource.model) {
+        TGPropertyType type = [resource.model[property] integerValue];
+        if ((type == TGPropertyTypeInteger || type == TGPropertyTypeFloatingPoint) && ![property isEqualToString:resource.primaryKey]) {
+            [parameters setObject:[data[0][property] description] forKey:[property stringByAppendingString:@"[gt]"]];
+        }
+    }
+    TGRESTQuery *query = [TGRESTQuery queryWithParameters:parameters resource:resource error:nil];
+    
+    __block NSArray *results;
+    [self measureBlock:^{
+        results = [store getObjectsForResource:resource matchingQuery:query afterPrimaryKey:nil limit:NSUIntegerMax error:nil];
+    }];
+    
+    XCTAssertNotNil(results, @"The scan must return the matching objects from %@", store);
+    [store dropResource:resource];
+}
+
+- (void)testColumnarLoadPerformance
+{
+    [self measureLoadOnStore:self.store];
+}
+
+- (void)testInMemoryLoadPerformance
+{
+    [self measureLoadOnStore:[TGRESTInMemoryStore new]];
+}
+
+- (void)testColumnarScanPerformance
+{
+    [self measureScanOnStore:self.store];
+}
+
+- (void)testInMemoryScanPerformance
+{
+    [self measureScanOnStore:[TGRESTInMemoryStore new]];
+}
+
+@end
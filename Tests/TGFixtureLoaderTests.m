@@ -0,0 +1,167 @@
+//
+//  TGFixtureLoaderTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "TGRESTFixtureLoader.h"
+
+@interface TGFixtureLoaderTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *resource;
+
+@end
+
+@implementation TGFixtureLoaderTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.resource = [TGTestFactory testResource];
+    [[TGRESTServer sharedServer] addResource:self.resource];
+    [[TGRESTServer sharedServer] startServerWithOptions:nil];
+}
+
+- (void)tearDown
+{
+    [[TGRESTServer sharedServer] removeAllResourcesWithData:YES];
+    [[TGRESTServer sharedServer] stopServer];
+    [super tearDown];
+}
+
+- (NSArray *)objectsWithCount:(NSUInteger)count
+{
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger x = 0; x < count; x++) {
+        [objects addObject:@{@"name": [NSString stringWithFormat:@"Person \"%lu\" with a name long enough to spread the file over several chunks", (unsigned long)x], @"unknown": @[@{@"nested": @"]},["}]}];
+    }
+    
+    return objects;
+}
+
+- (NSData *)linesDataForObjects:(NSArray *)objects
+{
+    NSMutableData *data = [NSMutableData new];
+    for (NSDictionary *object in objects) {
+        [data appendData:[NSJSONSerialization dataWithJSONObject:object options:0 error:nil]];
+        [data appendBytes:"\r\n\n" length:3];
+    }
+    
+    return data;
+}
+
+- (void)testLoadJSONArrayKeepsOrder
+{
+    NSArray *objects = [self objectsWithCount:50000];
+    NSData *data = [NSJSONSerialization dataWithJSONObject:objects options:NSJSONWritingPrettyPrinted error:nil];
+    NSError *error;
+    
+    XCTAssert([[TGRESTServer sharedServer] loadDataFromJSONData:data forResource:self.resource error:&error], @"The array must load %@", error);
+    NSArray *loaded = [[TGRESTServer sharedServer] allObjectsForResource:self.resource];
+    XCTAssert(loaded.count == objects.count, @"Every object must be loaded but there are %lu", (unsigned long)loaded.count);
+    XCTAssert([loaded.lastObject[@"name"] isEqualToString:[objects.lastObject objectForKey:@"name"]], @"Objects must be loaded in the order of the file");
+    XCTAssert(loaded.firstObject[@"unknown"] == nil, @"Keys outside the model must be dropped");
+}
+
+- (void)testLoadNewlineDelimitedFile
+{
+    NSArray *objects = [self objectsWithCount:50000];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [[self linesDataForObjects:objects] writeToFile:path atomically:YES];
+    NSError *error;
+    
+    XCTAssert([[TGRESTServer sharedServer] loadDataFromFileAtPath:path forResource:self.resource error:&error], @"The file must load %@", error);
+    XCTAssert([[TGRESTServer sharedServer] numberOfObjectsForResource:self.resource] == objects.count, @"Every line must be loaded");
+    NSDictionary *last = [[TGRESTServer sharedServer] allObjectsForResource:self.resource].lastObject;
+    XCTAssert([last[@"id"] integerValue] == objects.count && [last[@"name"] isEqualToString:[objects.lastObject objectForKey:@"name"]], @"Objects must be loaded in the order of the file");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testLoadEmptyArray
+{
+    NSError *error;
+    XCTAssert([[TGRESTServer sharedServer] loadDataFromJSONData:[@" [ ] " dataUsingEncoding:NSUTF8StringEncoding] forResource:self.resource error:&error], @"An empty array must load %@", error);
+    XCTAssert([[TGRESTServer sharedServer] numberOfObjectsForResource:self.resource] == 0, @"There must not be any objects");
+}
+
+#pragma mark - Negative testing
+
+- (void)testMalformedDataFails
+{
+    NSArray *bodies = @[@"[{\"name\": \"one\"}, {\"name\": ", @"[{\"name\": \"one\"}] trailing", @"[{\"name\": \"one\"},]", @"[{\"name\": \"one\"}, \n]", @"{\"name\": \"one\"}\n{\"name\" \"two\"}\n"];
+    for (NSString *body in bodies) {
+        NSError *error;
+        XCTAssertFalse([[TGRESTServer sharedServer] loadDataFromJSONData:[body dataUsingEncoding:NSUTF8StringEncoding] forResource:self.resource error:&error], @"Malformed data must not load: %@", body);
+        XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"Malformed data must be a bad request error");
+    }
+}
+
+- (void)testMalformedLaterChunkLeavesEarlierObjectsLoaded
+{
+    TGRESTInMemoryStore *store = [TGRESTInMemoryStore new];
+    [store addResource:self.resource];
+    NSMutableData *data = [NSMutableData dataWithData:[self linesDataForObjects:[self objectsWithCount:1000]]];
+    [data appendData:[@"{\"name\" \"malformed\"}\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    TGRESTFixtureLoader *loader = [TGRESTFixtureLoader loaderWithResource:self.resource store:store];
+    loader.chunkSize = 1024;
+    loader.concurrency = 1;
+    NSUInteger loadedCount = NSNotFound;
+    NSError *error;
+    
+    XCTAssertFalse([loader loadData:data loadedCount:&loadedCount error:&error], @"A malformed last line must fail the load");
+    XCTAssert(error.code == TGRESTStoreBadRequestErrorCode, @"Malformed data must be a bad request error");
+    XCTAssert(loadedCount > 0, @"Windows ahead of the malformed chunk must already be loaded");
+    XCTAssert(loadedCount == [store countOfObjectsForResource:self.resource], @"The loaded count must match the objects left in the store");
+    
+    [store dropResource:self.resource];
+}
+
+- (void)testLoadForUnknownResourceFails
+{
+    NSError *error;
+    TGRESTResource *unknown = [TGRESTResource newResourceWithName:@"unknown" model:@{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    XCTAssertFalse([[TGRESTServer sharedServer] loadDataFromJSONData:[@"[]" dataUsingEncoding:NSUTF8StringEncoding] forResource:unknown error:&error], @"A resource that was never added must not load");
+}
+
+#pragma mark - Performance
+
+- (void)measureLoadStreamingFile:(BOOL)streaming
+{
+    NSArray *objects = [self objectsWithCount:20000];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [[NSJSONSerialization dataWithJSONObject:objects options:0 error:nil] writeToFile:path atomically:YES];
+    
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        [[TGRESTServer sharedServer] stopServer];
+        [[TGRESTServer sharedServer] startServerWithOptions:nil];
+        [self startMeasuring];
+        if (streaming) {
+            [[TGRESTServer sharedServer] loadDataFromFileAtPath:path forResource:self.resource error:nil];
+        } else {
+            NSArray *parsed = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:0 error:nil];
+            [[TGRESTServer sharedServer] addData:parsed forResource:self.resource];
+        }
+        [self stopMeasuring];
+        XCTAssert([[TGRESTServer sharedServer] numberOfObjectsForResource:self.resource] == objects.count, @"Every object must be loaded");
+    }];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testWholeFileLoadPerformance
+{
+    [self measureLoadStreamingFile:NO];
+}
+
+- (void)testStreamedLoadPerformance
+{
+    [self measureLoadStreamingFile:YES];
+}
+
+@end
@@ -0,0 +1,135 @@
+//
+//  TGFragmentCacheTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+
+@interface TGEnvelopeTestSerializer : NSObject <TGRESTSerializer>
+
+@end
+
+@implementation TGEnvelopeTestSerializer
+
++ (id)dataWithSingularObject:(NSDictionary *)object resource:(TGRESTResource *)resource
+{
+    return @{resource.name: object};
+}
+
++ (id)dataWithCollection:(NSArray *)collection resource:(TGRESTResource *)resource
+{
+    return @{resource.name: collection};
+}
+
++ (NSDictionary *)requestParametersWithBody:(NSDictionary *)body resource:(TGRESTResource *)resource
+{
+    return body;
+}
+
+@end
+
+@interface TGFragmentCacheTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testResource;
+@property (nonatomic, strong) TGRESTInMemoryStore *store;
+
+@end
+
+@implementation TGFragmentCacheTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.store = [TGRESTInMemoryStore new];
+    self.testResource = [TGTestFactory testResource];
+    [self.store addResource:self.testResource];
+}
+
+- (void)tearDown
+{
+    [self.store dropResource:self.testResource];
+    
+    [super tearDown];
+}
+
+- (void)testFragmentIsReusedForTheSameVersion
+{
+    NSDictionary *object = [self.store createNewObjectForResource:self.testResource withProperties:[TGTestFactory buildTestDataForResource:self.testResource] error:nil];
+    TGRESTFragmentCache *cache = self.store.fragmentCache;
+    NSUInteger version = [self.store versionOfObjectOfResource:self.testResource withPrimaryKey:[object[self.testResource.primaryKey] description]];
+    
+    NSData *fragment = [cache fragmentForObject:object resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:version];
+    XCTAssert([[NSJSONSerialization JSONObjectWithData:fragment options:kNilOptions error:nil] isEqualToDictionary:object], @"The fragment must be the encoded object");
+    XCTAssert([cache fragmentForObject:object resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:version] == fragment, @"An unchanged object must reuse its fragment");
+    XCTAssert([cache fragmentForObject:object resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:NSNotFound] != fragment, @"An object without a version must not be cached");
+    
+    NSData *envelopeFragment = [cache fragmentForObject:object resource:self.testResource serializer:[TGEnvelopeTestSerializer class] version:version];
+    NSDictionary *envelope = [NSJSONSerialization JSONObjectWithData:envelopeFragment options:kNilOptions error:nil];
+    XCTAssert([envelope[self.testResource.name] isEqualToDictionary:object], @"Fragments must be kept separately for each serializer");
+}
+
+- (void)testFragmentStoredAfterAWriteIsNeverServed
+{
+    NSDictionary *object = [self.store createNewObjectForResource:self.testResource withProperties:[TGTestFactory buildTestDataForResource:self.testResource] error:nil];
+    TGRESTFragmentCache *cache = self.store.fragmentCache;
+    NSString *primaryKey = [object[self.testResource.primaryKey] description];
+    NSUInteger version = [self.store versionOfObjectOfResource:self.testResource withPrimaryKey:primaryKey];
+    
+    // A reader that read the object before the write only gets to cache it after the write has invalidated the object.
+    [self.store modifyObjectOfResource:self.testResource withPrimaryKey:primaryKey withProperties:@{@"name": @"changed"} error:nil];
+    NSData *staleFragment = [cache fragmentForObject:object resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:version];
+    
+    NSUInteger changedVersion = [self.store versionOfObjectOfResource:self.testResource withPrimaryKey:primaryKey];
+    NSDictionary *changedObject = [self.store getDataForObjectOfResource:self.testResource withPrimaryKey:primaryKey error:nil];
+    NSData *changedFragment = [cache fragmentForObject:changedObject resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:changedVersion];
+    
+    XCTAssert(changedVersion > version, @"Modifying an object must raise its version");
+    XCTAssert(changedFragment != staleFragment, @"A fragment stored with an older version must not be served to a reader of the new version");
+    XCTAssert([[NSJSONSerialization JSONObjectWithData:changedFragment options:kNilOptions error:nil][@"name"] isEqualToString:@"changed"], @"The new fragment must contain the changed value");
+}
+
+- (void)testStoreWritesInvalidateFragments
+{
+    NSArray *objects = [self.store createNewObjectsForResource:self.testResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testResource count:2] error:nil];
+    TGRESTFragmentCache *cache = self.store.fragmentCache;
+    NSString *primaryKey = self.testResource.primaryKey;
+    NSUInteger generation = [self.store generationForResource:self.testResource];
+    NSData *firstFragment = [cache fragmentForObject:objects[0] resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:generation];
+    NSData *secondFragment = [cache fragmentForObject:objects[1] resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:generation];
+    
+    [self.store modifyObjectOfResource:self.testResource withPrimaryKey:[objects[0][primaryKey] description] withProperties:@{@"name": @"changed"} error:nil];
+    generation = [self.store generationForResource:self.testResource];
+    XCTAssert([cache fragmentForObject:objects[0] resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:generation] != firstFragment, @"Modifying an object must invalidate its fragment");
+    XCTAssert([cache fragmentForObject:objects[1] resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:generation] == secondFragment, @"Modifying an object must not invalidate other fragments");
+    
+    [self.store deleteObjectOfResource:self.testResource withPrimaryKey:[objects[1][primaryKey] description] error:nil];
+    generation = [self.store generationForResource:self.testResource];
+    XCTAssert([cache fragmentForObject:objects[1] resource:self.testResource serializer:[TGRESTDefaultSerializer class] version:generation] != secondFragment, @"Deleting an object must invalidate its fragment");
+}
+
+- (void)testCollectionDataConcatenatesFragments
+{
+    NSArray *objects = [self.store createNewObjectsForResource:self.testResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testResource count:50] error:nil];
+    TGRESTFragmentCache *cache = self.store.fragmentCache;
+    NSUInteger generation = [self.store generationForResource:self.testResource];
+    
+    NSData *collectionData = [cache collectionDataWithObjects:objects resource:self.testResource generation:generation];
+    XCTAssert([[NSJSONSerialization JSONObjectWithData:collectionData options:kNilOptions error:nil] isEqualToArray:objects], @"The concatenated fragments must decode to the original objects");
+    XCTAssert([[cache collectionDataWithObjects:@[] resource:self.testResource generation:generation] isEqualToData:[@"[]" dataUsingEncoding:NSUTF8StringEncoding]], @"An empty collection must be an empty array");
+    
+    [cache invalidateResource:self.testResource];
+    XCTAssert([[cache collectionDataWithObjects:objects resource:self.testResource generation:generation] isEqualToData:collectionData], @"Re-encoding after an invalidation must produce the same bytes");
+    
+    [self.store modifyObjectOfResource:self.testResource withPrimaryKey:[objects[0][self.testResource.primaryKey] description] withProperties:@{@"name": @"changed"} error:nil];
+    generation = [self.store generationForResource:self.testResource];
+    NSArray *changedObjects = [self.store getAllObjectsForResource:self.testResource error:nil];
+    XCTAssert([[NSJSONSerialization JSONObjectWithData:[cache collectionDataWithObjects:changedObjects resource:self.testResource generation:generation] options:kNilOptions error:nil] isEqualToArray:changedObjects], @"Fragments of unchanged objects must be reused next to the changed object");
+}
+
+@end
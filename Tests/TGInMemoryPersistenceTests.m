@@ -0,0 +1,165 @@
+//
+//  TGInMemoryPersistenceTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/7/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+
+@interface TGInMemoryPersistenceTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testNormalResource;
+@property (nonatomic, copy) NSString *directory;
+
+@end
+
+@implementation TGInMemoryPersistenceTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.testNormalResource = [TGTestFactory testResource];
+    self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.directory error:nil];
+    
+    [super tearDown];
+}
+
+- (TGRESTInMemoryStore *)openStoreWithResource:(TGRESTResource *)resource
+{
+    TGRESTInMemoryStore *store = [TGRESTInMemoryStore new];
+    [store configureWithOptions:@{TGRESTInMemoryStorePersistencePathOptionKey: self.directory, TGRESTInMemoryStoreCompactionIntervalOptionKey: @0}];
+    [store addResource:resource];
+    
+    return store;
+}
+
+- (void)testObjectsSurviveRestart
+{
+    NSArray *objects;
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+        objects = [store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:10] error:nil];
+        [store modifyObjectOfResource:self.testNormalResource withPrimaryKey:@"2" withProperties:@{@"name": @"Renamed"} error:nil];
+        [store deleteObjectOfResource:self.testNormalResource withPrimaryKey:@"3" error:nil];
+    }
+    
+    TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+    NSError *error;
+    
+    XCTAssert([store countOfObjectsForResource:self.testNormalResource] == 9, @"The restored store must have 9 objects but has %lu", (unsigned long)[store countOfObjectsForResource:self.testNormalResource]);
+    XCTAssert([[store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"1" error:nil] isEqualToDictionary:objects[0]], @"A restored object must match the object that was stored");
+    XCTAssert([[store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"2" error:nil][@"name"] isEqualToString:@"Renamed"], @"A restored object must include its modifications");
+    [store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"3" error:&error];
+    XCTAssert(error.code == TGRESTStoreObjectAlreadyDeletedErrorCode, @"A deleted object must stay deleted after a restart");
+    
+    NSDictionary *newObject = [store createNewObjectForResource:self.testNormalResource withProperties:@{@"name": @"Next"} error:nil];
+    XCTAssert([newObject[@"id"] integerValue] == 11, @"Primary keys must continue where they left off");
+}
+
+- (void)testCompactionFoldsLogIntoSnapshot
+{
+    NSString *logPath = [self.directory stringByAppendingPathComponent:@"store.log"];
+    NSString *snapshotPath = [self.directory stringByAppendingPathComponent:@"store.snapshot"];
+    
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+        [store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:50] error:nil];
+        
+        NSError *error;
+        XCTAssert([store compactPersistentDataWithError:&error], @"Compaction must succeed %@", error);
+        XCTAssert([[NSFileManager defaultManager] fileExistsAtPath:snapshotPath], @"Compaction must write a snapshot");
+        XCTAssert([[[NSFileManager defaultManager] attributesOfItemAtPath:logPath error:nil] fileSize] == 0, @"Compaction must start a new log");
+        
+        [store deleteObjectOfResource:self.testNormalResource withPrimaryKey:@"50" error:nil];
+    }
+    
+    TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+    XCTAssert([store countOfObjectsForResource:self.testNormalResource] == 49, @"The snapshot and the log written after it must both be restored");
+}
+
+- (void)testTornLogTailIsIgnored
+{
+    NSString *logPath = [self.directory stringByAppendingPathComponent:@"store.log"];
+    
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+        [store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:5] error:nil];
+    }
+    
+    NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:logPath];
+    [handle seekToEndOfFile];
+    [handle writeData:[NSData dataWithBytes:"\x40\x00\x00\x00\x01\x02" length:6]];
+    [handle closeFile];
+    
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+        XCTAssert([store countOfObjectsForResource:self.testNormalResource] == 5, @"Every complete record must be restored");
+        [store createNewObjectForResource:self.testNormalResource withProperties:@{@"name": @"After"} error:nil];
+    }
+    
+    TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+    XCTAssert([store countOfObjectsForResource:self.testNormalResource] == 6, @"Records written after a torn tail must be restored");
+}
+
+- (void)testChangedModelDiscardsRestoredObjects
+{
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+        [store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:5] error:nil];
+    }
+    
+    TGRESTResource *changedResource = [TGRESTResource newResourceWithName:self.testNormalResource.name model:@{
+                                                                                                             @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
+                                                                                                             @"age": [NSNumber numberWithInteger:TGPropertyTypeInteger]
+                                                                                                             }];
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:changedResource];
+        XCTAssert([store countOfObjectsForResource:changedResource] == 0, @"A resource with a different model must start out empty");
+    }
+    
+    TGRESTInMemoryStore *store = [self openStoreWithResource:self.testNormalResource];
+    XCTAssert([store countOfObjectsForResource:self.testNormalResource] == 0, @"Objects purged by a model change must not come back");
+}
+
+- (void)measureRestoreWithCompactedLog:(BOOL)compacted
+{
+    TGRESTResource *resource = [TGTestFactory randomModelTestResource];
+    NSArray *data = [TGTestFactory buildTestDataForResource:resource count:20000];
+    
+    @autoreleasepool {
+        TGRESTInMemoryStore *store = [self openStoreWithResource:resource];
+        [store createNewObjectsForResource:resource withPropertiesArray:data error:nil];
+        if (compacted) {
+            [store compactPersistentDataWithError:nil];
+        }
+    }
+    
+    [self measureBlock:^{
+        @autoreleasepool {
+            TGRESTInMemoryStore *restoredStore = [self openStoreWithResource:resource];
+            XCTAssert([restoredStore countOfObjectsForResource:resource] == data.count, @"Every object must be restored");
+        }
+    }];
+}
+
+- (void)testLogReplayRestorePerformance
+{
+    [self measureRestoreWithCompactedLog:NO];
+}
+
+- (void)testSnapshotRestorePerformance
+{
+    [self measureRestoreWithCompactedLog:YES];
+}
+
+@end
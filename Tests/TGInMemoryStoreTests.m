@@ -141,6 +141,27 @@ static dispatch_queue_t in_memory_store_test_queue() {
     XCTAssert(!fetchError, @"There must not be an error");
 }
 
+- (void)testGetAllObjectsSnapshotIsReusedUntilWrite
+{
+    NSArray *newObjects = [TGTestFactory buildTestDataForResource:self.testNormalResource count:10];
+    NSMutableArray *createdObjects = [NSMutableArray new];
+    for (NSDictionary *newResourceDict in newObjects) {
+        [createdObjects addObject:[self.store createNewObjectForResource:self.testNormalResource withProperties:newResourceDict error:nil]];
+    }
+    
+    NSArray *firstFetch = [self.store getAllObjectsForResource:self.testNormalResource error:nil];
+    NSArray *secondFetch = [self.store getAllObjectsForResource:self.testNormalResource error:nil];
+    XCTAssert(firstFetch == secondFetch, @"Repeated fetches without a write in between must return the cached snapshot");
+    
+    [self.store deleteObjectOfResource:self.testNormalResource withPrimaryKey:createdObjects[3][self.testNormalResource.primaryKey] error:nil];
+    NSArray *fetchAfterDelete = [self.store getAllObjectsForResource:self.testNormalResource error:nil];
+    [createdObjects removeObjectAtIndex:3];
+    
+    XCTAssert(fetchAfterDelete != firstFetch, @"A write must invalidate the cached snapshot");
+    XCTAssert([fetchAfterDelete isEqualToArray:createdObjects], @"The snapshot must be ordered by primary key and exclude deleted objects");
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == createdObjects.count, @"The live count must track deletes");
+}
+
 - (void)testGetAllChildObjectsForParent
 {
     NSDictionary *parentAttributes = [TGTestFactory buildTestDataForResource:self.testParentResource];
@@ -168,6 +189,271 @@ static dispatch_queue_t in_memory_store_test_queue() {
     XCTAssert([fetchChildren isEqualToArray:childArray], @"The returned array must be identical to the array of children that were created.");
 }
 
+- (void)testForeignKeyIndexFollowsModifyAndDelete
+{
+    NSDictionary *firstParent = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSDictionary *secondParent = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    id firstParentKey = firstParent[self.testParentResource.primaryKey];
+    id secondParentKey = secondParent[self.testParentResource.primaryKey];
+    
+    NSMutableArray *children = [NSMutableArray new];
+    for (NSDictionary *childPropertiesDict in [TGTestFactory buildTestDataForResource:self.testChildResource count:4]) {
+        NSMutableDictionary *childProperties = [NSMutableDictionary dictionaryWithDictionary:childPropertiesDict];
+        [childProperties setObject:firstParentKey forKey:foreignKey];
+        [children addObject:[self.store createNewObjectForResource:self.testChildResource withProperties:childProperties error:nil]];
+    }
+    
+    NSDictionary *movedChild = [self.store modifyObjectOfResource:self.testChildResource withPrimaryKey:children[1][self.testChildResource.primaryKey] withProperties:@{foreignKey: secondParentKey} error:nil];
+    
+    NSArray *firstChildren = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:[firstParentKey description] error:nil];
+    NSArray *secondChildren = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:[secondParentKey description] error:nil];
+    XCTAssert(firstChildren.count == 3, @"The first parent must have three children left after one was moved");
+    XCTAssert([secondChildren isEqualToArray:@[movedChild]], @"The second parent must only have the moved child");
+    
+    NSError *deleteError;
+    [self.store deleteObjectOfResource:self.testParentResource withPrimaryKey:[firstParentKey description] error:&deleteError];
+    XCTAssertNil(deleteError, @"There must not be an error deleting the parent %@", deleteError);
+    
+    for (NSDictionary *child in firstChildren) {
+        NSDictionary *orphan = [self.store getDataForObjectOfResource:self.testChildResource withPrimaryKey:[child[self.testChildResource.primaryKey] description] error:nil];
+        XCTAssert(orphan[foreignKey] == [NSNull null], @"Children of a deleted parent must have their foreign key nulled");
+    }
+    
+    secondChildren = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:[secondParentKey description] error:nil];
+    XCTAssert([secondChildren isEqualToArray:@[movedChild]], @"Children of other parents must be untouched by the delete");
+}
+
+- (void)testCreateObjectsInBatch
+{
+    NSArray *newObjects = [TGTestFactory buildTestDataForResource:self.testNormalResource count:100];
+    
+    NSError *error;
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:newObjects error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error creating a batch of objects %@", error);
+    XCTAssert(createdObjects.count == newObjects.count, @"Every object in the batch must be returned");
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == newObjects.count, @"Every object in the batch must be in the datastore");
+    
+    for (NSUInteger x = 0; x < createdObjects.count; x++) {
+        NSDictionary *createdObject = createdObjects[x];
+        XCTAssert([createdObject[@"name"] isEqual:newObjects[x][@"name"]], @"Created objects must be returned in the same order as their properties");
+        NSDictionary *fetchedObject = [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:[createdObject[self.testNormalResource.primaryKey] description] error:nil];
+        XCTAssert([fetchedObject[@"name"] isEqual:createdObject[@"name"]], @"Each created object must be retrievable by its primary key");
+    }
+}
+
+- (void)testGetObjectsByPage
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:25] error:nil];
+    NSString *primaryKey = self.testNormalResource.primaryKey;
+    
+    NSMutableArray *pagedObjects = [NSMutableArray new];
+    NSString *afterKey;
+    NSArray *page;
+    do {
+        NSError *error;
+        page = [self.store getObjectsForResource:self.testNormalResource afterPrimaryKey:afterKey limit:10 error:&error];
+        XCTAssertNil(error, @"There must not be an error fetching a page %@", error);
+        XCTAssert(page.count <= 10, @"A page must never be larger than the limit");
+        [pagedObjects addObjectsFromArray:page];
+        afterKey = [[page.lastObject objectForKey:primaryKey] description];
+    } while (page.count == 10);
+    
+    XCTAssert(pagedObjects.count == createdObjects.count, @"Walking the pages must return every object exactly once");
+    XCTAssert([[pagedObjects valueForKey:primaryKey] isEqualToArray:[createdObjects valueForKey:primaryKey]], @"Pages must be ordered by primary key");
+    
+    NSArray *pastEnd = [self.store getObjectsForResource:self.testNormalResource afterPrimaryKey:[[createdObjects.lastObject objectForKey:primaryKey] description] limit:10 error:nil];
+    XCTAssert(pastEnd.count == 0, @"A page after the last object must be empty");
+}
+
+- (void)testObjectEnumerator
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:25] error:nil];
+    
+    NSError *error;
+    NSEnumerator *enumerator = [self.store objectEnumeratorForResource:self.testNormalResource error:&error];
+    XCTAssertNil(error, @"There must not be an error opening an enumerator %@", error);
+    XCTAssert([[enumerator.allObjects valueForKey:self.testNormalResource.primaryKey] isEqualToArray:[createdObjects valueForKey:self.testNormalResource.primaryKey]], @"The enumerator must return every object ordered by primary key");
+}
+
+- (void)testGetChildObjectsByPage
+{
+    NSDictionary *parentObject = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSString *parentKey = [parentObject[self.testParentResource.primaryKey] description];
+    NSString *primaryKey = self.testChildResource.primaryKey;
+    
+    NSMutableArray *childProperties = [NSMutableArray new];
+    for (NSDictionary *childPropertiesDict in [TGTestFactory buildTestDataForResource:self.testChildResource count:7]) {
+        NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithDictionary:childPropertiesDict];
+        [properties setObject:parentObject[self.testParentResource.primaryKey] forKey:foreignKey];
+        [childProperties addObject:properties];
+    }
+    NSArray *children = [self.store createNewObjectsForResource:self.testChildResource withPropertiesArray:childProperties error:nil];
+    
+    NSArray *firstPage = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:parentKey afterPrimaryKey:nil limit:5 error:nil];
+    NSArray *secondPage = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:parentKey afterPrimaryKey:[[firstPage.lastObject objectForKey:primaryKey] description] limit:5 error:nil];
+    
+    XCTAssert(firstPage.count == 5, @"The first page must be full");
+    XCTAssert(secondPage.count == 2, @"The second page must hold the remaining children");
+    XCTAssert([[[firstPage arrayByAddingObjectsFromArray:secondPage] valueForKey:primaryKey] isEqualToArray:[children valueForKey:primaryKey]], @"Child pages must be ordered by primary key");
+}
+
+- (void)testGetObjectsMatchingQuery
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:30] error:nil];
+    NSString *primaryKey = self.testNormalResource.primaryKey;
+    
+    NSError *error;
+    TGRESTQuery *rangeQuery = [TGRESTQuery queryWithParameters:@{@"id[gt]": @"10", @"id[lte]": @"20", @"sort": @"-id"} resource:self.testNormalResource error:&error];
+    XCTAssertNil(error, @"The query must be valid %@", error);
+    NSArray *rangeResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:rangeQuery afterPrimaryKey:nil limit:5 error:&error];
+    XCTAssertNil(error, @"There must not be an error running the query %@", error);
+    XCTAssert([[rangeResults valueForKey:primaryKey] isEqualToArray:@[@20, @19, @18, @17, @16]], @"The query must filter by range, sort descending and apply the limit");
+    
+    NSDictionary *namedObject = createdObjects[3];
+    TGRESTQuery *equalityQuery = [TGRESTQuery queryWithParameters:@{@"name": namedObject[@"name"]} resource:self.testNormalResource error:nil];
+    NSArray *equalityResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:equalityQuery afterPrimaryKey:nil limit:NSUIntegerMax error:&error];
+    XCTAssert([[equalityResults valueForKey:primaryKey] containsObject:namedObject[primaryKey]], @"The query must find the object by name");
+    for (NSDictionary *object in equalityResults) {
+        XCTAssert([object[@"name"] isEqualToString:namedObject[@"name"]], @"Every result must match the filter");
+    }
+    
+    NSArray *pagedResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:[TGRESTQuery queryWithParameters:@{@"id[lte]": @"20"} resource:self.testNormalResource error:nil] afterPrimaryKey:@"15" limit:NSUIntegerMax error:&error];
+    XCTAssert([[pagedResults valueForKey:primaryKey] isEqualToArray:@[@16, @17, @18, @19, @20]], @"A query ordered by primary key must start after the key");
+}
+
+- (void)testGetChildObjectsMatchingQueryUsesForeignKeyIndex
+{
+    NSArray *parents = [self.store createNewObjectsForResource:self.testParentResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testParentResource count:2] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSMutableArray *childProperties = [NSMutableArray new];
+    for (NSUInteger x = 0; x < 10; x++) {
+        NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithDictionary:[TGTestFactory buildTestDataForResource:self.testChildResource]];
+        [properties setObject:parents[x % 2][self.testParentResource.primaryKey] forKey:foreignKey];
+        [childProperties addObject:properties];
+    }
+    [self.store createNewObjectsForResource:self.testChildResource withPropertiesArray:childProperties error:nil];
+    
+    NSString *parentKey = [parents[1][self.testParentResource.primaryKey] description];
+    TGRESTQuery *query = [TGRESTQuery queryWithParameters:@{@"sort": @"-id"} resource:self.testChildResource error:nil];
+    query = [query queryByAddingFilterForProperty:foreignKey queryOperator:TGRESTQueryOperatorEqual value:parentKey error:nil];
+    NSArray *children = [self.store getObjectsForResource:self.testChildResource matchingQuery:query afterPrimaryKey:nil limit:NSUIntegerMax error:nil];
+    
+    XCTAssert([[children valueForKey:self.testChildResource.primaryKey] isEqualToArray:@[@10, @8, @6, @4, @2]], @"Only the children of the parent must be returned in query order");
+}
+
+- (TGRESTResource *)indexedResourceWithIndexes:(NSArray *)indexes
+{
+    NSDictionary *model = @{
+                            @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
+                            @"age": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                            @"score": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint]
+                            };
+    
+    return [TGRESTResource newResourceWithName:@"scoredPerson" model:model actions:TGResourceRESTActionsGET | TGResourceRESTActionsPOST primaryKey:nil parentResources:nil foreignKeys:nil indexedProperties:indexes];
+}
+
+- (void)testSecondaryIndexesMatchFullScan
+{
+    TGRESTResource *resource = [self indexedResourceWithIndexes:@[@"age", @"name", @"score"]];
+    [self.store addResource:resource];
+    
+    NSMutableArray *propertiesArray = [NSMutableArray new];
+    for (NSUInteger x = 0; x < 60; x++) {
+        [propertiesArray addObject:@{@"name": [NSString stringWithFormat:@"person%lu", (unsigned long)(x % 7)], @"age": @(x % 13), @"score": @((x % 9) * 0.5)}];
+    }
+    NSArray *createdObjects = [self.store createNewObjectsForResource:resource withPropertiesArray:propertiesArray error:nil];
+    
+    // Move some objects between index buckets and remove others so the indexes have to follow every kind of write.
+    for (NSUInteger x = 0; x < createdObjects.count; x += 5) {
+        NSString *primaryKey = [createdObjects[x][resource.primaryKey] description];
+        [self.store modifyObjectOfResource:resource withPrimaryKey:primaryKey withProperties:@{@"age": @(x % 4), @"name": @"moved", @"score": @2.25} error:nil];
+    }
+    for (NSUInteger x = 3; x < createdObjects.count; x += 11) {
+        [self.store deleteObjectOfResource:resource withPrimaryKey:[createdObjects[x][resource.primaryKey] description] error:nil];
+    }
+    
+    NSArray *allObjects = [self.store getAllObjectsForResource:resource error:nil];
+    NSArray *parameterSets = @[@{@"age": @"3"},
+                               @{@"name": @"moved"},
+                               @{@"name": @"person2", @"age[gte]": @"6"},
+                               @{@"age[gt]": @"4", @"age[lte]": @"9", @"sort": @"-score"},
+                               @{@"score[lt]": @"2.25"},
+                               @{@"score[gte]": @"2.25", @"sort": @"name"},
+                               @{@"age": @"100"}];
+    for (NSDictionary *parameters in parameterSets) {
+        NSError *error;
+        TGRESTQuery *query = [TGRESTQuery queryWithParameters:parameters resource:resource error:&error];
+        XCTAssertNil(error, @"The query must be valid %@", error);
+        NSArray *indexedResults = [self.store getObjectsForResource:resource matchingQuery:query afterPrimaryKey:nil limit:NSUIntegerMax error:&error];
+        XCTAssertNil(error, @"There must not be an error running the query %@", error);
+        NSArray *scannedResults = [query objectsMatchingQueryInObjects:allObjects afterPrimaryKey:nil limit:NSUIntegerMax];
+        XCTAssert([indexedResults isEqualToArray:scannedResults], @"The indexed results for %@ must be the same as a full scan", parameters);
+    }
+    
+    [self.store dropResource:resource];
+}
+
+- (void)testChangingIndexedPropertiesKeepsObjects
+{
+    TGRESTResource *resource = [self indexedResourceWithIndexes:nil];
+    [self.store addResource:resource];
+    [self.store createNewObjectsForResource:resource withPropertiesArray:@[@{@"name": @"Jane", @"age": @30, @"score": @1.5}, @{@"name": @"John", @"age": @40, @"score": @2.5}] error:nil];
+    
+    TGRESTResource *indexedResource = [self indexedResourceWithIndexes:@[@"age"]];
+    [self.store addResource:indexedResource];
+    
+    XCTAssert([self.store countOfObjectsForResource:indexedResource] == 2, @"Adding an index must not drop the existing objects");
+    TGRESTQuery *query = [TGRESTQuery queryWithParameters:@{@"age[gt]": @"35"} resource:indexedResource error:nil];
+    NSArray *results = [self.store getObjectsForResource:indexedResource matchingQuery:query afterPrimaryKey:nil limit:NSUIntegerMax error:nil];
+    XCTAssert([[results valueForKey:@"name"] isEqualToArray:@[@"John"]], @"The new index must cover the objects that were already stored");
+    
+    [self.store addResource:resource];
+    XCTAssert([self.store countOfObjectsForResource:resource] == 2, @"Removing an index must not drop the existing objects");
+    
+    [self.store dropResource:resource];
+}
+
+- (void)testGenerationsAndVersionsFollowWrites
+{
+    NSUInteger initialGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(initialGeneration != NSNotFound, @"The store must track a generation for every resource");
+    
+    NSArray *objects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:2] error:nil];
+    NSUInteger createdGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(createdGeneration > initialGeneration, @"Creating objects must move the generation forward");
+    
+    NSString *firstKey = [objects[0][self.testNormalResource.primaryKey] description];
+    NSString *secondKey = [objects[1][self.testNormalResource.primaryKey] description];
+    NSUInteger firstVersion = [self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:firstKey];
+    NSUInteger secondVersion = [self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey];
+    XCTAssert(firstVersion != NSNotFound && secondVersion != NSNotFound, @"Every created object must have a version");
+    
+    [self.store modifyObjectOfResource:self.testNormalResource withPrimaryKey:firstKey withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:nil];
+    NSUInteger modifiedGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(modifiedGeneration > createdGeneration, @"Modifying an object must move the generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:firstKey] > firstVersion, @"Modifying an object must move its version forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey] == secondVersion, @"Modifying an object must not change the version of other objects");
+    
+    [self.store deleteObjectOfResource:self.testNormalResource withPrimaryKey:secondKey error:nil];
+    XCTAssert([self.store generationForResource:self.testNormalResource] > modifiedGeneration, @"Deleting an object must move the generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey] != secondVersion, @"Deleting an object must change its version");
+    
+    NSDictionary *parent = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSMutableDictionary *childProperties = [NSMutableDictionary dictionaryWithDictionary:[TGTestFactory buildTestDataForResource:self.testChildResource]];
+    [childProperties setObject:parent[self.testParentResource.primaryKey] forKey:self.testChildResource.foreignKeys[self.testParentResource.name]];
+    NSDictionary *child = [self.store createNewObjectForResource:self.testChildResource withProperties:childProperties error:nil];
+    NSString *childKey = [child[self.testChildResource.primaryKey] description];
+    NSUInteger childGeneration = [self.store generationForResource:self.testChildResource];
+    NSUInteger childVersion = [self.store versionOfObjectOfResource:self.testChildResource withPrimaryKey:childKey];
+    
+    [self.store deleteObjectOfResource:self.testParentResource withPrimaryKey:[parent[self.testParentResource.primaryKey] description] error:nil];
+    XCTAssert([self.store generationForResource:self.testChildResource] > childGeneration, @"Nulling foreign keys on a parent delete must move the child generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testChildResource withPrimaryKey:childKey] != childVersion, @"Nulling a foreign key must change the child version");
+}
+
 - (void)testModifyObject
 {
     NSDictionary *properties = [TGTestFactory buildTestDataForResource:self.testNormalResource];
@@ -306,6 +592,97 @@ static dispatch_queue_t in_memory_store_test_queue() {
     XCTAssert(currentResources.count == newResourceProperties.count, @"The number of objects in the datastore must match the number of objects created");
 }
 
+- (void)performMixedWorkloadOnStore:(TGRESTStore *)store withResources:(NSArray *)resources count:(NSUInteger)count
+{
+    [self performMixedWorkloadOnStore:store withResources:resources count:count serialQueue:nil];
+}
+
+- (void)performMixedWorkloadOnStore:(TGRESTStore *)store withResources:(NSArray *)resources count:(NSUInteger)count serialQueue:(NSOperationQueue *)serialQueue
+{
+    NSMutableArray *propertiesArrays = [NSMutableArray new];
+    for (TGRESTResource *resource in resources) {
+        [propertiesArrays addObject:[TGTestFactory buildTestDataForResource:resource count:count]];
+    }
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        for (NSUInteger resourceIndex = 0; resourceIndex < resources.count; resourceIndex++) {
+            TGRESTResource *resource = resources[resourceIndex];
+            NSDictionary *properties = propertiesArrays[resourceIndex][x];
+            void (^workload)(void) = ^{
+                NSError *error;
+                NSDictionary *object = [store createNewObjectForResource:resource withProperties:properties error:&error];
+                XCTAssertNil(error, @"There must not be an error creating an object %@", error);
+                for (int read = 0; read < 4; read++) {
+                    [store getDataForObjectOfResource:resource withPrimaryKey:object[resource.primaryKey] error:nil];
+                }
+                if (x % 10 == 0) {
+                    [store getAllObjectsForResource:resource error:nil];
+                }
+                if (x % 5 == 0) {
+                    [store modifyObjectOfResource:resource withPrimaryKey:object[resource.primaryKey] withProperties:properties error:nil];
+                }
+            };
+            dispatch_group_async(in_memory_store_test_group(), in_memory_store_test_queue(), ^{
+                if (!serialQueue) {
+                    workload();
+                    return;
+                }
+                NSBlockOperation *operation = [NSBlockOperation blockOperationWithBlock:workload];
+                [serialQueue addOperation:operation];
+                [operation waitUntilFinished];
+            });
+        }
+    }
+    dispatch_group_wait(in_memory_store_test_group(), DISPATCH_TIME_FOREVER);
+}
+
+- (void)testConcurrentMixedWorkloadAcrossResources
+{
+    TGRESTResource *carResource = [TGRESTResource newResourceWithName:@"car" model:@{@"make": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    [self.store addResource:carResource];
+    
+    TGRESTResource *personResource = self.testNormalResource;
+    [self performMixedWorkloadOnStore:self.store withResources:@[personResource, carResource] count:500];
+    
+    XCTAssert([self.store countOfObjectsForResource:personResource] == 500, @"Every person object must have been created");
+    XCTAssert([self.store countOfObjectsForResource:carResource] == 500, @"Every car object must have been created");
+    
+    NSArray *personPrimaryKeys = [[self.store getAllObjectsForResource:personResource error:nil] valueForKey:personResource.primaryKey];
+    XCTAssert([[NSSet setWithArray:personPrimaryKeys] count] == 500, @"Primary keys must be unique under concurrent creation");
+    
+    [self.store dropResource:carResource];
+}
+
+#pragma mark - Performance
+
+- (void)testConcurrentMixedWorkloadPerformance
+{
+    TGRESTResource *carResource = [TGRESTResource newResourceWithName:@"car" model:@{@"make": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    [self.store addResource:carResource];
+    
+    [self measureBlock:^{
+        [self performMixedWorkloadOnStore:self.store withResources:@[self.testNormalResource, carResource] count:200];
+    }];
+    
+    [self.store dropResource:carResource];
+}
+
+- (void)testSerializedMixedWorkloadPerformance
+{
+    TGRESTResource *carResource = [TGRESTResource newResourceWithName:@"car" model:@{@"make": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    [self.store addResource:carResource];
+    
+    // The same workload funnelled through a single serial queue, which is how the store used to handle every call.
+    NSOperationQueue *serialQueue = [NSOperationQueue new];
+    serialQueue.maxConcurrentOperationCount = 1;
+    
+    [self measureBlock:^{
+        [self performMixedWorkloadOnStore:self.store withResources:@[self.testNormalResource, carResource] count:200 serialQueue:serialQueue];
+    }];
+    
+    [self.store dropResource:carResource];
+}
+
 /*
 
 - (void)testStringPrimaryKeyType
@@ -0,0 +1,137 @@
+//
+//  TGJSONEncoderTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/5/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+#import "TGRESTJSONEncoder.h"
+
+@interface TGJSONEncoderTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testResource;
+@property (nonatomic, strong) TGRESTJSONEncoder *encoder;
+
+@end
+
+@implementation TGJSONEncoderTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.testResource = [TGRESTResource newResourceWithName:@"measurement" model:@{
+                                                                                  @"label": [NSNumber numberWithInteger:TGPropertyTypeString],
+                                                                                  @"count": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                                                                                  @"reading": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint],
+                                                                                  @"payload": [NSNumber numberWithInteger:TGPropertyTypeBlob]
+                                                                                  }];
+    self.encoder = [TGRESTJSONEncoder encoderWithResource:self.testResource];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+- (void)testEncodedObjectMatchesJSONSerialization
+{
+    NSDictionary *object = @{@"id": @42,
+                             @"label": @"Quote \" backslash \\ newline \n tab \t bell \a snowman ☃",
+                             @"count": @-9000000000,
+                             @"reading": @0.1,
+                             @"extra": @[@1, @"two"]};
+    
+    NSData *data = [self.encoder dataWithObject:object];
+    XCTAssertNotNil(data, @"The object must be encoded");
+    
+    NSDictionary *decoded = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:nil];
+    XCTAssert([decoded isEqualToDictionary:object], @"The encoded object must decode to the original object %@", decoded);
+    XCTAssert([[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] rangeOfString:@"\"reading\":0.1,"].location != NSNotFound, @"Floating point values must be written in their shortest form");
+}
+
+- (void)testSpecialValues
+{
+    NSDictionary *object = @{@"id": @1,
+                             @"label": [NSNull null],
+                             @"count": @YES,
+                             @"payload": [@"bytes" dataUsingEncoding:NSUTF8StringEncoding]};
+    
+    NSDictionary *decoded = [NSJSONSerialization JSONObjectWithData:[self.encoder dataWithObject:object] options:kNilOptions error:nil];
+    XCTAssert(decoded[@"label"] == [NSNull null], @"Null values must be written as null");
+    XCTAssert([decoded[@"count"] isEqual:@YES], @"Boolean values must be written as booleans");
+    XCTAssert([decoded[@"payload"] isEqualToString:@"Ynl0ZXM="], @"Blob values must be written as base64 strings");
+}
+
+- (void)testUnencodableObjectLeavesBufferUnchanged
+{
+    NSMutableData *data = [NSMutableData dataWithBytes:"[" length:1];
+    
+    BOOL appended = [self.encoder appendObject:@{@"id": @1, @"label": @"Fine", @"reading": [NSNumber numberWithDouble:NAN]} toData:data];
+    XCTAssertFalse(appended, @"A value that is not a number can't be encoded");
+    XCTAssert(data.length == 1, @"The buffer must be left unchanged");
+    XCTAssertNil([self.encoder dataWithObjects:@[@{@"id": @1}, @{@"id": [NSDate date]}]], @"A collection with an unencodable object can't be encoded");
+}
+
+- (NSArray *)benchmarkObjectsWithResource:(TGRESTResource * __autoreleasing *)benchmarkResource
+{
+    static TGRESTResource *resource;
+    static NSArray *objects;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // Both benchmarks encode the very same objects. Blobs can't go through NSJSONSerialization so they only use the other properties.
+        resource = [TGTestFactory randomModelTestResource];
+        NSMutableArray *benchmarkObjects = [NSMutableArray new];
+        NSUInteger x = 1;
+        for (NSDictionary *properties in [TGTestFactory buildTestDataForResource:resource count:10000]) {
+            NSMutableDictionary *object = [NSMutableDictionary dictionaryWithDictionary:properties];
+            for (NSString *property in resource.model) {
+                if ([resource.model[property] integerValue] == TGPropertyTypeBlob) {
+                    [object removeObjectForKey:property];
+                }
+            }
+            [object setObject:[NSNumber numberWithUnsignedInteger:x++] forKey:resource.primaryKey];
+            [benchmarkObjects addObject:object];
+        }
+        objects = [NSArray arrayWithArray:benchmarkObjects];
+    });
+    
+    *benchmarkResource = resource;
+    return objects;
+}
+
+- (void)testEncodingPerformance
+{
+    TGRESTResource *resource;
+    NSArray *objects = [self benchmarkObjectsWithResource:&resource];
+    TGRESTJSONEncoder *encoder = [TGRESTJSONEncoder encoderWithResource:resource];
+    
+    __block NSData *encoderData;
+    [self measureBlock:^{
+        encoderData = [encoder dataWithObjects:objects];
+    }];
+    
+    XCTAssertNotNil(encoderData, @"The objects must be encoded");
+    NSArray *encoderObjects = [NSJSONSerialization JSONObjectWithData:encoderData options:kNilOptions error:nil];
+    NSArray *serializationObjects = [NSJSONSerialization JSONObjectWithData:[NSJSONSerialization dataWithJSONObject:objects options:kNilOptions error:nil] options:kNilOptions error:nil];
+    XCTAssert([encoderObjects isEqualToArray:serializationObjects], @"The encoder must produce the same values as NSJSONSerialization");
+}
+
+- (void)testJSONSerializationEncodingPerformance
+{
+    TGRESTResource *resource;
+    NSArray *objects = [self benchmarkObjectsWithResource:&resource];
+    
+    __block NSData *serializationData;
+    [self measureBlock:^{
+        serializationData = [NSJSONSerialization dataWithJSONObject:objects options:kNilOptions error:nil];
+    }];
+    
+    XCTAssertNotNil(serializationData, @"The objects must be serialized");
+}
+
+@end
@@ -0,0 +1,155 @@
+//
+//  TGLatencyProfileTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+
+@interface TGLatencyProfileTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testResource;
+
+@end
+
+@implementation TGLatencyProfileTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.testResource = [TGTestFactory testResource];
+}
+
+- (void)tearDown
+{
+    [[TGRESTServer sharedServer] removeAllResourcesWithData:YES];
+    [[TGRESTServer sharedServer] stopServer];
+    [super tearDown];
+}
+
+- (NSArray *)sortedSamplesFromProfile:(TGRESTLatencyProfile *)profile count:(NSUInteger)count
+{
+    NSMutableArray *samples = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger x = 0; x < count; x++) {
+        [samples addObject:@([profile nextLatency])];
+    }
+    
+    return [samples sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (void)testFixedAndUniformProfiles
+{
+    NSArray *fixed = [self sortedSamplesFromProfile:[TGRESTLatencyProfile fixedProfileWithLatency:0.25] count:1000];
+    XCTAssert([fixed.firstObject doubleValue] == 0.25 && [fixed.lastObject doubleValue] == 0.25, @"A fixed profile must always return its latency");
+    
+    NSArray *uniform = [self sortedSamplesFromProfile:[TGRESTLatencyProfile uniformProfileWithMinimum:0.1 maximum:0.3] count:10000];
+    XCTAssert([uniform.firstObject doubleValue] >= 0.1 && [uniform.lastObject doubleValue] <= 0.3, @"A uniform profile must stay within its range");
+    XCTAssertEqualWithAccuracy([uniform[uniform.count / 2] doubleValue], 0.2, 0.01, @"The median of a uniform profile must be in the middle of its range");
+}
+
+- (void)testNormalProfile
+{
+    NSArray *samples = [self sortedSamplesFromProfile:[TGRESTLatencyProfile normalProfileWithMean:0.1 standardDeviation:0.1] count:20000];
+    
+    XCTAssert([samples.firstObject doubleValue] >= 0, @"A normal profile must never return a negative latency");
+    XCTAssertEqualWithAccuracy([samples[samples.count / 2] doubleValue], 0.1, 0.01, @"The median of a normal profile must be its mean");
+    XCTAssertEqualWithAccuracy([samples[(NSUInteger)(samples.count * 0.8413)] doubleValue], 0.2, 0.015, @"One standard deviation above the mean must be the 84th percentile");
+}
+
+- (void)testPercentileProfile
+{
+    TGRESTLatencyProfile *profile = [TGRESTLatencyProfile percentileProfileWithLatencies:@{@50: @0.05, @99: @0.4, @99.9: @1.2}];
+    NSArray *samples = [self sortedSamplesFromProfile:profile count:100000];
+    
+    XCTAssertEqualWithAccuracy([samples[samples.count / 2] doubleValue], 0.05, 0.005, @"The 50th percentile must match the table");
+    XCTAssertEqualWithAccuracy([samples[(NSUInteger)(samples.count * 0.99)] doubleValue], 0.4, 0.05, @"The 99th percentile must match the table");
+    XCTAssert([samples.lastObject doubleValue] <= 1.2, @"No latency may be above the highest percentile");
+    XCTAssert([samples.lastObject doubleValue] > 0.4, @"The tail above the 99th percentile must be sampled");
+}
+
+- (void)testProfilePrecedence
+{
+    TGRESTLatencyProfile *serverProfile = [TGRESTLatencyProfile fixedProfileWithLatency:0.1];
+    TGRESTLatencyProfile *resourceProfile = [TGRESTLatencyProfile fixedProfileWithLatency:0.2];
+    TGRESTLatencyProfile *actionProfile = [TGRESTLatencyProfile fixedProfileWithLatency:0.3];
+    TGRESTServer *server = [TGRESTServer sharedServer];
+    [server addResource:self.testResource];
+    [server startServerWithOptions:@{TGRESTServerLatencyProfileOptionKey: serverProfile}];
+    
+    [server setLatencyProfile:resourceProfile forResource:self.testResource];
+    [server setLatencyProfile:actionProfile forResource:self.testResource action:TGRESTRouteActionCreate];
+    
+    XCTAssert([server latencyProfileForResource:self.testResource action:TGRESTRouteActionCreate] == actionProfile, @"An action profile must be used first");
+    XCTAssert([server latencyProfileForResource:self.testResource action:TGRESTRouteActionIndex] == resourceProfile, @"A resource profile must be used for the other actions");
+    
+    [server setLatencyProfile:nil forResource:self.testResource];
+    XCTAssert([server latencyProfileForResource:self.testResource action:TGRESTRouteActionIndex] == serverProfile, @"The server profile must be used when no other profile is set");
+    
+    [server removeResource:self.testResource withData:YES];
+    XCTAssert([server latencyProfileForResource:self.testResource action:TGRESTRouteActionCreate] == serverProfile, @"Profiles must be removed along with the resource");
+}
+
+- (void)testLatencyRangeUsesUniformProfile
+{
+    [[TGRESTServer sharedServer] addResource:self.testResource];
+    [[TGRESTServer sharedServer] startServerWithOptions:@{TGLatencyRangeMinimumOptionKey: @0.2, TGLatencyRangeMaximumOptionKey: @0.3}];
+    
+    TGRESTLatencyProfile *profile = [[TGRESTServer sharedServer] latencyProfileForResource:self.testResource action:TGRESTRouteActionShow];
+    NSArray *samples = [self sortedSamplesFromProfile:profile count:1000];
+    XCTAssert([samples.firstObject doubleValue] >= 0.2 && [samples.lastObject doubleValue] <= 0.3, @"The latency range options must make a uniform profile");
+    
+    [[TGRESTServer sharedServer] startServerWithOptions:nil];
+    XCTAssertNil([[TGRESTServer sharedServer] latencyProfileForResource:self.testResource action:TGRESTRouteActionShow], @"There must not be a profile without latency options");
+}
+
+#pragma mark - Negative testing
+
+- (void)testDecreasingPercentilesThrow
+{
+    XCTAssertThrows([TGRESTLatencyProfile percentileProfileWithLatencies:@{@50: @0.5, @99: @0.1}], @"Latencies that go down as the percentile goes up must throw");
+    XCTAssertThrows([TGRESTLatencyProfile percentileProfileWithLatencies:@{@150: @0.5}], @"Percentiles above 100 must throw");
+}
+
+#pragma mark - Performance
+
+- (void)testConcurrentDelayedRequests
+{
+    NSUInteger requestCount = 200;
+    NSTimeInterval latency = 0.5;
+    [[TGRESTServer sharedServer] addResource:self.testResource];
+    [[TGRESTServer sharedServer] startServerWithOptions:@{TGRESTServerLatencyProfileOptionKey: [TGRESTLatencyProfile fixedProfileWithLatency:latency]}];
+    
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    configuration.HTTPMaximumConnectionsPerHost = requestCount;
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:configuration];
+    NSURL *url = [[[TGRESTServer sharedServer] serverURL] URLByAppendingPathComponent:self.testResource.name];
+    
+    __weak typeof(self) weakSelf = self;
+    __block NSUInteger completedCount = 0;
+    __block NSUInteger failedCount = 0;
+    
+    CGFloat time = TGTimedTestBlock(^{
+        for (NSUInteger x = 0; x < requestCount; x++) {
+            [[session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                __strong typeof(weakSelf) strongSelf = weakSelf;
+                if (error || [(NSHTTPURLResponse *)response statusCode] != 200) {
+                    failedCount++;
+                }
+                completedCount++;
+                if (completedCount == requestCount) {
+                    [strongSelf notify:XCTAsyncTestCaseStatusSucceeded];
+                }
+            }] resume];
+        }
+        [weakSelf waitForStatus:XCTAsyncTestCaseStatusSucceeded timeout:10];
+    });
+    [session invalidateAndCancel];
+    
+    XCTAssert(completedCount == requestCount && failedCount == 0, @"Every request must succeed but %lu of %lu failed", (unsigned long)failedCount, (unsigned long)completedCount);
+    XCTAssert(time < latency * 4, @"Delayed requests must be answered concurrently instead of one worker at a time");
+}
+
+@end
@@ -0,0 +1,124 @@
+//
+//  TGLoggerTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "TGPrivateFunctions.h"
+#import "TGRESTLogger.h"
+
+@interface TGLoggerTests : XCTestCase
+
+@end
+
+@implementation TGLoggerTests
+
+- (void)tearDown
+{
+    TGRESTLogFlush();
+    [super tearDown];
+}
+
+- (void)testMessagesAreFormattedOnTheLoggingThread
+{
+    __block NSThread *formattingThread;
+    __block NSUInteger formattedCount = 0;
+    for (NSUInteger x = 0; x < 10; x++) {
+        TGRESTLogMessage(YES, ^NSString *{
+            formattingThread = [NSThread currentThread];
+            formattedCount++;
+            return nil;
+        });
+    }
+    TGRESTLogFlush();
+    
+    XCTAssert(formattedCount == 10, @"Every message must be formatted once the buffer is flushed but %lu were", (unsigned long)formattedCount);
+    XCTAssert(formattingThread && formattingThread != [NSThread currentThread], @"Asynchronous messages must not be formatted on the calling thread");
+}
+
+- (void)testSynchronousMessagesAreWrittenInOrder
+{
+    NSMutableArray *order = [NSMutableArray new];
+    TGRESTLogMessage(YES, ^NSString *{
+        [NSThread sleepForTimeInterval:0.1];
+        @synchronized(order) {
+            [order addObject:@"asynchronous"];
+        }
+        return nil;
+    });
+    TGRESTLogMessage(NO, ^NSString *{
+        @synchronized(order) {
+            [order addObject:@"synchronous"];
+        }
+        return nil;
+    });
+    
+    XCTAssertEqualObjects(order, (@[@"asynchronous", @"synchronous"]), @"A synchronous message must wait for the messages before it");
+}
+
+#pragma mark - Negative testing
+
+- (void)testMessagesAreDroppedWhenTheBufferIsFull
+{
+    uint64_t droppedBefore = TGRESTLogDroppedMessageCount();
+    dispatch_semaphore_t blocker = dispatch_semaphore_create(0);
+    TGRESTLogMessage(YES, ^NSString *{
+        dispatch_semaphore_wait(blocker, DISPATCH_TIME_FOREVER);
+        return nil;
+    });
+    
+    // Give the logging thread time to pick up the blocking message so the buffer can't drain.
+    [NSThread sleepForTimeInterval:0.1];
+    for (NSUInteger x = 0; x < TGRESTLogBufferCapacity + 100; x++) {
+        TGRESTLogMessage(YES, ^NSString *{
+            return nil;
+        });
+    }
+    dispatch_semaphore_signal(blocker);
+    TGRESTLogFlush();
+    
+    XCTAssert(TGRESTLogDroppedMessageCount() - droppedBefore >= 100, @"Messages that don't fit in the buffer must be dropped and counted");
+}
+
+#pragma mark - Performance
+
+- (void)testLoggingPerformance
+{
+    NSUInteger messageCount = 100000;
+    
+    [self measureBlock:^{
+        dispatch_apply(TGCountOfCores(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            for (NSUInteger x = 0; x < messageCount / TGCountOfCores(); x++) {
+                TGRESTLogMessage(YES, ^NSString *{
+                    return nil;
+                });
+            }
+        });
+        TGRESTLogFlush();
+    }];
+}
+
+- (void)testSynchronousLoggingPerformance
+{
+    NSUInteger messageCount = 100000;
+    FILE *output = fopen("/dev/null", "w");
+    
+    // What the macros used to do: format on the calling thread and take the stream lock for every message.
+    [self measureBlock:^{
+        dispatch_apply(TGCountOfCores(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            for (NSUInteger x = 0; x < messageCount / TGCountOfCores(); x++) {
+                NSString *message = [NSString stringWithFormat:@"%@ Returning response with latency %f", [NSDate date], (double)x];
+                fprintf(output, "%s\n", message.UTF8String);
+            }
+        });
+        fflush(output);
+    }];
+    
+    fclose(output);
+}
+
+@end
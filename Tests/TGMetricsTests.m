@@ -0,0 +1,163 @@
+//
+//  TGMetricsTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "TGPrivateFunctions.h"
+
+@interface TGMetricsTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *testResource;
+
+@end
+
+@implementation TGMetricsTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.testResource = [TGTestFactory testResource];
+    [[TGRESTServer sharedServer] addResource:self.testResource];
+}
+
+- (void)tearDown
+{
+    [[TGRESTServer sharedServer] removeAllResourcesWithData:YES];
+    [[TGRESTServer sharedServer] stopServer];
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)sendRequestWithPath:(NSString *)path data:(NSData **)data
+{
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", [[TGRESTServer sharedServer] serverURL], path]];
+    NSHTTPURLResponse *response;
+    NSData *responseData = [NSURLConnection sendSynchronousRequest:[NSURLRequest requestWithURL:url] returningResponse:&response error:nil];
+    if (data) {
+        *data = responseData;
+    }
+    
+    return response;
+}
+
+- (void)testMonotonicTime
+{
+    uint64_t start = TGMonotonicTime();
+    [NSThread sleepForTimeInterval:0.1];
+    uint64_t elapsed = TGMonotonicTime() - start;
+    
+    XCTAssert(elapsed >= 0.1 * NSEC_PER_SEC && elapsed < 0.5 * NSEC_PER_SEC, @"The clock must measure the sleep in nanoseconds but measured %llu", elapsed);
+}
+
+- (void)testHistogramPercentiles
+{
+    TGRESTHistogram *histogram = [TGRESTHistogram new];
+    for (uint64_t x = 1; x <= 10000; x++) {
+        [histogram recordValue:x];
+    }
+    
+    XCTAssert(histogram.count == 10000 && histogram.sum == 50005000, @"Every value must be counted");
+    XCTAssert(histogram.minimum == 1 && histogram.maximum == 10000, @"The minimum and maximum must be exact");
+    XCTAssertEqualWithAccuracy((double)[histogram valueAtPercentile:50], 5000, 5000 * 0.0625, @"The median must be within the bucket precision");
+    XCTAssertEqualWithAccuracy((double)[histogram valueAtPercentile:99.9], 9990, 9990 * 0.0625, @"The 99.9th percentile must be within the bucket precision");
+    XCTAssert([histogram valueAtPercentile:100] == 10000, @"The 100th percentile must be the maximum");
+    XCTAssert([[TGRESTHistogram new] valueAtPercentile:50] == 0, @"An empty histogram must report zero");
+}
+
+- (void)testHistogramConcurrentRecording
+{
+    TGRESTHistogram *histogram = [TGRESTHistogram new];
+    dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        for (uint64_t x = 0; x < 100000; x++) {
+            [histogram recordValue:x];
+        }
+    });
+    
+    XCTAssert(histogram.count == 800000, @"Values recorded from several threads must all be counted but %llu were", histogram.count);
+    XCTAssert([[histogram copy] count] == histogram.count, @"A copy must be a snapshot of the histogram");
+}
+
+- (void)testRequestsAreMeasured
+{
+    [[TGRESTServer sharedServer] startServerWithOptions:nil];
+    [TGTestFactory createTestDataForResource:self.testResource count:10];
+    
+    [self sendRequestWithPath:[NSString stringWithFormat:@"%@/1", self.testResource.name] data:nil];
+    [self sendRequestWithPath:[NSString stringWithFormat:@"%@/100", self.testResource.name] data:nil];
+    
+    TGRESTRouteMetrics *metrics = [[TGRESTServer sharedServer] metricsForResource:self.testResource action:TGRESTRouteActionShow];
+    XCTAssert(metrics.handlerTime.count == 2 && metrics.storeTime.count == 2, @"Every request must be measured");
+    XCTAssert([metrics countForStatusCode:200] == 1 && [metrics countForStatusCode:404] == 1, @"Status codes must be counted %@", [metrics statusCodeCounts]);
+    XCTAssert(metrics.responseBytes.maximum > 0, @"Response sizes must be measured");
+    XCTAssert(metrics.storeTime.maximum <= metrics.handlerTime.maximum, @"The store time must be part of the handler time");
+    XCTAssertNil([[TGRESTServer sharedServer] metricsForResource:self.testResource action:TGRESTRouteActionDestroy], @"Actions without requests must not have metrics");
+    
+    [[TGRESTServer sharedServer] resetMetrics];
+    XCTAssert([[TGRESTServer sharedServer] allRouteMetrics].count == 0, @"Reset metrics must be empty");
+}
+
+- (void)testMetricsEndpoint
+{
+    [[TGRESTServer sharedServer] startServerWithOptions:@{TGRESTServerMetricsEndpointOptionKey: @YES}];
+    [self sendRequestWithPath:self.testResource.name data:nil];
+    
+    NSData *data;
+    NSHTTPURLResponse *response = [self sendRequestWithPath:@"_metrics" data:&data];
+    NSString *text = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    
+    XCTAssert(response.statusCode == 200 && [response.MIMEType isEqualToString:@"text/plain"], @"The endpoint must return text");
+    XCTAssert([text rangeOfString:@"# TYPE resteasy_handler_seconds summary"].location != NSNotFound, @"Histograms must be summaries");
+    XCTAssert([text rangeOfString:@"resteasy_handler_seconds_count{resource=\"person\",action=\"index\"} 1\n"].location != NSNotFound, @"The index request must be counted %@", text);
+    XCTAssert([text rangeOfString:@"resteasy_responses_total{resource=\"person\",action=\"index\",code=\"200\"} 1\n"].location != NSNotFound, @"The status code must be counted %@", text);
+}
+
+#pragma mark - Negative testing
+
+- (void)testMetricsEndpointIsOptIn
+{
+    [[TGRESTServer sharedServer] startServerWithOptions:nil];
+    NSHTTPURLResponse *response = [self sendRequestWithPath:@"_metrics" data:nil];
+    
+    XCTAssert(response.statusCode != 200, @"The endpoint must not exist unless it is turned on");
+}
+
+#pragma mark - Performance
+
+- (void)testRecordingPerformance
+{
+    NSUInteger recordCount = 100000;
+    
+    [self measureBlock:^{
+        TGRESTRouteMetrics *metrics = [TGRESTRouteMetrics metricsWithResourceName:@"person" action:TGRESTRouteActionIndex];
+        dispatch_apply(TGCountOfCores(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            for (NSUInteger x = 0; x < recordCount / TGCountOfCores(); x++) {
+                [metrics recordRequestWithHandlerTime:x storeTime:x / 2 serializeTime:x / 4 requestBytes:0 responseBytes:x statusCode:200];
+            }
+        });
+        XCTAssert([metrics countForStatusCode:200] == (recordCount / TGCountOfCores()) * TGCountOfCores(), @"Every request must be recorded");
+    }];
+}
+
+- (void)testLockedRecordingPerformance
+{
+    NSUInteger recordCount = 100000;
+    
+    // The same recording behind a single lock, the contention the lock free histograms are there to avoid.
+    [self measureBlock:^{
+        TGRESTRouteMetrics *metrics = [TGRESTRouteMetrics metricsWithResourceName:@"person" action:TGRESTRouteActionIndex];
+        dispatch_apply(TGCountOfCores(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            for (NSUInteger x = 0; x < recordCount / TGCountOfCores(); x++) {
+                @synchronized(metrics) {
+                    [metrics recordRequestWithHandlerTime:x storeTime:x / 2 serializeTime:x / 4 requestBytes:0 responseBytes:x statusCode:200];
+                }
+            }
+        });
+        XCTAssert([metrics countForStatusCode:200] == (recordCount / TGCountOfCores()) * TGCountOfCores(), @"Every request must be recorded");
+    }];
+}
+
+@end
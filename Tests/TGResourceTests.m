@@ -199,6 +199,24 @@
     XCTAssert([resource.foreignKeys[parentResource.name] isEqualToString:customFkey], @"The foreign key dictionary value for the parent name should be the custom foreign key");
 }
 
+- (void)testIndexedPropertiesConstructor
+{
+    TGRESTResource *parentResource = [TGTestFactory randomModelTestResource];
+    NSDictionary *model = @{
+                            @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
+                            @"age": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                            @"score": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint]
+                            };
+    TGRESTResource *resource;
+    NSString *foreignKey = [NSString stringWithFormat:@"%@_id", [parentResource.name singularizedString]];
+    
+    XCTAssertNoThrow(resource = [TGRESTResource newResourceWithName:@"human" model:model actions:TGResourceRESTActionsGET primaryKey:nil parentResources:@[parentResource] foreignKeys:nil indexedProperties:@[@"score", @"age", @"id", foreignKey, @"age"]]);
+    XCTAssert([resource.indexedProperties isEqualToArray:@[@"age", @"score"]], @"Indexed properties must be sorted without duplicates, the primary key or foreign keys");
+    
+    TGRESTResource *defaultResource = [TGRESTResource newResourceWithName:@"human" model:model];
+    XCTAssert(defaultResource.indexedProperties && defaultResource.indexedProperties.count == 0, @"Resources must default to no indexed properties");
+}
+
 - (void)testModelPropertyTypes
 {
     NSDictionary *model = @{
@@ -327,6 +345,27 @@
     XCTAssertNil(resource, @"The resource must be nil");
 }
 
+- (void)testIndexedPropertyNotInModel
+{
+    TGRESTResource *resource;
+    NSDictionary *model = @{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]};
+    
+    XCTAssertThrows(resource = [TGRESTResource newResourceWithName:@"person" model:model actions:TGResourceRESTActionsGET primaryKey:nil parentResources:nil foreignKeys:nil indexedProperties:@[@"age"]], @"Indexing a property that is not in the model must throw an exception");
+    XCTAssertNil(resource, @"The resource must be nil");
+}
+
+- (void)testIndexedPropertyInvalidType
+{
+    TGRESTResource *resource;
+    NSDictionary *model = @{
+                            @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
+                            @"photo": [NSNumber numberWithInteger:TGPropertyTypeBlob]
+                            };
+    
+    XCTAssertThrows(resource = [TGRESTResource newResourceWithName:@"person" model:model actions:TGResourceRESTActionsGET primaryKey:nil parentResources:nil foreignKeys:nil indexedProperties:@[@"photo"]], @"Indexing a blob property must throw an exception");
+    XCTAssertNil(resource, @"The resource must be nil");
+}
+
 - (void)testForeignKeyParentNameMismatch
 {
     TGRESTResource *parent = [TGTestFactory testResource];
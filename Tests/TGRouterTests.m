@@ -0,0 +1,168 @@
+//
+//  TGRouterTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/8/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "TGRESTRouter.h"
+#import "TGRESTRoute.h"
+
+@interface TGRouterTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTRouter *router;
+@property (nonatomic, strong) TGRESTResource *parentResource;
+@property (nonatomic, strong) TGRESTResource *childResource;
+
+@end
+
+@implementation TGRouterTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.router = [TGRESTRouter new];
+    self.parentResource = [TGRESTResource newResourceWithName:@"people" model:@{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    self.childResource = [TGRESTResource newResourceWithName:@"email" model:@{@"address": [NSNumber numberWithInteger:TGPropertyTypeString]} actions:TGResourceRESTActionsPOST | TGResourceRESTActionsPUT | TGResourceRESTActionsGET | TGResourceRESTActionsDELETE primaryKey:nil parentResources:@[self.parentResource]];
+    [self.router addRoutesForResource:self.parentResource];
+    [self.router addRoutesForResource:self.childResource];
+}
+
+- (void)testResourceRoutes
+{
+    TGRESTRoute *route = [self.router routeForMethod:@"GET" path:@"/people"];
+    XCTAssert(route.action == TGRESTRouteActionIndex && route.resource == self.parentResource && !route.primaryKey, @"GET on a collection must route to index %@", route);
+    
+    route = [self.router routeForMethod:@"GET" path:@"/people/12/"];
+    XCTAssert(route.action == TGRESTRouteActionShow && [route.primaryKey isEqualToString:@"12"], @"GET on a member must route to show with its primary key %@", route);
+    
+    route = [self.router routeForMethod:@"POST" path:@"/people/"];
+    XCTAssert(route.action == TGRESTRouteActionCreate && route.resource == self.parentResource, @"POST on a collection must route to create %@", route);
+    
+    route = [self.router routeForMethod:@"PUT" path:@"/email/abc_1"];
+    XCTAssert(route.action == TGRESTRouteActionUpdate && route.resource == self.childResource && [route.primaryKey isEqualToString:@"abc_1"], @"PUT on a member must route to update %@", route);
+    
+    route = [self.router routeForMethod:@"DELETE" path:@"/email/3"];
+    XCTAssert(route.action == TGRESTRouteActionDestroy && [route.primaryKey isEqualToString:@"3"], @"DELETE on a member must route to destroy %@", route);
+}
+
+- (void)testNestedRoutes
+{
+    TGRESTRoute *route = [self.router routeForMethod:@"GET" path:@"/people/7/email"];
+    XCTAssert(route.action == TGRESTRouteActionIndex && route.resource == self.childResource && route.parentResource == self.parentResource && [route.parentPrimaryKey isEqualToString:@"7"] && !route.primaryKey, @"A nested GET must route to the child index with the parent key %@", route);
+    
+    route = [self.router routeForMethod:@"POST" path:@"/people/7/email/"];
+    XCTAssert(route.action == TGRESTRouteActionCreate && route.parentResource == self.parentResource, @"A nested POST must route to the child create %@", route);
+}
+
+#pragma mark - Negative testing
+
+- (void)testUnmatchedRoutes
+{
+    NSArray *paths = @[@"/", @"", @"people", @"/people//", @"/people/1.5", @"/people/7/email/1", @"/unknown", @"/people/7/unknown", @"/email/7/people"];
+    for (NSString *path in paths) {
+        XCTAssertNil([self.router routeForMethod:@"GET" path:path], @"%@ must not match a route", path);
+    }
+    
+    XCTAssertNil([self.router routeForMethod:@"PUT" path:@"/people"], @"PUT on a collection must not match a route");
+    XCTAssertNil([self.router routeForMethod:@"PATCH" path:@"/people/1"], @"Unsupported methods must not match a route");
+    XCTAssertNil([self.router routeForMethod:@"DELETE" path:@"/people/1/email"], @"DELETE on a nested collection must not match a route");
+}
+
+- (void)testRemovedResourceHasNoRoutes
+{
+    [self.router removeRoutesForResource:self.childResource];
+    
+    XCTAssertNil([self.router routeForMethod:@"GET" path:@"/email"], @"A removed resource must not be routed");
+    XCTAssertNil([self.router routeForMethod:@"GET" path:@"/people/1/email"], @"Nested routes of a removed resource must not be routed");
+    XCTAssertNotNil([self.router routeForMethod:@"GET" path:@"/people/1"], @"Other resources must still be routed");
+    
+    [self.router removeAllRoutes];
+    XCTAssertNil([self.router routeForMethod:@"GET" path:@"/people/1"], @"No resource may be routed after removing every route");
+}
+
+- (void)testRestrictedActions
+{
+    TGRESTResource *readOnly = [TGRESTResource newResourceWithName:@"reports" model:@{@"title": [NSNumber numberWithInteger:TGPropertyTypeString]} actions:TGResourceRESTActionsGET primaryKey:nil parentResources:nil];
+    [self.router addRoutesForResource:readOnly];
+    
+    XCTAssertNotNil([self.router routeForMethod:@"GET" path:@"/reports/1"], @"Allowed actions must be routed");
+    XCTAssertNil([self.router routeForMethod:@"POST" path:@"/reports"], @"Actions the resource doesn't allow must not be routed");
+    XCTAssertNil([self.router routeForMethod:@"DELETE" path:@"/reports/1"], @"Actions the resource doesn't allow must not be routed");
+}
+
+#pragma mark - Performance
+
+- (void)measureLookupsWithResourceCount:(NSUInteger)resourceCount usingRegularExpressions:(BOOL)usingRegularExpressions
+{
+    NSUInteger lookups = 20000;
+    TGRESTRouter *router = [TGRESTRouter new];
+    NSMutableArray *expressions = [NSMutableArray new];
+    NSMutableArray *paths = [NSMutableArray new];
+    
+    for (NSUInteger x = 0; x < resourceCount; x++) {
+        TGRESTResource *resource = [TGRESTResource newResourceWithName:[NSString stringWithFormat:@"resource%lu", (unsigned long)x] model:@{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+        [router addRoutesForResource:resource];
+        
+        // The index and show patterns every resource used to register, tried in order the way GCDWebServer does.
+        [expressions addObject:[NSRegularExpression regularExpressionWithPattern:[NSString stringWithFormat:@"^(/%@/?$)", resource.name] options:0 error:nil]];
+        [expressions addObject:[NSRegularExpression regularExpressionWithPattern:[NSString stringWithFormat:@"^(/%@/\\w+/?$)", resource.name] options:0 error:nil]];
+        [paths addObject:[NSString stringWithFormat:@"/%@/%lu", resource.name, (unsigned long)x]];
+    }
+    
+    [self measureBlock:^{
+        NSUInteger matches = 0;
+        for (NSUInteger x = 0; x < lookups; x++) {
+            NSString *path = paths[x % paths.count];
+            if (!usingRegularExpressions) {
+                if ([router routeForMethod:@"GET" path:path]) {
+                    matches++;
+                }
+                continue;
+            }
+            for (NSRegularExpression *expression in expressions) {
+                if ([expression firstMatchInString:path options:0 range:NSMakeRange(0, path.length)]) {
+                    matches++;
+                    break;
+                }
+            }
+        }
+        XCTAssert(matches == lookups, @"Every path must match");
+    }];
+}
+
+- (void)testRoutingPerformanceWith10Resources
+{
+    [self measureLookupsWithResourceCount:10 usingRegularExpressions:NO];
+}
+
+- (void)testRoutingPerformanceWith100Resources
+{
+    [self measureLookupsWithResourceCount:100 usingRegularExpressions:NO];
+}
+
+- (void)testRoutingPerformanceWith1000Resources
+{
+    [self measureLookupsWithResourceCount:1000 usingRegularExpressions:NO];
+}
+
+- (void)testRegularExpressionRoutingPerformanceWith10Resources
+{
+    [self measureLookupsWithResourceCount:10 usingRegularExpressions:YES];
+}
+
+- (void)testRegularExpressionRoutingPerformanceWith100Resources
+{
+    [self measureLookupsWithResourceCount:100 usingRegularExpressions:YES];
+}
+
+- (void)testRegularExpressionRoutingPerformanceWith1000Resources
+{
+    [self measureLookupsWithResourceCount:1000 usingRegularExpressions:YES];
+}
+
+@end
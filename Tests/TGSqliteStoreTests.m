@@ -9,6 +9,9 @@
 #import <XCTest/XCTest.h>
 #import "TGRESTSqliteStore.h"
 #import "TGTestFactory.h"
+#import "TGRESTQuery.h"
+#import <FMDB/FMDatabase.h>
+#import <FMDB/FMDatabaseQueue.h>
 
 static dispatch_group_t sqlite_store_test_group() {
     static dispatch_group_t sqlite_store_test_group;
@@ -171,6 +174,429 @@ static dispatch_queue_t sqlite_store_test_queue() {
     XCTAssert([fetchChildren isEqualToArray:childArray], @"The returned array must be identical to the array of children that were created.");
 }
 
+- (void)testCreateObjectsInBatch
+{
+    NSArray *newObjects = [TGTestFactory buildTestDataForResource:self.testNormalResource count:100];
+    
+    NSError *error;
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:newObjects error:&error];
+    
+    XCTAssertNil(error, @"There must not be an error creating a batch of objects %@", error);
+    XCTAssert(createdObjects.count == newObjects.count, @"Every object in the batch must be returned");
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == newObjects.count, @"Every object in the batch must be in the datastore");
+    
+    for (NSUInteger x = 0; x < createdObjects.count; x++) {
+        NSDictionary *createdObject = createdObjects[x];
+        XCTAssert([createdObject[@"name"] isEqual:newObjects[x][@"name"]], @"Created objects must be returned in the same order as their properties");
+        NSDictionary *fetchedObject = [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:[createdObject[self.testNormalResource.primaryKey] description] error:nil];
+        XCTAssert([fetchedObject[@"name"] isEqual:createdObject[@"name"]], @"Each created object must be retrievable by its primary key");
+    }
+}
+
+- (void)testPrimaryKeysAreBoundAsParameters
+{
+    NSDictionary *createdObject = [self.store createNewObjectForResource:self.testNormalResource withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:nil];
+    XCTAssert(createdObject, @"There must be an object returned");
+    
+    NSError *fetchError;
+    NSDictionary *injectedObject = [self.store getDataForObjectOfResource:self.testNormalResource withPrimaryKey:@"0 OR 1 = 1" error:&fetchError];
+    
+    XCTAssertNil(injectedObject, @"A primary key must never be interpreted as SQL");
+    XCTAssert(fetchError, @"There must be an error for a primary key that doesn't exist");
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == 1, @"The object must still exist");
+}
+
+- (void)measureRequestsWithStatementCache:(BOOL)cachesStatements
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:200] error:nil];
+    NSUInteger requestCount = 2000;
+    TGRESTSqliteStore *store = self.store;
+    TGRESTResource *resource = self.testNormalResource;
+    [self.store setValue:@(cachesStatements) forKey:@"cachesStatements"];
+    
+    [self measureBlock:^{
+        for (NSUInteger x = 0; x < requestCount; x++) {
+            NSDictionary *object = createdObjects[x % createdObjects.count];
+            NSString *primaryKey = [object[resource.primaryKey] description];
+            [store getDataForObjectOfResource:resource withPrimaryKey:primaryKey error:nil];
+            if (x % 10 == 0) {
+                [store modifyObjectOfResource:resource withPrimaryKey:primaryKey withProperties:@{@"name": object[@"name"]} error:nil];
+            }
+        }
+    }];
+    
+    [self.store setValue:@YES forKey:@"cachesStatements"];
+    XCTAssert([self.store countOfObjectsForResource:self.testNormalResource] == createdObjects.count, @"The benchmark must not change the number of objects");
+}
+
+- (void)testRequestsWithoutStatementCachePerformance
+{
+    [self measureRequestsWithStatementCache:NO];
+}
+
+- (void)testRequestsWithStatementCachePerformance
+{
+    [self measureRequestsWithStatementCache:YES];
+}
+
+- (void)testWALModeReadsWhileWriting
+{
+    TGRESTSqliteStore *walStore = [TGRESTSqliteStore new];
+    [walStore configureWithOptions:@{TGRESTSqliteStoreWALModeOptionKey: @YES,
+                                     TGRESTSqliteStoreReaderPoolSizeOptionKey: @4,
+                                     TGRESTSqliteStoreMmapSizeOptionKey: @(64 * 1024 * 1024),
+                                     TGRESTSqliteStoreCacheSizeOptionKey: @(-8000)}];
+    [walStore addResource:self.testNormalResource];
+    
+    XCTAssertNotNil([walStore valueForKey:@"readPool"], @"WAL mode must create a reader pool");
+    
+    NSArray *seededObjects = [walStore createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:200] error:nil];
+    NSArray *newObjects = [TGTestFactory buildTestDataForResource:self.testNormalResource count:200];
+    TGRESTResource *resource = self.testNormalResource;
+    NSUInteger readCount = 2000;
+    
+    dispatch_group_async(sqlite_store_test_group(), sqlite_store_test_queue(), ^{
+        for (NSDictionary *properties in newObjects) {
+            NSError *error;
+            [walStore createNewObjectForResource:resource withProperties:properties error:&error];
+            XCTAssertNil(error, @"There must not be an error writing while readers are active %@", error);
+        }
+    });
+    for (NSUInteger x = 0; x < readCount; x++) {
+        dispatch_group_async(sqlite_store_test_group(), sqlite_store_test_queue(), ^{
+            NSDictionary *object = seededObjects[x % seededObjects.count];
+            NSError *error;
+            NSDictionary *fetchedObject = [walStore getDataForObjectOfResource:resource withPrimaryKey:[object[resource.primaryKey] description] error:&error];
+            XCTAssertNil(error, @"There must not be an error reading while a writer is active %@", error);
+            XCTAssert([fetchedObject[@"name"] isEqual:object[@"name"]], @"Readers must see committed data");
+        });
+    }
+    dispatch_group_wait(sqlite_store_test_group(), DISPATCH_TIME_FOREVER);
+    
+    XCTAssert([walStore countOfObjectsForResource:resource] == seededObjects.count + newObjects.count, @"Every write must be visible to the readers once it has committed");
+    
+    [walStore configureWithOptions:@{}];
+    XCTAssertNil([walStore valueForKey:@"readPool"], @"Turning WAL mode off must release the reader pool");
+}
+
+- (void)testWALModeReadsBeyondPoolSize
+{
+    TGRESTSqliteStore *walStore = [TGRESTSqliteStore new];
+    [walStore configureWithOptions:@{TGRESTSqliteStoreWALModeOptionKey: @YES,
+                                     TGRESTSqliteStoreReaderPoolSizeOptionKey: @2}];
+    [walStore addResource:self.testNormalResource];
+    
+    NSArray *seededObjects = [walStore createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:50] error:nil];
+    TGRESTResource *resource = self.testNormalResource;
+    __block NSUInteger missingCount = 0;
+    
+    // Far more readers than connections, every one of them has to wait for a connection rather than come back empty.
+    dispatch_apply(500, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        NSDictionary *object = seededObjects[iteration % seededObjects.count];
+        NSDictionary *fetchedObject = [walStore getDataForObjectOfResource:resource withPrimaryKey:[object[resource.primaryKey] description] error:nil];
+        NSArray *allObjects = [walStore getAllObjectsForResource:resource error:nil];
+        if (![fetchedObject[@"name"] isEqual:object[@"name"]] || allObjects.count != seededObjects.count) {
+            @synchronized(walStore) {
+                missingCount++;
+            }
+        }
+    });
+    
+    XCTAssert(missingCount == 0, @"Every read must return its objects when the reader pool is exhausted but %lu did not", (unsigned long)missingCount);
+    
+    [walStore dropResource:resource];
+}
+
+- (void)measureReadsWhileWritingOnStore:(TGRESTSqliteStore *)store
+{
+    TGRESTResource *resource = self.testNormalResource;
+    [store addResource:resource];
+    NSArray *seededObjects = [store createNewObjectsForResource:resource withPropertiesArray:[TGTestFactory buildTestDataForResource:resource count:200] error:nil];
+    NSArray *newObjects = [TGTestFactory buildTestDataForResource:resource count:50];
+    
+    [self measureBlock:^{
+        dispatch_group_async(sqlite_store_test_group(), sqlite_store_test_queue(), ^{
+            for (NSDictionary *properties in newObjects) {
+                [store createNewObjectForResource:resource withProperties:properties error:nil];
+            }
+        });
+        dispatch_apply(2000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+            NSDictionary *object = seededObjects[iteration % seededObjects.count];
+            [store getDataForObjectOfResource:resource withPrimaryKey:[object[resource.primaryKey] description] error:nil];
+        });
+        dispatch_group_wait(sqlite_store_test_group(), DISPATCH_TIME_FOREVER);
+    }];
+    
+    [store dropResource:resource];
+}
+
+- (void)testReadsWhileWritingOnSingleQueuePerformance
+{
+    TGRESTSqliteStore *queueStore = [TGRESTSqliteStore new];
+    [queueStore configureWithOptions:@{}];
+    
+    [self measureReadsWhileWritingOnStore:queueStore];
+}
+
+- (void)testReadsWhileWritingInWALModePerformance
+{
+    TGRESTSqliteStore *walStore = [TGRESTSqliteStore new];
+    [walStore configureWithOptions:@{TGRESTSqliteStoreWALModeOptionKey: @YES}];
+    
+    [self measureReadsWhileWritingOnStore:walStore];
+}
+
+- (NSString *)queryPlanForSQL:(NSString *)sql
+{
+    NSMutableString *plan = [NSMutableString new];
+    FMDatabaseQueue *dbQueue = [self.store valueForKey:@"dbQueue"];
+    [dbQueue inDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:[NSString stringWithFormat:@"EXPLAIN QUERY PLAN %@", sql], @1];
+        while ([results next]) {
+            [plan appendFormat:@"%@\n", [results stringForColumn:@"detail"]];
+        }
+        [results close];
+    }];
+    
+    return plan;
+}
+
+- (void)testForeignKeyIndexIsUsedForNestedQueries
+{
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSString *indexName = [NSString stringWithFormat:@"%@_%@_fk_index", self.testChildResource.name, foreignKey];
+    
+    NSString *nestedPlan = [self queryPlanForSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ?", self.testChildResource.name, foreignKey]];
+    XCTAssert([nestedPlan rangeOfString:indexName].location != NSNotFound, @"The nested index query must use the foreign key index %@", nestedPlan);
+    
+    NSString *nullifyPlan = [self queryPlanForSQL:[NSString stringWithFormat:@"UPDATE %@ SET \"%@\" = NULL WHERE \"%@\" = ?", self.testChildResource.name, foreignKey, foreignKey]];
+    XCTAssert([nullifyPlan rangeOfString:indexName].location != NSNotFound, @"Nulling children on a parent delete must use the foreign key index %@", nullifyPlan);
+}
+
+- (void)testForeignKeyIndexDoesNotForceRebuild
+{
+    NSDictionary *childObject = [self.store createNewObjectForResource:self.testChildResource withProperties:[TGTestFactory buildTestDataForResource:self.testChildResource] error:nil];
+    XCTAssert(childObject, @"There must be an object returned");
+    
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSString *indexName = [NSString stringWithFormat:@"%@_%@_fk_index", self.testChildResource.name, foreignKey];
+    FMDatabaseQueue *dbQueue = [self.store valueForKey:@"dbQueue"];
+    [dbQueue inDatabase:^(FMDatabase *db) {
+        [db executeUpdate:[NSString stringWithFormat:@"DROP INDEX \"%@\"", indexName]];
+    }];
+    
+    [self.store addResource:self.testChildResource];
+    
+    XCTAssert([self.store countOfObjectsForResource:self.testChildResource] == 1, @"Re-adding an unchanged resource must not rebuild the table");
+    NSString *nestedPlan = [self queryPlanForSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"%@\" = ?", self.testChildResource.name, foreignKey]];
+    XCTAssert([nestedPlan rangeOfString:indexName].location != NSNotFound, @"A missing foreign key index must be recreated %@", nestedPlan);
+}
+
+- (void)testIndexedPropertiesAreCreatedAndDropped
+{
+    NSDictionary *model = @{
+                            @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
+                            @"age": [NSNumber numberWithInteger:TGPropertyTypeInteger]
+                            };
+    TGRESTResource *resource = [TGRESTResource newResourceWithName:@"indexedPerson" model:model actions:TGResourceRESTActionsGET primaryKey:nil parentResources:nil foreignKeys:nil indexedProperties:@[@"age"]];
+    [self.store addResource:resource];
+    [self.store createNewObjectForResource:resource withProperties:@{@"name": @"Jane", @"age": @30} error:nil];
+    
+    NSString *indexName = [NSString stringWithFormat:@"%@_age_index", resource.name];
+    NSString *indexedPlan = [self queryPlanForSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"age\" > ?", resource.name]];
+    XCTAssert([indexedPlan rangeOfString:indexName].location != NSNotFound, @"Range queries on an indexed property must use its index %@", indexedPlan);
+    
+    TGRESTResource *unindexedResource = [TGRESTResource newResourceWithName:@"indexedPerson" model:model actions:TGResourceRESTActionsGET primaryKey:nil parentResources:nil foreignKeys:nil indexedProperties:nil];
+    [self.store addResource:unindexedResource];
+    
+    XCTAssert([self.store countOfObjectsForResource:unindexedResource] == 1, @"Removing an index must not rebuild the table");
+    NSString *unindexedPlan = [self queryPlanForSQL:[NSString stringWithFormat:@"SELECT * FROM %@ WHERE \"age\" > ?", resource.name]];
+    XCTAssert([unindexedPlan rangeOfString:indexName].location == NSNotFound, @"An index that is no longer declared must be dropped %@", unindexedPlan);
+    
+    [self.store dropResource:unindexedResource];
+}
+
+- (void)testDeleteParentNullsChildForeignKeys
+{
+    NSDictionary *parentObject = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSString *parentKey = [parentObject[self.testParentResource.primaryKey] description];
+    
+    for (NSDictionary *childPropertiesDict in [TGTestFactory buildTestDataForResource:self.testChildResource count:3]) {
+        NSMutableDictionary *childProperties = [NSMutableDictionary dictionaryWithDictionary:childPropertiesDict];
+        [childProperties setObject:parentObject[self.testParentResource.primaryKey] forKey:foreignKey];
+        [self.store createNewObjectForResource:self.testChildResource withProperties:childProperties error:nil];
+    }
+    
+    NSError *deleteError;
+    XCTAssert([self.store deleteObjectOfResource:self.testParentResource withPrimaryKey:parentKey error:&deleteError], @"The parent delete must succeed %@", deleteError);
+    
+    NSArray *children = [self.store getAllObjectsForResource:self.testChildResource error:nil];
+    XCTAssert(children.count == 3, @"Deleting the parent must not delete the children");
+    for (NSDictionary *child in children) {
+        XCTAssert(child[foreignKey] == [NSNull null], @"Children of a deleted parent must have their foreign key nulled");
+    }
+}
+
+- (void)testGetObjectsByPage
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:25] error:nil];
+    NSString *primaryKey = self.testNormalResource.primaryKey;
+    
+    NSMutableArray *pagedObjects = [NSMutableArray new];
+    NSString *afterKey;
+    NSArray *page;
+    do {
+        NSError *error;
+        page = [self.store getObjectsForResource:self.testNormalResource afterPrimaryKey:afterKey limit:10 error:&error];
+        XCTAssertNil(error, @"There must not be an error fetching a page %@", error);
+        XCTAssert(page.count <= 10, @"A page must never be larger than the limit");
+        [pagedObjects addObjectsFromArray:page];
+        afterKey = [[page.lastObject objectForKey:primaryKey] description];
+    } while (page.count == 10);
+    
+    XCTAssert(pagedObjects.count == createdObjects.count, @"Walking the pages must return every object exactly once");
+    XCTAssert([[pagedObjects valueForKey:primaryKey] isEqualToArray:[createdObjects valueForKey:primaryKey]], @"Pages must be ordered by primary key");
+    
+    NSArray *pastEnd = [self.store getObjectsForResource:self.testNormalResource afterPrimaryKey:[[createdObjects.lastObject objectForKey:primaryKey] description] limit:10 error:nil];
+    XCTAssert(pastEnd.count == 0, @"A page after the last object must be empty");
+}
+
+- (void)testGetChildObjectsByPage
+{
+    NSDictionary *parentObject = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSString *foreignKey = self.testChildResource.foreignKeys[self.testParentResource.name];
+    NSString *parentKey = [parentObject[self.testParentResource.primaryKey] description];
+    NSString *primaryKey = self.testChildResource.primaryKey;
+    
+    NSMutableArray *childProperties = [NSMutableArray new];
+    for (NSDictionary *childPropertiesDict in [TGTestFactory buildTestDataForResource:self.testChildResource count:7]) {
+        NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithDictionary:childPropertiesDict];
+        [properties setObject:parentObject[self.testParentResource.primaryKey] forKey:foreignKey];
+        [childProperties addObject:properties];
+    }
+    NSArray *children = [self.store createNewObjectsForResource:self.testChildResource withPropertiesArray:childProperties error:nil];
+    
+    NSArray *firstPage = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:parentKey afterPrimaryKey:nil limit:5 error:nil];
+    NSArray *secondPage = [self.store getDataForObjectsOfResource:self.testChildResource withParent:self.testParentResource parentPrimaryKey:parentKey afterPrimaryKey:[[firstPage.lastObject objectForKey:primaryKey] description] limit:5 error:nil];
+    
+    XCTAssert(firstPage.count == 5, @"The first page must be full");
+    XCTAssert(secondPage.count == 2, @"The second page must hold the remaining children");
+    XCTAssert([[[firstPage arrayByAddingObjectsFromArray:secondPage] valueForKey:primaryKey] isEqualToArray:[children valueForKey:primaryKey]], @"Child pages must be ordered by primary key");
+}
+
+- (void)testObjectEnumeratorReadsEveryObjectWhileWriting
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:150] error:nil];
+    NSString *primaryKey = self.testNormalResource.primaryKey;
+    
+    NSError *error;
+    NSEnumerator *enumerator = [self.store objectEnumeratorForResource:self.testNormalResource error:&error];
+    XCTAssertNil(error, @"There must not be an error opening an enumerator %@", error);
+    
+    NSMutableArray *enumeratedKeys = [NSMutableArray new];
+    for (NSDictionary *object in enumerator) {
+        if (enumeratedKeys.count == 10) {
+            NSError *writeError;
+            [self.store createNewObjectForResource:self.testNormalResource withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:&writeError];
+            XCTAssertNil(writeError, @"An open enumerator must not lock out the writer %@", writeError);
+        }
+        [enumeratedKeys addObject:object[primaryKey]];
+    }
+    
+    XCTAssert(enumeratedKeys.count >= createdObjects.count, @"The enumerator must return every object");
+    XCTAssert([[enumeratedKeys subarrayWithRange:NSMakeRange(0, createdObjects.count)] isEqualToArray:[createdObjects valueForKey:primaryKey]], @"The enumerator must return objects ordered by primary key");
+}
+
+- (void)testObjectEnumeratorReadsSnapshotInWALMode
+{
+    TGRESTSqliteStore *walStore = [TGRESTSqliteStore new];
+    [walStore configureWithOptions:@{TGRESTSqliteStoreWALModeOptionKey: @YES}];
+    [walStore addResource:self.testNormalResource];
+    NSArray *createdObjects = [walStore createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:150] error:nil];
+    
+    NSError *error;
+    NSEnumerator *enumerator = [walStore objectEnumeratorForResource:self.testNormalResource error:&error];
+    XCTAssertNil(error, @"There must not be an error opening an enumerator %@", error);
+    
+    NSMutableArray *enumeratedKeys = [NSMutableArray new];
+    for (NSDictionary *object in enumerator) {
+        if (enumeratedKeys.count == 1) {
+            NSError *writeError;
+            [walStore createNewObjectForResource:self.testNormalResource withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:&writeError];
+            XCTAssertNil(writeError, @"An open cursor must not lock out the writer in WAL mode %@", writeError);
+        }
+        [enumeratedKeys addObject:object[self.testNormalResource.primaryKey]];
+    }
+    
+    XCTAssert([enumeratedKeys isEqualToArray:[createdObjects valueForKey:self.testNormalResource.primaryKey]], @"The cursor must read the objects that existed when it was opened");
+    XCTAssert([walStore countOfObjectsForResource:self.testNormalResource] == createdObjects.count + 1, @"The write made during the enumeration must have committed");
+    
+    [walStore configureWithOptions:@{}];
+}
+
+- (void)testGetObjectsMatchingQuery
+{
+    NSArray *createdObjects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:30] error:nil];
+    NSString *primaryKey = self.testNormalResource.primaryKey;
+    
+    NSError *error;
+    TGRESTQuery *rangeQuery = [TGRESTQuery queryWithParameters:@{@"id[gt]": @"10", @"id[lte]": @"20", @"sort": @"-id"} resource:self.testNormalResource error:&error];
+    XCTAssertNil(error, @"The query must be valid %@", error);
+    NSArray *rangeResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:rangeQuery afterPrimaryKey:nil limit:5 error:&error];
+    XCTAssertNil(error, @"There must not be an error running the query %@", error);
+    XCTAssert([[rangeResults valueForKey:primaryKey] isEqualToArray:@[@20, @19, @18, @17, @16]], @"The query must filter by range, sort descending and apply the limit");
+    
+    NSDictionary *namedObject = createdObjects[3];
+    TGRESTQuery *equalityQuery = [TGRESTQuery queryWithParameters:@{@"name": namedObject[@"name"]} resource:self.testNormalResource error:nil];
+    NSArray *equalityResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:equalityQuery afterPrimaryKey:nil limit:NSUIntegerMax error:&error];
+    XCTAssert([[equalityResults valueForKey:primaryKey] containsObject:namedObject[primaryKey]], @"The query must find the object by name");
+    for (NSDictionary *object in equalityResults) {
+        XCTAssert([object[@"name"] isEqualToString:namedObject[@"name"]], @"Every result must match the filter");
+    }
+    
+    NSArray *pagedResults = [self.store getObjectsForResource:self.testNormalResource matchingQuery:[TGRESTQuery queryWithParameters:@{@"id[lte]": @"20"} resource:self.testNormalResource error:nil] afterPrimaryKey:@"15" limit:NSUIntegerMax error:&error];
+    XCTAssert([[pagedResults valueForKey:primaryKey] isEqualToArray:@[@16, @17, @18, @19, @20]], @"A query ordered by primary key must start after the key");
+}
+
+- (void)testGenerationsAndVersionsFollowWrites
+{
+    NSUInteger initialGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(initialGeneration != NSNotFound, @"The store must track a generation for every resource");
+    
+    NSArray *objects = [self.store createNewObjectsForResource:self.testNormalResource withPropertiesArray:[TGTestFactory buildTestDataForResource:self.testNormalResource count:2] error:nil];
+    NSUInteger createdGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(createdGeneration > initialGeneration, @"Creating objects must move the generation forward");
+    
+    NSString *firstKey = [objects[0][self.testNormalResource.primaryKey] description];
+    NSString *secondKey = [objects[1][self.testNormalResource.primaryKey] description];
+    NSUInteger firstVersion = [self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:firstKey];
+    NSUInteger secondVersion = [self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey];
+    XCTAssert(firstVersion != NSNotFound && secondVersion != NSNotFound, @"Every created object must have a version");
+    
+    [self.store modifyObjectOfResource:self.testNormalResource withPrimaryKey:firstKey withProperties:[TGTestFactory buildTestDataForResource:self.testNormalResource] error:nil];
+    NSUInteger modifiedGeneration = [self.store generationForResource:self.testNormalResource];
+    XCTAssert(modifiedGeneration > createdGeneration, @"Modifying an object must move the generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:firstKey] > firstVersion, @"Modifying an object must move its version forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey] == secondVersion, @"Modifying an object must not change the version of other objects");
+    
+    [self.store deleteObjectOfResource:self.testNormalResource withPrimaryKey:secondKey error:nil];
+    XCTAssert([self.store generationForResource:self.testNormalResource] > modifiedGeneration, @"Deleting an object must move the generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testNormalResource withPrimaryKey:secondKey] != secondVersion, @"Deleting an object must change its version");
+    
+    NSDictionary *parent = [self.store createNewObjectForResource:self.testParentResource withProperties:[TGTestFactory buildTestDataForResource:self.testParentResource] error:nil];
+    NSMutableDictionary *childProperties = [NSMutableDictionary dictionaryWithDictionary:[TGTestFactory buildTestDataForResource:self.testChildResource]];
+    [childProperties setObject:parent[self.testParentResource.primaryKey] forKey:self.testChildResource.foreignKeys[self.testParentResource.name]];
+    NSDictionary *child = [self.store createNewObjectForResource:self.testChildResource withProperties:childProperties error:nil];
+    NSString *childKey = [child[self.testChildResource.primaryKey] description];
+    NSUInteger childGeneration = [self.store generationForResource:self.testChildResource];
+    NSUInteger childVersion = [self.store versionOfObjectOfResource:self.testChildResource withPrimaryKey:childKey];
+    
+    [self.store deleteObjectOfResource:self.testParentResource withPrimaryKey:[parent[self.testParentResource.primaryKey] description] error:nil];
+    XCTAssert([self.store generationForResource:self.testChildResource] > childGeneration, @"Nulling foreign keys on a parent delete must move the child generation forward");
+    XCTAssert([self.store versionOfObjectOfResource:self.testChildResource withPrimaryKey:childKey] != childVersion, @"Nulling a foreign key must change the child version");
+}
+
 - (void)testModifyObject
 {
     NSDictionary *properties = [TGTestFactory buildTestDataForResource:self.testNormalResource];
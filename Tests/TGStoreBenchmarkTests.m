@@ -0,0 +1,307 @@
+//
+//  TGStoreBenchmarkTests.m
+//  Tests
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <XCTest/XCTest.h>
+#import "TGTestFactory.h"
+#import "RESTEasyCore.h"
+#import "RESTEasySqlite.h"
+
+// Comma separated row counts, for example 1000,10000,1000000,10000000.  Default is 1000,10000.
+static NSString * const TGBenchmarkRowsEnvironmentKey = @"TG_BENCHMARK_ROWS";
+// Path of a JSON file written by TG_BENCHMARK_OUTPUT, results slower than it by more than the tolerance fail.
+static NSString * const TGBenchmarkBaselineEnvironmentKey = @"TG_BENCHMARK_BASELINE";
+// Fraction of the baseline throughput that may be lost before a result fails.  Default is 0.2.
+static NSString * const TGBenchmarkToleranceEnvironmentKey = @"TG_BENCHMARK_TOLERANCE";
+// Path the results are merged into, use it to record a new baseline.
+static NSString * const TGBenchmarkOutputEnvironmentKey = @"TG_BENCHMARK_OUTPUT";
+
+static uint64_t const TGBenchmarkSeed = 20140509;
+static NSUInteger const TGBenchmarkOperationCount = 2000;
+
+@interface TGStoreBenchmarkTests : XCTestCase
+
+@property (nonatomic, strong) TGRESTResource *recordResource;
+@property (nonatomic, strong) TGRESTResource *ownerResource;
+@property (nonatomic, strong) TGRESTResource *itemResource;
+
+@end
+
+@implementation TGStoreBenchmarkTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.recordResource = [TGRESTResource newResourceWithName:@"records" model:@{
+                                                                                 @"label": [NSNumber numberWithInteger:TGPropertyTypeString],
+                                                                                 @"count": [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                                                                                 @"reading": [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint],
+                                                                                 @"payload": [NSNumber numberWithInteger:TGPropertyTypeBlob]
+                                                                                 }];
+    self.ownerResource = [TGRESTResource newResourceWithName:@"owners" model:@{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]}];
+    self.itemResource = [TGRESTResource newResourceWithName:@"items"
+                                                      model:@{@"name": [NSNumber numberWithInteger:TGPropertyTypeString]}
+                                                    actions:TGResourceRESTActionsPOST | TGResourceRESTActionsGET | TGResourceRESTActionsPUT | TGResourceRESTActionsDELETE
+                                                 primaryKey:nil
+                                            parentResources:@[self.ownerResource]];
+}
+
+#pragma mark - Benchmarks
+
+- (void)testInMemoryStoreBenchmarks
+{
+    [self benchmarkStoreClass:[TGRESTInMemoryStore class]];
+}
+
+- (void)testSqliteStoreBenchmarks
+{
+    [self benchmarkStoreClass:[TGRESTSqliteStore class]];
+}
+
+- (void)testColumnarStoreBenchmarks
+{
+    [self benchmarkStoreClass:[TGRESTColumnarStore class]];
+}
+
+- (void)testSeededDataIsDeterministic
+{
+    NSArray *first = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:10000 seed:TGBenchmarkSeed];
+    NSArray *second = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:10000 seed:TGBenchmarkSeed];
+    NSArray *other = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:10000 seed:TGBenchmarkSeed + 1];
+    
+    XCTAssert(first.count == 10000, @"Every row must be generated");
+    XCTAssertEqualObjects(first, second, @"The same seed must generate the same data");
+    XCTAssertNotEqualObjects(first, other, @"A different seed must generate different data");
+    XCTAssert([first[0] count] == 4 && !first[0][self.recordResource.primaryKey], @"Rows must have every property except the primary key");
+}
+
+#pragma mark - Private
+
+- (NSArray *)rowCounts
+{
+    NSString *rows = [[NSProcessInfo processInfo] environment][TGBenchmarkRowsEnvironmentKey];
+    if (!rows) {
+        return @[@1000, @10000];
+    }
+    
+    NSMutableArray *rowCounts = [NSMutableArray new];
+    for (NSString *component in [rows componentsSeparatedByString:@","]) {
+        NSInteger rowCount = [component integerValue];
+        if (rowCount > 0) {
+            [rowCounts addObject:@(rowCount)];
+        }
+    }
+    
+    return rowCounts;
+}
+
+- (void)benchmarkStoreClass:(Class)storeClass
+{
+    NSString *storeName = NSStringFromClass(storeClass);
+    NSMutableDictionary *storeResults = [NSMutableDictionary new];
+    
+    for (NSNumber *rowCount in [self rowCounts]) {
+        @autoreleasepool {
+            NSDictionary *results = [self benchmarkStore:[storeClass new] rowCount:[rowCount unsignedIntegerValue]];
+            storeResults[[rowCount stringValue]] = results;
+            
+            for (NSString *operation in [results.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+                NSLog(@"%@ with %@ rows: %@ %.0f ops/sec, %llu resident bytes grown", storeName, rowCount, operation, [results[operation][@"opsPerSecond"] doubleValue], [results[operation][@"residentBytes"] unsignedLongLongValue]);
+            }
+        }
+    }
+    
+    [self compareResults:storeResults withBaseline:[self baseline][storeName] storeName:storeName];
+    [self writeResults:storeResults storeName:storeName];
+}
+
+- (NSDictionary *)benchmarkStore:(TGRESTStore *)store rowCount:(NSUInteger)rowCount
+{
+    [store addResource:self.recordResource];
+    [store addResource:self.ownerResource];
+    [store addResource:self.itemResource];
+    
+    NSUInteger ownerCount = MAX(rowCount / 10, 1);
+    NSUInteger operationCount = MIN(TGBenchmarkOperationCount, rowCount);
+    NSString *foreignKey = self.itemResource.foreignKeys[self.ownerResource.name];
+    NSMutableDictionary *results = [NSMutableDictionary new];
+    
+    // Owners are created first so the items can point at their real keys.
+    NSArray *ownerKeys = [self createObjects:[TGTestFactory buildSeededTestDataForResource:self.ownerResource count:ownerCount seed:TGBenchmarkSeed] forResource:self.ownerResource inStore:store];
+    NSArray *records = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:rowCount seed:TGBenchmarkSeed];
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:rowCount];
+    [[TGTestFactory buildSeededTestDataForResource:self.itemResource count:rowCount seed:TGBenchmarkSeed] enumerateObjectsUsingBlock:^(NSDictionary *item, NSUInteger index, BOOL *stop) {
+        NSMutableDictionary *child = [item mutableCopy];
+        child[foreignKey] = @([ownerKeys[index % ownerCount] integerValue]);
+        [items addObject:child];
+    }];
+    
+    __block NSArray *recordKeys;
+    [self recordOperation:@"load" count:rowCount * 2 inResults:results block:^{
+        recordKeys = [self createObjects:records forResource:self.recordResource inStore:store];
+        [self createObjects:items forResource:self.itemResource inStore:store];
+    }];
+    records = nil;
+    items = nil;
+    
+    XCTAssert(recordKeys.count == rowCount && [store countOfObjectsForResource:self.itemResource] == rowCount, @"The whole dataset must be loaded");
+    
+    // Keys are picked with a seeded generator so every run touches the same objects.
+    uint64_t state = TGBenchmarkSeed;
+    __block NSUInteger failures = 0;
+    
+    NSMutableArray *getKeys = [NSMutableArray arrayWithCapacity:operationCount];
+    for (NSUInteger x = 0; x < operationCount; x++) {
+        [getKeys addObject:recordKeys[TGSeededRandom(&state) % rowCount]];
+    }
+    [self recordOperation:@"get" count:operationCount inResults:results block:^{
+        for (NSString *key in getKeys) {
+            if (![store getDataForObjectOfResource:self.recordResource withPrimaryKey:key error:nil]) {
+                failures++;
+            }
+        }
+    }];
+    
+    NSUInteger scanCount = MIN(MAX(100000 / rowCount, 1), 100);
+    [self recordOperation:@"fullScan" count:scanCount inResults:results block:^{
+        for (NSUInteger x = 0; x < scanCount; x++) {
+            if ([store getAllObjectsForResource:self.recordResource error:nil].count != rowCount) {
+                failures++;
+            }
+        }
+    }];
+    
+    NSMutableArray *parentKeys = [NSMutableArray arrayWithCapacity:operationCount];
+    for (NSUInteger x = 0; x < operationCount; x++) {
+        [parentKeys addObject:ownerKeys[TGSeededRandom(&state) % ownerCount]];
+    }
+    [self recordOperation:@"parentLookup" count:operationCount inResults:results block:^{
+        for (NSString *key in parentKeys) {
+            if (![store getDataForObjectsOfResource:self.itemResource withParent:self.ownerResource parentPrimaryKey:key error:nil]) {
+                failures++;
+            }
+        }
+    }];
+    
+    NSArray *newRecords = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:operationCount seed:TGBenchmarkSeed + 1];
+    [self recordOperation:@"create" count:operationCount inResults:results block:^{
+        for (NSDictionary *properties in newRecords) {
+            if (![store createNewObjectForResource:self.recordResource withProperties:properties error:nil]) {
+                failures++;
+            }
+        }
+    }];
+    
+    NSArray *changes = [TGTestFactory buildSeededTestDataForResource:self.recordResource count:operationCount seed:TGBenchmarkSeed + 2];
+    NSMutableArray *modifyKeys = [NSMutableArray arrayWithCapacity:operationCount];
+    for (NSUInteger x = 0; x < operationCount; x++) {
+        [modifyKeys addObject:recordKeys[TGSeededRandom(&state) % rowCount]];
+    }
+    [self recordOperation:@"modify" count:operationCount inResults:results block:^{
+        for (NSUInteger x = 0; x < operationCount; x++) {
+            if (![store modifyObjectOfResource:self.recordResource withPrimaryKey:modifyKeys[x] withProperties:changes[x] error:nil]) {
+                failures++;
+            }
+        }
+    }];
+    
+    // Deleted keys are spread evenly over the dataset so none is deleted twice.
+    NSMutableArray *deleteKeys = [NSMutableArray arrayWithCapacity:operationCount];
+    for (NSUInteger x = 0; x < operationCount; x++) {
+        [deleteKeys addObject:recordKeys[x * (rowCount / operationCount)]];
+    }
+    [self recordOperation:@"delete" count:operationCount inResults:results block:^{
+        for (NSString *key in deleteKeys) {
+            if (![store deleteObjectOfResource:self.recordResource withPrimaryKey:key error:nil]) {
+                failures++;
+            }
+        }
+    }];
+    
+    XCTAssert(failures == 0, @"Every operation must succeed but %lu failed", (unsigned long)failures);
+    
+    [store dropResource:self.itemResource];
+    [store dropResource:self.ownerResource];
+    [store dropResource:self.recordResource];
+    
+    return results;
+}
+
+- (NSArray *)createObjects:(NSArray *)objects forResource:(TGRESTResource *)resource inStore:(TGRESTStore *)store
+{
+    NSError *error;
+    NSArray *created = [store createNewObjectsForResource:resource withPropertiesArray:objects error:&error];
+    XCTAssertNil(error, @"There must not be an error loading the dataset %@", error);
+    
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:created.count];
+    for (NSDictionary *object in created) {
+        [keys addObject:[object[resource.primaryKey] description]];
+    }
+    
+    return keys;
+}
+
+- (void)recordOperation:(NSString *)operation count:(NSUInteger)count inResults:(NSMutableDictionary *)results block:(void (^)(void))block
+{
+    // Every operation records how much resident memory grew while it ran, since the absolute size mostly reflects what earlier operations left behind.
+    uint64_t residentBefore = TGResidentMemorySize();
+    CGFloat time = TGTimedTestBlock(block);
+    uint64_t residentAfter = TGResidentMemorySize();
+    results[operation] = @{@"opsPerSecond": @(count / MAX(time, 1e-9)), @"residentBytes": @(residentAfter > residentBefore ? residentAfter - residentBefore : 0)};
+}
+
+- (NSDictionary *)baseline
+{
+    NSString *path = [[NSProcessInfo processInfo] environment][TGBenchmarkBaselineEnvironmentKey];
+    if (!path) {
+        return nil;
+    }
+    
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    XCTAssertNotNil(data, @"The baseline at %@ must be readable", path);
+    
+    return data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+}
+
+- (void)compareResults:(NSDictionary *)results withBaseline:(NSDictionary *)baseline storeName:(NSString *)storeName
+{
+    NSString *toleranceString = [[NSProcessInfo processInfo] environment][TGBenchmarkToleranceEnvironmentKey];
+    double tolerance = toleranceString ? [toleranceString doubleValue] : 0.2;
+    
+    for (NSString *rowCount in baseline) {
+        for (NSString *operation in baseline[rowCount]) {
+            double expected = [baseline[rowCount][operation][@"opsPerSecond"] doubleValue];
+            if (!results[rowCount][operation] || expected == 0) {
+                continue;
+            }
+            
+            double measured = [results[rowCount][operation][@"opsPerSecond"] doubleValue];
+            XCTAssert(measured >= expected * (1 - tolerance), @"%@ %@ with %@ rows regressed to %.0f ops/sec from a baseline of %.0f", storeName, operation, rowCount, measured, expected);
+        }
+    }
+}
+
+- (void)writeResults:(NSDictionary *)results storeName:(NSString *)storeName
+{
+    NSString *path = [[NSProcessInfo processInfo] environment][TGBenchmarkOutputEnvironmentKey];
+    if (!path) {
+        return;
+    }
+    
+    // Every store's test merges its results in so one file ends up with the whole suite.
+    NSMutableDictionary *output = [NSMutableDictionary new];
+    NSData *existing = [NSData dataWithContentsOfFile:path];
+    if (existing) {
+        [output addEntriesFromDictionary:[NSJSONSerialization JSONObjectWithData:existing options:0 error:nil]];
+    }
+    output[storeName] = results;
+    
+    NSData *data = [NSJSONSerialization dataWithJSONObject:output options:NSJSONWritingPrettyPrinted error:nil];
+    XCTAssert([data writeToFile:path atomically:YES], @"The results must be written to %@", path);
+}
+
+@end
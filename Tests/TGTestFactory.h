@@ -11,6 +11,8 @@
 @class TGRESTResource;
 
 extern CGFloat TGTimedTestBlock (void (^block)(void));
+extern uint64_t TGSeededRandom (uint64_t *state);
+extern uint64_t TGResidentMemorySize (void);
 
 @interface TGTestFactory : NSObject
 
@@ -23,6 +25,7 @@ extern CGFloat TGTimedTestBlock (void (^block)(void));
 
 + (NSDictionary *)buildTestDataForResource:(TGRESTResource *)resource;
 + (NSArray *)buildTestDataForResource:(TGRESTResource *)resource count:(NSUInteger)count;
++ (NSArray *)buildSeededTestDataForResource:(TGRESTResource *)resource count:(NSUInteger)count seed:(uint64_t)seed;
 + (void)createTestDataForResource:(TGRESTResource *)resource count:(NSUInteger)count;
 
 @end
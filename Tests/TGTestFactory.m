@@ -9,20 +9,36 @@
 #import "TGTestFactory.h"
 #import "TGRESTResource.h"
 #import <Gizou/Gizou.h>
-#import <mach/mach_time.h>
+#import "TGPrivateFunctions.h"
+#import <mach/mach.h>
 
 CGFloat TGTimedTestBlock (void (^block)(void))
 {
-    mach_timebase_info_data_t info;
-    if (mach_timebase_info(&info) != KERN_SUCCESS) return -1.0;
-    
-    uint64_t start = mach_absolute_time ();
+    uint64_t start = TGMonotonicTime();
     block ();
-    uint64_t end = mach_absolute_time ();
-    uint64_t elapsed = end - start;
+    uint64_t elapsed = TGMonotonicTime() - start;
     
-    uint64_t nanos = elapsed * info.numer / info.denom;
-    return (CGFloat)nanos / NSEC_PER_SEC;
+    return (CGFloat)elapsed / NSEC_PER_SEC;
+}
+
+uint64_t TGSeededRandom (uint64_t *state)
+{
+    // splitmix64, small and fast with a good enough spread for generating data.
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t TGResidentMemorySize (void)
+{
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    
+    return info.resident_size;
 }
 
 @implementation TGTestFactory
@@ -112,6 +128,64 @@ CGFloat TGTimedTestBlock (void (^block)(void))
     return [NSArray arrayWithArray:returnArray];
 }
 
++ (NSArray *)buildSeededTestDataForResource:(TGRESTResource *)resource count:(NSUInteger)count seed:(uint64_t)seed
+{
+    NSParameterAssert(resource);
+    
+    static NSArray *words;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        words = @[@"alpha", @"bravo", @"charlie", @"delta", @"echo", @"foxtrot", @"golf", @"hotel",
+                  @"india", @"juliet", @"kilo", @"lima", @"mike", @"november", @"oscar", @"papa"];
+    });
+    
+    // Foreign keys are left out, only the caller knows which parents exist.
+    NSMutableDictionary *model = [resource.model mutableCopy];
+    [model removeObjectForKey:resource.primaryKey];
+    [model removeObjectsForKeys:resource.foreignKeys.allValues];
+    NSArray *keys = [model.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    
+    // Every row is generated from its own index so the data is the same no matter how the rows are split between threads.
+    __strong NSDictionary **rows = (__strong NSDictionary **)calloc(count, sizeof(NSDictionary *));
+    NSUInteger chunkSize = 4096;
+    dispatch_apply((count + chunkSize - 1) / chunkSize, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+        for (NSUInteger x = chunk * chunkSize; x < MIN(count, (chunk + 1) * chunkSize); x++) {
+            @autoreleasepool {
+                uint64_t state = seed ^ (x * 0xD1B54A32D192ED03ULL);
+                NSMutableDictionary *row = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+                for (NSString *key in keys) {
+                    uint64_t random = TGSeededRandom(&state);
+                    switch ([model[key] integerValue]) {
+                        case TGPropertyTypeString:
+                            row[key] = [NSString stringWithFormat:@"%@ %@ %llu", words[random & 15], words[(random >> 4) & 15], (random >> 8) % 100000];
+                            break;
+                        case TGPropertyTypeInteger:
+                            row[key] = [NSNumber numberWithInteger:(NSInteger)(random % 1000000)];
+                            break;
+                        case TGPropertyTypeFloatingPoint:
+                            row[key] = [NSNumber numberWithDouble:(double)(random >> 11) / (double)(1ULL << 53) * 180.0 - 90.0];
+                            break;
+                        case TGPropertyTypeBlob:
+                            row[key] = [NSData dataWithBytes:&random length:sizeof(random)];
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                rows[x] = [row copy];
+            }
+        }
+    });
+    
+    NSArray *data = [NSArray arrayWithObjects:rows count:count];
+    for (NSUInteger x = 0; x < count; x++) {
+        rows[x] = nil;
+    }
+    free(rows);
+    
+    return data;
+}
+
 + (void)createTestDataForResource:(TGRESTResource *)resource count:(NSUInteger)count
 {
     NSParameterAssert(resource);
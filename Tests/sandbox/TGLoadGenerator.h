@@ -0,0 +1,68 @@
+//
+//  TGLoadGenerator.h
+//  sandbox
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class TGRESTResource;
+
+/**
+ `TGLoadGenerator` drives a running server with a number of concurrent clients.  Every client sends one request at a time and sends the next as soon as the response arrives, picking the action from a weighted mix of index, show, create, update and destroy.  Latencies are measured from sending the request to receiving the whole response and are collected per action.
+ */
+
+@interface TGLoadGenerator : NSObject
+
+/**
+ Number of concurrent clients.  Default is 8.
+ */
+
+@property (nonatomic, assign) NSUInteger clientCount;
+
+/**
+ How long the clients send requests for, in seconds.  Default is 10.
+ */
+
+@property (nonatomic, assign) NSTimeInterval duration;
+
+/**
+ Number of objects created before the run starts so show, update and destroy have something to work on.  Default is 1000.
+ */
+
+@property (nonatomic, assign) NSUInteger seedCount;
+
+/**
+ Page size of the index requests.  Default is 50.
+ */
+
+@property (nonatomic, assign) NSUInteger indexLimit;
+
+/**
+ Relative weights of the actions with the action names as keys, for example `@{@"show": @60, @"create": @20}`.  Actions that aren't in the mix are never sent.  Default is 10% index, 50% show, 15% create, 15% update and 10% destroy.
+ */
+
+@property (nonatomic, copy) NSDictionary *actionMix;
+
+/**
+ *  Creates a load generator for one resource of a server.
+ *
+ *  @param baseURL  Base URL of the server.
+ *  @param resource The resource to send requests to, it must be added to the server.
+ *
+ *  @return A new load generator.
+ */
+
+- (instancetype)initWithBaseURL:(NSURL *)baseURL resource:(TGRESTResource *)resource;
+
+/**
+ *  Seeds the resource, runs the clients for the duration and waits for them to finish.  Call it from a thread other than the one the server runs on.
+ *
+ *  @return A report that can be written with NSJSONSerialization.  It has the totals under `requests`, `errors` and `requestsPerSecond`, and the same numbers plus the `p50`, `p99`, `p999` and `max` latencies in milliseconds for every action under `actions`.
+ */
+
+- (NSDictionary *)run;
+
+@end
@@ -0,0 +1,324 @@
+//
+//  TGLoadGenerator.m
+//  sandbox
+//
+//  Created by John Tumminaro on 5/9/14.
+//
+//
+
+#import "TGLoadGenerator.h"
+#import "RESTEasy.h"
+#import "TGPrivateFunctions.h"
+
+@interface TGLoadGenerator ()
+
+@property (nonatomic, strong) NSURL *baseURL;
+@property (nonatomic, strong) TGRESTResource *resource;
+@property (nonatomic, strong) NSURLSession *session;
+@property (nonatomic, strong) NSMutableArray *primaryKeys;
+@property (nonatomic, strong) NSDictionary *latencies;
+@property (nonatomic, strong) NSCountedSet *errors;
+@property (nonatomic, copy) NSArray *mixActions;
+@property (nonatomic, copy) NSArray *mixThresholds;
+@property (nonatomic, assign) uint32_t mixTotal;
+
+@end
+
+@implementation TGLoadGenerator
+
+- (instancetype)initWithBaseURL:(NSURL *)baseURL resource:(TGRESTResource *)resource
+{
+    NSParameterAssert(baseURL);
+    NSParameterAssert(resource);
+    
+    self = [super init];
+    if (self) {
+        self.baseURL = baseURL;
+        self.resource = resource;
+        self.clientCount = 8;
+        self.duration = 10;
+        self.seedCount = 1000;
+        self.indexLimit = 50;
+        self.actionMix = @{TGRESTRouteActionName(TGRESTRouteActionIndex): @10,
+                           TGRESTRouteActionName(TGRESTRouteActionShow): @50,
+                           TGRESTRouteActionName(TGRESTRouteActionCreate): @15,
+                           TGRESTRouteActionName(TGRESTRouteActionUpdate): @15,
+                           TGRESTRouteActionName(TGRESTRouteActionDestroy): @10};
+    }
+    
+    return self;
+}
+
+- (NSDictionary *)run
+{
+    [self prepareMix];
+    
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    configuration.HTTPMaximumConnectionsPerHost = MAX(self.clientCount, 1);
+    configuration.timeoutIntervalForRequest = 30;
+    self.session = [NSURLSession sessionWithConfiguration:configuration delegate:nil delegateQueue:[NSOperationQueue new]];
+    self.primaryKeys = [NSMutableArray new];
+    self.errors = [NSCountedSet new];
+    
+    NSMutableDictionary *latencies = [NSMutableDictionary new];
+    for (NSNumber *action in self.mixActions) {
+        latencies[action] = [TGRESTHistogram new];
+    }
+    // Actions with nothing to work on send a create instead, so creates are measured even when they aren't in the mix.
+    latencies[@(TGRESTRouteActionCreate)] = [TGRESTHistogram new];
+    self.latencies = latencies;
+    
+    [self seed];
+    
+    dispatch_group_t group = dispatch_group_create();
+    uint64_t start = TGMonotonicTime();
+    uint64_t deadline = start + (uint64_t)(self.duration * NSEC_PER_SEC);
+    for (NSUInteger x = 0; x < self.clientCount; x++) {
+        dispatch_group_enter(group);
+        [self sendNextRequestWithDeadline:deadline group:group];
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    double elapsed = (double)(TGMonotonicTime() - start) / NSEC_PER_SEC;
+    
+    [self.session finishTasksAndInvalidate];
+    self.session = nil;
+    
+    return [self reportWithElapsedTime:elapsed];
+}
+
+#pragma mark - Private
+
+- (void)prepareMix
+{
+    NSMutableArray *actions = [NSMutableArray new];
+    NSMutableArray *thresholds = [NSMutableArray new];
+    uint32_t total = 0;
+    
+    for (TGRESTRouteAction action = TGRESTRouteActionIndex; action <= TGRESTRouteActionDestroy; action++) {
+        uint32_t weight = [self.actionMix[TGRESTRouteActionName(action)] unsignedIntValue];
+        if (weight > 0) {
+            total += weight;
+            [actions addObject:@(action)];
+            [thresholds addObject:@(total)];
+        }
+    }
+    
+    for (NSString *name in self.actionMix) {
+        BOOL known = NO;
+        for (TGRESTRouteAction action = TGRESTRouteActionIndex; action <= TGRESTRouteActionDestroy; action++) {
+            known = known || [TGRESTRouteActionName(action) isEqualToString:name];
+        }
+        if (!known) {
+            [NSException raise:NSInvalidArgumentException format:@"%@ is not an action, use index, show, create, update or destroy", name];
+        }
+    }
+    
+    if (total == 0) {
+        [NSException raise:NSInvalidArgumentException format:@"The action mix needs at least one action with a weight"];
+    }
+    
+    self.mixActions = actions;
+    self.mixThresholds = thresholds;
+    self.mixTotal = total;
+}
+
+- (TGRESTRouteAction)randomAction
+{
+    uint32_t roll = arc4random_uniform(self.mixTotal);
+    for (NSUInteger x = 0; x < self.mixThresholds.count; x++) {
+        if (roll < [self.mixThresholds[x] unsignedIntValue]) {
+            return [self.mixActions[x] unsignedIntegerValue];
+        }
+    }
+    
+    return [[self.mixActions lastObject] unsignedIntegerValue];
+}
+
+- (void)seed
+{
+    dispatch_semaphore_t clients = dispatch_semaphore_create(MAX(self.clientCount, 1));
+    dispatch_group_t group = dispatch_group_create();
+    
+    for (NSUInteger x = 0; x < self.seedCount; x++) {
+        dispatch_semaphore_wait(clients, DISPATCH_TIME_FOREVER);
+        dispatch_group_enter(group);
+        NSURLRequest *request = [self requestForAction:TGRESTRouteActionCreate primaryKey:nil];
+        [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            [self addPrimaryKeyFromData:data];
+            dispatch_semaphore_signal(clients);
+            dispatch_group_leave(group);
+        }] resume];
+    }
+    
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+}
+
+- (void)sendNextRequestWithDeadline:(uint64_t)deadline group:(dispatch_group_t)group
+{
+    if (TGMonotonicTime() >= deadline) {
+        dispatch_group_leave(group);
+        return;
+    }
+    
+    TGRESTRouteAction action = [self randomAction];
+    NSString *primaryKey;
+    if (action == TGRESTRouteActionShow || action == TGRESTRouteActionUpdate || action == TGRESTRouteActionDestroy) {
+        // Destroyed objects leave the pool right away so two clients never delete the same one.
+        primaryKey = [self primaryKeyRemovingFromPool:action == TGRESTRouteActionDestroy];
+        if (!primaryKey) {
+            action = TGRESTRouteActionCreate;
+        }
+    }
+    
+    NSURLRequest *request = [self requestForAction:action primaryKey:primaryKey];
+    uint64_t start = TGMonotonicTime();
+    
+    __weak typeof(self) weakSelf = self;
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        uint64_t latency = TGMonotonicTime() - start;
+        NSInteger statusCode = [(NSHTTPURLResponse *)response statusCode];
+        BOOL succeeded = !error && statusCode >= 200 && statusCode < 300;
+        
+        [strongSelf.latencies[@(action)] recordValue:latency];
+        if (!succeeded) {
+            @synchronized(strongSelf.errors) {
+                [strongSelf.errors addObject:@(action)];
+            }
+        } else if (action == TGRESTRouteActionCreate) {
+            [strongSelf addPrimaryKeyFromData:data];
+        }
+        
+        [strongSelf sendNextRequestWithDeadline:deadline group:group];
+    }] resume];
+}
+
+- (NSURLRequest *)requestForAction:(TGRESTRouteAction)action primaryKey:(NSString *)primaryKey
+{
+    NSURL *resourceURL = [self.baseURL URLByAppendingPathComponent:self.resource.name];
+    NSMutableURLRequest *request;
+    
+    switch (action) {
+        case TGRESTRouteActionIndex:
+            request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:[NSString stringWithFormat:@"%@?limit=%lu", resourceURL.absoluteString, (unsigned long)self.indexLimit]]];
+            break;
+        case TGRESTRouteActionShow:
+            request = [NSMutableURLRequest requestWithURL:[resourceURL URLByAppendingPathComponent:primaryKey]];
+            break;
+        case TGRESTRouteActionCreate:
+            request = [NSMutableURLRequest requestWithURL:resourceURL];
+            request.HTTPMethod = @"POST";
+            break;
+        case TGRESTRouteActionUpdate:
+            request = [NSMutableURLRequest requestWithURL:[resourceURL URLByAppendingPathComponent:primaryKey]];
+            request.HTTPMethod = @"PUT";
+            break;
+        case TGRESTRouteActionDestroy:
+            request = [NSMutableURLRequest requestWithURL:[resourceURL URLByAppendingPathComponent:primaryKey]];
+            request.HTTPMethod = @"DELETE";
+            break;
+        default:
+            break;
+    }
+    
+    if (action == TGRESTRouteActionCreate || action == TGRESTRouteActionUpdate) {
+        [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+        request.HTTPBody = [NSJSONSerialization dataWithJSONObject:[self randomObject] options:0 error:nil];
+    }
+    
+    return request;
+}
+
+- (NSDictionary *)randomObject
+{
+    NSMutableDictionary *object = [NSMutableDictionary new];
+    for (NSString *key in self.resource.model) {
+        if ([key isEqualToString:self.resource.primaryKey]) {
+            continue;
+        }
+        
+        switch ([self.resource.model[key] integerValue]) {
+            case TGPropertyTypeString:
+                object[key] = [NSString stringWithFormat:@"%08x%08x", arc4random(), arc4random()];
+                break;
+            case TGPropertyTypeInteger:
+                object[key] = @(arc4random_uniform(1000000));
+                break;
+            case TGPropertyTypeFloatingPoint:
+                object[key] = @((double)arc4random() / UINT32_MAX * 1000);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    return object;
+}
+
+- (void)addPrimaryKeyFromData:(NSData *)data
+{
+    if (!data) {
+        return;
+    }
+    
+    NSDictionary *object = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (![object isKindOfClass:[NSDictionary class]] || !object[self.resource.primaryKey]) {
+        return;
+    }
+    
+    @synchronized(self.primaryKeys) {
+        [self.primaryKeys addObject:[object[self.resource.primaryKey] description]];
+    }
+}
+
+- (NSString *)primaryKeyRemovingFromPool:(BOOL)remove
+{
+    @synchronized(self.primaryKeys) {
+        if (self.primaryKeys.count == 0) {
+            return nil;
+        }
+        
+        NSUInteger index = arc4random_uniform((uint32_t)self.primaryKeys.count);
+        NSString *primaryKey = self.primaryKeys[index];
+        if (remove) {
+            // Swap with the last key so removing stays constant time.
+            self.primaryKeys[index] = [self.primaryKeys lastObject];
+            [self.primaryKeys removeLastObject];
+        }
+        
+        return primaryKey;
+    }
+}
+
+- (NSDictionary *)reportWithElapsedTime:(double)elapsed
+{
+    NSMutableDictionary *actions = [NSMutableDictionary new];
+    uint64_t totalRequests = 0;
+    NSUInteger totalErrors = 0;
+    
+    for (NSNumber *action in self.latencies) {
+        TGRESTHistogram *histogram = [self.latencies[action] copy];
+        NSUInteger errorCount = [self.errors countForObject:action];
+        totalRequests += histogram.count;
+        totalErrors += errorCount;
+        
+        actions[TGRESTRouteActionName([action unsignedIntegerValue])] = @{@"requests": @(histogram.count),
+                                                                           @"errors": @(errorCount),
+                                                                           @"requestsPerSecond": @(histogram.count / elapsed),
+                                                                           @"p50": @((double)[histogram valueAtPercentile:50] / NSEC_PER_MSEC),
+                                                                           @"p99": @((double)[histogram valueAtPercentile:99] / NSEC_PER_MSEC),
+                                                                           @"p999": @((double)[histogram valueAtPercentile:99.9] / NSEC_PER_MSEC),
+                                                                           @"max": @((double)histogram.maximum / NSEC_PER_MSEC)};
+    }
+    
+    return @{@"resource": self.resource.name,
+             @"clients": @(self.clientCount),
+             @"seedCount": @(self.seedCount),
+             @"duration": @(elapsed),
+             @"requests": @(totalRequests),
+             @"errors": @(totalErrors),
+             @"requestsPerSecond": @(totalRequests / elapsed),
+             @"actions": actions};
+}
+
+@end
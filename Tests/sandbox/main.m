@@ -8,12 +8,130 @@
 
 #import <Foundation/Foundation.h>
 #import "RESTEasy.h"
+#import "TGLoadGenerator.h"
+
+/**
+ Action mixes are given as a comma separated list like `show=60,create=20`.
+ */
+
+static NSDictionary *TGActionMixFromString(NSString *string)
+{
+    NSMutableDictionary *mix = [NSMutableDictionary new];
+    for (NSString *component in [string componentsSeparatedByString:@","]) {
+        NSArray *pair = [component componentsSeparatedByString:@"="];
+        if (pair.count != 2) {
+            [NSException raise:NSInvalidArgumentException format:@"%@ is not an action and weight pair like show=60", component];
+        }
+        NSString *name = [pair[0] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        mix[name] = @([pair[1] integerValue]);
+    }
+    
+    return mix;
+}
+
+/**
+ Benchmark resources have a primary key plus the given number of fields, cycling through strings, integers and floating point numbers.
+ */
+
+static TGRESTResource *TGBenchmarkResource(NSUInteger fieldCount)
+{
+    NSArray *types = @[[NSNumber numberWithInteger:TGPropertyTypeString],
+                       [NSNumber numberWithInteger:TGPropertyTypeInteger],
+                       [NSNumber numberWithInteger:TGPropertyTypeFloatingPoint]];
+    NSMutableDictionary *model = [NSMutableDictionary new];
+    for (NSUInteger x = 0; x < fieldCount; x++) {
+        model[[NSString stringWithFormat:@"field%lu", (unsigned long)x]] = types[x % types.count];
+    }
+    
+    return [TGRESTResource newResourceWithName:@"widgets" model:model];
+}
+
+/**
+ Runs the load generator against a fresh server and writes the report as JSON.  Options are read from the argument domain of NSUserDefaults, so they are passed like `-clients 16`.
+ */
+
+static int TGRunBenchmark(NSUserDefaults *defaults)
+{
+    NSString *storeClassName = [defaults stringForKey:@"store"] ?: @"TGRESTInMemoryStore";
+    Class storeClass = NSClassFromString(storeClassName);
+    if (![storeClass isSubclassOfClass:[TGRESTStore class]]) {
+        fprintf(stderr, "%s is not a TGRESTStore subclass\n", storeClassName.UTF8String);
+        return 1;
+    }
+    
+    NSUInteger fieldCount = [defaults objectForKey:@"fields"] ? [defaults integerForKey:@"fields"] : 4;
+    TGRESTResource *resource = TGBenchmarkResource(fieldCount);
+    NSNumber *port = [defaults objectForKey:@"port"] ? @([defaults integerForKey:@"port"]) : @8888;
+    
+    [TGRESTServer setLogLevel:TGRESTServerLogLevelError];
+    [[TGRESTServer sharedServer] addResource:resource];
+    [[TGRESTServer sharedServer] startServerWithOptions:@{
+                                                          TGRESTServerDatastoreClassOptionKey: storeClass,
+                                                          TGWebServerPortNumberOptionKey: port
+                                                          }];
+    
+    TGLoadGenerator *generator = [[TGLoadGenerator alloc] initWithBaseURL:[[TGRESTServer sharedServer] serverURL] resource:resource];
+    if ([defaults objectForKey:@"clients"]) {
+        generator.clientCount = [defaults integerForKey:@"clients"];
+    }
+    if ([defaults objectForKey:@"duration"]) {
+        generator.duration = [defaults doubleForKey:@"duration"];
+    }
+    if ([defaults objectForKey:@"seed"]) {
+        generator.seedCount = [defaults integerForKey:@"seed"];
+    }
+    if ([defaults objectForKey:@"limit"]) {
+        generator.indexLimit = [defaults integerForKey:@"limit"];
+    }
+    if ([defaults stringForKey:@"mix"]) {
+        generator.actionMix = TGActionMixFromString([defaults stringForKey:@"mix"]);
+    }
+    
+    __block NSDictionary *report;
+    __block BOOL finished = NO;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        report = [generator run];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            finished = YES;
+        });
+    });
+    
+    while (!finished) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+    }
+    
+    [[TGRESTServer sharedServer] stopServer];
+    
+    NSMutableDictionary *output = [report mutableCopy];
+    output[@"store"] = storeClassName;
+    output[@"fields"] = @(fieldCount);
+    NSData *json = [NSJSONSerialization dataWithJSONObject:output options:NSJSONWritingPrettyPrinted error:nil];
+    
+    NSString *outputPath = [defaults stringForKey:@"output"];
+    if (outputPath) {
+        NSError *error;
+        if (![json writeToFile:outputPath options:NSDataWritingAtomic error:&error]) {
+            fprintf(stderr, "Couldn't write the report to %s: %s\n", outputPath.UTF8String, error.localizedDescription.UTF8String);
+            return 1;
+        }
+    } else {
+        fwrite(json.bytes, 1, json.length, stdout);
+        fputc('\n', stdout);
+    }
+    
+    return 0;
+}
 
 int main(int argc, const char * argv[])
 {
 
     @autoreleasepool {
         
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+        if ([defaults boolForKey:@"benchmark"]) {
+            return TGRunBenchmark(defaults);
+        }
+        
         TGRESTResource *people = [TGRESTResource newResourceWithName:@"people" model:@{
                                                                                        @"name": [NSNumber numberWithInteger:TGPropertyTypeString],
                                                                                        @"numberOfKids": [NSNumber numberWithInteger:TGPropertyTypeInteger],